@@ -10,6 +10,16 @@
 #include "BluetoothSerial.h"
 #include <WiFi.h>
 #include <WebServer.h>
+#include <BootTimeline.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <FastWiFi.h>
+#include <ResponseBuffer.h>
+#include <SppLink.h>
+#include <WiFiIdentity.h>
+#include <WiFiReconnect.h>
+#include <LoopIdle.h>
 
 // Check if Bluetooth is available
 #if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
@@ -19,104 +29,238 @@
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
 
-// Network Configuration  
+// Network Configuration (used until a connect has saved them in NVS)
 const char* ssid = "YOUR_WIFI_SSID";
 const char* password = "YOUR_WIFI_PASSWORD";
+const uint32_t WIFI_TIMEOUT_MS = 10000;
 
 // Bluetooth Configuration
 const char* BT_DEVICE_NAME = "ESP32_Hybrid_Server";
+const size_t BT_MAX_LINE_LENGTH = 64;         // Longer commands are rejected
+const uint32_t BT_LINE_IDLE_FLUSH_MS = 1000;  // Terminals that send no line ending
+const size_t BT_TX_BUFFER_SIZE = 512;         // Largest reply assembled before sending
+const size_t BT_TX_CHUNK_SIZE = 330;          // Bytes per SerialBT.write() (RFCOMM MTU)
+const uint32_t BT_POLL_INTERVAL_MS = 10;      // SerialBT has no socket to wait on
+const char* BT_REPLY_END = "\r\n";            // Blank line closing each reply after "mode:script"
 
 // Global Objects
 BluetoothSerial SerialBT;
 WebServer server(80);
+StaticLineAssembler<BT_MAX_LINE_LENGTH> btLine;
+SppLink btLink(btLine);  // Text commands + binary frames on the same link
+StaticResponseBuffer<BT_TX_BUFFER_SIZE> btOut;
+DeviceIdentity identity;  // MAC/IP/SSID formatted once, not per request
+WiFiCache wifiCache;  // Credentials, AP and address saved in NVS
+FastWiFi::Connector wifiConnector;  // Associates while Bluetooth comes up
+BootTimeline boot;    // Reset to the first Bluetooth or REST command
+uint8_t wifiPhase = BootTimeline::NO_PHASE;
 
 // State Variables
-bool ledState = false;
+CommandBus bus;  // Single LED state shared by REST and Bluetooth
 bool bluetoothConnected = false;
+bool btScriptReplies = false;  // Set by "mode:script", cleared when the client leaves
 bool wifiConnected = false;
+bool serverStarted = false;  // The REST server listens from the first connect on
 
 /**
- * @brief Get Bluetooth MAC address as formatted string
+ * @brief Read the Bluetooth MAC address once into the identity cache
  * 
  * This function properly handles the getBtAddress() method which requires
- * a uint8_t array parameter to store the 6-byte MAC address.
- * 
- * @return String formatted MAC address (XX:XX:XX:XX:XX:XX)
+ * a uint8_t array parameter to store the 6-byte MAC address. The formatted
+ * string (XX:XX:XX:XX:XX:XX) is then served from identity.bluetoothMac().
  */
-String getBluetoothMAC() {
+void cacheBluetoothMAC() {
   uint8_t mac[6];
   SerialBT.getBtAddress(mac);
+  identity.setBluetoothMac(mac);
+}
+
+/**
+ * @brief Drive the LED pin (CommandBus output hook)
+ */
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
+  Serial.println(state.led ? "LED: ON" : "LED: OFF");
+}
+
+/**
+ * @brief Bluetooth adapter - tell a connected terminal about changes made elsewhere
+ * 
+ * Changes made over Bluetooth are already confirmed by the command reply.
+ */
+void onLedChangedBluetooth(const StateEvent& event, void*) {
+  if (event.source == TRANSPORT_SPP || !SerialBT.hasClient()) return;
   
-  char macStr[18];  // 17 chars + null terminator
-  sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
-          mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-  
-  return String(macStr);
+  StaticResponseBuffer<64> note;
+  note.printf("LED turned %s via %s\r\n", event.state.led ? "ON" : "OFF", transportName(event.source));
+  note.flushTo(SerialBT);
+}
+
+/**
+ * @brief Close the boot timeline on the first command, over either transport
+ */
+void checkBootDone(const char* phase) {
+  if (!boot.ready(phase, micros())) return;
+  StaticResponseBuffer<192> line;
+  boot.report(line);
+  Serial.println(line.c_str());
 }
 
 /**
- * @brief Control LED state
+ * @brief Send the reply in btOut, closed with BT_REPLY_END in script mode
+ *
+ * A script that sent "mode:script" knows the reply is complete at the blank
+ * line, whatever its length. Terminal users get the reply as it was.
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
-  Serial.println(state ? "LED: ON" : "LED: OFF");
+void sendBluetoothReply() {
+  if (btScriptReplies) btOut.print(BT_REPLY_END);
+  btOut.flushTo(SerialBT, BT_TX_CHUNK_SIZE);
 }
 
 /**
  * @brief Process Bluetooth commands
+ * 
+ * Each reply is assembled in btOut and sent with a single write, so a
+ * multi-line block arrives as one RFCOMM packet instead of one per line.
  */
-void processBluetoothCommand(String command) {
-  command.trim();
-  command.toLowerCase();
+void processBluetoothCommand(const char* text, size_t length) {
+  Serial.print("BT Command: ");
+  Serial.println(text);
+  checkBootDone("first_bt_command");
   
-  Serial.println("BT Command: " + command);
+  Command command;
+  parseTextCommand(text, length, TRANSPORT_SPP, command);
   
-  if (command == "led on") {
-    setLED(true);
-    SerialBT.println("LED turned ON via Bluetooth");
-    
-  } else if (command == "led off") {
-    setLED(false);
-    SerialBT.println("LED turned OFF via Bluetooth");
+  if (command.type == CMD_LED_SET || command.type == CMD_LED_TOGGLE) {
+    bus.dispatch(command);
+    btOut.println(bus.led() ? "LED turned ON via Bluetooth" : "LED turned OFF via Bluetooth");
     
-  } else if (command == "status") {
-    SerialBT.println("=== Device Status ===");
-    SerialBT.println("Device: ESP32 Hybrid Server");
-    SerialBT.println("Bluetooth Name: " + String(BT_DEVICE_NAME));
-    SerialBT.println("Bluetooth MAC: " + getBluetoothMAC());  // FIXED: Using helper function
-    SerialBT.println("WiFi Status: " + String(wifiConnected ? "Connected" : "Disconnected"));
+  } else if (command.type == CMD_STATUS) {
+    btOut.println("=== Device Status ===");
+    btOut.println("Device: ESP32 Hybrid Server");
+    btOut.printf("Bluetooth Name: %s\r\n", identity.name());
+    btOut.printf("Bluetooth MAC: %s\r\n", identity.bluetoothMac());  // FIXED: Cached at startup
+    btOut.printf("WiFi Status: %s\r\n", wifiConnected ? "Connected" : "Disconnected");
     if (wifiConnected) {
-      SerialBT.println("WiFi IP: " + WiFi.localIP().toString());
-      SerialBT.println("REST API: http://" + WiFi.localIP().toString() + "/");
+      btOut.printf("WiFi IP: %s\r\n", identity.ip());
+      btOut.printf("REST API: http://%s/\r\n", identity.ip());
     }
-    SerialBT.println("LED State: " + String(ledState ? "ON" : "OFF"));
-    SerialBT.println("Uptime: " + String(millis() / 1000) + " seconds");
-    SerialBT.println("Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
-    SerialBT.println("====================");
+    btOut.printf("LED State: %s\r\n", bus.led() ? "ON" : "OFF");
+    btOut.printf("Uptime: %lu seconds\r\n", (unsigned long)(millis() / 1000));
+    btOut.printf("Free Heap: %lu bytes\r\n", (unsigned long)ESP.getFreeHeap());
+    btOut.println("====================");
     
-  } else if (command == "wifi status") {
+  } else if (command.type == CMD_WIFI_STATUS) {
     if (wifiConnected) {
-      SerialBT.println("WiFi Connected!");
-      SerialBT.println("SSID: " + WiFi.SSID());
-      SerialBT.println("IP: " + WiFi.localIP().toString());
-      SerialBT.println("Signal: " + String(WiFi.RSSI()) + " dBm");
+      btOut.println("WiFi Connected!");
+      btOut.printf("SSID: %s\r\n", identity.ssid());
+      btOut.printf("IP: %s\r\n", identity.ip());
+      btOut.printf("Signal: %d dBm\r\n", (int)WiFi.RSSI());
     } else {
-      SerialBT.println("WiFi Disconnected");
+      btOut.println("WiFi Disconnected");
     }
     
-  } else if (command == "help") {
-    SerialBT.println("=== Available Commands ===");
-    SerialBT.println("led on        - Turn LED ON");
-    SerialBT.println("led off       - Turn LED OFF");
-    SerialBT.println("status        - Get device status");
-    SerialBT.println("wifi status   - Get WiFi status");
-    SerialBT.println("help          - Show this help");
-    SerialBT.println("==========================");
+  } else if (command.type == CMD_HELP) {
+    btOut.println("=== Available Commands ===");
+    btOut.println("led on        - Turn LED ON");
+    btOut.println("led off       - Turn LED OFF");
+    btOut.println("status        - Get device status");
+    btOut.println("wifi status   - Get WiFi status");
+    btOut.println("help          - Show this help");
+    btOut.println("==========================");
+    
+  } else if (command.type == CMD_REPLY_MODE) {
+    btScriptReplies = command.value;
+    btOut.println(btScriptReplies ? "Reply mode: script" : "Reply mode: terminal");
     
   } else {
-    SerialBT.println("Unknown command: " + command);
-    SerialBT.println("Type 'help' for available commands");
+    btOut.printf("Unknown command: %s\r\n", text);
+    btOut.println("Type 'help' for available commands");
+  }
+  
+  sendBluetoothReply();
+}
+
+/**
+ * @brief Process a binary Bluetooth frame (see SppFrame.h for the layout)
+ */
+void processBluetoothFrame(const SppFrame& frame) {
+  uint8_t reply[SPP_FRAME_MAX_PAYLOAD];
+  uint8_t length = 0;
+  checkBootDone("first_bt_command");
+  
+  switch (frame.command) {
+    case SPP_CMD_PING:
+      reply[length++] = SPP_OK;
+      break;
+      
+    case SPP_CMD_STATUS:
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      reply[length++] = wifiConnected ? 1 : 0;
+      reply[length++] = (uint8_t)(int8_t)(wifiConnected ? WiFi.RSSI() : 0);
+      length += sppPutU32(reply + length, millis() / 1000);
+      length += sppPutU32(reply + length, ESP.getFreeHeap());
+      break;
+      
+    case SPP_CMD_LED_SET:
+      if (frame.length != 1) {
+        reply[length++] = SPP_ERR_BAD_LENGTH;
+        break;
+      }
+      bus.dispatch(Command::ledSet(frame.payload[0] != 0, TRANSPORT_SPP));
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      break;
+      
+    case SPP_CMD_LED_TOGGLE:
+      bus.dispatch(Command::toggle(TRANSPORT_SPP));
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      break;
+      
+    default:
+      reply[length++] = SPP_ERR_UNKNOWN_CMD;
+      break;
+  }
+  
+  btLink.reply(SerialBT, frame, reply, length);
+}
+
+/**
+ * @brief Poll Bluetooth input without blocking
+ * 
+ * Consumes only the bytes already received, so a slow terminal typing a
+ * command never holds up server.handleClient(). Binary frames are detected
+ * from their first byte; text commands work as before.
+ */
+void pollBluetooth() {
+  if (!SerialBT.hasClient()) btScriptReplies = false;  // The next client starts in terminal mode
+  
+  switch (btLink.poll(SerialBT, millis())) {
+    case SppLink::SPP_LINE:
+      if (btLink.lineLength() > 0) {
+        processBluetoothCommand(btLink.line(), btLink.lineLength());
+      }
+      break;
+      
+    case SppLink::SPP_LINE_OVERFLOW:
+      Serial.println("BT Command rejected: line too long");
+      btOut.printf("Command too long (max %u characters)\r\n", (unsigned)BT_MAX_LINE_LENGTH);
+      sendBluetoothReply();
+      break;
+      
+    case SppLink::SPP_FRAME:
+      processBluetoothFrame(btLink.frame());
+      break;
+      
+    case SppLink::SPP_FRAME_ERROR:
+      Serial.println("BT Frame rejected: error " + String(btLink.error()));
+      btLink.replyError(SerialBT);
+      break;
+      
+    default:
+      break;
   }
 }
 
@@ -124,10 +268,13 @@ void processBluetoothCommand(String command) {
  * @brief REST API Handlers
  */
 void handleRoot() {
+  checkBootDone("first_request");
   String html = "<!DOCTYPE html><html><head><title>ESP32 Hybrid Server</title></head>";
   html += "<body><h1>ESP32 REST + Bluetooth Server</h1>";
-  html += "<p>LED Status: " + String(ledState ? "ON" : "OFF") + "</p>";
-  html += "<p>Bluetooth MAC: " + getBluetoothMAC() + "</p>";  // FIXED: Using helper function
+  html += "<p>LED Status: " + String(bus.led() ? "ON" : "OFF") + "</p>";
+  html += "<p>Bluetooth MAC: ";
+  html += identity.bluetoothMac();  // FIXED: Cached at startup
+  html += "</p>";
   html += "<p><a href='/led/on'>Turn LED ON</a> | <a href='/led/off'>Turn LED OFF</a></p>";
   html += "<p><a href='/status'>Device Status</a></p>";
   html += "</body></html>";
@@ -136,27 +283,38 @@ void handleRoot() {
 }
 
 void handleLEDOn() {
-  setLED(true);
+  checkBootDone("first_request");
+  bus.dispatch(Command::ledSet(true, TRANSPORT_REST));
   server.send(200, "application/json", "{\"status\":\"success\",\"led\":\"on\",\"message\":\"LED turned ON via REST API\"}");
 }
 
 void handleLEDOff() {
-  setLED(false);
+  checkBootDone("first_request");
+  bus.dispatch(Command::ledSet(false, TRANSPORT_REST));
   server.send(200, "application/json", "{\"status\":\"success\",\"led\":\"off\",\"message\":\"LED turned OFF via REST API\"}");
 }
 
 void handleStatus() {
+  checkBootDone("first_request");
   String json = "{";
   json += "\"device\":\"ESP32 Hybrid Server\",";
-  json += "\"bluetooth_name\":\"" + String(BT_DEVICE_NAME) + "\",";
-  json += "\"bluetooth_mac\":\"" + getBluetoothMAC() + "\",";  // FIXED: Using helper function
+  json += "\"bluetooth_name\":\"";
+  json += identity.name();
+  json += "\",\"bluetooth_mac\":\"";
+  json += identity.bluetoothMac();  // FIXED: Cached at startup
+  json += "\",";
   json += "\"wifi_connected\":" + String(wifiConnected ? "true" : "false") + ",";
   if (wifiConnected) {
-    json += "\"wifi_ip\":\"" + WiFi.localIP().toString() + "\",";
-    json += "\"wifi_ssid\":\"" + WiFi.SSID() + "\",";
+    json += "\"wifi_ip\":\"";
+    json += identity.ip();
+    json += "\",\"wifi_ssid\":\"";
+    json += identity.ssid();
+    json += "\",";
     json += "\"wifi_rssi\":" + String(WiFi.RSSI()) + ",";
   }
-  json += "\"led_state\":\"" + String(ledState ? "on" : "off") + "\",";
+  json += "\"wifi_outages\":" + String(WiFiReconnect::policy().outages()) + ",";
+  json += "\"wifi_last_recovery_ms\":" + String(WiFiReconnect::policy().lastRecoveryMs()) + ",";
+  json += "\"led_state\":\"" + String(bus.led() ? "on" : "off") + "\",";
   json += "\"uptime_seconds\":" + String(millis() / 1000) + ",";
   json += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
   json += "\"bluetooth_connected\":" + String(bluetoothConnected ? "true" : "false");
@@ -166,9 +324,67 @@ void handleStatus() {
 }
 
 void handleNotFound() {
+  checkBootDone("first_request");
   server.send(404, "application/json", "{\"error\":\"Endpoint not found\",\"message\":\"Available endpoints: /, /led/on, /led/off, /status\"}");
 }
 
+/**
+ * @brief Advance the WiFi connect started in setup() (non-blocking)
+ *
+ * After the first connect the channel and BSSID are cached, so a reboot
+ * skips the scan (FastWiFi.h). Once it is done or failed, WiFiReconnect
+ * keeps (re)connecting with backoff.
+ */
+void updateWiFi() {
+  if (!wifiConnector.pending()) {
+    switch (WiFiReconnect::poll(millis())) {
+      case WiFiReconnect::LOST:
+        wifiConnected = false;
+        Serial.println("WiFi connection lost - reconnecting");
+        break;
+      case WiFiReconnect::CONNECTED:
+        wifiConnected = true;
+        if (serverStarted) {
+          Serial.println("WiFi reconnected after " +
+                         String(WiFiReconnect::policy().lastRecoveryMs()) + " ms: " +
+                         String(identity.ip()));
+        }
+        startServer();
+        break;
+      case WiFiReconnect::NONE:
+        break;
+    }
+    return;
+  }
+  FastWiFi::Result result = wifiConnector.update();
+  if (result == FastWiFi::PENDING) return;
+  
+  boot.end(wifiPhase, micros());
+  boot.setNote(FastWiFi::describe(result, wifiCache, false));
+  WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());
+  if (result == FastWiFi::FAILED) {
+    Serial.println("WiFi connection failed, continuing with Bluetooth only (retrying)");
+    return;
+  }
+  if (!FastWiFi::remember(wifiCache, false)) {
+    Serial.println("WARNING: could not save WiFi settings");
+  }
+  wifiConnected = true;
+  startServer();
+}
+
+/**
+ * @brief Start the REST server the first time WiFi has an address
+ */
+void startServer() {
+  if (serverStarted) return;
+  server.begin();
+  serverStarted = true;
+  WiFiIdentity::refresh();  // The got-IP event may be newer than loop()'s refresh
+  if (!boot.finished()) boot.mark("listen", micros());
+  Serial.println("REST API server started: http://" + String(identity.ip()) + "/");
+}
+
 /**
  * @brief Setup function
  */
@@ -178,30 +394,23 @@ void setup() {
   Serial.println();
   Serial.println("ESP32 REST + Bluetooth Hybrid Server Starting...");
   
+  // Start WiFi first: it associates while Bluetooth and the routes come up
+  if (!FastWiFi::load(wifiCache)) {
+    wifiCache.setCredentials(ssid, password);
+  }
+  wifiPhase = boot.begin("wifi", micros());
+  wifiConnector.start(wifiCache, WIFI_TIMEOUT_MS, false);
+  identity.setName(BT_DEVICE_NAME);
+  WiFiIdentity::begin(identity);
+  
   // Initialize LED
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.subscribe(onLedChangedBluetooth);
+  bus.applyOutput();  // LED off
   
-  // Initialize WiFi
-  Serial.print("Connecting to WiFi");
-  WiFi.begin(ssid, password);
-  
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
-  }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    wifiConnected = true;
-    Serial.println();
-    Serial.println("WiFi connected successfully!");
-    Serial.println("IP address: " + WiFi.localIP().toString());
-  } else {
-    Serial.println();
-    Serial.println("WiFi connection failed, continuing with Bluetooth only");
-  }
+  btLine.setIdleFlush(BT_LINE_IDLE_FLUSH_MS);
+  boot.mark("init", micros());
   
   // Initialize Bluetooth
   if (!SerialBT.begin(BT_DEVICE_NAME)) {
@@ -209,80 +418,71 @@ void setup() {
   } else {
     Serial.println("Bluetooth initialized successfully!");
   }
+  cacheBluetoothMAC();
+  boot.mark("bluetooth", micros());
   
-  // Setup REST API endpoints
-  if (wifiConnected) {
-    server.on("/", handleRoot);
-    server.on("/led/on", handleLEDOn);
-    server.on("/led/off", handleLEDOff);
-    server.on("/status", handleStatus);
-    server.onNotFound(handleNotFound);
-    
-    server.begin();
-    Serial.println("REST API server started!");
-  }
+  // Setup REST API endpoints (the server starts once WiFi connects)
+  server.on("/", handleRoot);
+  server.on("/led/on", handleLEDOn);
+  server.on("/led/off", handleLEDOff);
+  server.on("/status", handleStatus);
+  server.onNotFound(handleNotFound);
   
   // Display device information
   Serial.println();
   Serial.println("=== Device Information ===");
   Serial.println("Bluetooth Name: " + String(BT_DEVICE_NAME));
-  Serial.println("Bluetooth MAC: " + getBluetoothMAC());  // FIXED: Using helper function
-  if (wifiConnected) {
-    Serial.println("REST API URL: http://" + WiFi.localIP().toString() + "/");
-  }
+  Serial.println("Bluetooth MAC: " + String(identity.bluetoothMac()));  // FIXED: Cached at startup
+  Serial.println("WiFi: connecting to " + String(wifiCache.ssid()));
   Serial.println("==========================");
   Serial.println();
   Serial.println("Device ready! You can:");
-  if (wifiConnected) {
-    Serial.println("- Access REST API via web browser");
-    Serial.println("- Send HTTP requests to control LED");
-  }
   Serial.println("- Connect via Bluetooth and send commands");
   Serial.println("- Send 'help' via Bluetooth for command list");
+  Serial.println("- Use the REST API once WiFi connects (URL printed then)");
+  boot.mark("servers", micros());  // Includes the banner: Serial output blocks at 115200 baud
 }
 
 /**
  * @brief Main loop
  */
 void loop() {
+  // Re-format MAC/IP/SSID only after a WiFi event
+  WiFiIdentity::refresh();
+  
+  updateWiFi();
+  
   // Handle REST API requests (if WiFi is connected)
   if (wifiConnected) {
     server.handleClient();
   }
   
-  // Handle Bluetooth commands
-  if (SerialBT.available()) {
-    String command = SerialBT.readStringUntil('\n');
-    processBluetoothCommand(command);
-  }
-  
-  // Check WiFi connection status
-  if (WiFi.status() != WL_CONNECTED && wifiConnected) {
-    wifiConnected = false;
-    Serial.println("WiFi connection lost");
-  } else if (WiFi.status() == WL_CONNECTED && !wifiConnected) {
-    wifiConnected = true;
-    Serial.println("WiFi reconnected: " + WiFi.localIP().toString());
-  }
+  // Handle Bluetooth commands (non-blocking)
+  pollBluetooth();
   
-  delay(10);  // Small delay to prevent watchdog issues
+  // Wake on the next HTTP request, or after BT_POLL_INTERVAL_MS to poll SerialBT
+  LoopIdle::wait(BT_POLL_INTERVAL_MS);
 }
 
 /*
  * KEY FIXES MADE:
  * 
- * 1. Added getBluetoothMAC() helper function that properly handles getBtAddress()
+ * 1. Added cacheBluetoothMAC() helper function that properly handles getBtAddress()
  *    - Creates uint8_t mac[6] array to store the MAC address
  *    - Uses SerialBT.getBtAddress(mac) with the required parameter
- *    - Formats the MAC address as a readable string using sprintf()
+ *    - Formats the MAC address once into the DeviceIdentity cache
  * 
- * 2. Replaced all instances of SerialBT.getBtAddress() with getBluetoothMAC()
+ * 2. Replaced all instances of SerialBT.getBtAddress() with identity.bluetoothMac()
  *    - Line 78 in processBluetoothCommand() function
  *    - Line 129 in setup() function
  *    - Added to REST API responses for consistency
  * 
  * 3. Added comprehensive error handling and status reporting
  * 
+ * 4. WiFi connects in the background: Bluetooth is up within a second of
+ *    reset, and the REST server starts on the first connect even when WiFi
+ *    was not ready in setup() (it used to never start in that case)
+ * 
  * USAGE:
  * 1. Copy this entire code to your sketch_REST_Socket_Hybrid.ino file
  * 2. Update the WiFi credentials (ssid and password)
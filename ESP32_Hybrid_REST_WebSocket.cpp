@@ -1,6 +1,44 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <WebSocketsServer.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <WiFiIdentity.h>
+#include <WiFiReconnect.h>
+#include <WiFiPowerSave.h>
+#include <Scheduler.h>
+#include <LoopIdle.h>
+#include <MpscQueue.h>
+#include <SpscQueue.h>
+#include <MetricsEndpoint.h>
+#include <RequestArena.h>
+#include <JsonWriter.h>
+#include <CommandTrace.h>
+#include <FastWiFi.h>
+#include <ProvisioningPortal.h>
+#include <BootTimeline.h>
+
+// Serial log lines above this level are compiled out (LOG_LEVEL_WARN: errors
+// and warnings only - no banner, no per-request lines)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+// 1: send log lines as binary frames, decoded on the host by
+// host/tools/logdecode.cpp - cheap enough for LOG_LEVEL_DEBUG under load
+#ifndef LOG_BINARY
+#define LOG_BINARY 0
+#endif
+#include <Log.h>
+#include <FlightLog.h>
+
+// Per-phase cycle timing of the network task: GET /profile and the serial
+// command "profile" ("profile reset" starts a new window). 0 compiles it out.
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 0
+#endif
+#include <LoopProfiler.h>
+#include <LineAssembler.h>
 
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
@@ -9,20 +47,127 @@ const uint16_t WEBSOCKET_PORT = 81;
 
 // Timing Configuration
 const uint32_t WIFI_TIMEOUT_MS = 10000;
-const uint32_t WIFI_CHECK_INTERVAL_MS = 30000;
-const uint32_t SERIAL_TIMEOUT_MS = 30000;
+const uint32_t PROVISION_TIMEOUT_MS = 30000;  // Saved network down: wait this long for new credentials
 const uint32_t STATUS_BROADCAST_INTERVAL_MS = 5000;
+const uint32_t TELEMETRY_INTERVAL_MS = 1000;
+
+// WiFi power save: off while clients are connected or requests arrived in
+// the last POWER_SAVE_IDLE_MS, then modem sleep, deeper after
+// POWER_SAVE_DEEP_IDLE_MS (0: never). An idle board saves power; the first
+// request after idling waits for the next beacon (see WiFiPowerSave.h)
+const uint32_t POWER_SAVE_IDLE_MS = 10000;
+const uint32_t POWER_SAVE_DEEP_IDLE_MS = 120000;
+
+// Reboots reuse the last DHCP address instead of asking again: saves up to
+// a second, but only safe where the router reserves it (see FastWiFi.h)
+const bool REUSE_DHCP_LEASE = false;
+
+// Task Configuration
+// HTTP/WebSocket run in a network task on the other core (with the WiFi and
+// lwIP tasks); the Arduino loop task keeps the application (CommandBus,
+// GPIO, sampling)
+const uint32_t NETWORK_TASK_STACK = 8192;
+const UBaseType_t NETWORK_TASK_PRIORITY = 1;
+
+// Per-request memory for response JSON (a status response takes 256 bytes);
+// requests that need more spill to the heap, counted in /metrics
+const size_t REQUEST_ARENA_SIZE = 1024;
 
 // Global Objects
 WebServer httpServer(HTTP_PORT);
 WebSocketsServer webSocket = WebSocketsServer(WEBSOCKET_PORT);
 
-// State
-bool ledState = false;
-uint32_t lastWifiCheck = 0;
-uint32_t lastStatusBroadcast = 0;
-String wifiSSID = "";
-String wifiPassword = "";
+/**
+ * @brief Application -> network task messages
+ */
+struct NetEvent {
+  enum Type : uint8_t {
+    LED_CHANGED,  // Broadcast led_update to every WebSocket client
+    LED_REPLY,    // Answer the WebSocket client that sent an LED command
+    TELEMETRY,    // New heap / RSSI sample for status responses
+    TRACE_DONE    // Every event of a traced command delivered - log its trace
+  };
+  Type type;
+  bool led;
+  Transport source;
+  uint8_t client;
+  HeapSnapshot heap;
+  int8_t rssi;
+  uint32_t trace;  // CommandTrace id of the command behind the event, 0 if none
+};
+
+/**
+ * @brief WebSocket traffic counters for /metrics
+ */
+struct WebSocketMetrics {
+  uint32_t framesIn;
+  uint32_t framesOut;
+  uint32_t broadcasts;
+  uint32_t broadcastRecipients;  // Fan-out: clients reached by broadcasts
+  uint32_t commandsRejected;     // Command queue full ("Busy" / 503)
+};
+
+/**
+ * @brief What the network task reports, kept current from NetEvents
+ */
+struct NetworkView {
+  bool led;
+  HeapSnapshot heap;
+  int8_t rssi;
+};
+
+/**
+ * @brief Network task phases timed when LOOP_PROFILER is 1
+ */
+enum NetworkPhase : uint8_t {
+  PHASE_WIFI_IDENTITY,
+  PHASE_HTTP,
+  PHASE_WEBSOCKET,
+  PHASE_EVENTS,
+  PHASE_CHECK_WIFI,
+  PHASE_BROADCAST,
+  PHASE_SERIAL,
+  PHASE_COUNT
+};
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+  "wifi_identity", "http", "websocket", "events", "check_wifi", "broadcast", "serial"
+};
+
+// Application task state (Arduino loop task)
+CommandBus bus;  // Single LED state shared by REST and WebSocket
+Scheduler appScheduler;   // Telemetry sampling
+RTC_NOINIT_ATTR FlightRecorder::Storage flightStorage;  // Last events before a reset: GET /flight
+
+// Network task state
+DeviceIdentity identity;  // MAC/IP/SSID formatted once, not per request
+Scheduler networkScheduler;  // Periodic WiFi check and status broadcast
+NetworkView view = {false, HeapSnapshot(), 0};
+HttpMetrics httpMetrics;           // Per-route request counts and latency for /metrics
+WebSocketMetrics wsMetrics = {0, 0, 0, 0, 0};
+LatencyHistogram loopTime;         // Work per network task pass
+StaticRequestArena<REQUEST_ARENA_SIZE> requestArena;  // Reset after every request
+BootTimeline boot;  // Reset to first served request (written by setup() until then)
+#if LOOP_PROFILER
+PhaseProfiler profiler(PHASE_NAMES, PHASE_COUNT);
+StaticResponseBuffer<1536> profileReport;  // One table, 7 phases
+StaticLineAssembler<32> serialCommand;
+#endif
+StaticResponseBuffer<96> traceLine;  // One Serial trace line
+
+// Headers WebServer keeps for the handlers (it drops the rest)
+const char* COLLECTED_HEADERS[] = {"X-Trace-Id"};
+
+// Between the tasks: lock-free, no mutex on either side
+MpscQueue<Command, 16> commandQueue;  // Network handlers -> application
+SpscQueue<NetEvent, 32> eventQueue;   // Application -> network task
+CommandTrace traces;  // Receive-to-broadcast timing of the last commands: GET /traces
+TaskHandle_t appTaskHandle = nullptr;
+TaskHandle_t networkTaskHandle = nullptr;
+
+WiFiCache wifiCache;  // Credentials, AP and address saved in NVS
+FastWiFi::Connector wifiConnector;  // Associates while setup() does the rest
+uint8_t wifiPhase = BootTimeline::NO_PHASE;
 uint32_t sessionCounter = 0;  // Global session counter for unique IDs
 
 // Track active connections
@@ -35,6 +180,8 @@ struct ClientInfo {
 
 ClientInfo clients[WEBSOCKETS_SERVER_CLIENT_MAX];  // Default is 8
 
+int getActiveClientCount();
+
 /**
  * @brief Initialize client tracking
  */
@@ -54,27 +201,18 @@ void registerClient(uint8_t clientNum, IPAddress ip) {
   clients[clientNum].connectTime = millis();
   clients[clientNum].active = true;
   
-  Serial.print("🔌 Session #");
-  Serial.print(clients[clientNum].sessionId);
-  Serial.print(" (Slot ");
-  Serial.print(clientNum);
-  Serial.print(") connected from ");
-  Serial.print(ip);
-  Serial.print(" | Active connections: ");
-  Serial.println(getActiveClientCount());
+  LOG_INFO("Session #%lu (Slot %u) connected from %u.%u.%u.%u | Active connections: %d",
+           (unsigned long)clients[clientNum].sessionId, clientNum, ip[0], ip[1], ip[2], ip[3],
+           getActiveClientCount());
 }
 
 /**
  * @brief Unregister client disconnection
  */
 void unregisterClient(uint8_t clientNum) {
-  Serial.print("❌ Session #");
-  Serial.print(clients[clientNum].sessionId);
-  Serial.print(" (Slot ");
-  Serial.print(clientNum);
-  Serial.print(") disconnected | Active connections: ");
   clients[clientNum].active = false;
-  Serial.println(getActiveClientCount());
+  LOG_INFO("Session #%lu (Slot %u) disconnected | Active connections: %d",
+           (unsigned long)clients[clientNum].sessionId, clientNum, getActiveClientCount());
 }
 
 /**
@@ -115,181 +253,266 @@ void printActiveConnections() {
 }
 
 /**
- * @brief Read line from Serial with timeout
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-String readSerialLine(uint32_t timeout) {
-  String input = "";
-  uint32_t start = millis();
-  
-  while (millis() - start < timeout) {
-    if (Serial.available()) {
-      char c = Serial.read();
-      if (c == '\n' || c == '\r') {
-        return input;
-      } else {
-        input += c;
-      }
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
+}
+
+/**
+ * @brief Queue an event for the network task
+ */
+void postEvent(const NetEvent& event) {
+  if (!eventQueue.push(event)) {
+    LOG_WARN("Network task behind - event dropped");
+  }
+}
+
+/**
+ * @brief Network adapter - hand every LED change to the network task for broadcast
+ */
+void onLedChangedNetwork(const StateEvent& event, void*) {
+  FlightLog::record(FLIGHT_LED, event.source, event.state.led);
+  postEvent(NetEvent{NetEvent::LED_CHANGED, event.state.led, event.source, event.client,
+                     HeapSnapshot(), 0, event.trace});
+}
+
+/**
+ * @brief Apply the commands queued by the network task (application task)
+ *
+ * WebSocket senders get their reply through LED_REPLY, queued after the
+ * LED_CHANGED broadcast exactly as the single-task version sent them.
+ * TRACE_DONE follows both, so the trace is logged once it is complete.
+ */
+void processCommands() {
+  Command command;
+  while (commandQueue.pop(command)) {
+    bus.dispatch(command);
+    traces.mark(command.trace, TRACE_EXECUTE, micros());
+    if (command.source == TRANSPORT_WEBSOCKET) {
+      postEvent(NetEvent{NetEvent::LED_REPLY, bus.led(), command.source, command.client,
+                         HeapSnapshot(), 0, command.trace});
+    }
+    if (command.trace != 0) {
+      postEvent(NetEvent{NetEvent::TRACE_DONE, bus.led(), command.source, command.client,
+                         HeapSnapshot(), 0, command.trace});
     }
-    delay(10);
   }
-  return input;
+  if (!eventQueue.empty()) LoopIdle::wake();
 }
 
 /**
- * @brief Get WiFi credentials from Serial Monitor
+ * @brief Sample heap, fragmentation and signal for status responses (scheduled task)
  */
-bool getWiFiCredentials() {
-  Serial.println("\n=== WiFi Configuration ===");
-  Serial.println("Please enter your WiFi credentials");
-  Serial.println();
-  
-  Serial.print("Enter WiFi SSID: ");
-  wifiSSID = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiSSID.length() == 0) {
-    Serial.println("\nERROR: Empty input - SSID is required");
-    Serial.println("Please try again\n");
+void sampleTelemetry(void*) {
+  HeapSnapshot heap = HeapMonitor::snapshot();
+  FlightLog::noteHeap(heap.freeBytes);
+  postEvent(NetEvent{NetEvent::TELEMETRY, bus.led(), TRANSPORT_LOCAL, 0, heap,
+                     (int8_t)WiFi.RSSI(), 0});
+}
+
+// ========== NETWORK TASK ==========
+
+/**
+ * @brief Hand an LED command to the application task
+ * @return false if the command queue is full
+ */
+bool postCommand(const Command& command) {
+  if (!commandQueue.push(command)) {
+    wsMetrics.commandsRejected++;
     return false;
   }
-  
-  Serial.println(wifiSSID);
-  
-  Serial.print("Enter WiFi Password (press Enter if open network): ");
-  wifiPassword = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiPassword.length() == 0) {
-    Serial.println("[OPEN NETWORK]");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.println("  Password: [NONE - Open Network]");
-  } else {
-    Serial.println("********");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.print("  Password: ");
-    for (int i = 0; i < wifiPassword.length(); i++) {
-      Serial.print("*");
-    }
-    Serial.println();
-  }
-  
+  if (command.type == CMD_LED_SET) view.led = command.value;  // Known outcome - reply with it now
+  xTaskNotifyGive(appTaskHandle);
   return true;
 }
 
 /**
- * @brief Control LED state and notify all WebSocket clients
+ * @brief sendTXT() counted for /metrics
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
-  
-  // Broadcast state change to WebSocket clients
-  String json = "{";
-  json += "\"type\":\"led_update\"";
-  json += ",\"led\":" + String(ledState ? "true" : "false");
-  json += ",\"timestamp\":" + String(millis());
-  json += "}";
-  webSocket.broadcastTXT(json);
-  
-  Serial.print("💡 LED ");
-  Serial.print(state ? "ON" : "OFF");
-  Serial.print(" | Broadcast to ");
-  Serial.print(getActiveClientCount());
-  Serial.println(" client(s)");
+void wsSend(uint8_t clientNum, const JsonWriter& json) {
+  if (webSocket.sendTXT(clientNum, json.c_str(), json.length())) wsMetrics.framesOut++;
+}
+
+/**
+ * @brief broadcastTXT() counted for /metrics
+ */
+void wsBroadcast(const JsonWriter& json) {
+  int recipients = getActiveClientCount();
+  webSocket.broadcastTXT(json.c_str(), json.length());
+  wsMetrics.broadcasts++;
+  wsMetrics.broadcastRecipients += recipients;
+  wsMetrics.framesOut += recipients;
 }
 
 /**
- * @brief Build status JSON
+ * @brief Broadcast an LED change, whichever transport made it
  */
-String buildStatusJson() {
-  String json = "{";
-  json += "\"device\":\"ESP32\"";
-  json += ",\"ip\":\"" + WiFi.localIP().toString() + "\"";
-  json += ",\"ssid\":\"" + WiFi.SSID() + "\"";
-  json += ",\"rssi\":" + String(WiFi.RSSI());
-  json += ",\"led\":" + String(ledState ? "true" : "false");
-  json += ",\"uptime\":" + String(millis() / 1000);
-  json += ",\"heap\":" + String(ESP.getFreeHeap());
-  json += ",\"ws_clients\":" + String(getActiveClientCount());
-  json += ",\"timestamp\":" + String(millis());
-  json += "}";
-  return json;
+void broadcastLedUpdate(const NetEvent& event) {
+  HEAP_TAG("ws_broadcast");
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("type", "led_update")
+      .field("led", event.led)
+      .field("source", transportName(event.source))
+      .field("timestamp", millis())
+      .endObject();
+  wsBroadcast(json);
+  traces.mark(event.trace, TRACE_BROADCAST, micros());
+  
+  LOG_INFO("LED %s via %s | Broadcast to %d client(s)", event.led ? "ON" : "OFF",
+           transportName(event.source), getActiveClientCount());
+}
+
+/**
+ * @brief Print a command's trace line on Serial
+ */
+void logTrace(uint32_t trace) {
+  CommandTrace::Trace t;
+  if (!traces.find(trace, t)) return;
+  if (t.atUs[TRACE_REPLY] != CommandTrace::UNSET) {
+    WiFiPowerSave::policy().observeHandler(t.atUs[TRACE_REPLY]);  // By power-save mode
+  }
+#if LOG_BINARY
+  // Raw numbers instead of CommandTrace::format(); -1: point not reached
+  LOG_INFO("trace %08lx %s parse=%ld exec=%ld reply=%ld bcast=%ld", (unsigned long)t.id,
+           transportName(t.source), (long)(int32_t)t.atUs[TRACE_PARSE],
+           (long)(int32_t)t.atUs[TRACE_EXECUTE], (long)(int32_t)t.atUs[TRACE_REPLY],
+           (long)(int32_t)t.atUs[TRACE_BROADCAST]);
+#else
+  if (LOG_ENABLED(LOG_LEVEL_INFO) && traces.format(trace, traceLine)) traceLine.flushTo(Serial);
+#endif
+}
+
+/**
+ * @brief Status members, written into an object the caller has opened
+ */
+void writeStatusJson(JsonWriter& json) {
+  json.field("device", "ESP32")
+      .field("ip", identity.ip())
+      .field("ssid", identity.ssid())
+      .field("rssi", view.rssi)
+      .field("led", view.led)
+      .field("uptime", millis() / 1000)
+      .field("heap", view.heap.freeBytes);
+  HeapMonitor::writeStatusJson(json, view.heap);
+  WiFiReconnect::writeStatusJson(json);
+  WiFiPowerSave::writeStatusJson(json);
+  json.field("ws_clients", getActiveClientCount())
+      .field("timestamp", millis());
 }
 
 // ========== HTTP REST HANDLERS ==========
 
 /**
  * @brief Send standardized JSON response
+ * @param trace Command trace to mark TRACE_REPLY on and report, 0 if none
  */
-void sendJson(int code, const char* message, bool includeState = true) {
-  String json = "{\"success\":";
-  json += (code == 200) ? "true" : "false";
-  json += ",\"message\":\"";
-  json += message;
-  json += "\"";
-  
-  if (includeState) {
-    json += ",\"led\":";
-    json += ledState ? "true" : "false";
-  }
-  
-  json += ",\"timestamp\":";
-  json += millis();
-  json += "}";
-  
-  httpServer.send(code, "application/json", json);
+void sendJson(int code, const char* message, bool includeState = true, uint32_t trace = 0) {
+  traces.mark(trace, TRACE_REPLY, micros());
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("success", code == 200)
+      .field("message", message);
+  if (includeState) json.field("led", view.led);
+  json.field("timestamp", millis());
+  traces.writeJson(trace, json);
+  json.endObject();
+  
+  httpServer.send_P(code, "application/json", json.c_str(), json.length());
 }
 
 /**
  * @brief GET /status - Device status
  */
 void handleStatus() {
-  String json = buildStatusJson();
-  httpServer.send(200, "application/json", json);
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject();
+  writeStatusJson(json);
+  json.endObject();
+  httpServer.send_P(200, "application/json", json.c_str(), json.length());
+}
+
+/**
+ * @brief GET /traces - the last commands' traces, oldest first
+ */
+void handleTraces() {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  traces.writeAll(json);
+  httpServer.send_P(200, "application/json", json.c_str(), json.length());
+}
+
+/**
+ * @brief Start the trace of a parsed REST command, received at rxUs
+ *
+ * Uses the id from the body's "trace" member or the X-Trace-Id header;
+ * without either the device assigns one.
+ */
+void traceRestCommand(Command& command, uint32_t rxUs) {
+  if (command.trace == 0) {
+    String header = httpServer.header("X-Trace-Id");
+    command.trace = CommandTrace::parseId(header.c_str(), header.length());
+  }
+  command.trace = traces.begin(command.trace, TRANSPORT_REST, rxUs);
+  traces.mark(command.trace, TRACE_PARSE, micros());
+}
+
+/**
+ * @brief Queue a REST LED command and answer with the state it sets
+ */
+void sendLedCommand(const Command& command) {
+  if (!postCommand(command)) {
+    sendJson(503, "Busy", false, command.trace);
+    logTrace(command.trace);
+    return;
+  }
+  sendJson(200, command.value ? "LED ON" : "LED OFF", true, command.trace);
 }
 
 /**
  * @brief GET /led/on - Turn LED on
  */
 void handleLedOn() {
-  Serial.println("📡 HTTP: LED ON command received");
-  setLED(true);
-  sendJson(200, "LED ON");
+  uint32_t rxUs = micros();
+  LOG_INFO("HTTP: LED ON command received");
+  Command command = Command::ledSet(true, TRANSPORT_REST);
+  traceRestCommand(command, rxUs);
+  sendLedCommand(command);
 }
 
 /**
  * @brief GET /led/off - Turn LED off
  */
 void handleLedOff() {
-  Serial.println("📡 HTTP: LED OFF command received");
-  setLED(false);
-  sendJson(200, "LED OFF");
+  uint32_t rxUs = micros();
+  LOG_INFO("HTTP: LED OFF command received");
+  Command command = Command::ledSet(false, TRANSPORT_REST);
+  traceRestCommand(command, rxUs);
+  sendLedCommand(command);
 }
 
 /**
  * @brief POST /led - Control LED with JSON
  */
 void handleLedControl() {
+  uint32_t rxUs = micros();
   if (!httpServer.hasArg("plain")) {
     sendJson(400, "Missing JSON body", false);
     return;
   }
   
-  String body = httpServer.arg("plain");
-  body.toLowerCase();
+  const String& body = httpServer.arg("plain");
+  Command command;
   
-  if (body.indexOf("\"state\":true") >= 0) {
-    Serial.println("📡 HTTP: LED ON command received (POST)");
-    setLED(true);
-    sendJson(200, "LED ON");
-  } else if (body.indexOf("\"state\":false") >= 0) {
-    Serial.println("📡 HTTP: LED OFF command received (POST)");
-    setLED(false);
-    sendJson(200, "LED OFF");
+  if (parseJsonCommand(body.c_str(), body.length(), TRANSPORT_REST, command) &&
+      command.type == CMD_LED_SET) {
+    LOG_INFO("HTTP: LED %s command received (POST)", command.value ? "ON" : "OFF");
+    traceRestCommand(command, rxUs);
+    sendLedCommand(command);
   } else {
     sendJson(400, "Invalid JSON format", false);
   }
@@ -299,72 +522,83 @@ void handleLedControl() {
  * @brief Handle 404
  */
 void handleNotFound() {
-  String json = "{\"error\":\"Not found\",\"path\":\"";
-  json += httpServer.uri();
-  json += "\"}";
-  httpServer.send(404, "application/json", json);
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("error", "Not found")
+      .field("path", httpServer.uri().c_str())
+      .endObject();
+  httpServer.send_P(404, "application/json", json.c_str(), json.length());
 }
 
 // ========== WEBSOCKET HANDLERS ==========
 
 /**
- * @brief Build WebSocket response JSON
+ * @brief Send a WebSocket command response
+ * @param trace Command trace to mark TRACE_REPLY on and report, 0 if none
  */
-String buildWsResponseJson(bool success, const char* message) {
-  String json = "{";
-  json += "\"type\":\"response\"";
-  json += ",\"success\":";
-  json += success ? "true" : "false";
-  json += ",\"message\":\"";
-  json += message;
-  json += "\"";
-  json += ",\"led\":";
-  json += ledState ? "true" : "false";
-  json += ",\"timestamp\":" + String(millis());
-  json += "}";
-  return json;
+void sendWsResponse(uint8_t clientNum, bool success, const char* message, uint32_t trace = 0) {
+  traces.mark(trace, TRACE_REPLY, micros());
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("type", "response")
+      .field("success", success)
+      .field("message", message)
+      .field("led", view.led)
+      .field("timestamp", millis());
+  traces.writeJson(trace, json);
+  json.endObject();
+  wsSend(clientNum, json);
 }
 
 /**
  * @brief Handle WebSocket messages
  */
-void handleWebSocketMessage(uint8_t clientNum, String payload) {
+void handleWebSocketMessage(uint8_t clientNum, const char* payload, size_t length) {
+  HEAP_TAG("ws_message");
   if (!clients[clientNum].active) return;
-  
-  Serial.print("📨 Session #");
-  Serial.print(clients[clientNum].sessionId);
-  Serial.print(" (Slot ");
-  Serial.print(clientNum);
-  Serial.print("): ");
-  Serial.println(payload);
-  
-  payload.toLowerCase();
-  
-  if (payload.indexOf("\"command\":\"led_on\"") >= 0) {
-    setLED(true);
-    String response = buildWsResponseJson(true, "LED ON");
-    webSocket.sendTXT(clientNum, response);
-    
-  } else if (payload.indexOf("\"command\":\"led_off\"") >= 0) {
-    setLED(false);
-    String response = buildWsResponseJson(true, "LED OFF");
-    webSocket.sendTXT(clientNum, response);
-    
-  } else if (payload.indexOf("\"command\":\"toggle\"") >= 0) {
-    setLED(!ledState);
-    String response = buildWsResponseJson(true, ledState ? "LED ON" : "LED OFF");
-    webSocket.sendTXT(clientNum, response);
-    
-  } else if (payload.indexOf("\"command\":\"status\"") >= 0) {
-    String status = buildStatusJson();
-    webSocket.sendTXT(clientNum, status);
+  uint32_t rxUs = micros();
+  
+  LOG_DEBUG("Session #%lu (Slot %u): %.*s", (unsigned long)clients[clientNum].sessionId,
+            clientNum, (int)length, payload);
+  
+  Command command;
+  parseJsonCommand(payload, length, TRANSPORT_WEBSOCKET, command);
+  command.client = clientNum;
+  
+  switch (command.type) {
+    case CMD_LED_SET:
+    case CMD_LED_TOGGLE:
+      // Applied on the application task, which queues the reply (LED_REPLY)
+      command.trace = traces.begin(command.trace, TRANSPORT_WEBSOCKET, rxUs);
+      traces.mark(command.trace, TRACE_PARSE, micros());
+      if (!postCommand(command)) {
+        sendWsResponse(clientNum, false, "Busy", command.trace);
+        logTrace(command.trace);
+      }
+      break;
     
-  } else if (payload.indexOf("\"command\":\"list\"") >= 0) {
-    printActiveConnections();
+    case CMD_STATUS: {
+      // Tagged, so the sender can tell its reply from a status broadcast
+      RequestArena::Scope scope(requestArena);
+      JsonWriter json(requestArena);
+      json.beginObject()
+          .field("type", "status")
+          .field("request", "status");
+      writeStatusJson(json);
+      json.endObject();
+      wsSend(clientNum, json);
+      break;
+    }
     
-  } else {
-    String response = buildWsResponseJson(false, "Unknown command");
-    webSocket.sendTXT(clientNum, response);
+    case CMD_LIST:
+      printActiveConnections();
+      break;
+      
+    default:
+      sendWsResponse(clientNum, false, "Unknown command");
+      break;
   }
 }
 
@@ -372,6 +606,8 @@ void handleWebSocketMessage(uint8_t clientNum, String payload) {
  * @brief WebSocket event handler
  */
 void webSocketEvent(uint8_t clientNum, WStype_t type, uint8_t* payload, size_t length) {
+  LoopIdle::markBusy();  // The library may hold more frames; don't idle yet
+  
   switch(type) {
     case WStype_DISCONNECTED:
       unregisterClient(clientNum);
@@ -382,15 +618,20 @@ void webSocketEvent(uint8_t clientNum, WStype_t type, uint8_t* payload, size_t l
       registerClient(clientNum, ip);
       
       // Send initial status with session info
-      String status = "{\"type\":\"status\",\"session_id\":" + 
-                     String(clients[clientNum].sessionId) + "," + 
-                     buildStatusJson().substring(1);
-      webSocket.sendTXT(clientNum, status);
+      RequestArena::Scope scope(requestArena);
+      JsonWriter json(requestArena);
+      json.beginObject()
+          .field("type", "status")
+          .field("session_id", clients[clientNum].sessionId);
+      writeStatusJson(json);
+      json.endObject();
+      wsSend(clientNum, json);
       break;
     }
     
     case WStype_TEXT:
-      handleWebSocketMessage(clientNum, String((char*)payload));
+      wsMetrics.framesIn++;
+      handleWebSocketMessage(clientNum, (const char*)payload, length);
       break;
       
     default:
@@ -399,146 +640,339 @@ void webSocketEvent(uint8_t clientNum, WStype_t type, uint8_t* payload, size_t l
 }
 
 /**
- * @brief Broadcast status to all WebSocket clients
+ * @brief Broadcast status to all WebSocket clients (scheduled task)
  */
-void broadcastStatus() {
-  uint32_t now = millis();
-  if (now - lastStatusBroadcast < STATUS_BROADCAST_INTERVAL_MS) return;
-  
-  lastStatusBroadcast = now;
-  
+void broadcastStatus(void*) {
+  LOOP_PROFILE_SCOPE(profiler, PHASE_BROADCAST);
   int activeCount = getActiveClientCount();
   if (activeCount == 0) return;  // Don't broadcast if no clients
-  
-  String status = "{\"type\":\"status\"," + buildStatusJson().substring(1);
-  webSocket.broadcastTXT(status);
+  HEAP_TAG("ws_broadcast");
+  
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("type", "status");
+  writeStatusJson(json);
+  json.endObject();
+  wsBroadcast(json);
 }
 
-// ========== WIFI FUNCTIONS ==========
-
 /**
- * @brief Connect to WiFi
+ * @brief Send what the application task queued: broadcasts, replies, samples
  */
-bool connectWiFi() {
-  Serial.print("Connecting to WiFi: ");
-  Serial.println(wifiSSID);
-  
-  WiFi.mode(WIFI_STA);
-  
-  if (wifiPassword.length() > 0) {
-    Serial.println("(Secured network)");
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-  } else {
-    Serial.println("(Open network)");
-    WiFi.begin(wifiSSID.c_str());
-  }
-  
-  uint32_t start = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - start > WIFI_TIMEOUT_MS) {
-      Serial.println(" FAILED");
-      return false;
+void deliverEvents() {
+  NetEvent event;
+  while (eventQueue.pop(event)) {
+    switch (event.type) {
+      case NetEvent::LED_CHANGED:
+        view.led = event.led;
+        broadcastLedUpdate(event);
+        break;
+        
+      case NetEvent::LED_REPLY:
+        view.led = event.led;
+        sendWsResponse(event.client, true, event.led ? "LED ON" : "LED OFF", event.trace);
+        break;
+      
+      case NetEvent::TELEMETRY:
+        view.heap = event.heap;
+        view.rssi = event.rssi;
+        break;
+      
+      case NetEvent::TRACE_DONE:
+        logTrace(event.trace);
+        break;
     }
-    delay(500);
-    Serial.print(".");
   }
-  
-  Serial.println(" CONNECTED");
-  Serial.print("IP Address: ");
-  Serial.println(WiFi.localIP());
-  Serial.print("Signal: ");
-  Serial.print(WiFi.RSSI());
-  Serial.println(" dBm");
-  return true;
 }
 
 /**
- * @brief Monitor WiFi connection
+ * @brief Act on WiFi events; WiFiReconnect.h retries with backoff
+ *
+ * Clients whose connection survived the outage missed the broadcasts made
+ * during it, so they get the current state at once.
  */
 void checkWiFi() {
-  uint32_t now = millis();
-  if (now - lastWifiCheck < WIFI_CHECK_INTERVAL_MS) return;
+  switch (WiFiReconnect::poll(millis())) {
+    case WiFiReconnect::LOST:
+      LOG_WARN("WiFi lost - reconnecting");
+      break;
+    case WiFiReconnect::CONNECTED:
+      LOG_INFO("WiFi back after %lu ms", (unsigned long)WiFiReconnect::policy().lastRecoveryMs());
+      broadcastStatus(nullptr);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Close the boot timeline at the first served request and log it
+ */
+void checkBootDone() {
+  if (boot.finished() || httpMetrics.total() + wsMetrics.framesIn == 0) return;
+  boot.ready("first_request", micros());
+  StaticResponseBuffer<192> line;
+  boot.report(line);
+  LOG_INFO("%s", line.c_str());
+}
+
+/**
+ * @brief Everything GET /metrics reports (network task)
+ */
+void collectMetrics(MetricsWriter& out) {
+  httpMetrics.write(out);
+  out.counter("websocket_frames_received_total", "WebSocket text frames received",
+              wsMetrics.framesIn);
+  out.counter("websocket_frames_sent_total", "WebSocket text frames sent, broadcasts per client",
+              wsMetrics.framesOut);
+  out.counter("websocket_broadcasts_total", "Broadcasts (led_update and status)",
+              wsMetrics.broadcasts);
+  out.counter("websocket_broadcast_recipients_total", "Clients reached by broadcasts (fan-out)",
+              wsMetrics.broadcastRecipients);
+  out.gauge("websocket_clients", "Connected WebSocket clients", getActiveClientCount());
+  out.counter("commands_rejected_total", "Commands refused because the queue was full",
+              wsMetrics.commandsRejected);
+  requestArena.write(out, "network");
+  MetricsEndpoint::writeDevice(out, loopTime);
+  boot.write(out);
+  WiFiReconnect::write(out);
+  WiFiPowerSave::write(out);
+}
+
+#if LOOP_PROFILER
+/**
+ * @brief GET /profile - per-phase timing table (?reset=1 starts a new window)
+ */
+void handleProfile() {
+  LoopProfiler::report(profiler, profileReport);
+  httpServer.send(200, "text/plain", profileReport.c_str());
+  profileReport.clear();
+  if (httpServer.hasArg("reset")) profiler.reset();
+}
+
+/**
+ * @brief Serial "profile" / "profile reset" (network task)
+ */
+void pollSerialCommands() {
+  if (serialCommand.poll(Serial, millis()) != LineAssembler::LINE_READY) return;
+  if (strcmp(serialCommand.line(), "profile") == 0) {
+    LoopProfiler::report(profiler, profileReport);
+    profileReport.flushTo(Serial);
+  } else if (strcmp(serialCommand.line(), "profile reset") == 0) {
+    profiler.reset();
+    Serial.println("Profile reset");
+  }
+}
+#endif
+
+/**
+ * @brief One pass of the network task
+ */
+void networkLoop() {
+  uint32_t start = micros();
+  LOOP_PHASE(profiler, PHASE_CHECK_WIFI, checkWiFi());
+  // Requests and frames handled last pass decide the radio's power save
+  WiFiPowerSave::update(millis(), httpMetrics.total() + wsMetrics.framesIn,
+                        getActiveClientCount());
+  // Re-format MAC/IP/SSID only after a WiFi event
+  LOOP_PHASE(profiler, PHASE_WIFI_IDENTITY, WiFiIdentity::refresh());
+  LOOP_PHASE(profiler, PHASE_HTTP, httpServer.handleClient());
+  LOOP_PHASE(profiler, PHASE_WEBSOCKET, webSocket.loop());
+  // Broadcasts and replies from the application
+  LOOP_PHASE(profiler, PHASE_EVENTS, deliverEvents());
+  checkBootDone();
+  networkScheduler.run(millis());  // broadcastStatus (timed inside)
+#if LOOP_PROFILER
+  LOOP_PHASE(profiler, PHASE_SERIAL, pollSerialCommands());
+#endif
+  loopTime.observe(micros() - start);
+  
+  // Sleep until a packet arrives, the application queues an event or a task
+  // is due (reconnect attempts wait at most LoopIdle::MAX_WAIT_MS extra)
+  LoopIdle::wait(networkScheduler.msUntilNext(millis()), httpMetrics.total() + wsMetrics.framesIn);
+}
+
+/**
+ * @brief Network task body
+ */
+void networkTask(void*) {
+  for (;;) {
+    networkLoop();
+  }
+}
+
+/**
+ * @brief Core for the network task: the one the Arduino loop task is not on
+ */
+BaseType_t networkCore() {
+#if CONFIG_FREERTOS_UNICORE
+  return tskNO_AFFINITY;  // Single-core chips: separate task, same core
+#else
+  return xPortGetCoreID() == 0 ? 1 : 0;
+#endif
+}
+
+// ========== WIFI FUNCTIONS ==========
+
+/**
+ * @brief Start connecting to WiFi; finishWiFi() waits for the result
+ *
+ * After the first connect the channel and BSSID are cached, so a reboot
+ * skips the scan (FastWiFi.h)
+ */
+void startWiFi() {
+  LOG_INFO("Connecting to WiFi: %s (%s network)", wifiCache.ssid(),
+           wifiCache.password()[0] != '\0' ? "Secured" : "Open");
+  wifiPhase = boot.begin("wifi", micros());
+  wifiConnector.start(wifiCache, WIFI_TIMEOUT_MS, REUSE_DHCP_LEASE);
+}
+
+/**
+ * @brief Wait for the connection startWiFi() began, with timeout
+ */
+bool finishWiFi() {
+  FastWiFi::Result result;
+  while ((result = wifiConnector.update()) == FastWiFi::PENDING) {
+    delay(FastWiFi::POLL_MS);
+  }
+  boot.end(wifiPhase, micros());
+  boot.setNote(FastWiFi::describe(result, wifiCache, REUSE_DHCP_LEASE));
+  if (result == FastWiFi::FAILED) {
+    LOG_ERROR("WiFi connection timed out");
+    return false;
+  }
   
-  lastWifiCheck = now;
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi lost - reconnecting");
-    WiFi.reconnect();
+  IPAddress ip = WiFi.localIP();
+  LOG_INFO("WiFi connected (%s) | IP Address: %u.%u.%u.%u | Signal: %d dBm",
+           result == FastWiFi::CACHED_AP ? "cached AP" : "full scan",
+           ip[0], ip[1], ip[2], ip[3], (int)WiFi.RSSI());
+  if (!FastWiFi::remember(wifiCache, REUSE_DHCP_LEASE)) {
+    LOG_WARN("Could not save WiFi settings - next boot will ask again");
   }
+  return true;
 }
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);
+  
+  // With saved credentials WiFi associates while the rest of setup() runs,
+  // and there is no prompt to wait for a serial monitor
+  bool saved = FastWiFi::load(wifiCache);
+  if (saved) {
+    startWiFi();
+  } else {
+    delay(1000);
+  }
   
   while (Serial.available()) {
     Serial.read();
   }
+  Log::begin(Serial);
+  FlightLog::begin(flightStorage);  // Prints the events before the last reset
   
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.subscribe(onLedChangedNetwork);
+  bus.applyOutput();  // LED off
+  appTaskHandle = xTaskGetCurrentTaskHandle();  // setup() runs on the Arduino loop task
   
   initClientTracking();  // Initialize connection tracking
   
-  Serial.println("\n\n=== ESP32 Hybrid Server (REST + WebSocket) ===");
-  Serial.println("Firmware Version: 1.1 - Enhanced Connection Tracking");
-  Serial.println();
+  LOG_INFO("=== ESP32 Hybrid Server (REST + WebSocket) ===");
+  LOG_INFO("Firmware Version: 1.1 - Enhanced Connection Tracking");
+  
+  // Configure both servers; they listen once WiFi has an address
+  MetricsEndpoint::on(httpServer, httpMetrics, "/status", HTTP_GET, handleStatus);
+  MetricsEndpoint::on(httpServer, httpMetrics, "/led/on", HTTP_GET, handleLedOn);
+  MetricsEndpoint::on(httpServer, httpMetrics, "/led/off", HTTP_GET, handleLedOff);
+  MetricsEndpoint::on(httpServer, httpMetrics, "/led", HTTP_POST, handleLedControl);
+  MetricsEndpoint::on(httpServer, httpMetrics, "/traces", HTTP_GET, handleTraces);
+  MetricsEndpoint::onNotFound(httpServer, httpMetrics, handleNotFound);
+  httpServer.collectHeaders(COLLECTED_HEADERS, 1);
+  MetricsEndpoint::begin(httpServer, collectMetrics);
+  FlightLog::on(httpServer);
+#if LOOP_PROFILER
+  MetricsEndpoint::on(httpServer, httpMetrics, "/profile", HTTP_GET, handleProfile);
+#endif
+  webSocket.onEvent(webSocketEvent);
   
-  // Get WiFi credentials
-  while (!getWiFiCredentials()) {
-    delay(2000);
+  networkScheduler.every(STATUS_BROADCAST_INTERVAL_MS, broadcastStatus, nullptr, millis());
+  appScheduler.every(TELEMETRY_INTERVAL_MS, sampleTelemetry, nullptr, millis());
+  
+  LOG_INFO("=== Server Information ===");
+  LOG_INFO("HTTP REST API (port %u):", HTTP_PORT);
+  LOG_INFO("  GET  /status   - Device status");
+  LOG_INFO("  GET  /led/on   - Turn LED on");
+  LOG_INFO("  GET  /led/off  - Turn LED off");
+  LOG_INFO("  POST /led      - Control LED (JSON)");
+  LOG_INFO("  GET  /metrics  - Prometheus metrics");
+  LOG_INFO("  GET  /traces   - Timing of the last 16 LED commands (X-Trace-Id)");
+  LOG_INFO("  GET  /flight   - Events before the last reset (?clear=1 clears)");
+#if LOOP_PROFILER
+  LOG_INFO("  GET  /profile  - Network task phase timing (serial: \"profile\")");
+#endif
+  LOG_INFO("WebSocket API (port %u):", WEBSOCKET_PORT);
+  LOG_INFO("  {\"command\":\"led_on\"}  (optional \"trace\":\"<hex id>\")");
+  LOG_INFO("  {\"command\":\"led_off\"}");
+  LOG_INFO("  {\"command\":\"toggle\"}");
+  LOG_INFO("  {\"command\":\"status\"}");
+  LOG_INFO("  {\"command\":\"list\"}  - List active connections");
+  boot.mark("init", micros());  // Includes the banner: Serial output blocks at 115200 baud
+  
+  // Serial, BLE or the setup AP, whichever delivers first, unless saved
+  if (!wifiCache.hasCredentials()) {
+    ProvisioningPortal::run(wifiCache);
+    boot.mark("credentials", micros());
+    startWiFi();
   }
   
-  // Connect to WiFi
-  Serial.println("\n=== Connecting to WiFi ===");
-  if (!connectWiFi()) {
-    Serial.println("\nERROR: WiFi connection failed");
-    Serial.println("Please reset and check your credentials");
-    while(1) delay(1000);
+  while (!finishWiFi()) {
+    if (!saved) {
+      // Just entered, so never saved: drop them and ask again
+      LOG_ERROR("WiFi connection failed - check the SSID and password, then enter them again");
+      wifiCache.clear();
+      ProvisioningPortal::run(wifiCache);
+      startWiFi();
+      continue;
+    }
+    // The saved network may just be down: new credentials, or retry on timeout
+    LOG_WARN("Saved WiFi network not reachable - enter new credentials or wait to retry");
+    if (ProvisioningPortal::run(wifiCache, PROVISION_TIMEOUT_MS)) saved = false;
+    startWiFi();
   }
+  boot.mark("wifi_wait", micros());  // Setup time spent waiting for the address
+  WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());  // Drops from here on
+  WiFiPowerSave::begin(POWER_SAVE_IDLE_MS, POWER_SAVE_DEEP_IDLE_MS);
   
-  // Start HTTP REST server
-  Serial.println("\n=== Starting HTTP REST Server ===");
-  httpServer.on("/status", HTTP_GET, handleStatus);
-  httpServer.on("/led/on", HTTP_GET, handleLedOn);
-  httpServer.on("/led/off", HTTP_GET, handleLedOff);
-  httpServer.on("/led", HTTP_POST, handleLedControl);
-  httpServer.onNotFound(handleNotFound);
-  httpServer.begin();
-  Serial.println("HTTP server started on port 80");
+  WiFiIdentity::begin(identity);
+  LoopIdle::enableWake();  // Lets the application task interrupt the network task's idle
+  view = NetworkView{bus.led(), HeapMonitor::snapshot(), (int8_t)WiFi.RSSI()};
   
-  // Start WebSocket server
-  Serial.println("\n=== Starting WebSocket Server ===");
+  httpServer.begin();
   webSocket.begin();
-  webSocket.onEvent(webSocketEvent);
-  Serial.println("WebSocket server started on port 81");
-  
-  Serial.println("\n=== Server Information ===");
-  Serial.println("HTTP REST API:");
-  Serial.print("  http://");
-  Serial.println(WiFi.localIP());
-  Serial.println("  GET  /status   - Device status");
-  Serial.println("  GET  /led/on   - Turn LED on");
-  Serial.println("  GET  /led/off  - Turn LED off");
-  Serial.println("  POST /led      - Control LED (JSON)");
-  Serial.println();
-  Serial.println("WebSocket API:");
-  Serial.print("  ws://");
-  Serial.print(WiFi.localIP());
-  Serial.println(":81");
-  Serial.println("  Commands:");
-  Serial.println("    {\"command\":\"led_on\"}");
-  Serial.println("    {\"command\":\"led_off\"}");
-  Serial.println("    {\"command\":\"toggle\"}");
-  Serial.println("    {\"command\":\"status\"}");
-  Serial.println("    {\"command\":\"list\"}  ← List active connections");
-  Serial.println("==========================");
-  Serial.println("\nBoth servers ready!\n");
+  boot.mark("listen", micros());
+  LOG_INFO("HTTP REST API: http://%s | WebSocket API: ws://%s:%u",
+           identity.ip(), identity.ip(), WEBSOCKET_PORT);
+  
+  // Servers are only touched by the network task from here on
+  BaseType_t core = networkCore();
+  if (xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr,
+                              NETWORK_TASK_PRIORITY, &networkTaskHandle, core) != pdPASS) {
+    LOG_ERROR("Could not start the network task");
+    while(1) delay(1000);
+  }
+  LOG_INFO("Network task on core %d, application on core %d - both servers ready",
+           (int)(core == tskNO_AFFINITY ? xPortGetCoreID() : core), (int)xPortGetCoreID());
 }
 
+/**
+ * @brief Application task: apply queued commands, sample telemetry
+ */
 void loop() {
-  httpServer.handleClient();  // Handle HTTP requests
-  webSocket.loop();            // Handle WebSocket connections
-  checkWiFi();                 // Monitor WiFi
-  broadcastStatus();           // Broadcast status to WebSocket clients
-  delay(1);
+  processCommands();
+  appScheduler.run(millis());  // sampleTelemetry
+  
+  // Sleep until the network task queues a command or the next sample is due
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(appScheduler.msUntilNext(millis())));
 }
\ No newline at end of file
@@ -1,5 +1,18 @@
 #include <WiFi.h>
 #include <WebServer.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <WiFiIdentity.h>
+#include <WiFiReconnect.h>
+#include <WiFiPowerSave.h>
+#include <LoopIdle.h>
+#include <MetricsEndpoint.h>
+#include <RequestArena.h>
+#include <JsonWriter.h>
+#include <FastWiFi.h>
+#include <ProvisioningPortal.h>
+#include <BootTimeline.h>
 
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
@@ -7,140 +20,89 @@ const uint16_t SERVER_PORT = 80;
 
 // Timing Configuration
 const uint32_t WIFI_TIMEOUT_MS = 10000;
-const uint32_t WIFI_CHECK_INTERVAL_MS = 30000;
-const uint32_t SERIAL_TIMEOUT_MS = 30000;  // 30 seconds to enter WiFi info
+const uint32_t PROVISION_TIMEOUT_MS = 30000;  // Saved network down: wait this long for new credentials
+
+// WiFi power save: off for POWER_SAVE_IDLE_MS after each request, then
+// modem sleep, deeper after POWER_SAVE_DEEP_IDLE_MS (0: never). The first
+// request after idling waits for the next beacon (see WiFiPowerSave.h)
+const uint32_t POWER_SAVE_IDLE_MS = 10000;
+const uint32_t POWER_SAVE_DEEP_IDLE_MS = 120000;
+
+// Reboots reuse the last DHCP address instead of asking again: saves up to
+// a second, but only safe where the router reserves it (see FastWiFi.h)
+const bool REUSE_DHCP_LEASE = false;
+
+// Per-request memory for response JSON; overflow spills to the heap (see /metrics)
+const size_t REQUEST_ARENA_SIZE = 1024;
 
 // Global Objects
 WebServer server(SERVER_PORT);
 
 // State
-bool ledState = false;
-uint32_t lastWifiCheck = 0;
-String wifiSSID = "";
-String wifiPassword = "";
-
-/**
- * @brief Read line from Serial with timeout
- */
-String readSerialLine(uint32_t timeout) {
-  String input = "";
-  uint32_t start = millis();
-  
-  while (millis() - start < timeout) {
-    if (Serial.available()) {
-      char c = Serial.read();
-      if (c == '\n' || c == '\r') {
-        // Return even if empty (for open networks)
-        return input;
-      } else {
-        input += c;
-      }
-    }
-    delay(10);
-  }
-  return input;
-}
-
-/**
- * @brief Get WiFi credentials from Serial Monitor
- */
-bool getWiFiCredentials() {
-  Serial.println("\n=== WiFi Configuration ===");
-  Serial.println("Please enter your WiFi credentials");
-  Serial.println();
-  
-  Serial.print("Enter WiFi SSID: ");
-  wifiSSID = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiSSID.length() == 0) {
-    Serial.println("\nERROR: Empty input - SSID is required");
-    Serial.println("Please try again\n");
-    return false;
-  }
-  
-  Serial.println(wifiSSID);
-  
-  Serial.print("Enter WiFi Password (press Enter if open network): ");
-  wifiPassword = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiPassword.length() == 0) {
-    Serial.println("[OPEN NETWORK]");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.println("  Password: [NONE - Open Network]");
-  } else {
-    Serial.println("********");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.print("  Password: ");
-    for (int i = 0; i < wifiPassword.length(); i++) {
-      Serial.print("*");
-    }
-    Serial.println();
-  }
-  
-  return true;
-}
+CommandBus bus;  // LED state store
+DeviceIdentity identity;  // MAC/IP/SSID formatted once, not per request
+HttpMetrics httpMetrics;  // Per-route request counts and latency for /metrics
+LatencyHistogram loopTime;  // Work per loop() pass
+StaticRequestArena<REQUEST_ARENA_SIZE> requestArena;  // Reset after every request
+WiFiCache wifiCache;  // Credentials, AP and address saved in NVS
+BootTimeline boot;    // Reset to first served request: Serial and /metrics
+FastWiFi::Connector wifiConnector;  // Associates while setup() does the rest
+uint8_t wifiPhase = BootTimeline::NO_PHASE;
 
 /**
  * @brief Send standardized JSON response
  */
 void sendJson(int code, const char* message, bool includeState = true) {
-  String json = "{\"success\":";
-  json += (code == 200) ? "true" : "false";
-  json += ",\"message\":\"";
-  json += message;
-  json += "\"";
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("success", code == 200)
+      .field("message", message);
+  if (includeState) json.field("led_state", bus.led());
+  json.field("api_version", "1.0")
+      .field("timestamp", millis())
+      .endObject();
   
-  if (includeState) {
-    json += ",\"led_state\":";
-    json += ledState ? "true" : "false";
-  }
-  
-  json += ",\"api_version\":\"1.0\"";
-  json += ",\"timestamp\":";
-  json += millis();
-  json += "}";
-  
-  server.send(code, "application/json", json);
+  server.send_P(code, "application/json", json.c_str(), json.length());
 }
 
 /**
- * @brief Control LED state
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
 }
 
 /**
  * @brief GET /status - Device status
  */
 void handleStatus() {
-  String json = "{";
-  json += "\"device\":\"ESP32\"";
-  json += ",\"device_id\":\"" + WiFi.macAddress() + "\"";
-  json += ",\"ip\":\"" + WiFi.localIP().toString() + "\"";
-  json += ",\"ssid\":\"" + WiFi.SSID() + "\"";
-  json += ",\"rssi\":" + String(WiFi.RSSI());
-  json += ",\"led_state\":" + String(ledState ? "true" : "false");
-  json += ",\"uptime\":" + String(millis() / 1000);
-  json += ",\"heap\":" + String(ESP.getFreeHeap());
-  json += ",\"api_version\":\"1.0\"";
-  json += "}";
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  HeapSnapshot heap = HeapMonitor::snapshot();
+  json.beginObject()
+      .field("device", "ESP32")
+      .field("device_id", identity.wifiMac())
+      .field("ip", identity.ip())
+      .field("ssid", identity.ssid())
+      .field("rssi", WiFi.RSSI())
+      .field("led_state", bus.led())
+      .field("uptime", millis() / 1000)
+      .field("heap", heap.freeBytes);
+  HeapMonitor::writeStatusJson(json, heap);
+  WiFiReconnect::writeStatusJson(json);
+  WiFiPowerSave::writeStatusJson(json);
+  json.field("api_version", "1.0")
+      .endObject();
   
-  server.send(200, "application/json", json);
+  server.send_P(200, "application/json", json.c_str(), json.length());
 }
 
 /**
  * @brief GET /led/on - Turn LED on
  */
 void handleLedOn() {
-  setLED(true);
+  bus.dispatch(Command::ledSet(true, TRANSPORT_REST));
   sendJson(200, "LED ON");
 }
 
@@ -148,7 +110,7 @@ void handleLedOn() {
  * @brief GET /led/off - Turn LED off
  */
 void handleLedOff() {
-  setLED(false);
+  bus.dispatch(Command::ledSet(false, TRANSPORT_REST));
   sendJson(200, "LED OFF");
 }
 
@@ -162,15 +124,13 @@ void handleLedControl() {
     return;
   }
   
-  String body = server.arg("plain");
-  body.toLowerCase();
+  const String& body = server.arg("plain");
+  Command command;
   
-  if (body.indexOf("\"state\":true") >= 0) {
-    setLED(true);
-    sendJson(200, "LED ON");
-  } else if (body.indexOf("\"state\":false") >= 0) {
-    setLED(false);
-    sendJson(200, "LED OFF");
+  if (parseJsonCommand(body.c_str(), body.length(), TRANSPORT_REST, command) &&
+      command.type == CMD_LED_SET) {
+    bus.dispatch(command);
+    sendJson(200, command.value ? "LED ON" : "LED OFF");
   } else {
     sendJson(400, "Invalid JSON format", false);
   }
@@ -180,69 +140,117 @@ void handleLedControl() {
  * @brief Handle undefined endpoints
  */
 void handleNotFound() {
-  String json = "{\"success\":false,\"message\":\"Endpoint not found\",\"path\":\"";
-  json += server.uri();
-  json += "\",\"api_version\":\"1.0\",\"timestamp\":";
-  json += millis();
-  json += "}";
-  server.send(404, "application/json", json);
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("success", false)
+      .field("message", "Endpoint not found")
+      .field("path", server.uri().c_str())
+      .field("api_version", "1.0")
+      .field("timestamp", millis())
+      .endObject();
+  server.send_P(404, "application/json", json.c_str(), json.length());
 }
 
 /**
- * @brief Connect to WiFi with timeout
+ * @brief Start connecting to WiFi; finishWiFi() waits for the result
+ *
+ * After the first connect the channel and BSSID are cached, so a reboot
+ * skips the scan (FastWiFi.h)
  */
-bool connectWiFi() {
+void startWiFi() {
+  Serial.println("\n=== Connecting to WiFi ===");
   Serial.print("Connecting to WiFi: ");
-  Serial.println(wifiSSID);
+  Serial.println(wifiCache.ssid());
+  Serial.println(wifiCache.password()[0] != '\0' ? "(Secured network)" : "(Open network)");
   
-  WiFi.mode(WIFI_STA);
-  
-  // Connect with or without password
-  if (wifiPassword.length() > 0) {
-    Serial.println("(Secured network)");
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-  } else {
-    Serial.println("(Open network)");
-    WiFi.begin(wifiSSID.c_str());
+  wifiPhase = boot.begin("wifi", micros());
+  wifiConnector.start(wifiCache, WIFI_TIMEOUT_MS, REUSE_DHCP_LEASE);
+}
+
+/**
+ * @brief Wait for the connection startWiFi() began, with timeout
+ */
+bool finishWiFi() {
+  FastWiFi::Result result;
+  while ((result = wifiConnector.update()) == FastWiFi::PENDING) {
+    delay(FastWiFi::POLL_MS);
   }
-  
-  uint32_t start = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - start > WIFI_TIMEOUT_MS) {
-      Serial.println(" FAILED");
-      Serial.println("Connection timeout - check credentials");
-      return false;
-    }
-    delay(500);
-    Serial.print(".");
+  boot.end(wifiPhase, micros());
+  boot.setNote(FastWiFi::describe(result, wifiCache, REUSE_DHCP_LEASE));
+  if (result == FastWiFi::FAILED) {
+    Serial.println(" FAILED");
+    Serial.println("Connection timeout - check credentials");
+    return false;
   }
   
-  Serial.println(" CONNECTED");
+  Serial.print(" CONNECTED (");
+  Serial.print(result == FastWiFi::CACHED_AP ? "cached AP" : "full scan");
+  Serial.println(")");
   Serial.print("IP Address: ");
   Serial.println(WiFi.localIP());
   Serial.print("Signal: ");
   Serial.print(WiFi.RSSI());
   Serial.println(" dBm");
+  if (!FastWiFi::remember(wifiCache, REUSE_DHCP_LEASE)) {
+    Serial.println("WARNING: could not save WiFi settings - next boot will ask again");
+  }
   return true;
 }
 
 /**
- * @brief Monitor WiFi connection
+ * @brief Act on WiFi events; WiFiReconnect.h retries with backoff
  */
 void checkWiFi() {
-  uint32_t now = millis();
-  if (now - lastWifiCheck < WIFI_CHECK_INTERVAL_MS) return;
-  
-  lastWifiCheck = now;
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi lost - reconnecting");
-    WiFi.reconnect();
+  switch (WiFiReconnect::poll(millis())) {
+    case WiFiReconnect::LOST:
+      Serial.println("WiFi lost - reconnecting");
+      break;
+    case WiFiReconnect::CONNECTED:
+      Serial.print("WiFi back after ");
+      Serial.print(WiFiReconnect::policy().lastRecoveryMs());
+      Serial.println(" ms");
+      break;
+    default:
+      break;
   }
 }
 
+/**
+ * @brief Close the boot timeline at the first served request and print it
+ */
+void checkBootDone() {
+  if (boot.finished() || httpMetrics.total() == 0) return;
+  boot.ready("first_request", micros());
+  StaticResponseBuffer<192> line;
+  boot.report(line);
+  Serial.println(line.c_str());
+}
+
+/**
+ * @brief Everything GET /metrics reports
+ */
+void collectMetrics(MetricsWriter& out) {
+  httpMetrics.write(out);
+  requestArena.write(out, "http");
+  MetricsEndpoint::writeDevice(out, loopTime);
+  boot.write(out);
+  WiFiReconnect::write(out);
+  WiFiPowerSave::write(out);
+  out.counter("led_state_changes_total", "LED changes from any transport", bus.state().revision);
+}
+
 void setup() {
   Serial.begin(115200);
-  delay(1000);
+  
+  // With saved credentials WiFi associates while the rest of setup() runs,
+  // and there is no prompt to wait for a serial monitor
+  bool saved = FastWiFi::load(wifiCache);
+  if (saved) {
+    startWiFi();
+  } else {
+    delay(1000);
+  }
   
   // Clear serial buffer
   while (Serial.available()) {
@@ -251,50 +259,66 @@ void setup() {
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.applyOutput();  // LED off
   
   Serial.println("\n\n=== ESP32 REST API ===");
   Serial.println("Firmware Version: 1.0");
   Serial.println();
   
-  // Get WiFi credentials from user (retry until valid input)
-  while (!getWiFiCredentials()) {
-    delay(2000);  // Wait 2 seconds before prompting again
+  // Configure endpoints (the listener starts once WiFi has an address)
+  MetricsEndpoint::on(server, httpMetrics, "/status", HTTP_GET, handleStatus);
+  MetricsEndpoint::on(server, httpMetrics, "/led/on", HTTP_GET, handleLedOn);
+  MetricsEndpoint::on(server, httpMetrics, "/led/off", HTTP_GET, handleLedOff);
+  MetricsEndpoint::on(server, httpMetrics, "/led", HTTP_POST, handleLedControl);
+  MetricsEndpoint::onNotFound(server, httpMetrics, handleNotFound);
+  MetricsEndpoint::begin(server, collectMetrics);
+  
+  Serial.println("=== Available Endpoints ===");
+  Serial.println("GET  /status   - Device status");
+  Serial.println("GET  /led/on   - Turn LED on");
+  Serial.println("GET  /led/off  - Turn LED off");
+  Serial.println("POST /led      - Control LED (JSON)");
+  Serial.println("GET  /metrics  - Prometheus metrics");
+  boot.mark("init", micros());  // Includes the banner: Serial output blocks at 115200 baud
+  
+  // Serial, BLE or the setup AP, whichever delivers first, unless saved
+  if (!wifiCache.hasCredentials()) {
+    ProvisioningPortal::run(wifiCache);
+    boot.mark("credentials", micros());
+    startWiFi();
   }
   
-  // Connect to WiFi
-  Serial.println("\n=== Connecting to WiFi ===");
-  if (!connectWiFi()) {
-    Serial.println("\nERROR: WiFi connection failed");
-    Serial.println("Please reset and check:");
-    Serial.println("  1. SSID is correct");
-    Serial.println("  2. Password is correct (if secured)");
-    Serial.println("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
-    Serial.println("  4. Router is powered on");
-    while(1) {
-      delay(1000);
+  while (!finishWiFi()) {
+    if (!saved) {
+      // Just entered, so never saved: drop them and ask again
+      Serial.println("\nERROR: WiFi connection failed");
+      Serial.println("Enter the credentials again, and check:");
+      Serial.println("  1. SSID is correct");
+      Serial.println("  2. Password is correct (if secured)");
+      Serial.println("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
+      Serial.println("  4. Router is powered on");
+      wifiCache.clear();
+      ProvisioningPortal::run(wifiCache);
+      startWiFi();
+      continue;
     }
+    // The saved network may just be down: new credentials, or retry on timeout
+    Serial.println("\nSaved WiFi network not reachable");
+    Serial.println("Enter new credentials, or wait to retry the saved ones");
+    if (ProvisioningPortal::run(wifiCache, PROVISION_TIMEOUT_MS)) saved = false;
+    startWiFi();
   }
+  boot.mark("wifi_wait", micros());  // Setup time spent waiting for the address
+  WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());  // Drops from here on
+  WiFiPowerSave::begin(POWER_SAVE_IDLE_MS, POWER_SAVE_DEEP_IDLE_MS);
   
-  // Configure endpoints
-  Serial.println("\n=== Starting HTTP Server ===");
-  server.on("/status", HTTP_GET, handleStatus);
-  server.on("/led/on", HTTP_GET, handleLedOn);
-  server.on("/led/off", HTTP_GET, handleLedOff);
-  server.on("/led", HTTP_POST, handleLedControl);
-  server.onNotFound(handleNotFound);
+  WiFiIdentity::begin(identity);
   
   // Start server
   server.begin();
-  Serial.println("Server started successfully!");
-  Serial.println();
-  Serial.println("=== Available Endpoints ===");
-  Serial.println("GET  /status   - Device status");
-  Serial.println("GET  /led/on   - Turn LED on");
-  Serial.println("GET  /led/off  - Turn LED off");
-  Serial.println("POST /led      - Control LED (JSON)");
-  Serial.println();
-  Serial.println("=== Access URLs ===");
+  boot.mark("listen", micros());
+  Serial.println("\n=== HTTP Server Started ===");
   Serial.print("http://");
   Serial.println(WiFi.localIP());
   Serial.println("=======================");
@@ -302,7 +326,19 @@ void setup() {
 }
 
 void loop() {
-  server.handleClient();
+  uint32_t start = micros();
   checkWiFi();
-  delay(1);
+  WiFiIdentity::refresh();  // Re-format MAC/IP/SSID only after a WiFi event
+  uint32_t handled = httpMetrics.total();
+  WiFiPowerSave::update(millis(), handled, 0);
+  uint32_t handlerStart = micros();
+  server.handleClient();  // At most one request
+  if (httpMetrics.total() != handled) {
+    WiFiPowerSave::policy().observeHandler(micros() - handlerStart);
+  }
+  checkBootDone();
+  loopTime.observe(micros() - start);
+  
+  // Sleep until a request arrives or a reconnect attempt is due (no fixed delay)
+  LoopIdle::wait(WiFiReconnect::msUntilNext(millis()), httpMetrics.total());
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <HTTPClient.h>
+#include <StallMonitor.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <LineAssembler.h>
 
 // --- Configuration ---
 const char* ssid = "YOUR_WIFI_SSID";
@@ -12,11 +14,17 @@ const char* password = "YOUR_WIFI_PASSWORD";
 const char* API_SAVE_ENDPOINT = "https://YOUR-CUSTOM-PROXY-API.com/api/v1/data/save";
 const char* API_FETCH_ENDPOINT = "https://YOUR-CUSTOM-PROXY-API.com/api/v1/data/latest";
 const int API_TIMEOUT_MS = 10000;
+const uint32_t STALL_THRESHOLD_MS = 200;  // loop() passes longer than this are stalls
 
 // Hardware/State
 WebServer server(80);
 float current_temperature = 25.5; // Simulate a sensor reading
 
+// The API calls block loop(): GET /stalls and the serial command "stalls" show for how long
+StallWatchdog stallWatchdog(STALL_THRESHOLD_MS);
+StaticResponseBuffer<640> stallReport;  // Header and TOP_STALLS rows
+StaticLineAssembler<32> serialCommand;
+
 // --- MODEL (Data & External Service Interaction) ---
 
 /**
@@ -24,6 +32,7 @@ float current_temperature = 25.5; // Simulate a sensor reading
  * @return true if the API call was successful (HTTP 200/201), false otherwise.
  */
 bool saveDataToMongoAPI(float temperature) {
+  STALL_SECTION(stallWatchdog, "save_mongo");
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("MODEL: Wi-Fi not connected. Cannot send data.");
     return false;
@@ -68,6 +77,7 @@ bool saveDataToMongoAPI(float temperature) {
  * * @return A String containing the fetched temperature value (or a status message on failure).
  */
 String fetchDataFromMongoAPI() {
+  STALL_SECTION(stallWatchdog, "fetch_mongo");  // Up to API_TIMEOUT_MS
   if (WiFi.status() != WL_CONNECTED) return "ERROR: Wi-Fi Disconnected";
 
   HTTPClient http;
@@ -225,6 +235,30 @@ void handleSaveData() {
   server.send(302, "text/plain", "Redirecting...");
 }
 
+/**
+ * @brief GET /stalls - worst loop() stalls (?reset=1 clears them)
+ */
+void handleStalls() {
+  StallMonitor::report(stallWatchdog, stallReport);
+  server.send(200, "text/plain", stallReport.c_str());
+  stallReport.clear();
+  if (server.hasArg("reset")) stallWatchdog.reset();
+}
+
+/**
+ * @brief Serial "stalls" / "stalls reset"
+ */
+void pollSerialCommands() {
+  if (serialCommand.poll(Serial, millis()) != LineAssembler::LINE_READY) return;
+  if (strcmp(serialCommand.line(), "stalls") == 0) {
+    StallMonitor::report(stallWatchdog, stallReport);
+    stallReport.flushTo(Serial);
+  } else if (strcmp(serialCommand.line(), "stalls reset") == 0) {
+    stallWatchdog.reset();
+    Serial.println("Stalls reset");
+  }
+}
+
 void setup() {
   Serial.begin(115200);
 
@@ -244,14 +278,18 @@ void setup() {
   // --- Server Setup (Controller Function) ---
   server.on("/", HTTP_GET, handleRoot);       // GET request for the dashboard
   server.on("/save", HTTP_POST, handleSaveData); // POST request to save data
+  server.on("/stalls", HTTP_GET, handleStalls);  // Worst loop() stalls
   server.begin();
 
   Serial.println("CONTROLLER: HTTP Server started. Ready for requests.");
   randomSeed(analogRead(0)); // Initialize random seed for sensor simulation
+  StallMonitor::begin(stallWatchdog);
 }
 
 void loop() {
   // --- Loop (Controller Function) ---
+  stallWatchdog.tick(millis());
   server.handleClient(); // Process incoming client requests
+  pollSerialCommands();
   delay(1);
 }
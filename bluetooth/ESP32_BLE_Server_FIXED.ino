@@ -9,6 +9,10 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <Scheduler.h>
+#include <LoopIdle.h>
 
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
@@ -28,24 +32,29 @@ BLECharacteristic* pStatusCharacteristic = nullptr;
 BLECharacteristic* pDataCharacteristic = nullptr;
 
 // State Variables
-bool ledState = false;
+CommandBus bus;  // LED state store
 bool deviceConnected = false;
 bool oldDeviceConnected = false;
-unsigned long lastStatusUpdate = 0;
-unsigned long lastDataSend = 0;
+Scheduler scheduler;  // Periodic status and sensor notifications
 const unsigned long STATUS_UPDATE_INTERVAL = 5000; // 5 seconds
 const unsigned long DATA_SEND_INTERVAL = 2000; // 2 seconds
+const uint32_t SERIAL_POLL_MS = 10; // Serial commands answered within 10 ms
 uint32_t dataCounter = 0;
 
+void updateStatusCharacteristic();
+
 /**
- * @brief Control LED state and notify clients
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
-  Serial.println(state ? "🔵 LED: ON" : "⚫ LED: OFF");
-  
-  // Update status immediately when LED changes
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
+  Serial.println(state.led ? "🔵 LED: ON" : "⚫ LED: OFF");
+}
+
+/**
+ * @brief BLE adapter - update status immediately when the LED changes
+ */
+void onLedChangedBle(const StateEvent&, void*) {
   updateStatusCharacteristic();
 }
 
@@ -56,7 +65,7 @@ String getDeviceStatus() {
   String status = "{";
   status += "\"device\":\"ESP32_BLE\",";
   status += "\"name\":\"" + String(BLE_DEVICE_NAME) + "\",";
-  status += "\"led\":\"" + String(ledState ? "on" : "off") + "\",";
+  status += "\"led\":\"" + String(bus.led() ? "on" : "off") + "\",";
   status += "\"uptime\":" + String(millis() / 1000) + ",";
   status += "\"heap\":" + String(ESP.getFreeHeap()) + ",";
   status += "\"connected\":" + String(deviceConnected ? "true" : "false") + ",";
@@ -82,7 +91,7 @@ String getSensorData() {
   data += "\"temperature\":" + String(temperature, 1) + ",";
   data += "\"humidity\":" + String(humidity, 1) + ",";
   data += "\"light\":" + String(light) + ",";
-  data += "\"led\":\"" + String(ledState ? "on" : "off") + "\"";
+  data += "\"led\":\"" + String(bus.led() ? "on" : "off") + "\"";
   data += "}";
   
   return data;
@@ -115,51 +124,73 @@ void sendSensorData() {
 /**
  * @brief Process incoming BLE commands
  */
-void processCommand(String command) {
-  command.trim();
-  command.toLowerCase();
+void processCommand(const char* text, size_t length, Transport source) {
+  Command command;
+  parseTextCommand(text, length, source, command);
   
-  Serial.println("📨 Command: " + command);
+  Serial.print("📨 Command: ");
+  Serial.write((const uint8_t*)text, length);
+  Serial.println();
   
-  if (command == "led on" || command == "on") {
-    setLED(true);
-    
-  } else if (command == "led off" || command == "off") {
-    setLED(false);
-    
-  } else if (command == "toggle") {
-    setLED(!ledState);
-    
-  } else if (command == "status") {
-    updateStatusCharacteristic();
-    
-  } else if (command == "data") {
-    sendSensorData();
-    
-  } else if (command == "help") {
-    // Send help as status update
-    if (deviceConnected && pStatusCharacteristic) {
-      String help = "{\"help\":[\"on\",\"off\",\"toggle\",\"status\",\"data\",\"help\"]}";
-      pStatusCharacteristic->setValue(help.c_str());
-      pStatusCharacteristic->notify();
-    }
-    
-  } else if (command.length() > 0) {
-    Serial.println("❌ Unknown: " + command);
-    // Send error as status
-    if (deviceConnected && pStatusCharacteristic) {
-      String error = "{\"error\":\"Unknown command: " + command + "\"}";
-      pStatusCharacteristic->setValue(error.c_str());
-      pStatusCharacteristic->notify();
+  switch (command.type) {
+    case CMD_LED_SET:
+    case CMD_LED_TOGGLE:
+      bus.dispatch(command);  // Notifies through onLedChangedBle
+      break;
+      
+    case CMD_STATUS:
+      updateStatusCharacteristic();
+      break;
+      
+    case CMD_DATA:
+      sendSensorData();
+      break;
+      
+    case CMD_HELP:
+      // Send help as status update
+      if (deviceConnected && pStatusCharacteristic) {
+        String help = "{\"help\":[\"on\",\"off\",\"toggle\",\"status\",\"data\",\"help\"]}";
+        pStatusCharacteristic->setValue(help.c_str());
+        pStatusCharacteristic->notify();
+      }
+      break;
+      
+    default: {
+      String unknown = String(text).substring(0, length);
+      unknown.trim();
+      if (unknown.length() == 0) break;
+      
+      Serial.println("❌ Unknown: " + unknown);
+      // Send error as status
+      if (deviceConnected && pStatusCharacteristic) {
+        String error = "{\"error\":\"Unknown command: " + unknown + "\"}";
+        pStatusCharacteristic->setValue(error.c_str());
+        pStatusCharacteristic->notify();
+      }
+      break;
     }
   }
 }
 
+/**
+ * @brief Periodic status notification (scheduled task)
+ */
+void statusTask(void*) {
+  if (deviceConnected) updateStatusCharacteristic();
+}
+
+/**
+ * @brief Periodic sensor notification (scheduled task)
+ */
+void sensorTask(void*) {
+  if (deviceConnected) sendSensorData();
+}
+
 /**
  * @brief BLE Server Callbacks
  */
 class MyServerCallbacks: public BLEServerCallbacks {
-    void onConnect(BLEServer* pServer) {
+    void onConnect(BLEServer*) {
       deviceConnected = true;
       Serial.println("📱 BLE Client Connected!");
       
@@ -171,7 +202,7 @@ class MyServerCallbacks: public BLEServerCallbacks {
       }
     };
 
-    void onDisconnect(BLEServer* pServer) {
+    void onDisconnect(BLEServer*) {
       deviceConnected = false;
       Serial.println("📱 BLE Client Disconnected");
     }
@@ -186,18 +217,8 @@ class MyCharacteristicCallbacks: public BLECharacteristicCallbacks {
       std::string rxValue = pCharacteristic->getValue();
 
       if (rxValue.length() > 0) {
-        // Method 1: Using c_str() - RECOMMENDED
-        String command = String(rxValue.c_str());
-        processCommand(command);
-        
-        // Alternative Method 2: Manual character copying
-        /*
-        String command = "";
-        for (int i = 0; i < rxValue.length(); i++) {
-          command += rxValue[i];
-        }
-        processCommand(command);
-        */
+        // Method 3: pass rxValue.c_str() directly - no String copy
+        processCommand(rxValue.c_str(), rxValue.length(), TRANSPORT_BLE);
       }
     }
 };
@@ -212,7 +233,9 @@ void setup() {
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.subscribe(onLedChangedBle);
+  bus.applyOutput();  // LED off
   
   // Initialize BLE
   Serial.println("🔧 Initializing BLE...");
@@ -262,6 +285,9 @@ void setup() {
   pAdvertising->setMinPreferred(0x0);  // set value to 0x00 to not advertise this parameter
   BLEDevice::startAdvertising();
   
+  scheduler.every(STATUS_UPDATE_INTERVAL, statusTask, nullptr, millis());
+  scheduler.every(DATA_SEND_INTERVAL, sensorTask, nullptr, millis());
+  
   Serial.println("✅ BLE Server initialized successfully!");
   Serial.println();
   Serial.println("🔷 === Device Information ===");
@@ -301,26 +327,18 @@ void loop() {
     oldDeviceConnected = deviceConnected;
   }
   
-  // Send periodic status updates
-  if (deviceConnected && (millis() - lastStatusUpdate > STATUS_UPDATE_INTERVAL)) {
-    updateStatusCharacteristic();
-    lastStatusUpdate = millis();
-  }
-  
-  // Send periodic sensor data
-  if (deviceConnected && (millis() - lastDataSend > DATA_SEND_INTERVAL)) {
-    sendSensorData();
-    lastDataSend = millis();
-  }
+  // Periodic status updates and sensor data
+  scheduler.run(millis());
   
   // Check for Serial Monitor commands (for testing)
   if (Serial.available()) {
     String command = Serial.readStringUntil('\n');
     Serial.println("🧪 Testing: " + command);
-    processCommand(command);
+    processCommand(command.c_str(), command.length(), TRANSPORT_SERIAL);
   }
   
-  delay(10);
+  // BLE writes arrive on the Bluetooth task; only Serial needs polling here
+  LoopIdle::wait(min(scheduler.msUntilNext(millis()), SERIAL_POLL_MS));
 }
 
 /*
@@ -346,7 +364,7 @@ void loop() {
  * 
  * ALTERNATIVE METHODS:
  * Method 1: String(rxValue.c_str()) - RECOMMENDED (most efficient)
- * Method 2: Manual loop (commented out) - works but less efficient
+ * Method 2: Manual loop - works but less efficient
  * Method 3: rxValue.c_str() directly in functions expecting const char*
  * 
  * The compilation error should now be resolved!
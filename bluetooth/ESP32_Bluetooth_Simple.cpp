@@ -2,6 +2,11 @@
 #include "esp_bt_main.h"
 #include "esp_bt_device.h"
 #include "esp_gap_bt_api.h"
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <ResponseBuffer.h>
+#include <SppLink.h>
 
 // Check if Bluetooth is available
 #if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
@@ -13,13 +18,29 @@ const uint8_t LED_PIN = 2;
 
 // Bluetooth Configuration
 const char* BT_DEVICE_NAME = "ESP32_BT_Server";
+const size_t BT_MAX_LINE_LENGTH = 64;         // Longer commands are rejected
+const uint32_t BT_LINE_IDLE_FLUSH_MS = 1000;  // Terminals that send no line ending
+const size_t BT_TX_BUFFER_SIZE = 512;         // Largest reply assembled before sending
+const size_t BT_TX_CHUNK_SIZE = 330;          // Bytes per SerialBT.write() (RFCOMM MTU)
+const char* BT_HELP_TEXT =
+  "  led on    - Turn LED ON\r\n"
+  "  led off   - Turn LED OFF\r\n"
+  "  status    - Get device status\r\n"
+  "  help      - Show this help\r\n";
+const char* BT_REPLY_END = "\r\n";  // Blank line closing each reply after "mode:script"
 
 // Global Objects
 BluetoothSerial SerialBT;
+StaticLineAssembler<BT_MAX_LINE_LENGTH> btLine;
+SppLink btLink(btLine);  // Text commands + binary frames on the same link
+StaticLineAssembler<BT_MAX_LINE_LENGTH> serialLine;
+StaticResponseBuffer<BT_TX_BUFFER_SIZE> btOut;  // Used from loop() only
+DeviceIdentity identity;  // Name and MAC formatted once, not per request
 
 // State Variables
-bool ledState = false;
+CommandBus bus;  // LED state shared by Bluetooth and Serial Monitor commands
 bool bluetoothConnected = false;
+bool btScriptReplies = false;  // Set by "mode:script", cleared on each new connection
 String deviceName = "";
 unsigned long lastDiscoverabilityCheck = 0;
 const unsigned long DISCOVERABILITY_INTERVAL = 30000; // Check every 30 seconds
@@ -39,43 +60,39 @@ void maintainDiscoverability() {
 }
 
 /**
- * @brief Get Bluetooth MAC address as string
+ * @brief Read the Bluetooth MAC address once into the identity cache
  */
-String getBluetoothMAC() {
+void cacheBluetoothMAC() {
   uint8_t mac[6];
   SerialBT.getBtAddress(mac);
-  
-  char macStr[18];
-  sprintf(macStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
-          mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-  
-  return String(macStr);
+  identity.setBluetoothMac(mac);
 }
 
 /**
- * @brief Control LED state
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
-  Serial.println(state ? "LED: ON" : "LED: OFF");
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
+  Serial.println(state.led ? "LED: ON" : "LED: OFF");
 }
 
 /**
  * @brief Bluetooth event callback
  */
-void bluetoothCallback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
+void bluetoothCallback(esp_spp_cb_event_t event, esp_spp_cb_param_t*) {
   switch (event) {
-    case ESP_SPP_SRV_OPEN_EVT:
+    case ESP_SPP_SRV_OPEN_EVT: {
       Serial.println("Bluetooth client connected");
       bluetoothConnected = true;
-      SerialBT.println("Welcome to ESP32 Bluetooth Server!");
-      SerialBT.println("Available commands:");
-      SerialBT.println("  led on    - Turn LED ON");
-      SerialBT.println("  led off   - Turn LED OFF");
-      SerialBT.println("  status    - Get device status");
-      SerialBT.println("  help      - Show this help");
+      btScriptReplies = false;  // Terminal output until the client asks otherwise
+      // Runs on the Bluetooth task, so it must not share btOut with loop()
+      StaticResponseBuffer<192> welcome;
+      welcome.println("Welcome to ESP32 Bluetooth Server!");
+      welcome.println("Available commands:");
+      welcome.print(BT_HELP_TEXT);
+      welcome.flushTo(SerialBT);
       break;
+    }
       
     case ESP_SPP_CLOSE_EVT:
       Serial.println("Bluetooth client disconnected");
@@ -99,44 +116,144 @@ void bluetoothCallback(esp_spp_cb_event_t event, esp_spp_cb_param_t *param) {
   }
 }
 
+/**
+ * @brief Send the reply in btOut, closed with BT_REPLY_END in script mode
+ *
+ * A script that sent "mode:script" knows the reply is complete at the blank
+ * line, whatever its length. Terminal users get the reply as it was.
+ */
+void sendBluetoothReply() {
+  if (btScriptReplies) btOut.print(BT_REPLY_END);
+  btOut.flushTo(SerialBT, BT_TX_CHUNK_SIZE);
+}
+
 /**
  * @brief Process incoming Bluetooth commands
+ * 
+ * Replies are assembled in btOut and sent with a single write instead of
+ * one RFCOMM packet per line.
  */
-void processBluetoothCommand(String command) {
-  command.trim();
-  command.toLowerCase();
+void processBluetoothCommand(const char* text, size_t length, Transport source) {
+  if (length == 0) return;
   
-  Serial.println("Received command: " + command);
+  Serial.print("Received command: ");
+  Serial.println(text);
   
-  if (command == "led on") {
-    setLED(true);
-    SerialBT.println("LED turned ON");
+  Command command;
+  parseTextCommand(text, length, source, command);
+  
+  if (command.type == CMD_LED_SET || command.type == CMD_LED_TOGGLE) {
+    bus.dispatch(command);
+    btOut.println(bus.led() ? "LED turned ON" : "LED turned OFF");
     
-  } else if (command == "led off") {
-    setLED(false);
-    SerialBT.println("LED turned OFF");
+  } else if (command.type == CMD_STATUS) {
+    btOut.println("=== Device Status ===");
+    btOut.println("Device: ESP32");
+    btOut.printf("Bluetooth Name: %s\r\n", identity.name());
+    btOut.printf("Bluetooth MAC: %s\r\n", identity.bluetoothMac());
+    btOut.printf("LED State: %s\r\n", bus.led() ? "ON" : "OFF");
+    btOut.printf("Uptime: %lu seconds\r\n", (unsigned long)(millis() / 1000));
+    btOut.printf("Free Heap: %lu bytes\r\n", (unsigned long)ESP.getFreeHeap());
+    btOut.printf("Bluetooth Connected: %s\r\n", bluetoothConnected ? "Yes" : "No");
+    btOut.println("====================");
     
-  } else if (command == "status") {
-    SerialBT.println("=== Device Status ===");
-    SerialBT.println("Device: ESP32");
-    SerialBT.println("Bluetooth Name: " + String(BT_DEVICE_NAME));
-    SerialBT.println("Bluetooth MAC: " + getBluetoothMAC());
-    SerialBT.println("LED State: " + String(ledState ? "ON" : "OFF"));
-    SerialBT.println("Uptime: " + String(millis() / 1000) + " seconds");
-    SerialBT.println("Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
-    SerialBT.println("Bluetooth Connected: " + String(bluetoothConnected ? "Yes" : "No"));
-    SerialBT.println("====================");
+  } else if (command.type == CMD_HELP) {
+    btOut.println("Available commands:");
+    btOut.print(BT_HELP_TEXT);
     
-  } else if (command == "help") {
-    SerialBT.println("Available commands:");
-    SerialBT.println("  led on    - Turn LED ON");
-    SerialBT.println("  led off   - Turn LED OFF");
-    SerialBT.println("  status    - Get device status");
-    SerialBT.println("  help      - Show this help");
+  } else if (command.type == CMD_REPLY_MODE) {
+    btScriptReplies = command.value;
+    btOut.println(btScriptReplies ? "Reply mode: script" : "Reply mode: terminal");
     
-  } else if (command.length() > 0) {
-    SerialBT.println("Unknown command: '" + command + "'");
-    SerialBT.println("Type 'help' for available commands");
+  } else {
+    btOut.printf("Unknown command: '%s'\r\n", text);
+    btOut.println("Type 'help' for available commands");
+  }
+  
+  sendBluetoothReply();
+}
+
+/**
+ * @brief Process a binary Bluetooth frame (see SppFrame.h for the layout)
+ */
+void processBluetoothFrame(const SppFrame& frame) {
+  uint8_t reply[SPP_FRAME_MAX_PAYLOAD];
+  uint8_t length = 0;
+  
+  switch (frame.command) {
+    case SPP_CMD_PING:
+      reply[length++] = SPP_OK;
+      break;
+      
+    case SPP_CMD_STATUS:
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      reply[length++] = 0;  // No WiFi in this sketch
+      reply[length++] = 0;
+      length += sppPutU32(reply + length, millis() / 1000);
+      length += sppPutU32(reply + length, ESP.getFreeHeap());
+      break;
+      
+    case SPP_CMD_LED_SET:
+      if (frame.length != 1) {
+        reply[length++] = SPP_ERR_BAD_LENGTH;
+        break;
+      }
+      bus.dispatch(Command::ledSet(frame.payload[0] != 0, TRANSPORT_SPP));
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      break;
+      
+    case SPP_CMD_LED_TOGGLE:
+      bus.dispatch(Command::toggle(TRANSPORT_SPP));
+      reply[length++] = SPP_OK;
+      reply[length++] = bus.led() ? 1 : 0;
+      break;
+      
+    default:
+      reply[length++] = SPP_ERR_UNKNOWN_CMD;
+      break;
+  }
+  
+  btLink.reply(SerialBT, frame, reply, length);
+}
+
+/**
+ * @brief Poll Bluetooth and Serial Monitor input without blocking
+ */
+void pollCommandInputs() {
+  uint32_t now = millis();
+  
+  switch (btLink.poll(SerialBT, now)) {
+    case SppLink::SPP_LINE:
+      processBluetoothCommand(btLink.line(), btLink.lineLength(), TRANSPORT_SPP);
+      break;
+    case SppLink::SPP_LINE_OVERFLOW:
+      btOut.printf("Command too long (max %u characters)\r\n", (unsigned)BT_MAX_LINE_LENGTH);
+      sendBluetoothReply();
+      break;
+    case SppLink::SPP_FRAME:
+      processBluetoothFrame(btLink.frame());
+      break;
+    case SppLink::SPP_FRAME_ERROR:
+      Serial.println("Frame rejected: error " + String(btLink.error()));
+      btLink.replyError(SerialBT);
+      break;
+    default:
+      break;
+  }
+  
+  // Serial Monitor input (for testing)
+  switch (serialLine.poll(Serial, now)) {
+    case LineAssembler::LINE_READY:
+      Serial.println("Testing command locally: " + String(serialLine.line()));
+      processBluetoothCommand(serialLine.line(), serialLine.length(), TRANSPORT_SERIAL);
+      break;
+    case LineAssembler::LINE_OVERFLOW:
+      Serial.println("Command too long (max " + String(BT_MAX_LINE_LENGTH) + " characters)");
+      break;
+    default:
+      break;
   }
 }
 
@@ -151,7 +268,11 @@ void setup() {
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.applyOutput();  // LED off
+  
+  btLine.setIdleFlush(BT_LINE_IDLE_FLUSH_MS);
+  serialLine.setIdleFlush(BT_LINE_IDLE_FLUSH_MS);
   
   // Initialize Bluetooth
   Serial.println("Initializing Bluetooth...");
@@ -173,11 +294,14 @@ void setup() {
   // Set device as discoverable and connectable
   esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
   
+  identity.setName(BT_DEVICE_NAME);
+  cacheBluetoothMAC();
+  
   Serial.println("Bluetooth initialized successfully!");
   Serial.println();
   Serial.println("=== Device Information ===");
-  Serial.println("Bluetooth Name: " + String(BT_DEVICE_NAME));
-  Serial.println("Bluetooth MAC: " + getBluetoothMAC());
+  Serial.println("Bluetooth Name: " + String(identity.name()));
+  Serial.println("Bluetooth MAC: " + String(identity.bluetoothMac()));
   Serial.println("Device discoverable as: " + String(BT_DEVICE_NAME));
   Serial.println("Discoverability: ENABLED (Continuous)");
   Serial.println("==========================");
@@ -201,18 +325,8 @@ void loop() {
   // Maintain Bluetooth discoverability
   maintainDiscoverability();
   
-  // Check for incoming Bluetooth data
-  if (SerialBT.available()) {
-    String command = SerialBT.readString();
-    processBluetoothCommand(command);
-  }
-  
-  // Check for Serial Monitor input (for testing)
-  if (Serial.available()) {
-    String command = Serial.readString();
-    Serial.println("Testing command locally: " + command);
-    processBluetoothCommand(command);
-  }
+  // Check for incoming Bluetooth and Serial Monitor commands
+  pollCommandInputs();
   
   delay(10);
 }
\ No newline at end of file
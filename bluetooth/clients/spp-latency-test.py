@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+ESP32 SPP Response Latency Test
+Measures end-to-end time to receive a complete multi-line reply (e.g. the
+"status" block) over Bluetooth Classic RFCOMM, or over TCP from the host
+build of ESP32_Bluetooth_Simple.cpp (host/README.md, port 9000).
+
+The script first sends "mode:script", after which every text reply of the
+Bluetooth sketches ends with a blank line, so any command can be timed.
+
+Usage:
+    python3 spp-latency-test.py --bt AA:BB:CC:DD:EE:FF [--channel 1]
+    python3 spp-latency-test.py --tcp 127.0.0.1:9000 --command help
+    python3 spp-latency-test.py --bt AA:BB:CC:DD:EE:FF --command help --count 50
+
+Requires Linux (AF_BLUETOOTH sockets) and a paired device for --bt.
+"""
+
+import argparse
+import socket
+import statistics
+import sys
+import time
+
+
+def reply_complete(buffer):
+    """A reply ends with a blank line (BT_REPLY_END in the sketches, script mode)"""
+    return buffer.replace(b"\r", b"").endswith(b"\n\n")
+
+
+def open_socket(args):
+    if args.bt:
+        sock = socket.socket(socket.AF_BLUETOOTH, socket.SOCK_STREAM, socket.BTPROTO_RFCOMM)
+        sock.connect((args.bt, args.channel))
+    else:
+        host, port = args.tcp.rsplit(":", 1)
+        sock = socket.create_connection((host, int(port)))
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    sock.settimeout(args.timeout)
+    return sock
+
+
+def drain(sock):
+    """Discard anything pending (e.g. the welcome banner)"""
+    sock.settimeout(0.5)
+    try:
+        while sock.recv(4096):
+            pass
+    except socket.timeout:
+        pass
+
+
+def measure_once(sock, command, timeout):
+    """Send one command and time until the closing blank line arrives"""
+    buffer = b""
+    packets = 0
+    start = time.perf_counter()
+    first_byte = None
+    sock.sendall(command.encode() + b"\r\n")
+    sock.settimeout(timeout)
+
+    while True:
+        chunk = sock.recv(4096)
+        if not chunk:
+            raise ConnectionError("connection closed")
+        if first_byte is None:
+            first_byte = time.perf_counter()
+        packets += 1
+        buffer += chunk
+        if reply_complete(buffer):
+            end = time.perf_counter()
+            return (first_byte - start) * 1000.0, (end - start) * 1000.0, packets, len(buffer)
+
+
+def percentile(values, pct):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(pct / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure SPP multi-line response latency")
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("--bt", help="ESP32 Bluetooth MAC address")
+    target.add_argument("--tcp", help="host:port of a TCP stand-in")
+    parser.add_argument("--channel", type=int, default=1, help="RFCOMM channel (default 1)")
+    parser.add_argument("--command", default="status", help="Command to send (default status)")
+    parser.add_argument("--count", type=int, default=20, help="Number of requests")
+    parser.add_argument("--interval", type=float, default=0.2, help="Seconds between requests")
+    parser.add_argument("--timeout", type=float, default=5.0, help="Per-request timeout (s)")
+    args = parser.parse_args()
+
+    sock = open_socket(args)
+    drain(sock)
+    measure_once(sock, "mode:script", args.timeout)  # Close replies with a blank line
+
+    first, total, packets, sizes = [], [], [], []
+    for i in range(args.count):
+        try:
+            f, t, p, n = measure_once(sock, args.command, args.timeout)
+        except socket.timeout:
+            print(f"Request {i + 1}: timeout", file=sys.stderr)
+            continue
+        first.append(f)
+        total.append(t)
+        packets.append(p)
+        sizes.append(n)
+        time.sleep(args.interval)
+    sock.close()
+
+    if not total:
+        print("No complete responses received")
+        return 1
+
+    print(f"Command:            {args.command!r} x {len(total)}")
+    print(f"Response size:      {statistics.mean(sizes):.0f} bytes")
+    print(f"Packets per reply:  {statistics.mean(packets):.1f} (recv() calls)")
+    print(f"First byte (ms):    p50 {percentile(first, 50):.1f}  p90 {percentile(first, 90):.1f}")
+    print(f"Full block (ms):    p50 {percentile(total, 50):.1f}  p90 {percentile(total, 90):.1f}"
+          f"  p99 {percentile(total, 99):.1f}  max {max(total):.1f}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,62 @@
+#include "BootTimeline.h"
+
+#include <stdio.h>
+
+void BootTimeline::mark(const char* phase, uint32_t nowUs) {
+  if (finished_ || count_ >= MAX_PHASES) return;
+  phases_[count_] = Phase{phase, cursorUs_, nowUs, false, false};
+  cursorUs_ = nowUs;
+  count_++;
+}
+
+uint8_t BootTimeline::begin(const char* phase, uint32_t nowUs) {
+  if (finished_ || count_ >= MAX_PHASES) return NO_PHASE;
+  phases_[count_] = Phase{phase, nowUs, nowUs, true, true};
+  return count_++;
+}
+
+void BootTimeline::end(uint8_t phase, uint32_t nowUs) {
+  if (phase >= count_ || !phases_[phase].open) return;
+  phases_[phase].endUs = nowUs;
+  phases_[phase].open = false;
+}
+
+uint32_t BootTimeline::durationUs(uint8_t phase) const {
+  if (phase >= count_ || phases_[phase].open) return 0;
+  return phases_[phase].endUs - phases_[phase].startUs;
+}
+
+void BootTimeline::report(ResponseBuffer& out) const {
+  uint32_t total = totalUs();
+  out.printf("boot %lu.%lu ms", (unsigned long)(total / 1000), (unsigned long)(total % 1000 / 100));
+  if (note_ != nullptr) out.printf(" (%s)", note_);
+  for (uint8_t i = 0; i < count_; i++) {
+    const Phase& p = phases_[i];
+    out.printf("%s%s ", i == 0 ? ": " : " | ", p.name);
+    if (p.open) {
+      out.print("-");
+    } else {
+      uint32_t us = durationUs(i);
+      out.printf("%lu.%lu", (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 100));
+    }
+    if (p.overlapping) {
+      out.printf(" @%lu.%lu", (unsigned long)(p.startUs / 1000),
+                 (unsigned long)(p.startUs % 1000 / 100));
+    }
+  }
+}
+
+void BootTimeline::write(MetricsWriter& out) const {
+  char labels[48];
+
+  out.family("esp32_boot_phase_seconds", "gauge", "Setup phase durations of this boot");
+  for (uint8_t i = 0; i < count_; i++) {
+    if (phases_[i].open) continue;
+    snprintf(labels, sizeof(labels), "phase=\"%s\"", phases_[i].name);
+    out.sampleSeconds("esp32_boot_phase_seconds", labels, durationUs(i));
+  }
+  if (finished_) {
+    out.family("esp32_boot_seconds", "gauge", "Reset to the first served request");
+    out.sampleSeconds("esp32_boot_seconds", nullptr, totalUs());
+  }
+}
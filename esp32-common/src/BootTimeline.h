@@ -0,0 +1,96 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Metrics.h"
+#include "ResponseBuffer.h"
+
+/**
+ * @brief Time from reset to the first served request, split into setup phases
+ *
+ * setup() calls mark() with micros() as each phase ends; a marked phase
+ * starts where the previous marked phase ended, the first one at 0. Work
+ * that overlaps them (WiFi associating while the rest of setup() runs) is
+ * timed with begin() / end() instead. On the ESP32 micros() starts with
+ * the application, so the ROM and second-stage bootloader (about 300 ms
+ * with default settings) are not included. ready() closes the timeline the
+ * first time the device does its job (a request served, a broker
+ * connection) and is a single compare afterwards, so loop() can call it
+ * every pass.
+ */
+class BootTimeline {
+public:
+  static const uint8_t MAX_PHASES = 10;
+  static const uint8_t NO_PHASE = 0xFF;
+
+  /**
+   * @brief The phase named by the literal `phase` ended at `nowUs`
+   */
+  void mark(const char* phase, uint32_t nowUs);
+
+  /**
+   * @brief Start a phase that runs alongside the marked ones
+   * @return id for end(), NO_PHASE when the timeline is full or closed
+   */
+  uint8_t begin(const char* phase, uint32_t nowUs);
+
+  /**
+   * @brief End a begin() phase; allowed after ready() (it is still reported)
+   */
+  void end(uint8_t phase, uint32_t nowUs);
+
+  /**
+   * @brief Last phase; true only for the call that closed the timeline
+   */
+  bool ready(const char* phase, uint32_t nowUs) {
+    if (finished_) return false;
+    mark(phase, nowUs);
+    finished_ = true;
+    readyUs_ = nowUs;
+    return true;
+  }
+
+  /**
+   * @brief Short literal shown with the total, e.g. how WiFi connected
+   */
+  void setNote(const char* note) { note_ = note; }
+
+  bool finished() const { return finished_; }
+  uint8_t count() const { return count_; }
+  const char* name(uint8_t phase) const { return phases_[phase].name; }
+  uint32_t startUs(uint8_t phase) const { return phases_[phase].startUs; }
+  uint32_t durationUs(uint8_t phase) const;
+  bool open(uint8_t phase) const { return phases_[phase].open; }
+  uint32_t totalUs() const { return readyUs_; }
+
+  /**
+   * @brief One line: "boot 412.3 ms (note): init 3.1 | wifi 380.2 @1.0 | ...";
+   *        "@" gives the start of a begin() phase, "-" one still running
+   */
+  void report(ResponseBuffer& out) const;
+
+  /**
+   * @brief esp32_boot_phase_seconds{phase=...} and esp32_boot_seconds
+   */
+  void write(MetricsWriter& out) const;
+
+private:
+  struct Phase {
+    const char* name;
+    uint32_t startUs;
+    uint32_t endUs;
+    bool overlapping;  // From begin()
+    bool open;         // begin() without end() yet
+  };
+
+  Phase phases_[MAX_PHASES];
+  uint8_t count_ = 0;
+  uint32_t cursorUs_ = 0;  // End of the last marked phase
+  uint32_t readyUs_ = 0;
+  bool finished_ = false;
+  const char* note_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "CommandBus.h"
+
+const char* transportName(Transport transport) {
+  switch (transport) {
+    case TRANSPORT_LOCAL: return "local";
+    case TRANSPORT_REST: return "rest";
+    case TRANSPORT_WEBSOCKET: return "websocket";
+    case TRANSPORT_MQTT: return "mqtt";
+    case TRANSPORT_BLE: return "ble";
+    case TRANSPORT_SPP: return "bluetooth";
+    case TRANSPORT_SERIAL: return "serial";
+  }
+  return "unknown";
+}
+
+bool CommandBus::subscribe(StateListener listener, void* context) {
+  if (listener == nullptr || subscriberCount_ >= MAX_SUBSCRIBERS) return false;
+  subscribers_[subscriberCount_++] = Subscriber{listener, context};
+  return true;
+}
+
+CommandBus::Result CommandBus::dispatch(const Command& command) {
+  bool led = state_.led;
+
+  switch (command.type) {
+    case CMD_LED_SET:
+      led = command.value;
+      break;
+    case CMD_LED_TOGGLE:
+      led = !state_.led;
+      break;
+    case CMD_UNKNOWN:
+      return RESULT_UNKNOWN;
+    default:
+      return RESULT_QUERY;
+  }
+
+  // A no-op is published too: every LED command gets its led_update, as
+  // when each transport broadcast from its own setLED()
+  const bool changed = led != state_.led;
+  if (changed) {
+    state_.led = led;
+    state_.revision++;
+    if (output_ != nullptr) output_(state_);
+  }
+  publish(command, changed);
+  return changed ? RESULT_CHANGED : RESULT_UNCHANGED;
+}
+
+void CommandBus::applyOutput() {
+  if (output_ != nullptr) output_(state_);
+}
+
+void CommandBus::publish(const Command& command, bool changed) {
+  StateEvent event = {state_, command.source, command.client, command.trace, changed};
+  for (uint8_t i = 0; i < subscriberCount_; i++) {
+    subscribers_[i].listener(event, subscribers_[i].context);
+  }
+  eventsPublished_++;
+}
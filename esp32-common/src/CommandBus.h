@@ -0,0 +1,147 @@
+#ifndef COMMAND_BUS_H
+#define COMMAND_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Command types shared by every transport
+ *
+ * State commands (LED) are executed by the bus. Query commands are returned
+ * to the caller, which formats the reply for its own transport.
+ */
+enum CommandType : uint8_t {
+  CMD_UNKNOWN,
+  CMD_LED_SET,      // Command::value holds the target state
+  CMD_LED_TOGGLE,
+  CMD_STATUS,
+  CMD_WIFI_STATUS,
+  CMD_DATA,
+  CMD_HELP,
+  CMD_LIST,
+  CMD_RESTART,
+  CMD_REPLY_MODE    // Command::value: true for framed (script) replies
+};
+
+/**
+ * @brief Where a command came from (or an event is going to)
+ */
+enum Transport : uint8_t {
+  TRANSPORT_LOCAL,
+  TRANSPORT_REST,
+  TRANSPORT_WEBSOCKET,
+  TRANSPORT_MQTT,
+  TRANSPORT_BLE,
+  TRANSPORT_SPP,
+  TRANSPORT_SERIAL
+};
+
+const char* transportName(Transport transport);
+
+struct Command {
+  CommandType type;
+  bool value;         // CMD_LED_SET target state
+  Transport source;
+  uint8_t client;     // Transport-specific client (e.g. WebSocket slot), 0 if unused
+  uint32_t trace;     // CommandTrace id, 0 if the command is not traced
+
+  // Build commands through these, so a new field gets its value in one place
+  static Command make(CommandType type, bool value, Transport source, uint8_t client = 0) {
+    return Command{type, value, source, client, 0};
+  }
+
+  static Command ledSet(bool on, Transport source, uint8_t client = 0) {
+    return make(CMD_LED_SET, on, source, client);
+  }
+
+  static Command toggle(Transport source, uint8_t client = 0) {
+    return make(CMD_LED_TOGGLE, false, source, client);
+  }
+};
+
+/**
+ * @brief The single state store behind all transports
+ */
+struct DeviceState {
+  bool led;
+  uint32_t revision;  // Incremented on every change
+};
+
+/**
+ * @brief Published once per LED command to every subscriber
+ */
+struct StateEvent {
+  const DeviceState& state;
+  Transport source;   // Transport that issued the command
+  uint8_t client;
+  uint32_t trace;     // Command::trace of the command that made the change
+  bool changed;       // false: the LED already had the commanded state
+};
+
+typedef void (*StateListener)(const StateEvent& event, void* context);
+typedef void (*StateOutput)(const DeviceState& state);
+
+/**
+ * @brief Executes typed commands against one DeviceState and fans out changes
+ *
+ * Each transport adapter subscribes once. An LED command from any transport
+ * is applied to the hardware output (if it changes the state) and then
+ * delivered to every subscriber exactly once, including the originating
+ * transport (which can skip it using StateEvent::source). Commands that
+ * leave the state as it was are delivered too, with StateEvent::changed
+ * false, so every sender still gets its update. Listeners must not call
+ * dispatch() re-entrantly.
+ */
+class CommandBus {
+public:
+  static const uint8_t MAX_SUBSCRIBERS = 8;
+
+  enum Result : uint8_t {
+    RESULT_CHANGED,     // State changed and was published
+    RESULT_UNCHANGED,   // Valid state command, state already matched (published too)
+    RESULT_QUERY,       // Not a state command - caller replies
+    RESULT_UNKNOWN      // CMD_UNKNOWN
+  };
+
+  /**
+   * @brief Hardware hook, called on every change before subscribers
+   */
+  void setOutput(StateOutput output) { output_ = output; }
+
+  /**
+   * @brief Register a transport adapter
+   * @return false if all subscriber slots are taken
+   */
+  bool subscribe(StateListener listener, void* context = nullptr);
+
+  Result dispatch(const Command& command);
+
+  const DeviceState& state() const { return state_; }
+  bool led() const { return state_.led; }
+
+  /**
+   * @brief Drive the output to the current state without publishing (setup)
+   */
+  void applyOutput();
+
+  /**
+   * @brief LED commands published, no-ops included; state().revision counts changes
+   */
+  uint32_t eventsPublished() const { return eventsPublished_; }
+
+private:
+  struct Subscriber {
+    StateListener listener;
+    void* context;
+  };
+
+  void publish(const Command& command, bool changed);
+
+  DeviceState state_ = {false, 0};
+  StateOutput output_ = nullptr;
+  Subscriber subscribers_[MAX_SUBSCRIBERS];
+  uint8_t subscriberCount_ = 0;
+  uint32_t eventsPublished_ = 0;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "CommandParser.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include "CommandTrace.h"
+
+namespace {
+
+struct Keyword {
+  const char* text;
+  CommandType type;
+  bool value;
+};
+
+const Keyword TEXT_COMMANDS[] = {
+  {"led on", CMD_LED_SET, true},
+  {"on", CMD_LED_SET, true},
+  {"led off", CMD_LED_SET, false},
+  {"off", CMD_LED_SET, false},
+  {"toggle", CMD_LED_TOGGLE, false},
+  {"status", CMD_STATUS, false},
+  {"wifi status", CMD_WIFI_STATUS, false},
+  {"data", CMD_DATA, false},
+  {"help", CMD_HELP, false},
+  {"list", CMD_LIST, false},
+  {"restart", CMD_RESTART, false},
+  {"mode:script", CMD_REPLY_MODE, true},
+  {"mode:terminal", CMD_REPLY_MODE, false},
+};
+
+const Keyword JSON_COMMANDS[] = {
+  {"led_on", CMD_LED_SET, true},
+  {"led_off", CMD_LED_SET, false},
+  {"toggle", CMD_LED_TOGGLE, false},
+  {"status", CMD_STATUS, false},
+  {"list", CMD_LIST, false},
+  {"restart", CMD_RESTART, false},
+};
+
+bool equalsIgnoreCase(const char* a, size_t length, const char* b) {
+  for (size_t i = 0; i < length; i++) {
+    if (b[i] == '\0' || tolower((unsigned char)a[i]) != b[i]) return false;
+  }
+  return b[length] == '\0';
+}
+
+template <size_t N>
+bool lookup(const Keyword (&table)[N], const char* text, size_t length, Transport source, Command& out) {
+  for (size_t i = 0; i < N; i++) {
+    if (equalsIgnoreCase(text, length, table[i].text)) {
+      out = Command::make(table[i].type, table[i].value, source);
+      return true;
+    }
+  }
+  out = Command::make(CMD_UNKNOWN, false, source);
+  return false;
+}
+
+const char* skipSpace(const char* p, const char* end) {
+  while (p < end && isspace((unsigned char)*p)) p++;
+  return p;
+}
+
+/**
+ * @brief Find "key" followed by ':' and return a pointer to the value
+ */
+const char* findValue(const char* json, const char* end, const char* key) {
+  size_t keyLength = strlen(key);
+  for (const char* p = json; p + keyLength + 2 <= end; p++) {
+    if (*p != '"' || p[keyLength + 1] != '"') continue;
+    if (!equalsIgnoreCase(p + 1, keyLength, key)) continue;
+    const char* value = skipSpace(p + keyLength + 2, end);
+    if (value >= end || *value != ':') continue;
+    return skipSpace(value + 1, end);
+  }
+  return nullptr;
+}
+
+/**
+ * @brief "trace":"<hex id>", 0 if absent or malformed
+ */
+uint32_t findTraceId(const char* json, const char* end) {
+  const char* value = findValue(json, end, "trace");
+  if (value == nullptr || value >= end || *value != '"') return 0;
+  const char* start = value + 1;
+  const char* close = (const char*)memchr(start, '"', end - start);
+  return close != nullptr ? CommandTrace::parseId(start, close - start) : 0;
+}
+
+bool parseJsonBody(const char* json, const char* end, Transport source, Command& out) {
+  const char* value = findValue(json, end, "command");
+  if (value != nullptr && value < end && *value == '"') {
+    const char* start = value + 1;
+    const char* close = (const char*)memchr(start, '"', end - start);
+    if (close != nullptr) {
+      return lookup(JSON_COMMANDS, start, close - start, source, out);
+    }
+  }
+
+  value = findValue(json, end, "state");
+  if (value != nullptr) {
+    if (end - value >= 4 && equalsIgnoreCase(value, 4, "true")) {
+      out = Command::ledSet(true, source);
+      return true;
+    }
+    if (end - value >= 5 && equalsIgnoreCase(value, 5, "false")) {
+      out = Command::ledSet(false, source);
+      return true;
+    }
+  }
+
+  out = Command::make(CMD_UNKNOWN, false, source);
+  return false;
+}
+
+}  // namespace
+
+bool parseTextCommand(const char* text, size_t length, Transport source, Command& out) {
+  const char* end = text + length;
+  const char* start = skipSpace(text, end);
+  while (end > start && isspace((unsigned char)end[-1])) end--;
+  return lookup(TEXT_COMMANDS, start, end - start, source, out);
+}
+
+bool parseJsonCommand(const char* json, size_t length, Transport source, Command& out) {
+  const char* end = json + length;
+  const bool known = parseJsonBody(json, end, source, out);
+  out.trace = findTraceId(json, end);
+  return known;
+}
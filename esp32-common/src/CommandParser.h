@@ -0,0 +1,28 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <stddef.h>
+
+#include "CommandBus.h"
+
+/**
+ * @brief Parse a plain-text command ("led on", "off", "toggle", "status", ...)
+ *
+ * Case-insensitive, ignores surrounding whitespace, does not allocate.
+ * Unrecognised text yields CMD_UNKNOWN.
+ * @return true if a known command was parsed
+ */
+bool parseTextCommand(const char* text, size_t length, Transport source, Command& out);
+
+/**
+ * @brief Parse a JSON command body without a JSON library
+ *
+ * Accepts {"command":"led_on|led_off|toggle|status|list|restart"} (WebSocket)
+ * and {"state":true|false} (REST POST /led, MQTT esp32/led/control).
+ * Key/value matching is case-insensitive and tolerates whitespace. An
+ * optional "trace":"<hex id>" member sets Command::trace (CommandTrace.h).
+ * @return true if a known command was parsed
+ */
+bool parseJsonCommand(const char* json, size_t length, Transport source, Command& out);
+
+#endif
@@ -0,0 +1,126 @@
+#include "CommandTrace.h"
+
+#include <ctype.h>
+
+namespace {
+
+const char* const POINT_NAMES[TRACE_POINTS] = {"rx", "parse", "exec", "reply", "bcast"};
+
+void formatId(uint32_t id, char (&text)[9]) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  for (int i = 7; i >= 0; i--) {
+    text[i] = HEX_DIGITS[id & 0xF];
+    id >>= 4;
+  }
+  text[8] = '\0';
+}
+
+}  // namespace
+
+uint32_t CommandTrace::begin(uint32_t id, Transport source, uint32_t nowUs) {
+  if (id == 0) id = DEVICE_ID | (++assigned_ & ~DEVICE_ID);
+  Slot& slot = slots_[next_];
+  next_ = (uint8_t)((next_ + 1) % SLOTS);
+
+  slot.id.store(0, std::memory_order_relaxed);  // mark() and readers skip it meanwhile
+  slot.source.store(source, std::memory_order_relaxed);
+  slot.startUs.store(nowUs, std::memory_order_relaxed);
+  slot.atUs[TRACE_RECEIVE].store(0, std::memory_order_relaxed);
+  for (uint8_t i = TRACE_RECEIVE + 1; i < TRACE_POINTS; i++) {
+    slot.atUs[i].store(UNSET, std::memory_order_relaxed);
+  }
+  slot.id.store(id, std::memory_order_release);
+  return id;
+}
+
+int CommandTrace::indexOf(uint32_t id) const {
+  if (id == 0) return -1;
+  for (uint8_t i = 0; i < SLOTS; i++) {
+    if (slots_[i].id.load(std::memory_order_acquire) == id) return i;
+  }
+  return -1;
+}
+
+void CommandTrace::mark(uint32_t id, TracePoint point, uint32_t nowUs) {
+  const int index = indexOf(id);
+  if (index < 0 || point >= TRACE_POINTS) return;
+  Slot& slot = slots_[index];
+  slot.atUs[point].store(nowUs - slot.startUs.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+}
+
+bool CommandTrace::copy(const Slot& slot, Trace& out) const {
+  out.id = slot.id.load(std::memory_order_acquire);
+  if (out.id == 0) return false;
+  out.source = (Transport)slot.source.load(std::memory_order_relaxed);
+  out.startUs = slot.startUs.load(std::memory_order_relaxed);
+  for (uint8_t i = 0; i < TRACE_POINTS; i++) {
+    out.atUs[i] = slot.atUs[i].load(std::memory_order_relaxed);
+  }
+  return slot.id.load(std::memory_order_acquire) == out.id;  // Not reused meanwhile
+}
+
+bool CommandTrace::find(uint32_t id, Trace& out) const {
+  const int index = indexOf(id);
+  return index >= 0 && copy(slots_[index], out) && out.id == id;
+}
+
+void CommandTrace::writeTrace(const Trace& trace, JsonWriter& json) {
+  char id[9];
+  formatId(trace.id, id);
+  json.field("id", id)
+      .field("source", transportName(trace.source))
+      .beginObject("us");
+  for (uint8_t i = TRACE_RECEIVE + 1; i < TRACE_POINTS; i++) {
+    if (trace.atUs[i] != UNSET) json.field(POINT_NAMES[i], trace.atUs[i]);
+  }
+  json.endObject();
+}
+
+void CommandTrace::writeJson(uint32_t id, JsonWriter& json) const {
+  Trace trace;
+  if (!find(id, trace)) return;
+  json.beginObject("trace");
+  writeTrace(trace, json);
+  json.endObject();
+}
+
+void CommandTrace::writeAll(JsonWriter& json) const {
+  json.beginObject().beginArray("traces");
+  for (uint8_t n = 0; n < SLOTS; n++) {
+    Trace trace;
+    if (!copy(slots_[(next_ + n) % SLOTS], trace)) continue;
+    json.beginObject();
+    writeTrace(trace, json);
+    json.endObject();
+  }
+  json.endArray().endObject();
+}
+
+bool CommandTrace::format(uint32_t id, ResponseBuffer& out) const {
+  Trace trace;
+  if (!find(id, trace)) return false;
+  char text[9];
+  formatId(trace.id, text);
+  out.printf("trace %s %s", text, transportName(trace.source));
+  for (uint8_t i = TRACE_RECEIVE + 1; i < TRACE_POINTS; i++) {
+    if (trace.atUs[i] != UNSET) out.printf(" %s=%lu", POINT_NAMES[i], (unsigned long)trace.atUs[i]);
+  }
+  out.print("\n");
+  return true;
+}
+
+uint32_t CommandTrace::parseId(const char* text, size_t length) {
+  if (length == 0 || length > 8) return 0;
+  uint32_t id = 0;
+  for (size_t i = 0; i < length; i++) {
+    const int c = tolower((unsigned char)text[i]);
+    if (!isxdigit(c)) return 0;
+    id = id << 4 | (uint32_t)(isdigit(c) ? c - '0' : c - 'a' + 10);
+  }
+  return id;
+}
+
+const char* CommandTrace::pointName(TracePoint point) {
+  return point < TRACE_POINTS ? POINT_NAMES[point] : "?";
+}
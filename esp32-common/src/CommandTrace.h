@@ -0,0 +1,113 @@
+#ifndef COMMAND_TRACE_H
+#define COMMAND_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "CommandBus.h"
+#include "JsonWriter.h"
+#include "ResponseBuffer.h"
+
+/**
+ * @brief Where a traced command is on its way through the device
+ */
+enum TracePoint : uint8_t {
+  TRACE_RECEIVE,    // Request or frame handed to the handler
+  TRACE_PARSE,      // Command decoded
+  TRACE_EXECUTE,    // CommandBus::dispatch() returned
+  TRACE_REPLY,      // Answer to the sender handed to the server
+  TRACE_BROADCAST,  // led_update handed to the WebSocket clients
+  TRACE_POINTS
+};
+
+/**
+ * @brief Timestamps of the last few commands, by trace id
+ *
+ * A caller (the Node controller) sends a trace id with the command: the
+ * X-Trace-Id header on HTTP, a "trace" member in WebSocket JSON. Commands
+ * without one get a device id, which has the top bit set so it never
+ * equals a caller's. Each TracePoint is stored in microseconds after
+ * TRACE_RECEIVE and reported in the response, on Serial as one line
+ *
+ *   trace 1f03a9c2 rest parse=38 exec=412 reply=96 bcast=655
+ *
+ * and by GET /traces, which http-REST/trace-merge.js lines up with the
+ * controller's own timestamps.
+ *
+ * begin() belongs to one task (the one that receives commands); mark()
+ * may be called from any task. The last SLOTS traces are kept; a mark()
+ * for an older one is dropped.
+ */
+class CommandTrace {
+public:
+  static const uint8_t SLOTS = 16;
+  static const uint32_t DEVICE_ID = 0x80000000;  // Set in ids assigned by the device
+  static const uint32_t UNSET = UINT32_MAX;
+
+  struct Trace {
+    uint32_t id;
+    Transport source;
+    uint32_t startUs;            // micros() at TRACE_RECEIVE
+    uint32_t atUs[TRACE_POINTS];  // After startUs; UNSET if not reached
+  };
+
+  /**
+   * @brief Start a trace at TRACE_RECEIVE
+   * @param id The caller's id, or 0 to assign one
+   * @return The id in use
+   */
+  uint32_t begin(uint32_t id, Transport source, uint32_t nowUs);
+
+  /**
+   * @brief Record `point` for trace `id` (any task; id 0 is ignored)
+   */
+  void mark(uint32_t id, TracePoint point, uint32_t nowUs);
+
+  /**
+   * @brief Copy of trace `id`, if still kept
+   */
+  bool find(uint32_t id, Trace& out) const;
+
+  /**
+   * @brief "trace":{"id":"1f03a9c2","source":"rest","us":{"parse":38,...}} member
+   */
+  void writeJson(uint32_t id, JsonWriter& json) const;
+
+  /**
+   * @brief {"traces":[...]} with every kept trace, oldest first (GET /traces)
+   */
+  void writeAll(JsonWriter& json) const;
+
+  /**
+   * @brief The one-line Serial form, newline included
+   * @return false if the trace is no longer kept
+   */
+  bool format(uint32_t id, ResponseBuffer& out) const;
+
+  /**
+   * @brief 1 to 8 hex digits; 0 if empty, longer or not hex
+   */
+  static uint32_t parseId(const char* text, size_t length);
+  static const char* pointName(TracePoint point);
+
+private:
+  // Atomics throughout: a reader on another task may see the slot being reused
+  struct Slot {
+    std::atomic<uint32_t> id{0};
+    std::atomic<uint8_t> source{TRANSPORT_LOCAL};
+    std::atomic<uint32_t> startUs{0};
+    std::atomic<uint32_t> atUs[TRACE_POINTS];
+  };
+
+  int indexOf(uint32_t id) const;  // -1: not kept
+  bool copy(const Slot& slot, Trace& out) const;
+  static void writeTrace(const Trace& trace, JsonWriter& json);
+
+  Slot slots_[SLOTS];
+  uint8_t next_ = 0;         // Slot the next begin() takes
+  uint32_t assigned_ = 0;    // Device ids handed out
+};
+
+#endif
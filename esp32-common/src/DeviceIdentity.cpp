@@ -0,0 +1,65 @@
+#include "DeviceIdentity.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t NO_MAC[6] = {0, 0, 0, 0, 0, 0};
+
+DeviceIdentity::DeviceIdentity() {
+  name_[0] = '\0';
+  ssid_[0] = '\0';
+  formatMac(bluetoothMac_, NO_MAC, ':');
+  formatMac(wifiMac_, NO_MAC, ':');
+  formatMac(deviceId_, NO_MAC, '\0');
+  clearIp();
+  revision_ = 0;
+}
+
+void DeviceIdentity::setName(const char* name) {
+  copy(name_, sizeof(name_), name);
+  revision_++;
+}
+
+void DeviceIdentity::setBluetoothMac(const uint8_t mac[6]) {
+  formatMac(bluetoothMac_, mac, ':');
+  revision_++;
+}
+
+void DeviceIdentity::setWifiMac(const uint8_t mac[6]) {
+  formatMac(wifiMac_, mac, ':');
+  formatMac(deviceId_, mac, '\0');
+  revision_++;
+}
+
+void DeviceIdentity::setIp(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  snprintf(ip_, sizeof(ip_), "%u.%u.%u.%u", a, b, c, d);
+  hasIp_ = (a | b | c | d) != 0;
+  revision_++;
+}
+
+void DeviceIdentity::clearIp() {
+  copy(ip_, sizeof(ip_), "0.0.0.0");
+  hasIp_ = false;
+  revision_++;
+}
+
+void DeviceIdentity::setSsid(const char* ssid) {
+  copy(ssid_, sizeof(ssid_), ssid);
+  revision_++;
+}
+
+void DeviceIdentity::formatMac(char* out, const uint8_t mac[6], char separator) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  for (uint8_t i = 0; i < 6; i++) {
+    *out++ = HEX_DIGITS[mac[i] >> 4];
+    *out++ = HEX_DIGITS[mac[i] & 0x0F];
+    if (separator != '\0' && i < 5) *out++ = separator;
+  }
+  *out = '\0';
+}
+
+void DeviceIdentity::copy(char* out, size_t size, const char* text) {
+  if (text == nullptr) text = "";
+  strncpy(out, text, size - 1);
+  out[size - 1] = '\0';
+}
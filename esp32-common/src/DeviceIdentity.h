@@ -0,0 +1,57 @@
+#ifndef DEVICE_IDENTITY_H
+#define DEVICE_IDENTITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Preformatted device identity strings shared by all response builders
+ *
+ * MAC addresses, IP and SSID are formatted once when they change (startup,
+ * network events) instead of on every status request. Getters return
+ * NUL-terminated strings that stay valid for the lifetime of the object.
+ */
+class DeviceIdentity {
+public:
+  static const size_t NAME_SIZE = 33;
+  static const size_t MAC_SIZE = 18;   // "AA:BB:CC:DD:EE:FF"
+  static const size_t IP_SIZE = 16;    // "255.255.255.255"
+  static const size_t SSID_SIZE = 33;  // 32 chars max per 802.11
+
+  DeviceIdentity();
+
+  void setName(const char* name);
+  void setBluetoothMac(const uint8_t mac[6]);
+  void setWifiMac(const uint8_t mac[6]);
+  void setIp(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+  void clearIp();
+  void setSsid(const char* ssid);
+
+  const char* name() const { return name_; }
+  const char* bluetoothMac() const { return bluetoothMac_; }
+  const char* wifiMac() const { return wifiMac_; }
+  const char* deviceId() const { return deviceId_; }  // WiFi MAC without separators
+  const char* ip() const { return ip_; }
+  const char* ssid() const { return ssid_; }
+  bool hasIp() const { return hasIp_; }
+
+  /**
+   * @brief Incremented on every change, lets callers cache derived strings
+   */
+  uint32_t revision() const { return revision_; }
+
+private:
+  static void formatMac(char* out, const uint8_t mac[6], char separator);
+  static void copy(char* out, size_t size, const char* text);
+
+  char name_[NAME_SIZE];
+  char bluetoothMac_[MAC_SIZE];
+  char wifiMac_[MAC_SIZE];
+  char deviceId_[13];
+  char ip_[IP_SIZE];
+  char ssid_[SSID_SIZE];
+  bool hasIp_ = false;
+  uint32_t revision_ = 0;
+};
+
+#endif
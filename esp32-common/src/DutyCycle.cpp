@@ -0,0 +1,103 @@
+#include "DutyCycle.h"
+
+#include <string.h>
+
+bool DutyCycle::begin() {
+  // The layout is part of the magic: a firmware with another one starts over
+  const uint32_t magic = MAGIC ^ (uint32_t)sizeof(Storage);
+  const bool kept = storage_.magic == magic && storage_.head < CAPACITY &&
+                    storage_.count <= CAPACITY;
+  if (!kept) {
+    wipe();
+    storage_.magic = magic;
+  }
+  return kept;
+}
+
+void DutyCycle::enable(uint32_t sleepMs, uint16_t uploadEvery, uint32_t nowMs) {
+  if (uploadEvery == 0) uploadEvery = 1;
+  if (uploadEvery > CAPACITY) uploadEvery = CAPACITY;
+  storage_.sleepMs = sleepMs < MIN_SLEEP_MS ? MIN_SLEEP_MS : sleepMs;
+  storage_.uploadEvery = uploadEvery;
+  // Samples still held keep their age
+  const uint32_t shift = clockMs(nowMs);
+  for (uint32_t i = 0; i < storage_.count; i++) {
+    storage_.ring[(storage_.head + i) % CAPACITY].atMs -= shift;
+  }
+  storage_.clockMs = 0 - nowMs;  // clockMs(nowMs) reads 0
+  storage_.wakesSinceUpload = 0;
+  storage_.wakes = 0;
+  storage_.samples = 0;
+  storage_.sessions = 0;
+  storage_.failedSessions = 0;
+  storage_.uploadedSamples = 0;
+  storage_.dropped = 0;
+  storage_.awakeUs = 0;
+  storage_.sessionAwakeUs = 0;
+}
+
+void DutyCycle::wake() {
+  storage_.wakes++;
+  storage_.wakesSinceUpload++;
+}
+
+void DutyCycle::add(const Sample& sample) {
+  if (storage_.count == CAPACITY) {
+    storage_.head = (storage_.head + 1) % CAPACITY;
+    storage_.count--;
+    storage_.dropped++;
+  }
+  storage_.ring[(storage_.head + storage_.count) % CAPACITY] = sample;
+  storage_.count++;
+  storage_.samples++;
+}
+
+bool DutyCycle::uploadDue() const {
+  return storage_.count > 0 &&
+         (storage_.wakesSinceUpload >= storage_.uploadEvery || storage_.count == CAPACITY);
+}
+
+void DutyCycle::uploaded(uint16_t count) {
+  if (count > storage_.count) count = (uint16_t)storage_.count;
+  storage_.head = (storage_.head + count) % CAPACITY;
+  storage_.count -= count;
+  storage_.uploadedSamples += count;
+  storage_.sessions++;
+  storage_.wakesSinceUpload = 0;
+}
+
+void DutyCycle::uploadFailed() {
+  storage_.failedSessions++;
+  storage_.wakesSinceUpload = 0;
+}
+
+uint64_t DutyCycle::sleep(uint32_t nowMs, uint32_t awakeUs, bool session) {
+  storage_.awakeUs += awakeUs;
+  if (session) storage_.sessionAwakeUs += awakeUs;
+  // The next boot starts its millis() at 0
+  storage_.clockMs = clockMs(nowMs) + storage_.sleepMs;
+  return (uint64_t)storage_.sleepMs * 1000;
+}
+
+float DutyCycle::samplesPerSession() const {
+  return storage_.sessions > 0 ? (float)storage_.uploadedSamples / storage_.sessions : 0.0f;
+}
+
+uint32_t DutyCycle::awakeUsPerSample() const {
+  return storage_.samples > 0 ? (uint32_t)(storage_.awakeUs / storage_.samples) : 0;
+}
+
+uint32_t DutyCycle::sampleWakeUs() const {
+  const uint32_t sessionWakes = storage_.sessions + storage_.failedSessions;
+  if (storage_.wakes <= sessionWakes) return 0;
+  return (uint32_t)((storage_.awakeUs - storage_.sessionAwakeUs) / (storage_.wakes - sessionWakes));
+}
+
+uint32_t DutyCycle::sessionWakeUs() const {
+  const uint32_t sessionWakes = storage_.sessions + storage_.failedSessions;
+  return sessionWakes > 0 ? (uint32_t)(storage_.sessionAwakeUs / sessionWakes) : 0;
+}
+
+void DutyCycle::wipe() {
+  memset(&storage_, 0, sizeof(storage_));
+}
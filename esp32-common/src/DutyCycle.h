@@ -0,0 +1,166 @@
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Deep-sleep duty cycle: samples kept across wakes, WiFi every N wakes
+ *
+ * The storage is declared by the sketch with RTC_NOINIT_ATTR, so it survives
+ * deep sleep (and warm resets). Every wake adds one sample and sleeps again
+ * without starting WiFi; every uploadEvery() wakes, or when the buffer is
+ * full, uploadDue() asks for a WiFi session that sends the whole burst. A
+ * failed session keeps the samples for the next one; when the buffer
+ * overflows, the oldest samples are dropped and counted.
+ *
+ * The clock counts ms since enable(), sleep included, so a sample's age at
+ * upload time is clockMs(millis()) - atMs. It advances by the programmed
+ * sleep, so a wake that comes early (button) makes older samples look older
+ * by at most one sleep.
+ *
+ * Awake time is what the sketch passes to sleep(): micros() since the app
+ * started. The ROM and bootloader add a fixed time per wake on top.
+ *
+ * Time is passed in as millis() / micros() so the class stays Arduino-free.
+ */
+class DutyCycle {
+public:
+  static const uint16_t CAPACITY = 64;
+  static const uint32_t MIN_SLEEP_MS = 1000;
+
+  /**
+   * @brief One reading of the generic client (12 bytes)
+   */
+  struct Sample {
+    uint32_t atMs;        // clockMs() when taken
+    uint16_t analog;      // Raw ADC value
+    int16_t temperature;  // 0.1 °C
+    uint16_t humidity;    // 0.1 %
+    uint8_t button;       // 1: pressed
+    uint8_t reserved;
+  };
+
+  /**
+   * @brief Everything kept across deep sleep (0.8 KB); never initialised by the C runtime
+   */
+  struct Storage {
+    uint32_t magic;
+    uint32_t sleepMs;       // 0: duty cycle off
+    uint32_t uploadEvery;
+    uint32_t clockMs;       // Clock at the start of this boot
+    uint32_t registeredIp;  // Address the API last registered; 0: none
+    uint32_t wakesSinceUpload;
+    uint32_t head;          // Oldest sample
+    uint32_t count;
+    uint32_t wakes;
+    uint32_t samples;
+    uint32_t sessions;
+    uint32_t failedSessions;
+    uint32_t uploadedSamples;
+    uint32_t dropped;
+    uint64_t awakeUs;       // Every wake, upload sessions included
+    uint64_t sessionAwakeUs;
+    Sample ring[CAPACITY];
+  };
+
+  explicit DutyCycle(Storage& storage) : storage_(storage) {}
+
+  /**
+   * @brief Keep the state from before this boot, or start over off (setup(), first)
+   * @return true if the state was kept (deep sleep wake or warm reset)
+   */
+  bool begin();
+
+  /**
+   * @brief Start duty cycling from `nowMs` (millis()); counters start over, samples stay
+   *
+   * sleepMs is raised to MIN_SLEEP_MS, uploadEvery limited to 1..CAPACITY.
+   */
+  void enable(uint32_t sleepMs, uint16_t uploadEvery, uint32_t nowMs);
+  void disable() { storage_.sleepMs = 0; }
+
+  bool active() const { return storage_.sleepMs != 0; }
+  uint32_t sleepMs() const { return storage_.sleepMs; }
+  uint16_t uploadEvery() const { return (uint16_t)storage_.uploadEvery; }
+  uint32_t clockMs(uint32_t nowMs) const { return storage_.clockMs + nowMs; }
+
+  /**
+   * @brief Count a wake from deep sleep (before add())
+   */
+  void wake();
+
+  /**
+   * @brief Append a sample, dropping the oldest if the buffer is full
+   */
+  void add(const Sample& sample);
+
+  /**
+   * @brief This wake should bring up WiFi and upload
+   */
+  bool uploadDue() const;
+
+  uint16_t count() const { return (uint16_t)storage_.count; }
+
+  /**
+   * @brief index 0 is the oldest sample held
+   */
+  const Sample& sample(uint16_t index) const {
+    return storage_.ring[(storage_.head + index) % CAPACITY];
+  }
+
+  /**
+   * @brief A session sent the oldest `count` samples; they are dropped
+   */
+  void uploaded(uint16_t count);
+
+  /**
+   * @brief A session found no WiFi or no API; the samples wait uploadEvery() more wakes
+   */
+  void uploadFailed();
+
+  /**
+   * @brief Record this wake's awake time and advance the clock past the sleep
+   *
+   * awakeUs 0 leaves the statistics alone (the first sleep, from the awake client).
+   * @return The sleep to program, in microseconds
+   */
+  uint64_t sleep(uint32_t nowMs, uint32_t awakeUs, bool session);
+
+  /**
+   * @brief The API registration still holds while the address is the same
+   */
+  bool registered(uint32_t ip) const { return ip != 0 && storage_.registeredIp == ip; }
+  void setRegistered(uint32_t ip) { storage_.registeredIp = ip; }
+
+  uint32_t wakes() const { return storage_.wakes; }
+  uint32_t samples() const { return storage_.samples; }
+  uint32_t sessions() const { return storage_.sessions; }
+  uint32_t failedSessions() const { return storage_.failedSessions; }
+  uint32_t uploadedSamples() const { return storage_.uploadedSamples; }
+  uint32_t dropped() const { return storage_.dropped; }
+
+  /**
+   * @brief Samples sent per successful WiFi session
+   */
+  float samplesPerSession() const;
+
+  /**
+   * @brief Total awake time, sessions included, per sample taken
+   */
+  uint32_t awakeUsPerSample() const;
+
+  /**
+   * @brief Average wake that only sampled, and average wake with a session
+   */
+  uint32_t sampleWakeUs() const;
+  uint32_t sessionWakeUs() const;
+
+private:
+  static const uint32_t MAGIC = 0x44435931;  // "DCY1"
+
+  void wipe();
+
+  Storage& storage_;
+};
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef FAST_WIFI_H
+#define FAST_WIFI_H
+
+#include <Preferences.h>
+#include <WiFi.h>
+#include <string.h>
+
+#include "WiFiCache.h"
+
+/**
+ * @brief Boot-time WiFi connect from NVS: no prompt, no scan, optionally no DHCP
+ *
+ * load() reads the WiFiCache that remember() saved after the last connect.
+ * connect() passes the cached channel and BSSID to WiFi.begin(), so the
+ * driver probes one channel instead of scanning all of them (1-2 s), and
+ * configures a static or cached address first, which skips DHCP. If the
+ * cached AP does not answer within FAST_CONNECT_MS (new router, channel
+ * change) it is forgotten and a normal connect follows. The core's own
+ * credential storage is turned off, and save() writes NVS only when the
+ * blob differs, so an unchanged reboot costs one flash read.
+ *
+ * Connector does the same without blocking, so setup() can bring up GPIO,
+ * Bluetooth and the servers while the station associates.
+ */
+namespace FastWiFi {
+
+const char NVS_NAMESPACE[] = "wifi";
+const char NVS_KEY[] = "cache";
+const uint32_t FAST_CONNECT_MS = 1500;
+const uint32_t POLL_MS = 10;  // Connect status poll; the sketches used to poll every 500 ms
+
+enum Result : uint8_t {
+  PENDING,    // Connector still associating
+  FAILED,
+  SCANNED,    // Full scan: first boot, or the cached AP was gone
+  CACHED_AP   // Cached channel and BSSID, no scan
+};
+
+inline bool usesCachedAddress(const WiFiCache& cache, bool reuseLease) {
+  return cache.staticAddress() || (reuseLease && cache.hasAddress());
+}
+
+/**
+ * @brief Literal for BootTimeline::setNote(); call between connect() and remember()
+ */
+inline const char* describe(Result result, const WiFiCache& cache, bool reuseLease) {
+  bool cachedAddress = usesCachedAddress(cache, reuseLease);
+  if (result == PENDING) return "wifi pending";
+  if (result == FAILED) return "wifi failed";
+  if (result == CACHED_AP) return cachedAddress ? "cached AP and address" : "cached AP, DHCP";
+  return cachedAddress ? "full scan, cached address" : "full scan, DHCP";
+}
+
+/**
+ * @return false, with the cache cleared, when nothing valid is stored
+ */
+inline bool load(WiFiCache& cache) {
+  uint8_t stored[WiFiCache::STORED_SIZE];
+  Preferences prefs;
+  size_t length = 0;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    length = prefs.getBytes(NVS_KEY, stored, sizeof(stored));
+    prefs.end();
+  }
+  return cache.restore(length > 0 ? stored : nullptr, length);
+}
+
+/**
+ * @brief Write the cache unless NVS already holds the same bytes
+ */
+inline bool save(const WiFiCache& cache) {
+  uint8_t blob[WiFiCache::STORED_SIZE];
+  uint8_t current[WiFiCache::STORED_SIZE];
+  cache.store(blob);
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) return false;
+  bool ok = (prefs.getBytes(NVS_KEY, current, sizeof(current)) == sizeof(current) &&
+             memcmp(current, blob, sizeof(blob)) == 0) ||
+            prefs.putBytes(NVS_KEY, blob, sizeof(blob)) == sizeof(blob);
+  prefs.end();
+  return ok;
+}
+
+inline void forget() {
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) return;
+  prefs.remove(NVS_KEY);
+  prefs.end();
+}
+
+inline void configAddress(const WiFiCache& cache) {
+  WiFi.config(IPAddress(cache.ip()), IPAddress(cache.gateway()), IPAddress(cache.subnet()),
+              IPAddress(cache.dns()));
+}
+
+inline void configDhcp() {
+  WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+}
+
+/**
+ * @brief Non-blocking connect: start() returns at once, update() advances it
+ *
+ * The cached AP is tried for FAST_CONNECT_MS, then a full connect for the
+ * timeout given to start(). update() is cheap (one WiFi.status() call) and
+ * is meant to be called from loop() or a short wait loop.
+ */
+class Connector {
+public:
+  /**
+   * @param reuseLease Configure the cached DHCP lease as a static address.
+   *        Saves the DHCP exchange (0.1-1 s), but the address is then used
+   *        without a lease: only for networks that reserve it for this MAC.
+   */
+  void start(WiFiCache& cache, uint32_t timeoutMs, bool reuseLease) {
+    cache_ = &cache;
+    timeoutMs_ = timeoutMs;
+    useAddress_ = usesCachedAddress(cache, reuseLease);
+    result_ = PENDING;
+
+    WiFi.persistent(false);  // The cache is the only copy of the credentials
+    WiFi.mode(WIFI_STA);
+    if (useAddress_) configAddress(cache);
+    if (cache.hasAp()) {
+      fast_ = true;
+      WiFi.begin(cache.ssid(), password(), cache.channel(), cache.bssid());
+    } else {
+      beginFull();
+    }
+    startMs_ = millis();
+  }
+
+  /**
+   * @return PENDING, then CACHED_AP, SCANNED or FAILED (kept until start())
+   */
+  Result update() {
+    if (result_ != PENDING || cache_ == nullptr) return result_;
+    wl_status_t status = WiFi.status();
+    if (status == WL_CONNECTED) {
+      result_ = fast_ ? CACHED_AP : SCANNED;
+    } else if (fast_ && (status == WL_NO_SSID_AVAIL || millis() - startMs_ >= FAST_CONNECT_MS)) {
+      WiFi.disconnect();
+      cache_->forgetAp();
+      cache_->forgetLease();  // A different AP may be a different subnet
+      if (useAddress_ && !cache_->staticAddress()) configDhcp();
+      beginFull();
+      startMs_ = millis();
+    } else if (!fast_ && millis() - startMs_ >= timeoutMs_) {
+      result_ = FAILED;
+    }
+    return result_;
+  }
+
+  Result result() const { return result_; }
+  bool pending() const { return result_ == PENDING && cache_ != nullptr; }
+
+private:
+  const char* password() const {
+    return cache_->password()[0] != '\0' ? cache_->password() : nullptr;
+  }
+
+  void beginFull() {
+    fast_ = false;
+    WiFi.begin(cache_->ssid(), password());
+  }
+
+  WiFiCache* cache_ = nullptr;
+  uint32_t timeoutMs_ = 0;
+  uint32_t startMs_ = 0;
+  bool useAddress_ = false;
+  bool fast_ = false;
+  Result result_ = FAILED;
+};
+
+/**
+ * @brief Blocking Connector: returns once connected or failed
+ */
+inline Result connect(WiFiCache& cache, uint32_t timeoutMs, bool reuseLease) {
+  Connector connector;
+  connector.start(cache, timeoutMs, reuseLease);
+  Result result;
+  while ((result = connector.update()) == PENDING) delay(POLL_MS);
+  return result;
+}
+
+/**
+ * @brief After a connect: store credentials, AP and (with reuseLease) the
+ *        DHCP lease for the next boot; NVS is written only if they changed
+ */
+inline bool remember(WiFiCache& cache, bool reuseLease) {
+  uint8_t* bssid = WiFi.BSSID();
+  if (bssid != nullptr) cache.rememberAp(bssid, (uint8_t)WiFi.channel());
+  if (reuseLease) {
+    cache.rememberLease((uint32_t)WiFi.localIP(), (uint32_t)WiFi.gatewayIP(),
+                        (uint32_t)WiFi.subnetMask(), (uint32_t)WiFi.dnsIP(0));
+  }
+  return save(cache);
+}
+
+}  // namespace FastWiFi
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef FLIGHT_LOG_H
+#define FLIGHT_LOG_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include <WiFi.h>
+#include <esp_system.h>
+
+#include "FlightRecorder.h"
+#include "StallWatchdog.h"
+
+/**
+ * @brief Flight recorder clock, reset reason and hooks (header-only, ESP32)
+ *
+ *   RTC_NOINIT_ATTR FlightRecorder::Storage flightStorage;  // Global, kept across resets
+ *
+ *   void setup() {
+ *     Serial.begin(115200);
+ *     FlightLog::begin(flightStorage);      // First: prints what led to this boot
+ *     FlightLog::watch(stallWatchdog);      // Optional
+ *     FlightLog::on(server);                // GET /flight (?clear=1)
+ *     ...
+ *   }
+ *
+ *   FlightLog::record(FLIGHT_MQTT_UP);      // Anywhere, any task
+ *   FlightLog::record(FLIGHT_LED, event.source, event.state.led);  // CommandBus listener
+ *   FlightLog::restart("ota");              // Instead of ESP.restart()
+ *
+ * begin() records the reset reason, follows WiFi up / down events and
+ * prints the events of the previous boot, so the reason for a watchdog or
+ * panic reset is on the console right after it. Until begin(), record() is
+ * a no-op.
+ */
+namespace FlightLog {
+
+const uint32_t HEAP_LOW_BYTES = 24 * 1024;  // noteHeap() records FLIGHT_HEAP_LOW below this
+const uint32_t HEAP_OK_BYTES = 32 * 1024;   // and again only after rising above this
+const size_t CHUNK_SIZE = 512;
+
+inline FlightRecorder*& recorder() {
+  static FlightRecorder* instance = nullptr;
+  return instance;
+}
+
+inline WebServer*& server() {
+  static WebServer* instance = nullptr;
+  return instance;
+}
+
+/**
+ * @brief Append one event stamped with millis() (any task, a few microseconds)
+ */
+inline void record(FlightEventType type, uint8_t arg = 0, uint16_t value = 0) {
+  FlightRecorder* flight = recorder();
+  if (flight != nullptr) flight->record(type, arg, value, millis());
+}
+
+/**
+ * @brief record() for an event whose arg is a name (stall section, restart cause)
+ */
+inline void recordNamed(FlightEventType type, const char* name, uint32_t value = 0) {
+  FlightRecorder* flight = recorder();
+  if (flight == nullptr) return;
+  flight->record(type, flight->nameId(name), value > 0xFFFF ? 0xFFFF : (uint16_t)value, millis());
+}
+
+/**
+ * @brief Record the cause, then ESP.restart()
+ */
+[[noreturn]] inline void restart(const char* cause) {
+  recordNamed(FLIGHT_RESTART, cause);
+  Serial.flush();
+  ESP.restart();
+}
+
+/**
+ * @brief Record FLIGHT_HEAP_LOW once per drop below HEAP_LOW_BYTES
+ */
+inline void noteHeap(uint32_t freeBytes) {
+  static bool low = false;
+  if (!low && freeBytes < HEAP_LOW_BYTES) {
+    low = true;
+    record(FLIGHT_HEAP_LOW, 0, (uint16_t)(freeBytes / 1024));
+  } else if (low && freeBytes > HEAP_OK_BYTES) {
+    low = false;
+  }
+}
+
+// System event task
+inline void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    record(FLIGHT_WIFI_UP, 0, (uint16_t)(int16_t)WiFi.RSSI());
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    record(FLIGHT_WIFI_DOWN, 0, info.wifi_sta_disconnected.reason);
+  }
+}
+
+inline void onStall(const char* section, uint32_t durationMs, bool ended, void*) {
+  recordNamed(ended ? FLIGHT_STALL : FLIGHT_STALL_BEGIN, section, durationMs);
+}
+
+/**
+ * @brief Record stalls as they are seen and when they end
+ */
+inline void watch(StallWatchdog& watchdog) {
+  watchdog.onStall(onStall, nullptr);
+}
+
+/**
+ * @brief Write the rows from `first` on to `out` in CHUNK_SIZE pieces
+ */
+template <typename Output>
+void printTo(Output& out, uint16_t first = 0) {
+  const FlightRecorder* flight = recorder();
+  if (flight == nullptr) return;
+  StaticResponseBuffer<CHUNK_SIZE> chunk;
+  do {
+    first = flight->report(chunk, first);
+    out.write((const uint8_t*)chunk.c_str(), chunk.length());
+    chunk.clear();
+  } while (first < flight->count());
+}
+
+/**
+ * @brief Serial dump of the whole log ("flight" serial command)
+ */
+inline void print() {
+  printTo(Serial);
+}
+
+/**
+ * @brief Start recording into `storage` (first thing in setup(), after Serial.begin())
+ *
+ * Prints a one-line summary and, when the log survived the reset, the
+ * events of the previous boot.
+ */
+inline void begin(FlightRecorder::Storage& storage) {
+  static FlightRecorder flight(storage);
+  const esp_reset_reason_t reason = esp_reset_reason();
+  const bool kept = flight.begin((uint8_t)reason, millis());
+  recorder() = &flight;
+  WiFi.onEvent(onWiFiEvent);
+
+  Serial.printf("Flight log: boot %lu, reset=%s, %u events kept\n", (unsigned long)flight.boots(),
+                FlightRecorder::resetReasonName((uint8_t)reason),
+                kept ? (unsigned)flight.count() - 1 : 0u);
+  if (!kept || flight.count() < 2) return;
+
+  // From the previous FLIGHT_BOOT (or the oldest event held) to this one
+  int previous = flight.count() - 2;
+  while (previous > 0 && flight.event((uint16_t)previous).type != FLIGHT_BOOT) previous--;
+  printTo(Serial, (uint16_t)previous);
+}
+
+/**
+ * @brief GET uri: the whole log as text, streamed; ?clear=1 empties it afterwards
+ */
+inline void handleHttp() {
+  WebServer& webServer = *server();
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "text/plain", "");
+
+  struct Chunks {
+    WebServer& webServer;
+    size_t write(const uint8_t* data, size_t length) {
+      webServer.sendContent((const char*)data, length);
+      return length;
+    }
+  } chunks{webServer};
+  printTo(chunks);
+
+  if (webServer.hasArg("clear") && recorder() != nullptr) recorder()->clear(millis());
+}
+
+inline void on(WebServer& webServer, const char* uri = "/flight") {
+  server() = &webServer;
+  webServer.on(uri, HTTP_GET, handleHttp);
+}
+
+}  // namespace FlightLog
+
+#endif
@@ -0,0 +1,170 @@
+#include "FlightRecorder.h"
+
+#include <string.h>
+
+#include "CommandBus.h"
+
+namespace {
+
+const char* const TYPE_NAMES[FLIGHT_EVENT_TYPES] = {
+  "none", "boot", "led", "wifi_up", "wifi_down", "mqtt_up", "mqtt_down",
+  "stall_begin", "stall", "heap_low", "restart", "mark"
+};
+
+// esp_reset_reason_t values (ESP-IDF esp_system.h)
+const char* const RESET_REASONS[] = {
+  "unknown", "poweron", "external", "software", "panic", "int_wdt",
+  "task_wdt", "wdt", "deepsleep", "brownout", "sdio"
+};
+const uint8_t RESET_REASON_COUNT = sizeof(RESET_REASONS) / sizeof(RESET_REASONS[0]);
+
+}  // namespace
+
+FlightRecorder::FlightRecorder(Storage& storage) : storage_(storage) {}
+
+bool FlightRecorder::begin(uint8_t resetReason, uint32_t nowMs) {
+  // The layout is part of the magic: a firmware with another one starts over
+  const uint32_t magic = MAGIC ^ (uint32_t)sizeof(Storage);
+  const bool kept = storage_.magic == magic && storage_.nameCount <= MAX_NAMES;
+  if (!kept) {
+    wipe();
+    storage_.magic = magic;
+    storage_.boots = 0;
+  }
+  storage_.boots++;
+  next_.store(storage_.next, std::memory_order_relaxed);
+  record(FLIGHT_BOOT, resetReason, (uint16_t)storage_.boots, nowMs);
+  return kept;
+}
+
+uint8_t FlightRecorder::nameId(const char* name) {
+  uint8_t id = findName(name);
+  if (id != NO_NAME) return id;
+  if (addingName_.test_and_set(std::memory_order_acquire)) return NO_NAME;
+
+  id = findName(name);  // Added by another task since
+  const uint32_t count = storage_.nameCount;
+  if (id == NO_NAME && count < MAX_NAMES) {
+    strncpy(storage_.names[count], name, NAME_LENGTH - 1);
+    storage_.names[count][NAME_LENGTH - 1] = '\0';
+    __atomic_store_n(&storage_.nameCount, count + 1, __ATOMIC_RELEASE);
+    id = (uint8_t)count;
+  }
+  addingName_.clear(std::memory_order_release);
+  return id;
+}
+
+uint8_t FlightRecorder::findName(const char* name) const {
+  const uint32_t count = __atomic_load_n(&storage_.nameCount, __ATOMIC_ACQUIRE);
+  for (uint32_t i = 0; i < count; i++) {
+    if (strncmp(storage_.names[i], name, NAME_LENGTH - 1) == 0) return (uint8_t)i;
+  }
+  return NO_NAME;
+}
+
+void FlightRecorder::wipe() {
+  storage_.next = 0;
+  storage_.nameCount = 0;
+  memset(storage_.names, 0, sizeof(storage_.names));
+  memset(storage_.times, 0, sizeof(storage_.times));
+  memset(storage_.words, 0, sizeof(storage_.words));
+}
+
+void FlightRecorder::clear(uint32_t nowMs) {
+  wipe();
+  next_.store(0, std::memory_order_relaxed);
+  record(FLIGHT_MARK, nameId("cleared"), 0, nowMs);
+}
+
+uint16_t FlightRecorder::count() const {
+  const uint32_t total = next_.load(std::memory_order_relaxed);
+  return total < CAPACITY ? (uint16_t)total : CAPACITY;
+}
+
+FlightEvent FlightRecorder::event(uint16_t index) const {
+  const uint32_t total = next_.load(std::memory_order_relaxed);
+  const uint32_t slot = (total - count() + index) & (CAPACITY - 1);
+  const uint32_t word = __atomic_load_n(&storage_.words[slot], __ATOMIC_ACQUIRE);
+  FlightEvent event;
+  event.timeMs = __atomic_load_n(&storage_.times[slot], __ATOMIC_RELAXED);
+  event.type = (uint8_t)word < FLIGHT_EVENT_TYPES ? (FlightEventType)(uint8_t)word : FLIGHT_NONE;
+  event.arg = (uint8_t)(word >> 8);
+  event.value = (uint16_t)(word >> 16);
+  return event;
+}
+
+const char* FlightRecorder::name(uint8_t id) const {
+  return id < __atomic_load_n(&storage_.nameCount, __ATOMIC_ACQUIRE) ? storage_.names[id] : "?";
+}
+
+const char* FlightRecorder::typeName(FlightEventType type) {
+  return type < FLIGHT_EVENT_TYPES ? TYPE_NAMES[type] : "?";
+}
+
+const char* FlightRecorder::resetReasonName(uint8_t reason) {
+  return reason < RESET_REASON_COUNT ? RESET_REASONS[reason] : "?";
+}
+
+void FlightRecorder::printDetail(ResponseBuffer& out, const FlightEvent& event) const {
+  switch (event.type) {
+    case FLIGHT_BOOT:
+      out.printf("reset=%s", resetReasonName(event.arg));
+      break;
+    case FLIGHT_LED:
+      out.printf("led=%s via %s", event.value ? "on" : "off", transportName((Transport)event.arg));
+      break;
+    case FLIGHT_WIFI_UP:
+      out.printf("rssi=%d", (int)(int16_t)event.value);
+      break;
+    case FLIGHT_WIFI_DOWN:
+      out.printf("reason=%u", (unsigned)event.value);
+      break;
+    case FLIGHT_MQTT_DOWN:
+      out.printf("state=%d", (int)(int16_t)event.value);
+      break;
+    case FLIGHT_STALL_BEGIN:
+    case FLIGHT_STALL:
+      out.printf("%s %u ms", name(event.arg), (unsigned)event.value);
+      break;
+    case FLIGHT_HEAP_LOW:
+      out.printf("free=%u KB", (unsigned)event.value);
+      break;
+    case FLIGHT_RESTART:
+      out.print(name(event.arg));
+      break;
+    case FLIGHT_MARK:
+      out.printf("%s %u", name(event.arg), (unsigned)event.value);
+      break;
+    default:
+      break;
+  }
+}
+
+uint16_t FlightRecorder::report(ResponseBuffer& out, uint16_t first) const {
+  const uint16_t held = count();
+  uint32_t bootsHeld = 0;
+  uint32_t bootsBefore = 0;  // Among the rows before `first`
+  for (uint16_t i = 0; i < held; i++) {
+    if (event(i).type != FLIGHT_BOOT) continue;
+    bootsHeld++;
+    if (i < first) bootsBefore++;
+  }
+
+  if (first == 0) {
+    out.printf("Flight log: %u events held, %lu written, boot %lu\n", (unsigned)held,
+               (unsigned long)total(), (unsigned long)storage_.boots);
+    out.printf("%4s %10s  %-12s %s\n", "boot", "ms", "event", "detail");
+  }
+  // Rows before the oldest FLIGHT_BOOT held belong to the boot before it
+  uint32_t boot = storage_.boots - bootsHeld + bootsBefore;
+  uint16_t i = first;
+  for (; i < held && out.capacity() - out.length() >= MAX_ROW_LENGTH; i++) {
+    const FlightEvent e = event(i);
+    if (e.type == FLIGHT_BOOT) boot++;
+    out.printf("%4lu %10lu  %-12s ", (unsigned long)boot, (unsigned long)e.timeMs,
+               typeName(e.type));
+    printDetail(out, e);
+    out.print("\n");
+  }
+  return i;
+}
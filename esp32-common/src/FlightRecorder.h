@@ -0,0 +1,150 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "ResponseBuffer.h"
+
+/**
+ * @brief What a flight recorder event means; arg and value per type
+ */
+enum FlightEventType : uint8_t {
+  FLIGHT_NONE = 0,
+  FLIGHT_BOOT,          // arg: esp_reset_reason_t, value: boot number (low 16 bits)
+  FLIGHT_LED,           // arg: Transport, value: LED state
+  FLIGHT_WIFI_UP,       // value: RSSI in dBm (int16_t)
+  FLIGHT_WIFI_DOWN,     // value: disconnect reason (wifi_err_reason_t)
+  FLIGHT_MQTT_UP,       // -
+  FLIGHT_MQTT_DOWN,     // value: PubSubClient state (int16_t)
+  FLIGHT_STALL_BEGIN,   // arg: name id, value: ms when the monitor noticed
+  FLIGHT_STALL,         // arg: name id, value: duration in ms (saturated)
+  FLIGHT_HEAP_LOW,      // value: free heap in KB
+  FLIGHT_RESTART,       // arg: name id of the cause
+  FLIGHT_MARK,          // arg: name id, value: caller-defined
+  FLIGHT_EVENT_TYPES
+};
+
+/**
+ * @brief One recorded event, decoded
+ */
+struct FlightEvent {
+  uint32_t timeMs;  // millis() of the boot it belongs to
+  FlightEventType type;
+  uint8_t arg;
+  uint16_t value;
+};
+
+/**
+ * @brief Event ring buffer in memory that survives warm resets
+ *
+ * The storage is declared by the sketch with RTC_NOINIT_ATTR, which the
+ * boot code leaves alone on software, watchdog, panic and brownout resets
+ * (and deep sleep). begin() tells a log from before the reset from power-on
+ * noise by a magic number, keeps it and appends a FLIGHT_BOOT event, so
+ * the events before a reset can be read after it. FlightLog.h adds the
+ * clock, reset reason and hooks.
+ *
+ * An event is 8 bytes: record() is one atomic increment and two word
+ * stores, callable from any task. Names (stall sections, restart causes)
+ * are copied once into a small table in the same storage, so they are
+ * still readable after the reset and after a firmware update.
+ *
+ * Storage is plain words accessed through the __atomic builtins: a
+ * std::atomic member would be zeroed by its constructor under C++20 and
+ * wipe the log at every boot.
+ */
+class FlightRecorder {
+public:
+  static const uint16_t CAPACITY = 256;  // Power of two
+  static const uint8_t MAX_NAMES = 16;
+  static const uint8_t NAME_LENGTH = 16;  // Including the NUL; longer names are cut
+  static const uint8_t NO_NAME = 0xFF;
+
+  /**
+   * @brief Everything kept across resets (2.3 KB); never initialised by the C runtime
+   */
+  struct Storage {
+    uint32_t magic;
+    uint32_t next;   // Events ever written; the ring holds the last CAPACITY
+    uint32_t boots;
+    uint32_t nameCount;
+    char names[MAX_NAMES][NAME_LENGTH];
+    uint32_t times[CAPACITY];
+    uint32_t words[CAPACITY];  // type | arg << 8 | value << 16
+  };
+
+  explicit FlightRecorder(Storage& storage);
+
+  /**
+   * @brief Keep or reset the log and record FLIGHT_BOOT (setup(), before other tasks)
+   * @return true if events from before this boot were kept
+   */
+  bool begin(uint8_t resetReason, uint32_t nowMs);
+
+  void record(FlightEventType type, uint8_t arg, uint16_t value, uint32_t nowMs) {
+    const uint32_t seq = next_.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t slot = seq & (CAPACITY - 1);
+    __atomic_store_n(&storage_.times[slot], nowMs, __ATOMIC_RELAXED);
+    __atomic_store_n(&storage_.words[slot], type | (uint32_t)arg << 8 | (uint32_t)value << 16,
+                     __ATOMIC_RELEASE);
+    // Concurrent writers may leave the stored count one short, never torn
+    __atomic_store_n(&storage_.next, seq + 1, __ATOMIC_RELAXED);
+  }
+
+  /**
+   * @brief Id of `name` in the stored table, adding it if new (not for hot paths)
+   *
+   * Any task; never waits: while another task is adding a name it only
+   * finds names already there.
+   * @return NO_NAME if the table is full or busy
+   */
+  uint8_t nameId(const char* name);
+
+  /**
+   * @brief Drop every event and name (the boot count stays)
+   */
+  void clear(uint32_t nowMs);
+
+  uint32_t boots() const { return storage_.boots; }
+  uint32_t total() const { return next_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Events currently held, at most CAPACITY
+   */
+  uint16_t count() const;
+
+  /**
+   * @brief index 0 is the oldest event held
+   */
+  FlightEvent event(uint16_t index) const;
+
+  const char* name(uint8_t id) const;
+  static const char* typeName(FlightEventType type);
+  static const char* resetReasonName(uint8_t reason);
+
+  /**
+   * @brief Text table of the held events, oldest first, with the boot each belongs to
+   *
+   * Adds the rows from `first` on that fit in `out` (the header too when
+   * first is 0), so a small buffer can send the log in pieces.
+   * @return The next row to report; count() when done
+   */
+  uint16_t report(ResponseBuffer& out, uint16_t first = 0) const;
+
+private:
+  static const uint32_t MAGIC = 0x464C5431;  // "FLT1"
+  static const size_t MAX_ROW_LENGTH = 80;
+
+  void wipe();
+  uint8_t findName(const char* name) const;
+  void printDetail(ResponseBuffer& out, const FlightEvent& event) const;
+
+  Storage& storage_;
+  std::atomic<uint32_t> next_{0};
+  std::atomic_flag addingName_ = ATOMIC_FLAG_INIT;
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "HeapAccounting.h"
+
+#include <stdio.h>
+#include <string.h>
+
+std::atomic<HeapAccounting*> HeapAccounting::recording_{nullptr};
+
+int HeapAccounting::addTag(const char* name) {
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    if (strcmp(tags_[i].name, name) == 0) return i;
+  }
+  if (tagCount_ == MAX_TAGS) return INVALID_TAG;
+  tags_[tagCount_] = Tag();
+  tags_[tagCount_].name = name;
+  return tagCount_++;
+}
+
+bool HeapAccounting::begin(int tag, const void* task, uint32_t freeBytes) {
+  if (tag < 0 || tag >= tagCount_ || openTag_ != INVALID_TAG) return false;
+  openTag_ = tag;
+  openFreeBytes_ = freeBytes;
+  allocations_ = 0;
+  bytes_ = 0;
+  task_.store(task, std::memory_order_relaxed);
+  recording_.store(this, std::memory_order_release);
+  return true;
+}
+
+bool HeapAccounting::end(uint32_t freeBytes) {
+  if (openTag_ == INVALID_TAG) return false;
+  recording_.store(nullptr, std::memory_order_release);
+
+  Tag& tag = tags_[openTag_];
+  openTag_ = INVALID_TAG;
+  tag.requests++;
+  tag.allocations += allocations_;
+  tag.bytes += bytes_;
+  tag.retainedBytes += (int64_t)openFreeBytes_ - (int64_t)freeBytes;
+  tag.windowAllocations += allocations_;
+  if (++tag.windowRequests < WINDOW_REQUESTS) return false;
+
+  const bool wasGrowing = tag.growing;
+  closeWindow(tag);
+  return tag.growing && !wasGrowing;
+}
+
+void HeapAccounting::closeWindow(Tag& tag) {
+  const uint32_t perRequest = tag.windowAllocations * 100 / tag.windowRequests;
+  tag.windowAllocations = 0;
+  tag.windowRequests = 0;
+  tag.lastPerRequest = perRequest;
+
+  if (!tag.hasBaseline) {
+    tag.baselinePerRequest = perRequest;
+    tag.hasBaseline = true;
+    return;
+  }
+
+  // Above the first window by a quarter and by at least one allocation
+  uint32_t margin = tag.baselinePerRequest / 4;
+  if (margin < 100) margin = 100;
+  if (perRequest > tag.baselinePerRequest + margin) {
+    if (tag.growthWindows < GROWTH_WINDOWS) tag.growthWindows++;
+  } else {
+    tag.growthWindows = 0;
+  }
+  // Sticky: a handler that grew once is worth a look even if it settled
+  if (tag.growthWindows >= GROWTH_WINDOWS) tag.growing = true;
+}
+
+uint8_t HeapAccounting::growingCount() const {
+  uint8_t growing = 0;
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    if (tags_[i].growing) growing++;
+  }
+  return growing;
+}
+
+void HeapAccounting::write(MetricsWriter& out) const {
+  char labels[48];
+
+  out.family("heap_handler_requests_total", "counter", "Requests measured, by handler tag");
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    snprintf(labels, sizeof(labels), "handler=\"%s\"", tags_[i].name);
+    out.sample("heap_handler_requests_total", labels, tags_[i].requests);
+  }
+
+  out.family("heap_handler_allocations_total", "counter", "Heap allocations made while handling");
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    snprintf(labels, sizeof(labels), "handler=\"%s\"", tags_[i].name);
+    out.sample("heap_handler_allocations_total", labels, tags_[i].allocations);
+  }
+
+  out.family("heap_handler_allocated_bytes_total", "counter", "Bytes allocated while handling");
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    snprintf(labels, sizeof(labels), "handler=\"%s\"", tags_[i].name);
+    out.sample("heap_handler_allocated_bytes_total", labels, (int64_t)tags_[i].bytes);
+  }
+
+  out.family("heap_handler_retained_bytes", "gauge",
+             "Free heap lost across requests (negative: released)");
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    snprintf(labels, sizeof(labels), "handler=\"%s\"", tags_[i].name);
+    out.sample("heap_handler_retained_bytes", labels, tags_[i].retainedBytes);
+  }
+
+  out.family("heap_handler_allocation_growth", "gauge",
+             "1 when allocations per request kept rising above the first window");
+  for (uint8_t i = 0; i < tagCount_; i++) {
+    snprintf(labels, sizeof(labels), "handler=\"%s\"", tags_[i].name);
+    out.sample("heap_handler_allocation_growth", labels, tags_[i].growing ? 1 : 0);
+  }
+}
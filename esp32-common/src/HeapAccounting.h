@@ -0,0 +1,138 @@
+#ifndef HEAP_ACCOUNTING_H
+#define HEAP_ACCOUNTING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "Metrics.h"
+
+/**
+ * @brief Heap figures that show fragmentation, not just free bytes
+ *
+ * A heap can report 60 KB free while its largest block is 4 KB: a 5 KB
+ * String then fails. largestFreeBlock and freeBlocks make that visible.
+ */
+struct HeapSnapshot {
+  uint32_t freeBytes;
+  uint32_t minFreeBytes;
+  uint32_t largestFreeBlock;
+  uint32_t freeBlocks;
+  uint32_t allocatedBlocks;
+
+  /**
+   * @brief Share of the free heap not usable by one allocation, in percent
+   */
+  uint8_t fragmentationPercent() const {
+    if (freeBytes == 0 || largestFreeBlock >= freeBytes) return 0;
+    return (uint8_t)(100 - (uint64_t)largestFreeBlock * 100 / freeBytes);
+  }
+};
+
+/**
+ * @brief Allocations attributed to request handlers by a scoped tag
+ *
+ * begin() / end() bracket one request (HeapMonitor.h does it per WebServer
+ * route and for HEAP_TAG scopes). Every allocation the allocator reports
+ * through noteAllocation() in between, from the same task, counts against
+ * the tag. The free-heap difference across the request is kept as well, so
+ * retained memory shows up even where the allocator has no hooks.
+ *
+ * Allocations per request are averaged over windows of WINDOW_REQUESTS. A
+ * tag whose average stays above its first window for GROWTH_WINDOWS windows
+ * in a row is flagged as growing: a String or document that gets bigger per
+ * request until the heap fragments.
+ *
+ * Only one task may record; nested begin() calls are refused.
+ */
+class HeapAccounting {
+public:
+  static const uint8_t MAX_TAGS = 12;
+  static const int INVALID_TAG = -1;
+  static const uint16_t WINDOW_REQUESTS = 32;
+  static const uint8_t GROWTH_WINDOWS = 3;
+
+  struct Tag {
+    const char* name;
+    uint32_t requests;
+    uint32_t allocations;
+    uint64_t bytes;
+    int64_t retainedBytes;          // Sum of free-heap drops across requests
+    uint32_t baselinePerRequest;    // Allocations x100 in the first window
+    uint32_t lastPerRequest;        // Allocations x100 in the last full window
+    uint32_t windowAllocations;
+    uint16_t windowRequests;
+    uint8_t growthWindows;          // Consecutive windows above the baseline
+    bool hasBaseline;
+    bool growing;
+  };
+
+  /**
+   * @brief Register a tag; the string must stay valid (a literal)
+   * @return tag id (the existing one for a known name), or INVALID_TAG
+   */
+  int addTag(const char* name);
+
+  /**
+   * @brief Start attributing allocations made by `task` to `tag`
+   * @param freeBytes Free heap now, for the retained-bytes figure
+   * @return false if the tag is invalid or a request is already open (a
+   *         tagged handler called from another one stays in the outer tag)
+   */
+  bool begin(int tag, const void* task, uint32_t freeBytes);
+
+  /**
+   * @brief Close the request opened by begin()
+   * @return true if this request completed a window that flagged the tag
+   */
+  bool end(uint32_t freeBytes);
+
+  /**
+   * @brief True while a request is open; lets the allocator hook skip
+   *        looking up the current task
+   */
+  static bool recording() { return recording_.load(std::memory_order_relaxed) != nullptr; }
+
+  /**
+   * @brief Allocator hook: count `size` against the open request, if `task` owns it
+   *
+   * Called for every allocation in every task, so it only loads two atomics
+   * unless the caller is the task being measured.
+   */
+  static void noteAllocation(const void* task, size_t size) {
+    HeapAccounting* self = recording_.load(std::memory_order_acquire);
+    if (self == nullptr || self->task_.load(std::memory_order_relaxed) != task) return;
+    self->allocations_++;
+    self->bytes_ += size;
+  }
+
+  uint8_t count() const { return tagCount_; }
+  const Tag& tag(uint8_t tag) const { return tags_[tag]; }
+
+  /**
+   * @brief Number of tags currently flagged as growing
+   */
+  uint8_t growingCount() const;
+
+  /**
+   * @brief Per-tag allocation, byte, retained and growth families
+   */
+  void write(MetricsWriter& out) const;
+
+private:
+  void closeWindow(Tag& tag);
+
+  static std::atomic<HeapAccounting*> recording_;
+
+  std::atomic<const void*> task_{nullptr};
+  int openTag_ = INVALID_TAG;
+  uint32_t openFreeBytes_ = 0;
+  uint32_t allocations_ = 0;  // Of the open request
+  uint32_t bytes_ = 0;
+
+  Tag tags_[MAX_TAGS];
+  uint8_t tagCount_ = 0;
+};
+
+#endif
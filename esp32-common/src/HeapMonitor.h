@@ -0,0 +1,125 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+#include "HeapAccounting.h"
+#include "JsonWriter.h"
+
+/**
+ * @brief Heap fragmentation and per-handler allocations (header-only, ESP32)
+ *
+ * ESP32 glue around HeapAccounting.h. MetricsEndpoint::on() already tags
+ * every route with its URI; other handlers open a tag for their scope:
+ *
+ *   void handleWebSocketMessage(...) {
+ *     HEAP_TAG("ws_message");
+ *     ...
+ *   }
+ *
+ * Allocations are counted through ESP-IDF's heap hooks, which need
+ * CONFIG_HEAP_USE_HOOKS (ESP-IDF 5 sdkconfig; the prebuilt Arduino core
+ * leaves it off). Without it the allocation and growth figures stay at 0;
+ * fragmentation and the retained bytes per handler still work.
+ *
+ * This header defines the hook functions, so include it (directly or through
+ * MetricsEndpoint.h) from one source file of the sketch only.
+ */
+namespace HeapMonitor {
+
+const uint32_t HEAP_CAPS = MALLOC_CAP_8BIT;  // What malloc, new and String draw from
+
+inline HeapAccounting& accounting() {
+  static HeapAccounting instance;
+  return instance;
+}
+
+inline HeapSnapshot snapshot() {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, HEAP_CAPS);
+  return HeapSnapshot{(uint32_t)info.total_free_bytes, (uint32_t)info.minimum_free_bytes,
+                      (uint32_t)info.largest_free_block, (uint32_t)info.free_blocks,
+                      (uint32_t)info.allocated_blocks};
+}
+
+/**
+ * @brief Attributes the enclosing scope's allocations to one tag
+ */
+class Scope {
+public:
+  explicit Scope(int tag) : tag_(tag) {
+    if (!accounting().begin(tag, xTaskGetCurrentTaskHandle(), heap_caps_get_free_size(HEAP_CAPS))) {
+      tag_ = HeapAccounting::INVALID_TAG;  // Nested in another tag, which keeps counting
+    }
+  }
+
+  ~Scope() {
+    if (tag_ == HeapAccounting::INVALID_TAG) return;
+    if (accounting().end(heap_caps_get_free_size(HEAP_CAPS))) {
+      Serial.print("⚠️ Heap: allocations per request keep growing in ");
+      Serial.println(accounting().tag(tag_).name);
+    }
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  int tag_;
+};
+
+/**
+ * @brief Free blocks, allocated blocks and the per-handler families
+ *
+ * Free / minimum / largest block are written by MetricsEndpoint::writeDevice().
+ */
+inline void writeMetrics(MetricsWriter& out, const HeapSnapshot& heap) {
+  out.gauge("esp32_heap_free_blocks", "Free heap blocks (many small ones: fragmented)",
+            heap.freeBlocks);
+  out.gauge("esp32_heap_allocated_blocks", "Live heap allocations", heap.allocatedBlocks);
+  accounting().write(out);
+}
+
+/**
+ * @brief "heap_largest_block", "heap_free_blocks", "heap_fragmentation", "alloc_growth"
+ *
+ * Members of an open /status object; alloc_growth lists the flagged tags.
+ */
+inline void writeStatusJson(JsonWriter& json, const HeapSnapshot& heap) {
+  json.field("heap_largest_block", heap.largestFreeBlock)
+      .field("heap_free_blocks", heap.freeBlocks)
+      .field("heap_fragmentation", heap.fragmentationPercent())
+      .beginArray("alloc_growth");
+  const HeapAccounting& tags = accounting();
+  for (uint8_t i = 0; i < tags.count(); i++) {
+    if (tags.tag(i).growing) json.field(nullptr, tags.tag(i).name);
+  }
+  json.endArray();
+}
+
+}  // namespace HeapMonitor
+
+/**
+ * @brief Attribute the rest of the enclosing scope to `name` (a literal)
+ */
+#define HEAP_TAG(name)                                                          \
+  static const int heapTag_ = HeapMonitor::accounting().addTag(name);           \
+  HeapMonitor::Scope heapScope_(heapTag_)
+
+#if CONFIG_HEAP_USE_HOOKS
+// Called by the allocator for every allocation in every task: keep it short
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  (void)ptr;
+  (void)caps;
+  if (HeapAccounting::recording()) {
+    HeapAccounting::noteAllocation(xTaskGetCurrentTaskHandle(), size);
+  }
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+  (void)ptr;
+}
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+#include "JsonWriter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+JsonWriter::JsonWriter(RequestArena& arena) : arena_(arena) {}
+
+bool JsonWriter::reserve(size_t extra) {
+  if (!ok_) return false;
+  const size_t needed = length_ + extra + 1;  // + NUL
+  if (needed <= capacity_) return true;
+
+  size_t capacity = capacity_ > 0 ? capacity_ * 2 : INITIAL_CAPACITY;
+  if (capacity < needed) capacity = needed;
+
+  // Newest arena block: extend it where it is
+  if (buffer_ != nullptr && arena_.grow(buffer_, capacity_, capacity)) {
+    capacity_ = capacity;
+    return true;
+  }
+
+  char* buffer = (char*)arena_.allocate(capacity);
+  if (buffer == nullptr) {
+    ok_ = false;
+    return false;
+  }
+  if (length_ > 0) memcpy(buffer, buffer_, length_);
+  buffer[length_] = '\0';
+  buffer_ = buffer;
+  capacity_ = capacity;
+  return true;
+}
+
+void JsonWriter::append(const char* text, size_t length) {
+  if (!reserve(length)) return;
+  memcpy(buffer_ + length_, text, length);
+  length_ += length;
+  buffer_[length_] = '\0';
+}
+
+void JsonWriter::appendChar(char c) {
+  if (!reserve(1)) return;
+  buffer_[length_++] = c;
+  buffer_[length_] = '\0';
+}
+
+void JsonWriter::appendEscaped(const char* text, size_t length) {
+  appendChar('"');
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    const unsigned char c = (unsigned char)text[i];
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    append(text + start, i - start);
+    char escape[7];
+    switch (c) {
+      case '"': append("\\\"", 2); break;
+      case '\\': append("\\\\", 2); break;
+      case '\n': append("\\n", 2); break;
+      case '\r': append("\\r", 2); break;
+      case '\t': append("\\t", 2); break;
+      default:
+        snprintf(escape, sizeof(escape), "\\u%04x", c);
+        append(escape, 6);
+        break;
+    }
+    start = i + 1;
+  }
+  append(text + start, length - start);
+  appendChar('"');
+}
+
+void JsonWriter::appendNumber(unsigned long long value, bool negative) {
+  char digits[21];  // 2^64 - 1 has 20
+  char* end = digits + sizeof(digits);
+  char* start = end;
+  do {
+    *--start = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  if (negative) *--start = '-';
+  append(start, (size_t)(end - start));
+}
+
+void JsonWriter::key(const char* name) {
+  if (depth_ > 0) {
+    const uint32_t bit = 1UL << (depth_ - 1);
+    if (hasMembers_ & bit) appendChar(',');
+    hasMembers_ |= bit;
+  }
+  if (name != nullptr) {
+    appendEscaped(name, strlen(name));
+    appendChar(':');
+  }
+}
+
+void JsonWriter::open(const char* name, char bracket) {
+  key(name);
+  appendChar(bracket);
+  if (depth_ == MAX_DEPTH) {
+    ok_ = false;
+    return;
+  }
+  depth_++;
+  hasMembers_ &= ~(1UL << (depth_ - 1));
+}
+
+void JsonWriter::close(char bracket) {
+  if (depth_ > 0) depth_--;
+  appendChar(bracket);
+}
+
+JsonWriter& JsonWriter::beginObject(const char* key) {
+  open(key, '{');
+  return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+  close('}');
+  return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const char* key) {
+  open(key, '[');
+  return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+  close(']');
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, const char* value) {
+  if (value == nullptr) return rawField(name, "null", 4);
+  return field(name, value, strlen(value));
+}
+
+JsonWriter& JsonWriter::field(const char* name, const char* value, size_t length) {
+  key(name);
+  appendEscaped(value, length);
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, bool value) {
+  return rawField(name, value ? "true" : "false", value ? 4 : 5);
+}
+
+JsonWriter& JsonWriter::field(const char* name, long long value) {
+  key(name);
+  // Negate as unsigned: -LLONG_MIN does not fit in long long
+  appendNumber(value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value, value < 0);
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, unsigned long long value) {
+  key(name);
+  appendNumber(value, false);
+  return *this;
+}
+
+JsonWriter& JsonWriter::rawField(const char* name, const char* json, size_t length) {
+  key(name);
+  append(json, length);
+  return *this;
+}
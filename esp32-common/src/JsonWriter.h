@@ -0,0 +1,88 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "RequestArena.h"
+
+/**
+ * @brief Streaming JSON builder on a RequestArena
+ *
+ * Replaces the `json += ",\"led\":" + String(...)` chains: the text grows in
+ * place at the end of the arena (no copy while it is the newest
+ * allocation) and is released with the request. Commas are inserted by
+ * nesting level, strings are escaped, numbers are formatted without String or printf.
+ *
+ *   RequestArena::Scope scope(arena);
+ *   JsonWriter json(arena);
+ *   json.beginObject()
+ *       .field("led", bus.led())
+ *       .field("ssid", identity.ssid())
+ *       .field("uptime", millis() / 1000)
+ *       .endObject();
+ *   server.send_P(200, "application/json", json.c_str(), json.length());
+ *
+ * If an allocation fails, ok() turns false and the text stops growing.
+ */
+class JsonWriter {
+public:
+  static const uint8_t MAX_DEPTH = 16;
+  static const size_t INITIAL_CAPACITY = 128;
+
+  explicit JsonWriter(RequestArena& arena);
+
+  JsonWriter& beginObject(const char* key = nullptr);
+  JsonWriter& endObject();
+  JsonWriter& beginArray(const char* key = nullptr);
+  JsonWriter& endArray();
+
+  // Object members; pass key = nullptr for an array element
+  JsonWriter& field(const char* key, const char* value);
+  JsonWriter& field(const char* key, bool value);
+  // Every integer type (uint32_t is unsigned int on one target, unsigned long on the other)
+  JsonWriter& field(const char* key, long long value);
+  JsonWriter& field(const char* key, unsigned long long value);
+  JsonWriter& field(const char* key, int value) { return field(key, (long long)value); }
+  JsonWriter& field(const char* key, long value) { return field(key, (long long)value); }
+  JsonWriter& field(const char* key, unsigned int value) {
+    return field(key, (unsigned long long)value);
+  }
+  JsonWriter& field(const char* key, unsigned long value) {
+    return field(key, (unsigned long long)value);
+  }
+
+  /**
+   * @brief Member whose value is already JSON (a nested object, a literal)
+   */
+  JsonWriter& rawField(const char* key, const char* json, size_t length);
+
+  /**
+   * @brief Escaped string value of `length` chars (not NUL-terminated input)
+   */
+  JsonWriter& field(const char* key, const char* value, size_t length);
+
+  const char* c_str() const { return buffer_ != nullptr ? buffer_ : ""; }
+  size_t length() const { return length_; }
+  bool ok() const { return ok_; }
+
+private:
+  void key(const char* name);
+  void open(const char* name, char bracket);
+  void close(char bracket);
+  void append(const char* text, size_t length);
+  void appendChar(char c);
+  void appendEscaped(const char* text, size_t length);
+  void appendNumber(unsigned long long value, bool negative);
+  bool reserve(size_t extra);
+
+  RequestArena& arena_;
+  char* buffer_ = nullptr;
+  size_t capacity_ = 0;
+  size_t length_ = 0;
+  uint32_t hasMembers_ = 0;  // Bit per nesting level: a comma is due
+  uint8_t depth_ = 0;
+  bool ok_ = true;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "LineAssembler.h"
+
+LineAssembler::LineAssembler(char* buffer, size_t capacity)
+    : buffer_(buffer), capacity_(capacity) {
+  buffer_[0] = '\0';
+}
+
+LineAssembler::Result LineAssembler::feed(char c) {
+  if (ready_) {
+    ready_ = false;
+    length_ = 0;
+    buffer_[0] = '\0';
+  }
+
+  if (c == '\n' && lastWasCR_) {
+    // Second half of a CRLF pair - already terminated on '\r'
+    lastWasCR_ = false;
+    return LINE_PENDING;
+  }
+  lastWasCR_ = (c == '\r');
+
+  if (c == '\n' || c == '\r') {
+    if (discarding_) {
+      discarding_ = false;
+      length_ = 0;
+      return LINE_PENDING;
+    }
+    return complete();
+  }
+
+  if (discarding_) return LINE_PENDING;
+
+  if (length_ >= capacity_ - 1) {
+    discarding_ = true;
+    length_ = 0;
+    overflows_++;
+    return LINE_OVERFLOW;
+  }
+
+  buffer_[length_++] = c;
+  return LINE_PENDING;
+}
+
+LineAssembler::Result LineAssembler::flushIfIdle(uint32_t nowMs) {
+  if (idleFlushMs_ == 0 || ready_) return LINE_PENDING;
+  if (nowMs - lastByteMs_ < idleFlushMs_) return LINE_PENDING;
+  if (discarding_) {
+    discarding_ = false;
+    length_ = 0;
+    return LINE_PENDING;
+  }
+  if (length_ == 0) return LINE_PENDING;
+  return complete();
+}
+
+LineAssembler::Result LineAssembler::complete() {
+  buffer_[length_] = '\0';
+  ready_ = true;
+  return LINE_READY;
+}
+
+void LineAssembler::reset() {
+  length_ = 0;
+  buffer_[0] = '\0';
+  ready_ = false;
+  discarding_ = false;
+  lastWasCR_ = false;
+}
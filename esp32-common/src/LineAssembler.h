@@ -0,0 +1,123 @@
+#ifndef LINE_ASSEMBLER_H
+#define LINE_ASSEMBLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Incremental, non-blocking line framer for Stream-like inputs
+ *
+ * Consumes whatever bytes are available into a fixed buffer and hands out one
+ * complete line at a time. It never waits for more input, so loop() can poll
+ * it on every pass without stalling the other servers. Lines longer than the
+ * buffer are dropped up to the next terminator and counted as overflows.
+ *
+ * Accepts "\n", "\r" and "\r\n" as terminators.
+ */
+class LineAssembler {
+public:
+  enum Result : uint8_t {
+    LINE_PENDING,   // No complete line yet
+    LINE_READY,     // line() holds a complete, NUL-terminated line
+    LINE_OVERFLOW   // The current line exceeded the buffer and is being dropped
+  };
+
+  LineAssembler(char* buffer, size_t capacity);
+
+  /**
+   * @brief Feed one byte
+   */
+  Result feed(char c);
+
+  /**
+   * @brief Feed one byte received at nowMs (tracks input for idle flush)
+   */
+  Result feed(char c, uint32_t nowMs) {
+    lastByteMs_ = nowMs;
+    return feed(c);
+  }
+
+  /**
+   * @brief Consume available bytes until a line completes or input runs dry
+   *
+   * Bytes after a completed line stay in the stream for the next call.
+   */
+  template <typename StreamT>
+  Result poll(StreamT& stream) {
+    while (stream.available() > 0) {
+      int c = stream.read();
+      if (c < 0) break;
+      Result result = feed((char)c);
+      if (result != LINE_PENDING) return result;
+    }
+    return LINE_PENDING;
+  }
+
+  /**
+   * @brief Same as poll(stream), plus idle flush for terminals without line endings
+   */
+  template <typename StreamT>
+  Result poll(StreamT& stream, uint32_t nowMs) {
+    bool received = stream.available() > 0;
+    Result result = poll(stream);
+    if (received) lastByteMs_ = nowMs;
+    if (result != LINE_PENDING) return result;
+    return flushIfIdle(nowMs);
+  }
+
+  /**
+   * @brief Emit a partial line after this many ms without input (0 disables)
+   */
+  void setIdleFlush(uint32_t idleMs) { idleFlushMs_ = idleMs; }
+
+  /**
+   * @brief Complete a buffered partial line once the idle flush time has passed
+   */
+  Result flushIfIdle(uint32_t nowMs);
+
+  /**
+   * @brief Complete line, valid until the next feed()
+   */
+  const char* line() const { return buffer_; }
+  size_t length() const { return length_; }
+
+  /**
+   * @brief True when no partial line is buffered
+   */
+  bool empty() const { return (length_ == 0 && !discarding_) || ready_; }
+
+  uint32_t overflowCount() const { return overflows_; }
+  size_t maxLineLength() const { return capacity_ - 1; }
+
+  /**
+   * @brief Drop the partial line and a pending CRLF (SppLink calls it around frames)
+   */
+  void reset();
+
+private:
+  Result complete();
+
+  char* buffer_;
+  size_t capacity_;
+  size_t length_ = 0;
+  uint32_t lastByteMs_ = 0;
+  uint32_t idleFlushMs_ = 0;
+  uint32_t overflows_ = 0;
+  bool ready_ = false;
+  bool discarding_ = false;
+  bool lastWasCR_ = false;
+};
+
+/**
+ * @brief LineAssembler with its own storage for lines up to MaxLength chars
+ */
+template <size_t MaxLength>
+class StaticLineAssembler : public LineAssembler {
+public:
+  StaticLineAssembler() : LineAssembler(storage_, sizeof(storage_)) {}
+
+private:
+  char storage_[MaxLength + 1];
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "Log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+Log::Sink sink = nullptr;
+
+const char* const PREFIXES[] = {"", "[E] ", "[W] ", "[I] ", "[D] "};
+
+}  // namespace
+
+namespace Log {
+
+void setSink(Sink newSink) {
+  sink = newSink;
+}
+
+void write(uint8_t level, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vwrite(level, format, args);
+  va_end(args);
+}
+
+void vwrite(uint8_t level, const char* format, va_list args) {
+  Sink out = sink;
+  if (out == nullptr) return;
+
+  char line[LINE_SIZE];
+  int length = snprintf(line, sizeof(line), "%s", level <= LOG_LEVEL_DEBUG ? PREFIXES[level] : "");
+  int size = vsnprintf(line + length, sizeof(line) - length - 1, format, args);
+  if (size < 0) return;
+  length += size;
+  if (length > (int)sizeof(line) - 2) length = sizeof(line) - 2;  // Cut, keep room for '\n'
+  line[length++] = '\n';
+  out(line, length);
+}
+
+bool hasSink() {
+  return sink != nullptr;
+}
+
+Frame::Frame(uint32_t id) : length_(6) {
+  bytes_[0] = FRAME_START;
+  for (int i = 0; i < 4; i++) bytes_[2 + i] = (uint8_t)(id >> (8 * i));
+}
+
+void Frame::addVarint(uint64_t value) {
+  uint8_t encoded[10];
+  size_t size = 0;
+  do {
+    encoded[size] = (uint8_t)(value & 0x7F);
+    value >>= 7;
+    if (value != 0) encoded[size] |= 0x80;
+    size++;
+  } while (value != 0);
+  if (full_ || length_ + size > FRAME_SIZE) {
+    full_ = true;  // The decoder marks the missing arguments
+    return;
+  }
+  memcpy(bytes_ + length_, encoded, size);
+  length_ += size;
+}
+
+void Frame::addInt(int64_t value) {
+  addVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));  // Zigzag: small negatives stay short
+}
+
+void Frame::addFloat(float value) {
+  if (full_ || length_ + sizeof(value) > FRAME_SIZE) {
+    full_ = true;
+    return;
+  }
+  memcpy(bytes_ + length_, &value, sizeof(value));  // Little-endian on the ESP32 and x86
+  length_ += sizeof(value);
+}
+
+void Frame::addString(const char* text) {
+  if (text == nullptr) text = "(null)";
+  if (full_ || length_ >= FRAME_SIZE) {
+    full_ = true;
+    return;
+  }
+  size_t size = strlen(text);
+  size_t room = FRAME_SIZE - length_ - 1;  // After the length byte
+  if (size > room) size = room;            // Cut to fit
+  if (size > 127) size = 127;              // One-byte varint length
+  bytes_[length_++] = (uint8_t)size;
+  memcpy(bytes_ + length_, text, size);
+  length_ += size;
+}
+
+void Frame::send() {
+  Sink out = sink;
+  if (out == nullptr) return;
+  bytes_[1] = (uint8_t)(length_ - 2);  // Id and arguments
+  out((const char*)bytes_, length_);
+}
+
+}  // namespace Log
@@ -0,0 +1,176 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Highest level compiled in; define before the include (or -DLOG_LEVEL=2)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 1: send enabled lines as binary frames for host/tools/logdecode.cpp
+#ifndef LOG_BINARY
+#define LOG_BINARY 0
+#endif
+
+#define LOG_ENABLED(level) (LOG_LEVEL >= (level))
+
+/**
+ * @brief printf-style log lines with a compile-time level
+ *
+ *   #define LOG_LEVEL LOG_LEVEL_WARN  // Before the include: ERROR and WARN only
+ *   #include <Log.h>
+ *
+ *   Log::begin(Serial);                              // setup()
+ *   LOG_INFO("LED %s via %s", on ? "ON" : "OFF", transportName(source));
+ *   LOG_WARN("Network task behind - event dropped");
+ *
+ * A statement above LOG_LEVEL becomes `if (false)`: its arguments are still
+ * type-checked against the format but never evaluated, and the format string
+ * is not linked in. An enabled statement passes the literal through as is -
+ * on the ESP32 literals are read from flash, so no RAM copy and no String -
+ * and is formatted into a LINE_SIZE stack buffer, then written with one
+ * sink call ("[W] message\n"), so lines from two tasks do not interleave.
+ * Without a sink (before begin()) lines are dropped before formatting.
+ *
+ * With LOG_BINARY 1 nothing is formatted on the device. A statement sends
+ *
+ *   0x1F  length  id (4 bytes, little-endian)  arguments
+ *
+ * where id is a compile-time FNV-1a hash of the format string (the string
+ * itself is not linked in), integers are zigzag varints, floating point
+ * values 4-byte floats and strings a varint length plus the bytes.
+ * host/tools/logdecode.cpp builds the id -> format table from the sources
+ * at build time and turns the frames back into lines; text written to the
+ * same Serial is passed through. %s arguments must be NUL-terminated (the
+ * precision of %.*s is applied by the decoder).
+ */
+namespace Log {
+
+const size_t LINE_SIZE = 160;  // Longer lines are cut
+
+typedef void (*Sink)(const char* text, size_t length);
+
+void setSink(Sink sink);
+void write(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+void vwrite(uint8_t level, const char* format, va_list args);
+
+/**
+ * @brief Send lines to a Stream (Serial, SerialBT)
+ */
+template <typename StreamT>
+void begin(StreamT& stream) {
+  static StreamT* out = nullptr;
+  out = &stream;
+  setSink([](const char* text, size_t length) { out->write((const uint8_t*)text, length); });
+}
+
+// Never called: only type-checks the arguments of a compiled-out statement
+inline void discard(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void discard(const char*, ...) {}
+
+// ---- LOG_BINARY frames ----
+
+const uint8_t FRAME_START = 0x1F;  // ASCII unit separator, never part of a text line
+const size_t FRAME_SIZE = 96;      // Start, length, id and arguments; strings are cut to fit
+
+/**
+ * @brief FNV-1a of a format string, evaluated by the compiler
+ */
+constexpr uint32_t formatId(const char* format, uint32_t hash = 2166136261u) {
+  return *format == '\0' ? hash : formatId(format + 1, (hash ^ (uint8_t)*format) * 16777619u);
+}
+
+/**
+ * @brief One binary log frame, sent with a single sink call
+ */
+class Frame {
+public:
+  explicit Frame(uint32_t id);
+
+  void addInt(int64_t value);
+  void addFloat(float value);
+  void addString(const char* text);
+  void send();
+
+private:
+  void addVarint(uint64_t value);
+
+  uint8_t bytes_[FRAME_SIZE];
+  size_t length_;
+  bool full_ = false;
+};
+
+bool hasSink();
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+encode(Frame& frame, T value) {
+  frame.addInt((int64_t)value);
+}
+inline void encode(Frame& frame, double value) { frame.addFloat((float)value); }
+inline void encode(Frame& frame, const char* text) { frame.addString(text); }
+inline void encode(Frame& frame, const void* pointer) { frame.addInt((int64_t)(uintptr_t)pointer); }
+
+/**
+ * @brief Send a LOG_BINARY frame: the format's id and the raw arguments
+ */
+template <typename... Args>
+void emit(uint32_t id, Args... args) {
+  if (!hasSink()) return;
+  Frame frame(id);
+  int expand[] = {0, (encode(frame, args), 0)...};
+  (void)expand;
+  frame.send();
+}
+
+}  // namespace Log
+
+#define LOG_DISCARD(format, ...) \
+  do { if (false) Log::discard(format, ##__VA_ARGS__); } while (0)
+
+#if LOG_BINARY
+#define LOG_WRITE(level, format, ...)                                                  \
+  do {                                                                                 \
+    LOG_DISCARD(format, ##__VA_ARGS__);                                                \
+    Log::emit(std::integral_constant<uint32_t, Log::formatId(format)>::value, ##__VA_ARGS__); \
+  } while (0)
+#else
+#define LOG_WRITE(level, format, ...) Log::write(level, format, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+#define LOG_ERROR(format, ...) LOG_WRITE(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_WARN)
+#define LOG_WARN(format, ...) LOG_WRITE(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+#define LOG_INFO(format, ...) LOG_WRITE(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+#define LOG_DEBUG(format, ...) LOG_WRITE(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef LOOP_IDLE_H
+#define LOOP_IDLE_H
+
+#include <Arduino.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#if defined(ESP_PLATFORM)
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Idle the loop() task until the next scheduler deadline or network activity
+ *
+ * Replaces the trailing delay(1)/delay(10): instead of waking on a fixed
+ * period, loop() blocks in select() on every open lwIP socket (listeners,
+ * HTTP, WebSocket and MQTT clients), so a request is handled as soon as it
+ * arrives and the CPU idles otherwise. Header-only ESP32 glue; the socket
+ * libraries do not expose their descriptors, so every socket is watched.
+ *
+ *   loop() {
+ *     server.handleClient();
+ *     scheduler.run(millis());
+ *     LoopIdle::wait(scheduler.msUntilNext(millis()));
+ *   }
+ *
+ * Libraries that buffer more data than they handle per call (a second
+ * WebSocket frame already read from the socket) call markBusy() from their
+ * event handler so the next wait() returns immediately.
+ *
+ * A socket can stay readable while its library consumes nothing, e.g. a
+ * client that is midway through its headers. select() would then return at
+ * once on every pass. Pass the sketch's running count of handled requests
+ * and frames as `activity`: a readable return that follows a pass with no
+ * new activity sleeps SPIN_SLEEP_MS first.
+ *
+ * When another task hands work to the one idling here (see the dual-core
+ * hybrid sketch), call enableWake() once in setup() and wake() after
+ * queueing: a byte sent to a loopback UDP socket makes select() return.
+ */
+namespace LoopIdle {
+
+// Upper bound per wait, so polled inputs (Serial) stay responsive
+const uint32_t MAX_WAIT_MS = 50;
+// Sleep when a socket stays readable without being handled
+const uint32_t SPIN_SLEEP_MS = 1;
+
+#if defined(ESP_PLATFORM)
+const int FIRST_SOCKET = LWIP_SOCKET_OFFSET;
+const int SOCKET_COUNT = CONFIG_LWIP_MAX_SOCKETS;
+#else
+const int FIRST_SOCKET = 3;  // Host build: skip stdin/stdout/stderr
+const int SOCKET_COUNT = 61;
+#endif
+
+inline volatile bool& busyFlag() {
+  static volatile bool busy = false;
+  return busy;
+}
+
+inline int& wakeSocket() {
+  static int fd = -1;
+  return fd;
+}
+
+/**
+ * @brief What the last wait() saw: a readable socket, and `activity` at that time
+ */
+struct SpinGuard {
+  bool readable = false;
+  uint32_t activity = 0;
+};
+
+inline SpinGuard& spinGuard() {
+  static SpinGuard guard;
+  return guard;
+}
+
+/**
+ * @brief Skip the next wait (more work may be buffered inside a library)
+ */
+inline void markBusy() {
+  busyFlag() = true;
+}
+
+/**
+ * @brief Create the loopback socket behind wake() (setup(), before other tasks start)
+ * @return false if lwIP is out of sockets or has no loopback interface
+ */
+inline bool enableWake() {
+  if (wakeSocket() >= 0) return true;
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return false;
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  // Bind to an ephemeral port, then connect to ourselves so wake() is a plain send()
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      getsockname(fd, (struct sockaddr*)&address, &length) != 0 ||
+      connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    return false;
+  }
+  wakeSocket() = fd;
+  return true;
+}
+
+/**
+ * @brief End the current (or next) wait() early; callable from any task
+ */
+inline void wake() {
+  const int fd = wakeSocket();
+  if (fd < 0) return;
+  const char signal = 0;
+  send(fd, &signal, 1, MSG_DONTWAIT);  // A full buffer already means "wake up"
+}
+
+/**
+ * @brief Block until a socket is readable or maxMs elapses (capped at MAX_WAIT_MS)
+ * @param activity Running count of handled requests and frames; sketches
+ *                 without one pass nothing, so every repeated readable return sleeps
+ * @return true if woken by network activity
+ */
+inline bool wait(uint32_t maxMs, uint32_t activity = 0) {
+  SpinGuard& guard = spinGuard();
+  // The last wake found data, yet the pass since handled nothing
+  const bool stalled = guard.readable && activity == guard.activity;
+  guard.readable = false;
+  guard.activity = activity;
+
+  if (busyFlag()) {
+    busyFlag() = false;
+    return true;
+  }
+  if (maxMs == 0) return false;
+  if (maxMs > MAX_WAIT_MS) maxMs = MAX_WAIT_MS;
+
+  fd_set readable;
+  FD_ZERO(&readable);
+  int highest = -1;
+  for (int fd = FIRST_SOCKET; fd < FIRST_SOCKET + SOCKET_COUNT; fd++) {
+    int type = 0;
+    socklen_t length = sizeof(type);
+    if (getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) != 0) continue;  // Not open
+    FD_SET(fd, &readable);
+    highest = fd;
+  }
+  if (highest < 0) {
+    delay(maxMs);
+    return false;
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = maxMs / 1000;
+  timeout.tv_usec = (maxMs % 1000) * 1000;
+  if (select(highest + 1, &readable, nullptr, nullptr, &timeout) <= 0) return false;
+
+  const int fd = wakeSocket();
+  if (fd >= 0 && FD_ISSET(fd, &readable)) {
+    char drain[16];
+    while (recv(fd, drain, sizeof(drain), MSG_DONTWAIT) > 0) {
+    }
+    return true;  // Work queued by another task
+  }
+  if (stalled) delay(SPIN_SLEEP_MS);
+  guard.readable = true;
+  return true;
+}
+
+}  // namespace LoopIdle
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+#include "PhaseProfiler.h"
+
+/**
+ * @brief Cycle-counter glue for PhaseProfiler that compiles out (header-only, ESP32)
+ *
+ * Define LOOP_PROFILER to 1 before including this header to time phases;
+ * with 0 (the default) both macros keep only the wrapped statement and no
+ * profiler code or data is referenced:
+ *
+ *   #define LOOP_PROFILER 1
+ *   #include <LoopProfiler.h>
+ *
+ *   enum LoopPhase : uint8_t { PHASE_HTTP, PHASE_WEBSOCKET, PHASE_WIFI, PHASE_COUNT };
+ *   const char* const PHASE_NAMES[PHASE_COUNT] = {"http", "websocket", "wifi"};
+ *   #if LOOP_PROFILER
+ *   PhaseProfiler profiler(PHASE_NAMES, PHASE_COUNT);
+ *   #endif
+ *
+ *   void checkWiFi(void*) {
+ *     LOOP_PROFILE_SCOPE(profiler, PHASE_WIFI);  // Rest of the function
+ *     ...
+ *   }
+ *
+ *   void loop() {
+ *     LOOP_PHASE(profiler, PHASE_HTTP, server.handleClient());
+ *     LOOP_PHASE(profiler, PHASE_WEBSOCKET, webSocket.loop());
+ *   }
+ *
+ * The cycle counter is per core and wraps every 17.9 s at 240 MHz, so a
+ * profiler must only be recorded from one task and phases must be shorter
+ * than that.
+ */
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 0
+#endif
+
+#if LOOP_PROFILER
+
+namespace LoopProfiler {
+
+/**
+ * @brief Records the cycles from construction to the end of the enclosing scope
+ */
+class Scope {
+public:
+  Scope(PhaseProfiler& profiler, uint8_t phase)
+      : profiler_(profiler), phase_(phase), start_(ESP.getCycleCount()) {}
+  ~Scope() { profiler_.record(phase_, ESP.getCycleCount() - start_); }
+
+private:
+  PhaseProfiler& profiler_;
+  uint8_t phase_;
+  uint32_t start_;
+};
+
+/**
+ * @brief profiler.report() at the current CPU frequency
+ */
+inline void report(const PhaseProfiler& profiler, ResponseBuffer& out) {
+  profiler.report(out, ESP.getCpuFreqMHz());
+}
+
+}  // namespace LoopProfiler
+
+#define LOOP_PHASE(profiler, phase, statement)                              \
+  do {                                                                      \
+    const uint32_t loopPhaseStart_ = ESP.getCycleCount();                   \
+    statement;                                                              \
+    (profiler).record((phase), ESP.getCycleCount() - loopPhaseStart_);      \
+  } while (0)
+
+#define LOOP_PROFILE_SCOPE(profiler, phase) \
+  LoopProfiler::Scope loopProfileScope_((profiler), (phase))
+
+#else
+
+#define LOOP_PHASE(profiler, phase, statement) \
+  do {                                         \
+    statement;                                 \
+  } while (0)
+
+#define LOOP_PROFILE_SCOPE(profiler, phase) \
+  do {                                      \
+  } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+#include "Metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// 64 us * 4^i: 64 us, 256 us, 1.024 ms, 4.096 ms, 16.384 ms, 65.536 ms, 262.144 ms, 1.048576 s
+const uint32_t LatencyHistogram::BUCKET_BOUNDS_US[BUCKET_COUNT] = {
+  64, 256, 1024, 4096, 16384, 65536, 262144, 1048576
+};
+
+void LatencyHistogram::observe(uint32_t micros) {
+  count_++;
+  sumMicros_ += micros;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    if (micros <= BUCKET_BOUNDS_US[i]) {
+      buckets_[i]++;
+      return;
+    }
+  }
+  // Above the last bound: only in count_ (+Inf)
+}
+
+uint32_t LatencyHistogram::cumulative(uint8_t bucket) const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i <= bucket && i < BUCKET_COUNT; i++) total += buckets_[i];
+  return total;
+}
+
+// ---------------------------------------------------------------------------
+// MetricsWriter
+
+MetricsWriter::MetricsWriter(ResponseBuffer& buffer, Sink sink, void* context)
+    : out_(buffer), sink_(sink), context_(context) {
+  out_.clear();
+}
+
+void MetricsWriter::reserveLine() {
+  if (out_.capacity() - out_.length() < MAX_LINE) finish();
+}
+
+void MetricsWriter::finish() {
+  if (out_.length() > 0 && sink_ != nullptr) sink_(out_.c_str(), out_.length(), context_);
+  out_.clear();
+}
+
+void MetricsWriter::family(const char* name, const char* type, const char* help) {
+  reserveLine();
+  out_.printf("# HELP %s %s\n", name, help);
+  reserveLine();
+  out_.printf("# TYPE %s %s\n", name, type);
+}
+
+void MetricsWriter::printLabels(const char* labels, const char* extra) {
+  bool hasLabels = labels != nullptr && labels[0] != '\0';
+  if (!hasLabels && extra == nullptr) return;
+  out_.print("{");
+  if (hasLabels) out_.print(labels);
+  if (extra != nullptr) {
+    if (hasLabels) out_.print(",");
+    out_.print(extra);
+  }
+  out_.print("}");
+}
+
+void MetricsWriter::printSeconds(uint64_t micros) {
+  out_.printf("%llu.%06lu", (unsigned long long)(micros / 1000000ULL),
+              (unsigned long)(micros % 1000000ULL));
+}
+
+void MetricsWriter::sample(const char* name, const char* labels, int64_t value) {
+  reserveLine();
+  out_.print(name);
+  printLabels(labels, nullptr);
+  out_.printf(" %lld\n", (long long)value);
+}
+
+void MetricsWriter::sampleSeconds(const char* name, const char* labels, uint64_t micros) {
+  reserveLine();
+  out_.print(name);
+  printLabels(labels, nullptr);
+  out_.print(" ");
+  printSeconds(micros);
+  out_.print("\n");
+}
+
+void MetricsWriter::histogram(const char* name, const char* labels,
+                              const LatencyHistogram& histogram) {
+  char le[24];
+  for (uint8_t i = 0; i <= LatencyHistogram::BUCKET_COUNT; i++) {
+    if (i < LatencyHistogram::BUCKET_COUNT) {
+      uint32_t bound = LatencyHistogram::BUCKET_BOUNDS_US[i];
+      snprintf(le, sizeof(le), "le=\"%lu.%06lu\"", (unsigned long)(bound / 1000000UL),
+               (unsigned long)(bound % 1000000UL));
+    } else {
+      snprintf(le, sizeof(le), "le=\"+Inf\"");
+    }
+    reserveLine();
+    out_.printf("%s_bucket", name);
+    printLabels(labels, le);
+    out_.printf(" %lu\n", (unsigned long)(i < LatencyHistogram::BUCKET_COUNT
+                                              ? histogram.cumulative(i)
+                                              : histogram.count()));
+  }
+
+  reserveLine();
+  out_.printf("%s_sum", name);
+  printLabels(labels, nullptr);
+  out_.print(" ");
+  printSeconds(histogram.sumMicros());
+  out_.print("\n");
+
+  reserveLine();
+  out_.printf("%s_count", name);
+  printLabels(labels, nullptr);
+  out_.printf(" %lu\n", (unsigned long)histogram.count());
+}
+
+void MetricsWriter::counter(const char* name, const char* help, int64_t value) {
+  family(name, "counter", help);
+  sample(name, nullptr, value);
+}
+
+void MetricsWriter::gauge(const char* name, const char* help, int64_t value) {
+  family(name, "gauge", help);
+  sample(name, nullptr, value);
+}
+
+// ---------------------------------------------------------------------------
+// HttpMetrics
+
+int HttpMetrics::addRoute(const char* route) {
+  for (uint8_t i = 0; i < routeCount_; i++) {
+    if (strcmp(routes_[i].name, route) == 0) return i;  // Same path, another method
+  }
+  if (routeCount_ == MAX_ROUTES) return INVALID_ROUTE;
+  routes_[routeCount_].name = route;
+  routes_[routeCount_].latency = LatencyHistogram();
+  return routeCount_++;
+}
+
+void HttpMetrics::record(int route, uint32_t micros) {
+  if (route < 0 || route >= routeCount_) return;
+  routes_[route].latency.observe(micros);
+}
+
+uint32_t HttpMetrics::requests(int route) const {
+  if (route < 0 || route >= routeCount_) return 0;
+  return routes_[route].latency.count();
+}
+
+uint32_t HttpMetrics::total() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < routeCount_; i++) total += routes_[i].latency.count();
+  return total;
+}
+
+void HttpMetrics::write(MetricsWriter& out) const {
+  char labels[48];
+
+  out.family("http_requests_total", "counter", "HTTP requests handled, by route");
+  for (uint8_t i = 0; i < routeCount_; i++) {
+    snprintf(labels, sizeof(labels), "route=\"%s\"", routes_[i].name);
+    out.sample("http_requests_total", labels, routes_[i].latency.count());
+  }
+
+  out.family("http_request_duration_seconds", "histogram",
+             "Time spent in the route handler, including the response write");
+  for (uint8_t i = 0; i < routeCount_; i++) {
+    snprintf(labels, sizeof(labels), "route=\"%s\"", routes_[i].name);
+    out.histogram("http_request_duration_seconds", labels, routes_[i].latency);
+  }
+}
@@ -0,0 +1,131 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ResponseBuffer.h"
+
+/**
+ * @brief Latency histogram with fixed log-scale buckets
+ *
+ * Upper bounds grow 4x per bucket from 64 us to about 1 s, plus +Inf, so a
+ * 50 us handler and a 300 ms stall land in different buckets with nine
+ * counters and no allocation. observe() is a handful of compares.
+ */
+class LatencyHistogram {
+public:
+  static const uint8_t BUCKET_COUNT = 8;  // Finite bounds; +Inf is count()
+  static const uint32_t BUCKET_BOUNDS_US[BUCKET_COUNT];
+
+  void observe(uint32_t micros);
+
+  uint32_t count() const { return count_; }
+  uint64_t sumMicros() const { return sumMicros_; }
+
+  /**
+   * @brief Observations <= BUCKET_BOUNDS_US[bucket], as Prometheus exposes them
+   */
+  uint32_t cumulative(uint8_t bucket) const;
+
+private:
+  uint32_t buckets_[BUCKET_COUNT] = {};
+  uint32_t count_ = 0;
+  uint64_t sumMicros_ = 0;
+};
+
+/**
+ * @brief Prometheus text exposition format (0.0.4) writer
+ *
+ * Lines are formatted into a small ResponseBuffer and handed to `sink`
+ * whenever the next line might not fit, so the page is streamed as a
+ * chunked HTTP response instead of being built in one String. `labels` is
+ * the inside of the braces (`route="/status"`) or nullptr; values are
+ * written as-is, so only pass literals without quotes or backslashes.
+ */
+class MetricsWriter {
+public:
+  typedef void (*Sink)(const char* data, size_t length, void* context);
+
+  static const size_t MAX_LINE = 128;
+
+  MetricsWriter(ResponseBuffer& buffer, Sink sink, void* context);
+
+  /**
+   * @brief # HELP and # TYPE lines; type is "counter", "gauge" or "histogram"
+   */
+  void family(const char* name, const char* type, const char* help);
+
+  void sample(const char* name, const char* labels, int64_t value);
+
+  /**
+   * @brief Sample in seconds, from microseconds (exact, no float formatting)
+   */
+  void sampleSeconds(const char* name, const char* labels, uint64_t micros);
+
+  /**
+   * @brief _bucket{le=...} lines, _sum (seconds) and _count of one histogram
+   */
+  void histogram(const char* name, const char* labels, const LatencyHistogram& histogram);
+
+  // Single-sample families
+  void counter(const char* name, const char* help, int64_t value);
+  void gauge(const char* name, const char* help, int64_t value);
+
+  /**
+   * @brief Hand the remaining text to the sink
+   */
+  void finish();
+
+private:
+  void reserveLine();
+  void printSeconds(uint64_t micros);
+  void printLabels(const char* labels, const char* extra);
+
+  ResponseBuffer& out_;
+  Sink sink_;
+  void* context_;
+};
+
+/**
+ * @brief Request counter and latency histogram per HTTP route
+ *
+ * Routes are registered once in setup() (the glue in MetricsEndpoint.h does
+ * it while registering the handler) and recorded from the server's task.
+ */
+class HttpMetrics {
+public:
+  static const uint8_t MAX_ROUTES = 10;
+  static const int INVALID_ROUTE = -1;
+
+  /**
+   * @brief Register a route label; the string must stay valid (a literal)
+   * @return route id, or INVALID_ROUTE when MAX_ROUTES are in use
+   */
+  int addRoute(const char* route);
+
+  void record(int route, uint32_t micros);
+
+  uint32_t requests(int route) const;
+
+  /**
+   * @brief Requests on every route
+   */
+  uint32_t total() const;
+
+  /**
+   * @brief http_requests_total and http_request_duration_seconds families
+   */
+  void write(MetricsWriter& out) const;
+
+private:
+  struct Route {
+    const char* name;
+    LatencyHistogram latency;
+  };
+
+  Route routes_[MAX_ROUTES];
+  uint8_t routeCount_ = 0;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef METRICS_ENDPOINT_H
+#define METRICS_ENDPOINT_H
+
+#include <WebServer.h>
+#include <WiFi.h>
+
+#include "HeapMonitor.h"
+#include "Metrics.h"
+
+/**
+ * @brief GET /metrics for a WebServer, in Prometheus text format
+ *
+ * Header-only ESP32 glue around Metrics.h:
+ *
+ *   HttpMetrics httpMetrics;
+ *
+ *   void collectMetrics(MetricsWriter& out) {
+ *     httpMetrics.write(out);
+ *     MetricsEndpoint::writeDevice(out, loopTime);
+ *   }
+ *
+ *   MetricsEndpoint::on(server, httpMetrics, "/status", HTTP_GET, handleStatus);
+ *   MetricsEndpoint::begin(server, collectMetrics);
+ *
+ * on() registers a handler that is counted and timed per route, and whose
+ * allocations are tagged with the route (HeapMonitor.h). begin()
+ * adds GET /metrics, which streams the page in CHUNK_SIZE pieces, so its
+ * size is not limited by a buffer.
+ */
+namespace MetricsEndpoint {
+
+const char CONTENT_TYPE[] = "text/plain; version=0.0.4";
+const size_t CHUNK_SIZE = 512;
+
+typedef void (*Collector)(MetricsWriter& out);
+
+inline WebServer*& server() {
+  static WebServer* instance = nullptr;
+  return instance;
+}
+
+inline Collector& collector() {
+  static Collector instance = nullptr;
+  return instance;
+}
+
+/**
+ * @brief Register a route handler that is counted and timed in httpMetrics
+ */
+inline void on(WebServer& webServer, HttpMetrics& httpMetrics, const char* uri,
+               HTTPMethod method, void (*handler)()) {
+  int route = httpMetrics.addRoute(uri);
+  int heapTag = HeapMonitor::accounting().addTag(uri);
+  webServer.on(uri, method, [&httpMetrics, route, heapTag, handler]() {
+    HeapMonitor::Scope heapScope(heapTag);
+    uint32_t start = micros();
+    handler();
+    httpMetrics.record(route, micros() - start);
+  });
+}
+
+/**
+ * @brief onNotFound() counterpart of on(), recorded as route "unmatched"
+ */
+inline void onNotFound(WebServer& webServer, HttpMetrics& httpMetrics, void (*handler)()) {
+  int route = httpMetrics.addRoute("unmatched");
+  int heapTag = HeapMonitor::accounting().addTag("unmatched");
+  webServer.onNotFound([&httpMetrics, route, heapTag, handler]() {
+    HeapMonitor::Scope heapScope(heapTag);
+    uint32_t start = micros();
+    handler();
+    httpMetrics.record(route, micros() - start);
+  });
+}
+
+inline void sendChunk(const char* data, size_t length, void* context) {
+  static_cast<WebServer*>(context)->sendContent(data, length);
+}
+
+inline void handleMetrics() {
+  WebServer& webServer = *server();
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, CONTENT_TYPE, "");
+
+  StaticResponseBuffer<CHUNK_SIZE> chunk;
+  MetricsWriter out(chunk, sendChunk, &webServer);
+  collector()(out);
+  out.finish();
+}
+
+/**
+ * @brief Serve GET /metrics from collect (call once in setup())
+ */
+inline void begin(WebServer& webServer, Collector collect) {
+  server() = &webServer;
+  collector() = collect;
+  webServer.on("/metrics", HTTP_GET, handleMetrics);
+}
+
+/**
+ * @brief Heap and fragmentation, per-handler allocations, uptime, RSSI and loop time
+ */
+inline void writeDevice(MetricsWriter& out, const LatencyHistogram& loopTime) {
+  HeapSnapshot heap = HeapMonitor::snapshot();
+  out.gauge("esp32_heap_free_bytes", "Free heap", heap.freeBytes);
+  out.gauge("esp32_heap_min_free_bytes", "Lowest free heap since boot", heap.minFreeBytes);
+  out.gauge("esp32_heap_largest_free_block_bytes", "Largest allocatable block",
+            heap.largestFreeBlock);
+  HeapMonitor::writeMetrics(out, heap);
+  out.gauge("esp32_uptime_seconds", "Seconds since boot", millis() / 1000);
+  out.gauge("esp32_wifi_rssi_dbm", "WiFi signal strength", WiFi.RSSI());
+  out.family("esp32_loop_duration_seconds", "histogram",
+             "Work per loop() iteration, idle time excluded");
+  out.histogram("esp32_loop_duration_seconds", nullptr, loopTime);
+}
+
+}  // namespace MetricsEndpoint
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "SpscQueue.h"  // QUEUE_INDEX_ALIGN
+
+/**
+ * @brief Bounded lock-free queue from any number of producer tasks to one consumer
+ *
+ * Same contract as SpscQueue, but push() may be called concurrently from
+ * several tasks (HTTP, WebSocket and MQTT handlers on the network core, a
+ * console task, ...). Producers claim a slot with a compare-and-swap on the
+ * tail and publish it through a per-slot sequence number, so the consumer
+ * never sees a half-written item. pop() is only ever called from the one
+ * consumer task. Not for use from an ISR.
+ *
+ * CAPACITY must be a power of two.
+ */
+template <typename T, uint32_t CAPACITY>
+class MpscQueue {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "MpscQueue capacity must be a power of two");
+
+public:
+  MpscQueue() {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Producer side, any task
+   * @return false if the queue is full (item not queued)
+   */
+  bool push(const T& item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[tail & MASK];
+      const uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const int32_t difference = (int32_t)(sequence - tail);
+      if (difference == 0) {
+        // Slot is free for this lap - claim it
+        if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) break;
+      } else if (difference < 0) {
+        return false;  // Consumer has not released this slot yet: full
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);  // Another producer won
+      }
+    }
+    cell->item = item;
+    cell->sequence.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Consumer side
+   * @return false if the queue is empty (or the next slot is still being written)
+   */
+  bool pop(T& item) {
+    Cell& cell = cells_[head_ & MASK];
+    const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (head_ + 1)) < 0) return false;
+    item = cell.item;
+    cell.sequence.store(head_ + CAPACITY, std::memory_order_release);
+    head_++;
+    return true;
+  }
+
+  static uint32_t capacity() { return CAPACITY; }
+
+private:
+  static const uint32_t MASK = CAPACITY - 1;
+
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    T item;
+  };
+
+  alignas(QUEUE_INDEX_ALIGN) std::atomic<uint32_t> tail_{0};  // Shared by producers
+  alignas(QUEUE_INDEX_ALIGN) uint32_t head_ = 0;              // Consumer only
+  alignas(QUEUE_INDEX_ALIGN) Cell cells_[CAPACITY];
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "PhaseProfiler.h"
+
+// 256 * 4^i cycles: 1.07 us, 4.27 us, 17.1 us, 68.3 us, 273 us, 1.09 ms, 4.37 ms, 17.5 ms at 240 MHz
+const uint32_t PhaseProfiler::BUCKET_BOUNDS_CYCLES[BUCKET_COUNT - 1] = {
+  256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304
+};
+
+namespace {
+
+const char* const BUCKET_LABELS[PhaseProfiler::BUCKET_COUNT] = {
+  "<256", "<1K", "<4K", "<16K", "<64K", "<256K", "<1M", "<4M", "more"
+};
+
+}  // namespace
+
+PhaseProfiler::PhaseProfiler(const char* const* names, uint8_t count)
+    : names_(names), count_(count < MAX_PHASES ? count : MAX_PHASES) {
+  reset();
+}
+
+void PhaseProfiler::reset() {
+  for (uint8_t i = 0; i < count_; i++) {
+    phases_[i] = Phase();
+    phases_[i].minCycles = UINT32_MAX;
+  }
+}
+
+void PhaseProfiler::printMicros(ResponseBuffer& out, uint64_t cycles, uint32_t cpuMhz) const {
+  const uint64_t centiMicros = cycles * 100 / (cpuMhz > 0 ? cpuMhz : 1);
+  out.printf(" %8lu.%02lu", (unsigned long)(centiMicros / 100), (unsigned long)(centiMicros % 100));
+}
+
+void PhaseProfiler::report(ResponseBuffer& out, uint32_t cpuMhz) const {
+  uint64_t profiled = 0;
+  for (uint8_t i = 0; i < count_; i++) profiled += phases_[i].totalCycles;
+
+  out.printf("%-14s %8s %11s %11s %11s %6s |", "phase", "calls", "min_us", "mean_us", "max_us",
+             "share");
+  for (uint8_t b = 0; b < BUCKET_COUNT; b++) out.printf(" %6s", BUCKET_LABELS[b]);
+  out.print(" cycles\n");
+
+  for (uint8_t i = 0; i < count_; i++) {
+    const Phase& p = phases_[i];
+    out.printf("%-14s %8lu", names_[i], (unsigned long)p.calls);
+    printMicros(out, p.calls > 0 ? p.minCycles : 0, cpuMhz);
+    printMicros(out, p.calls > 0 ? p.totalCycles / p.calls : 0, cpuMhz);
+    printMicros(out, p.maxCycles, cpuMhz);
+    const uint32_t permille = profiled > 0 ? (uint32_t)(p.totalCycles * 1000 / profiled) : 0;
+    out.printf(" %3lu.%lu%% |", (unsigned long)(permille / 10), (unsigned long)(permille % 10));
+    for (uint8_t b = 0; b < BUCKET_COUNT; b++) out.printf(" %6lu", (unsigned long)p.buckets[b]);
+    out.print("\n");
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef PHASE_PROFILER_H
+#define PHASE_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ResponseBuffer.h"
+
+/**
+ * @brief Per-phase timing of loop() in CPU cycles
+ *
+ * Each named phase (handleClient, webSocket.loop, a scheduled task, ...)
+ * keeps a call count, min / mean / max and a log-scale histogram. record()
+ * takes a cycle delta, so this file has no clock of its own; LoopProfiler.h
+ * reads the ESP32 cycle counter and compiles the calls out when disabled.
+ *
+ * Phase names come from the sketch as an array of literals indexed by an
+ * enum, so recording is an array access, a few adds and one clz.
+ */
+class PhaseProfiler {
+public:
+  static const uint8_t MAX_PHASES = 8;
+
+  // Bucket i < 8 holds cycles < 256 * 4^i (about 1 us .. 17 ms at 240 MHz);
+  // the last bucket holds everything above
+  static const uint8_t BUCKET_COUNT = 9;
+  static const uint32_t BUCKET_BOUNDS_CYCLES[BUCKET_COUNT - 1];
+
+  struct Phase {
+    uint32_t calls;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t buckets[BUCKET_COUNT];
+  };
+
+  /**
+   * @param names One literal per phase, must stay valid; count > MAX_PHASES is cut
+   */
+  PhaseProfiler(const char* const* names, uint8_t count);
+
+  /**
+   * @brief Add one run of `phase` that took `cycles` (wrap-safe end - start)
+   */
+  void record(uint8_t phase, uint32_t cycles) {
+    if (phase >= count_) return;
+    Phase& p = phases_[phase];
+    p.calls++;
+    p.totalCycles += cycles;
+    if (cycles < p.minCycles) p.minCycles = cycles;
+    if (cycles > p.maxCycles) p.maxCycles = cycles;
+    p.buckets[bucketFor(cycles)]++;
+  }
+
+  static uint8_t bucketFor(uint32_t cycles) {
+    // Bit width 1..8 -> 0, 9..10 -> 1, ..., 23 and up -> 8
+    const int bits = 32 - __builtin_clz(cycles | 1);
+    const int bucket = bits <= 8 ? 0 : (bits - 7) / 2;
+    return bucket < BUCKET_COUNT - 1 ? (uint8_t)bucket : BUCKET_COUNT - 1;
+  }
+
+  /**
+   * @brief Start a new measurement window
+   */
+  void reset();
+
+  uint8_t count() const { return count_; }
+  const char* name(uint8_t phase) const { return names_[phase]; }
+  const Phase& phase(uint8_t phase) const { return phases_[phase]; }
+
+  /**
+   * @brief Text table: calls, min / mean / max in us, share of the profiled
+   *        cycles, then the histogram counts
+   * @param cpuMhz Cycles per microsecond (ESP.getCpuFreqMHz())
+   */
+  void report(ResponseBuffer& out, uint32_t cpuMhz) const;
+
+private:
+  void printMicros(ResponseBuffer& out, uint64_t cycles, uint32_t cpuMhz) const;
+
+  const char* const* names_;
+  uint8_t count_;
+  Phase phases_[MAX_PHASES];
+};
+
+#endif
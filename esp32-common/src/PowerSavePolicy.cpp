@@ -0,0 +1,82 @@
+#include "PowerSavePolicy.h"
+
+#include <stdio.h>
+
+void PowerSavePolicy::configure(uint32_t idleMs, uint32_t deepIdleMs, uint32_t nowMs) {
+  idleMs_ = idleMs;
+  deepIdleMs_ = deepIdleMs;
+  mode_ = ACTIVE;
+  lastActiveMs_ = nowMs;
+  modeSinceMs_ = nowMs;
+}
+
+bool PowerSavePolicy::update(uint32_t nowMs, uint32_t activity, uint16_t sessions) {
+  uint32_t arrived = activity - lastActivity_;
+  lastActivity_ = activity;
+  requests_[mode_] += arrived;  // Handled since the last pass, in the mode set then
+  if (arrived > 0 || sessions > 0) lastActiveMs_ = nowMs;
+
+  uint32_t idle = nowMs - lastActiveMs_;
+  Mode next = ACTIVE;
+  if (deepIdleMs_ != 0 && idle >= deepIdleMs_) {
+    next = MAX_MODEM;
+  } else if (idle >= idleMs_) {
+    next = MIN_MODEM;
+  }
+  if (next == mode_) return false;
+
+  timeInModeMs_[mode_] += nowMs - modeSinceMs_;
+  modeSinceMs_ = nowMs;
+  mode_ = next;
+  switches_++;
+  return true;
+}
+
+uint64_t PowerSavePolicy::timeInModeMs(Mode mode, uint32_t nowMs) const {
+  return timeInModeMs_[mode] + (mode == mode_ ? nowMs - modeSinceMs_ : 0);
+}
+
+const char* PowerSavePolicy::modeName(Mode mode) {
+  switch (mode) {
+    case ACTIVE: return "active";
+    case MIN_MODEM: return "min_modem";
+    case MAX_MODEM: return "max_modem";
+    default: return "unknown";
+  }
+}
+
+void PowerSavePolicy::writeStatusJson(JsonWriter& json, uint32_t nowMs) const {
+  json.field("wifi_power_mode", modeName(mode_))
+      .field("wifi_power_active_ms", timeInModeMs(ACTIVE, nowMs))
+      .field("wifi_power_min_modem_ms", timeInModeMs(MIN_MODEM, nowMs))
+      .field("wifi_power_max_modem_ms", timeInModeMs(MAX_MODEM, nowMs));
+}
+
+void PowerSavePolicy::write(MetricsWriter& out, uint32_t nowMs) const {
+  char labels[24];
+
+  out.family("esp32_wifi_power_mode", "gauge", "WiFi power-save mode in use (1)");
+  for (uint8_t i = 0; i < MODE_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "mode=\"%s\"", modeName((Mode)i));
+    out.sample("esp32_wifi_power_mode", labels, i == mode_ ? 1 : 0);
+  }
+  out.family("esp32_wifi_power_mode_seconds_total", "counter", "Time spent in each power-save mode");
+  for (uint8_t i = 0; i < MODE_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "mode=\"%s\"", modeName((Mode)i));
+    out.sampleSeconds("esp32_wifi_power_mode_seconds_total", labels,
+                      timeInModeMs((Mode)i, nowMs) * 1000);
+  }
+  out.family("esp32_wifi_power_requests_total", "counter",
+             "Requests and frames by the power-save mode they arrived in");
+  for (uint8_t i = 0; i < MODE_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "mode=\"%s\"", modeName((Mode)i));
+    out.sample("esp32_wifi_power_requests_total", labels, requests_[i]);
+  }
+  out.counter("esp32_wifi_power_mode_switches_total", "Power-save mode changes", switches_);
+  out.family("esp32_wifi_power_handler_latency_seconds", "histogram",
+             "On-device receive to reply, without the radio wake-up, by the power-save mode it arrived in");
+  for (uint8_t i = 0; i < MODE_COUNT; i++) {
+    snprintf(labels, sizeof(labels), "mode=\"%s\"", modeName((Mode)i));
+    out.histogram("esp32_wifi_power_handler_latency_seconds", labels, handlerLatency_[i]);
+  }
+}
@@ -0,0 +1,94 @@
+#ifndef POWER_SAVE_POLICY_H
+#define POWER_SAVE_POLICY_H
+
+#include <stdint.h>
+
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+/**
+ * @brief WiFi power-save mode from recent activity, and time spent in each
+ *
+ * Modem sleep wakes the radio only for beacons, so a frame sent to an idle
+ * device waits for the next DTIM (about 100 ms, 300 ms at MAX_MODEM);
+ * with power save off the radio never sleeps. The policy keeps ACTIVE while
+ * sessions are open or requests arrived within idleMs, then MIN_MODEM, and
+ * MAX_MODEM after deepIdleMs (0: never).
+ *
+ * The wake-up wait itself is only visible to a client: the handler latency
+ * per mode covers the device's own work and reads the same in every mode.
+ *
+ * Activity is a counter the sketch already keeps (HTTP requests plus
+ * WebSocket frames): update() compares it with the last pass, so handlers
+ * need no hook. Requests are counted under the mode they arrived in; those
+ * in a sleep mode paid the wake-up. Time per mode is the current-draw proxy.
+ */
+class PowerSavePolicy {
+public:
+  static const uint32_t DEFAULT_IDLE_MS = 10000;
+  static const uint32_t DEFAULT_DEEP_IDLE_MS = 120000;
+
+  enum Mode : uint8_t {
+    ACTIVE,     // WIFI_PS_NONE
+    MIN_MODEM,  // WIFI_PS_MIN_MODEM: wake every DTIM
+    MAX_MODEM,  // WIFI_PS_MAX_MODEM: wake every listen interval
+    MODE_COUNT
+  };
+
+  /**
+   * @brief Thresholds, and ACTIVE from `nowMs`
+   */
+  void configure(uint32_t idleMs, uint32_t deepIdleMs, uint32_t nowMs);
+
+  /**
+   * @brief One loop() pass: `activity` is a running request count, `sessions` open clients
+   * @return true when mode() changed (apply it with WiFi.setSleep())
+   */
+  bool update(uint32_t nowMs, uint32_t activity, uint16_t sessions);
+
+  /**
+   * @brief On-device handling time of a request that arrived in the current mode
+   *
+   * Receive to reply only: the radio wake-up happens before the frame
+   * reaches the device and is not part of it.
+   */
+  void observeHandler(uint32_t micros) { handlerLatency_[mode_].observe(micros); }
+
+  Mode mode() const { return mode_; }
+  uint32_t idleMs() const { return idleMs_; }
+  uint32_t deepIdleMs() const { return deepIdleMs_; }
+  uint64_t timeInModeMs(Mode mode, uint32_t nowMs) const;
+  uint32_t requests(Mode mode) const { return requests_[mode]; }
+  uint32_t switches() const { return switches_; }
+  const LatencyHistogram& handlerLatency(Mode mode) const { return handlerLatency_[mode]; }
+
+  static const char* modeName(Mode mode);
+
+  /**
+   * @brief "wifi_power_mode" and the ms spent in each mode
+   *
+   * Members of an open /status object.
+   */
+  void writeStatusJson(JsonWriter& json, uint32_t nowMs) const;
+
+  /**
+   * @brief esp32_wifi_power_mode{mode}, esp32_wifi_power_mode_seconds_total{mode},
+   *        esp32_wifi_power_requests_total{mode}, esp32_wifi_power_mode_switches_total,
+   *        esp32_wifi_power_handler_latency_seconds{mode}
+   */
+  void write(MetricsWriter& out, uint32_t nowMs) const;
+
+private:
+  Mode mode_ = ACTIVE;
+  uint32_t idleMs_ = DEFAULT_IDLE_MS;
+  uint32_t deepIdleMs_ = DEFAULT_DEEP_IDLE_MS;
+  uint32_t lastActiveMs_ = 0;
+  uint32_t modeSinceMs_ = 0;
+  uint32_t lastActivity_ = 0;
+  uint32_t switches_ = 0;
+  uint64_t timeInModeMs_[MODE_COUNT] = {};  // Ended stretches; the current one is added on read
+  uint32_t requests_[MODE_COUNT] = {};
+  LatencyHistogram handlerLatency_[MODE_COUNT];
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "Provisioner.h"
+
+#include <string.h>
+
+namespace {
+
+bool copyField(char* out, size_t size, const char* data, size_t length) {
+  if (length >= size) return false;
+  memcpy(out, data, length);
+  out[length] = '\0';
+  return true;
+}
+
+}  // namespace
+
+void Provisioner::start(uint32_t nowMs) {
+  source_ = NONE;
+  startMs_ = nowMs;
+  elapsedMs_ = 0;
+  rejected_ = 0;
+  memset(ssid_, 0, sizeof(ssid_));
+  memset(password_, 0, sizeof(password_));
+  serialSsid_[0] = '\0';
+}
+
+bool Provisioner::offer(Source source, const char* ssid, const char* password, uint32_t nowMs) {
+  if (password == nullptr) password = "";
+  size_t ssidLength = ssid != nullptr ? strlen(ssid) : 0;
+  if (done() || source == NONE || ssidLength == 0 ||
+      !copyField(ssid_, sizeof(ssid_), ssid, ssidLength) ||
+      !copyField(password_, sizeof(password_), password, strlen(password))) {
+    if (!done()) ssid_[0] = '\0';
+    rejected_++;
+    return false;
+  }
+  source_ = source;
+  elapsedMs_ = nowMs - startMs_;
+  return true;
+}
+
+bool Provisioner::offerText(Source source, const char* data, size_t length, uint32_t nowMs) {
+  // Trailing line ending from terminal-style BLE apps
+  while (length > 0 && (data[length - 1] == '\n' || data[length - 1] == '\r')) length--;
+  const char* newline = (const char*)memchr(data, '\n', length);
+  size_t ssidLength = newline != nullptr ? (size_t)(newline - data) : length;
+  if (ssidLength > 0 && data[ssidLength - 1] == '\r') ssidLength--;
+  const char* password = newline != nullptr ? newline + 1 : data + length;
+
+  char ssid[SSID_SIZE];
+  char passphrase[PASSWORD_SIZE];
+  if (!copyField(ssid, sizeof(ssid), data, ssidLength) ||
+      !copyField(passphrase, sizeof(passphrase), password, data + length - password)) {
+    rejected_++;
+    return false;
+  }
+  return offer(source, ssid, passphrase, nowMs);
+}
+
+Provisioner::SerialResult Provisioner::serialLine(const char* line, uint32_t nowMs) {
+  if (serialSsid_[0] == '\0') {
+    if (line[0] == '\0') return SERIAL_EMPTY_SSID;
+    if (done() || !copyField(serialSsid_, sizeof(serialSsid_), line, strlen(line))) {
+      rejected_++;
+      return SERIAL_REJECTED;
+    }
+    return SERIAL_ASK_PASSWORD;
+  }
+  bool accepted = offer(SERIAL_CONSOLE, serialSsid_, line, nowMs);
+  serialSsid_[0] = '\0';
+  return accepted ? SERIAL_ACCEPTED : SERIAL_REJECTED;
+}
+
+const char* Provisioner::sourceName(Source source) {
+  switch (source) {
+    case SERIAL_CONSOLE: return "serial";
+    case BLE: return "ble";
+    case SOFTAP: return "softap";
+    default: return "none";
+  }
+}
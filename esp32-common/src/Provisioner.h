@@ -0,0 +1,79 @@
+#ifndef PROVISIONER_H
+#define PROVISIONER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief WiFi credentials from whichever provisioning channel delivers first
+ *
+ * Serial, BLE and the setup AP's page all offer() into one Provisioner;
+ * the first valid offer wins and later ones are ignored, so the channels
+ * can run side by side without coordinating. Nothing here blocks: serial
+ * input arrives one line at a time (serialLine()), BLE as one write of
+ * "ssid\npassword" (offerText()).
+ *
+ * Limits match WiFiCache, so accepted credentials always fit the cache.
+ */
+class Provisioner {
+public:
+  static const size_t SSID_SIZE = 33;      // 32 chars max per 802.11
+  static const size_t PASSWORD_SIZE = 65;  // 63-char passphrase or 64 hex digits
+
+  enum Source : uint8_t {
+    NONE,
+    SERIAL_CONSOLE,
+    BLE,
+    SOFTAP
+  };
+
+  enum SerialResult : uint8_t {
+    SERIAL_EMPTY_SSID,    // Ask for the SSID again
+    SERIAL_ASK_PASSWORD,  // SSID taken; next line is the password
+    SERIAL_ACCEPTED,      // done() is now true
+    SERIAL_REJECTED       // Too long, or already provisioned; back to the SSID
+  };
+
+  Provisioner() { start(0); }
+
+  /**
+   * @brief Forget any credentials and wait for new ones from `nowMs`
+   */
+  void start(uint32_t nowMs);
+
+  /**
+   * @return false when ssid is empty, either is too long, or done() already
+   */
+  bool offer(Source source, const char* ssid, const char* password, uint32_t nowMs);
+
+  /**
+   * @brief "ssid\npassword" in one buffer (not NUL-terminated); no newline: open network
+   */
+  bool offerText(Source source, const char* data, size_t length, uint32_t nowMs);
+
+  /**
+   * @brief One serial line: the SSID, then the password (empty: open network)
+   */
+  SerialResult serialLine(const char* line, uint32_t nowMs);
+
+  bool done() const { return source_ != NONE; }
+  bool awaitingPassword() const { return serialSsid_[0] != '\0'; }  // Serial has the SSID
+  Source source() const { return source_; }
+  const char* ssid() const { return ssid_; }
+  const char* password() const { return password_; }
+  uint32_t elapsedMs() const { return elapsedMs_; }  // start() to the accepted offer
+  uint32_t rejected() const { return rejected_; }    // Offers refused since start()
+
+  static const char* sourceName(Source source);
+
+private:
+  Source source_ = NONE;
+  uint32_t startMs_ = 0;
+  uint32_t elapsedMs_ = 0;
+  uint32_t rejected_ = 0;
+  char ssid_[SSID_SIZE];
+  char password_[PASSWORD_SIZE];
+  char serialSsid_[SSID_SIZE];  // Waiting for its password
+};
+
+#endif
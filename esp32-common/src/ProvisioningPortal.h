@@ -0,0 +1,276 @@
+#ifndef PROVISIONING_PORTAL_H
+#define PROVISIONING_PORTAL_H
+
+#include <WiFi.h>
+#include <WebServer.h>
+#include <DNSServer.h>
+
+// BLE pulls in the Bluedroid stack (several hundred KB of flash); 0 leaves
+// serial and the setup AP
+#ifndef PROVISIONING_BLE
+#define PROVISIONING_BLE 1
+#endif
+
+#if PROVISIONING_BLE
+#include <BLEDevice.h>
+#endif
+
+#include "LineAssembler.h"
+#include "LoopIdle.h"
+#include "Provisioner.h"
+#include "WiFiCache.h"
+
+/**
+ * @brief WiFi credentials over serial, BLE and a setup AP at once (header-only, ESP32)
+ *
+ * Replaces the serial prompt that waited up to 30 s per field. All three
+ * channels stay open until one of them delivers; whichever is first wins:
+ *
+ * - Serial: the SSID line, then the password line, read without blocking.
+ * - BLE: write "ssid\npassword" to CREDENTIALS_UUID; reading it back gives
+ *   "waiting", "ok" or "invalid".
+ * - Setup AP: an open network named like the BLE device, with DNS pointing
+ *   every name at 192.168.4.1, so phones open the form as a captive page.
+ *
+ *   if (!wifiCache.hasCredentials()) ProvisioningPortal::run(wifiCache);
+ *
+ * run() is begin(), poll() until done or timeout, end(). Anyone in radio
+ * range can provision while the window is open, as with any open setup AP.
+ */
+namespace ProvisioningPortal {
+
+const uint32_t POLL_MS = 20;
+const uint16_t DNS_PORT = 53;
+const uint16_t HTTP_PORT = 80;
+const char* const DEFAULT_NAME = "ESP32-Setup";
+const char* const SERVICE_UUID = "6e7a0001-5d2c-4f3a-9b8e-3c1f0e6d2a10";
+const char* const CREDENTIALS_UUID = "6e7a0002-5d2c-4f3a-9b8e-3c1f0e6d2a10";
+
+const char SETUP_PAGE[] PROGMEM =
+    "<!DOCTYPE html><html><head><meta name='viewport' content='width=device-width'>"
+    "<title>WiFi setup</title></head><body><h3>WiFi setup</h3>"
+    "<form method='POST' action='/provision'>"
+    "<p>SSID<br><input name='ssid' maxlength='32' required></p>"
+    "<p>Password (empty: open network)<br><input name='password' type='password' maxlength='64'></p>"
+    "<p><input type='submit' value='Connect'></p></form></body></html>";
+
+const char SAVED_PAGE[] PROGMEM =
+    "<!DOCTYPE html><html><body><h3>Saved</h3>"
+    "<p>The device joins the network now; this setup network goes away.</p></body></html>";
+
+struct BleInbox {
+  char data[Provisioner::SSID_SIZE + Provisioner::PASSWORD_SIZE];
+  volatile size_t length = 0;
+  volatile bool ready = false;  // Set by the BLE task, cleared by poll()
+};
+
+struct Portal {
+  Provisioner provisioner;
+  WebServer server{HTTP_PORT};
+  DNSServer dns;
+  StaticLineAssembler<Provisioner::PASSWORD_SIZE> serialLine;
+  char name[32] = "";
+  bool active = false;
+  bool routesAdded = false;  // A saved network that fails again opens a second window
+#if PROVISIONING_BLE
+  BleInbox ble;
+  BLECharacteristic* characteristic = nullptr;
+  bool bleReleased = false;  // deinit(true) frees the controller until reset
+#endif
+};
+
+inline Portal& portal() {
+  static Portal instance;
+  return instance;
+}
+
+inline const Provisioner& provisioner() {
+  return portal().provisioner;
+}
+
+#if PROVISIONING_BLE
+class CredentialsCallbacks : public BLECharacteristicCallbacks {
+public:
+  void onWrite(BLECharacteristic* characteristic) override {
+    // BLE task: copy only; poll() hands it to the Provisioner
+    BleInbox& inbox = portal().ble;
+    if (inbox.ready) return;
+    auto value = characteristic->getValue();
+    size_t length = value.length() < sizeof(inbox.data) ? value.length() : sizeof(inbox.data);
+    memcpy(inbox.data, value.c_str(), length);
+    inbox.length = length;
+    inbox.ready = true;
+  }
+};
+
+inline void beginBle(Portal& state) {
+  if (state.bleReleased) {
+    Serial.println("BLE:    not available until reset");
+    return;
+  }
+  static CredentialsCallbacks callbacks;
+  BLEDevice::init(state.name);
+  BLEServer* server = BLEDevice::createServer();
+  BLEService* service = server->createService(SERVICE_UUID);
+  state.characteristic = service->createCharacteristic(
+      CREDENTIALS_UUID, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE);
+  state.characteristic->setCallbacks(&callbacks);
+  state.characteristic->setValue("waiting");
+  service->start();
+  BLEDevice::getAdvertising()->addServiceUUID(SERVICE_UUID);
+  BLEDevice::startAdvertising();
+  Serial.printf("BLE:    write \"ssid\\npassword\" to %s on \"%s\"\n", CREDENTIALS_UUID, state.name);
+}
+#endif
+
+inline void handleSetupPage() {
+  portal().server.send_P(200, "text/html", SETUP_PAGE);
+}
+
+inline void handleProvision() {
+  Portal& state = portal();
+  if (state.provisioner.offer(Provisioner::SOFTAP, state.server.arg("ssid").c_str(),
+                              state.server.arg("password").c_str(), millis())) {
+    state.server.send_P(200, "text/html", SAVED_PAGE);
+  } else {
+    state.server.send_P(400, "text/html", SETUP_PAGE);
+  }
+}
+
+inline void handleCaptiveRedirect() {
+  // OS connectivity checks (/generate_204, /hotspot-detect.html, ...) land here
+  Portal& state = portal();
+  state.server.sendHeader("Location", String("http://") + WiFi.softAPIP().toString() + "/");
+  state.server.send(302, "text/plain", "");
+}
+
+inline void promptSerial(const Provisioner& provisioner) {
+  Serial.print(provisioner.awaitingPassword()
+                   ? "Enter WiFi Password (press Enter if open network): "
+                   : "Enter WiFi SSID: ");
+}
+
+/**
+ * @brief Open all channels; `name` + the last MAC bytes names the AP and BLE device
+ */
+inline void begin(const char* name = DEFAULT_NAME) {
+  Portal& state = portal();
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  snprintf(state.name, sizeof(state.name), "%s-%02X%02X", name, mac[4], mac[5]);
+  state.provisioner.start(millis());
+
+  Serial.println("\n=== WiFi Setup ===");
+  Serial.println("Serial: enter the SSID, then the password");
+#if PROVISIONING_BLE
+  beginBle(state);
+#endif
+
+  WiFi.mode(WIFI_AP_STA);
+  WiFi.softAP(state.name);
+  state.dns.start(DNS_PORT, "*", WiFi.softAPIP());
+  if (!state.routesAdded) {
+    state.server.on("/", HTTP_GET, handleSetupPage);
+    state.server.on("/provision", HTTP_POST, handleProvision);
+    state.server.onNotFound(handleCaptiveRedirect);
+    state.routesAdded = true;
+  }
+  state.server.begin();
+  state.active = true;
+  Serial.printf("AP:     join \"%s\", open http://%s/\n", state.name,
+                WiFi.softAPIP().toString().c_str());
+  Serial.println();
+  promptSerial(state.provisioner);
+}
+
+/**
+ * @brief Service every channel once (loop() or a wait loop)
+ * @return true once credentials have arrived
+ */
+inline bool poll(uint32_t nowMs) {
+  Portal& state = portal();
+  Provisioner& received = state.provisioner;
+
+  LineAssembler::Result line = state.serialLine.poll(Serial, nowMs);
+  if (line == LineAssembler::LINE_OVERFLOW) {
+    Serial.println("\nERROR: too long - SSID is limited to 32 characters, password to 64");
+    promptSerial(received);
+  } else if (line == LineAssembler::LINE_READY && !received.done()) {
+    bool password = received.awaitingPassword();
+    switch (received.serialLine(state.serialLine.line(), nowMs)) {
+      case Provisioner::SERIAL_EMPTY_SSID:
+        Serial.println("\nERROR: Empty input - SSID is required");
+        break;
+      case Provisioner::SERIAL_ASK_PASSWORD:
+        Serial.println(state.serialLine.line());
+        break;
+      case Provisioner::SERIAL_ACCEPTED:
+        Serial.println(state.serialLine.length() > 0 ? "********" : "[OPEN NETWORK]");
+        break;
+      case Provisioner::SERIAL_REJECTED:
+        Serial.println(password ? "\nERROR: password is limited to 64 characters"
+                                : "\nERROR: SSID is limited to 32 characters");
+        break;
+    }
+    if (!received.done()) promptSerial(received);
+  }
+
+#if PROVISIONING_BLE
+  if (state.ble.ready) {
+    bool accepted = received.offerText(Provisioner::BLE, state.ble.data, state.ble.length, nowMs);
+    if (state.characteristic != nullptr) state.characteristic->setValue(accepted ? "ok" : "invalid");
+    state.ble.ready = false;
+  }
+#endif
+
+  state.dns.processNextRequest();
+  state.server.handleClient();
+  return received.done();
+}
+
+/**
+ * @brief Close every channel (the AP, DNS, the page and BLE)
+ */
+inline void end() {
+  Portal& state = portal();
+  if (!state.active) return;
+  state.server.close();
+  state.dns.stop();
+  WiFi.softAPdisconnect(true);
+#if PROVISIONING_BLE
+  if (!state.bleReleased) {
+    BLEDevice::deinit(true);  // The sketches have no other use for BLE
+    state.bleReleased = true;
+    state.characteristic = nullptr;
+  }
+#endif
+  state.active = false;
+}
+
+/**
+ * @brief Provision into `cache`; timeoutMs 0 waits until credentials arrive
+ * @return false on timeout (cache unchanged)
+ */
+inline bool run(WiFiCache& cache, uint32_t timeoutMs = 0, const char* name = DEFAULT_NAME) {
+  begin(name);
+  uint32_t start = millis();
+  while (!poll(millis())) {
+    if (timeoutMs != 0 && millis() - start >= timeoutMs) {
+      end();
+      Serial.println();
+      return false;
+    }
+    LoopIdle::wait(POLL_MS);  // Wakes at once for a request to the setup page
+  }
+  end();
+
+  const Provisioner& received = provisioner();
+  Serial.printf("\nCredentials over %s after %lu ms: SSID %s, %s\n",
+                Provisioner::sourceName(received.source()), (unsigned long)received.elapsedMs(),
+                received.ssid(), received.password()[0] != '\0' ? "secured" : "open network");
+  return cache.setCredentials(received.ssid(), received.password());
+}
+
+}  // namespace ProvisioningPortal
+
+#endif
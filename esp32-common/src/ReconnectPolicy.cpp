@@ -0,0 +1,83 @@
+#include "ReconnectPolicy.h"
+
+void ReconnectPolicy::start(uint32_t nowMs) {
+  lost(nowMs);
+  firstConnect_ = state_ != UP;
+}
+
+void ReconnectPolicy::lost(uint32_t nowMs) {
+  if (state_ == CONNECTING) {
+    failed(nowMs);
+    return;
+  }
+  if (state_ != UP) return;
+  state_ = WAITING;
+  downSinceMs_ = nowMs;
+  nextAttemptMs_ = nowMs;  // First attempt at once
+  backoffMs_ = INITIAL_BACKOFF_MS;
+  attempts_ = 0;
+}
+
+void ReconnectPolicy::failed(uint32_t nowMs) {
+  if (state_ != CONNECTING) return;
+  state_ = WAITING;
+  nextAttemptMs_ = nowMs + jitter(backoffMs_);
+  backoffMs_ = backoffMs_ >= MAX_BACKOFF_MS / 2 ? MAX_BACKOFF_MS : backoffMs_ * 2;
+}
+
+bool ReconnectPolicy::recovered(uint32_t nowMs) {
+  if (state_ == UP) return false;
+  state_ = UP;
+  if (firstConnect_) {
+    firstConnect_ = false;
+    return true;
+  }
+  lastRecoveryMs_ = nowMs - downSinceMs_;
+  if (lastRecoveryMs_ > maxRecoveryMs_) maxRecoveryMs_ = lastRecoveryMs_;
+  outages_++;
+  return true;
+}
+
+bool ReconnectPolicy::attemptDue(uint32_t nowMs) {
+  if (state_ == CONNECTING && nowMs - attemptStartMs_ >= ATTEMPT_TIMEOUT_MS) failed(nowMs);
+  if (state_ != WAITING || (int32_t)(nowMs - nextAttemptMs_) < 0) return false;
+  state_ = CONNECTING;
+  attemptStartMs_ = nowMs;
+  attempts_++;
+  totalAttempts_++;
+  return true;
+}
+
+uint32_t ReconnectPolicy::msUntilNext(uint32_t nowMs) const {
+  if (state_ == UP) return NO_DEADLINE;
+  uint32_t deadline = state_ == WAITING ? nextAttemptMs_ : attemptStartMs_ + ATTEMPT_TIMEOUT_MS;
+  return (int32_t)(deadline - nowMs) > 0 ? deadline - nowMs : 0;
+}
+
+uint32_t ReconnectPolicy::jitter(uint32_t backoffMs) {
+  // xorshift32: cheap, and only has to differ between devices
+  random_ ^= random_ << 13;
+  random_ ^= random_ >> 17;
+  random_ ^= random_ << 5;
+  return backoffMs + random_ % (backoffMs / 4 + 1);
+}
+
+void ReconnectPolicy::writeStatusJson(JsonWriter& json, uint32_t nowMs) const {
+  json.field("wifi_down_ms", downMs(nowMs))
+      .field("wifi_outages", outages_)
+      .field("wifi_last_recovery_ms", lastRecoveryMs_)
+      .field("wifi_max_recovery_ms", maxRecoveryMs_);
+}
+
+void ReconnectPolicy::write(MetricsWriter& out, uint32_t nowMs) const {
+  out.counter("esp32_wifi_outages_total", "WiFi outages that ended in a reconnect", outages_);
+  out.counter("esp32_wifi_reconnect_attempts_total", "WiFi reconnect attempts",
+              totalAttempts_);
+  out.family("esp32_wifi_recovery_seconds", "gauge", "Outage start to address again");
+  out.sampleSeconds("esp32_wifi_recovery_seconds", "stat=\"last\"",
+                    (uint64_t)lastRecoveryMs_ * 1000);
+  out.sampleSeconds("esp32_wifi_recovery_seconds", "stat=\"max\"",
+                    (uint64_t)maxRecoveryMs_ * 1000);
+  out.family("esp32_wifi_down_seconds", "gauge", "Length of the current outage (0: up)");
+  out.sampleSeconds("esp32_wifi_down_seconds", nullptr, (uint64_t)downMs(nowMs) * 1000);
+}
@@ -0,0 +1,110 @@
+#ifndef RECONNECT_POLICY_H
+#define RECONNECT_POLICY_H
+
+#include <stdint.h>
+
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+/**
+ * @brief When to retry a dropped link, and how long outages last
+ *
+ * lost() starts an outage and the first attempt is due at once. An attempt
+ * that fails (failed(), or no address within ATTEMPT_TIMEOUT_MS) waits
+ * INITIAL_BACKOFF_MS before the next one, doubling up to MAX_BACKOFF_MS,
+ * plus up to a quarter of jitter so devices that lost the same AP do not
+ * retry in step. recovered() ends the outage and records its length: the
+ * time-to-recover reported in /status and /metrics. start() is the same for
+ * a first connect, which is not counted as an outage.
+ *
+ * Time is passed in as millis() so the policy stays Arduino-free;
+ * WiFiReconnect.h drives it from WiFi events.
+ */
+class ReconnectPolicy {
+public:
+  static const uint32_t INITIAL_BACKOFF_MS = 500;
+  static const uint32_t MAX_BACKOFF_MS = 30000;
+  static const uint32_t ATTEMPT_TIMEOUT_MS = 10000;
+  static const uint32_t NO_DEADLINE = 0xFFFFFFFFUL;
+
+  enum State : uint8_t {
+    UP,
+    WAITING,     // Down, next attempt at nextAttemptMs_
+    CONNECTING   // Attempt started, waiting for an address
+  };
+
+  /**
+   * @brief Jitter source; devices seeded alike (e.g. from the MAC) still differ
+   */
+  void seed(uint32_t value) { random_ = value != 0 ? value : 1; }
+
+  /**
+   * @brief Not connected yet: the first attempt is due at once
+   */
+  void start(uint32_t nowMs);
+
+  /**
+   * @brief The link went down at `nowMs`; during an attempt, that attempt failed
+   */
+  void lost(uint32_t nowMs);
+
+  /**
+   * @brief The attempt in progress failed (AP not found, wrong password)
+   */
+  void failed(uint32_t nowMs);
+
+  /**
+   * @brief The link has an address (again)
+   * @return true if this ended an outage or the first connect
+   */
+  bool recovered(uint32_t nowMs);
+
+  /**
+   * @brief Time out a stuck attempt; true when the caller should start one now
+   */
+  bool attemptDue(uint32_t nowMs);
+
+  /**
+   * @brief Milliseconds until attemptDue() has work (NO_DEADLINE while up)
+   */
+  uint32_t msUntilNext(uint32_t nowMs) const;
+
+  State state() const { return state_; }
+  bool down() const { return state_ != UP; }
+  uint32_t downMs(uint32_t nowMs) const { return down() ? nowMs - downSinceMs_ : 0; }
+  uint32_t attempts() const { return attempts_; }        // This outage
+  uint32_t outages() const { return outages_; }          // Ended ones
+  uint32_t lastRecoveryMs() const { return lastRecoveryMs_; }
+  uint32_t maxRecoveryMs() const { return maxRecoveryMs_; }
+
+  /**
+   * @brief "wifi_down_ms", "wifi_outages", "wifi_last_recovery_ms", "wifi_max_recovery_ms"
+   *
+   * Members of an open /status object.
+   */
+  void writeStatusJson(JsonWriter& json, uint32_t nowMs) const;
+
+  /**
+   * @brief esp32_wifi_outages_total, esp32_wifi_reconnect_attempts_total,
+   *        esp32_wifi_recovery_seconds{stat="last|max"}, esp32_wifi_down_seconds
+   */
+  void write(MetricsWriter& out, uint32_t nowMs) const;
+
+private:
+  uint32_t jitter(uint32_t backoffMs);
+
+  State state_ = UP;
+  uint32_t downSinceMs_ = 0;
+  uint32_t nextAttemptMs_ = 0;
+  uint32_t attemptStartMs_ = 0;
+  uint32_t backoffMs_ = INITIAL_BACKOFF_MS;
+  uint32_t attempts_ = 0;
+  uint32_t totalAttempts_ = 0;
+  uint32_t outages_ = 0;
+  uint32_t lastRecoveryMs_ = 0;
+  uint32_t maxRecoveryMs_ = 0;
+  uint32_t random_ = 1;
+  bool firstConnect_ = false;  // From start(): not an outage
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "RequestArena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+// Heap fallback blocks carry a link to the previous one, padded to ALIGNMENT
+struct FallbackHeader {
+  void* next;
+};
+const size_t HEADER_SIZE =
+    (sizeof(FallbackHeader) + RequestArena::ALIGNMENT - 1) & ~(RequestArena::ALIGNMENT - 1);
+
+size_t alignUp(size_t size) {
+  return (size + RequestArena::ALIGNMENT - 1) & ~(RequestArena::ALIGNMENT - 1);
+}
+
+}  // namespace
+
+RequestArena::RequestArena(uint8_t* buffer, size_t capacity)
+    : buffer_(buffer), capacity_(capacity) {}
+
+RequestArena::~RequestArena() {
+  reset();
+}
+
+void* RequestArena::allocate(size_t size) {
+  const size_t aligned = alignUp(size > 0 ? size : 1);
+  if (aligned <= capacity_ - used_) {
+    void* block = buffer_ + used_;
+    used_ += aligned;
+    if (used_ > highWater_) highWater_ = used_;
+    return block;
+  }
+  return allocateFallback(size);
+}
+
+void* RequestArena::allocateFallback(size_t size) {
+  uint8_t* block = (uint8_t*)malloc(HEADER_SIZE + size);
+  if (block == nullptr) return nullptr;
+  ((FallbackHeader*)block)->next = fallbacks_;
+  fallbacks_ = block;
+  fallbackCount_++;
+  fallbackBytes_ += size;
+  return block + HEADER_SIZE;
+}
+
+bool RequestArena::grow(void* ptr, size_t oldSize, size_t newSize) {
+  if (!owns(ptr)) return false;
+  const size_t offset = (uint8_t*)ptr - buffer_;
+  if (offset + alignUp(oldSize > 0 ? oldSize : 1) != used_) return false;  // Not the last block
+  const size_t aligned = alignUp(newSize > 0 ? newSize : 1);
+  if (aligned > capacity_ - offset) return false;
+  used_ = offset + aligned;
+  if (used_ > highWater_) highWater_ = used_;
+  return true;
+}
+
+char* RequestArena::copy(const char* text, size_t length) {
+  char* result = (char*)allocate(length + 1);
+  if (result == nullptr) return nullptr;
+  memcpy(result, text, length);
+  result[length] = '\0';
+  return result;
+}
+
+char* RequestArena::format(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  va_list measure;
+  va_copy(measure, args);
+  const int length = vsnprintf(nullptr, 0, format, measure);
+  va_end(measure);
+
+  char* result = length >= 0 ? (char*)allocate((size_t)length + 1) : nullptr;
+  if (result != nullptr) vsnprintf(result, (size_t)length + 1, format, args);
+  va_end(args);
+  return result;
+}
+
+void RequestArena::release(const Marker& marker) {
+  while (fallbacks_ != nullptr && fallbacks_ != marker.fallbacks) {
+    void* next = ((FallbackHeader*)fallbacks_)->next;
+    free(fallbacks_);
+    fallbacks_ = next;
+  }
+  if (marker.used < used_) used_ = marker.used;
+}
+
+void RequestArena::write(MetricsWriter& out, const char* name) const {
+  char labels[48];
+  snprintf(labels, sizeof(labels), "arena=\"%s\"", name);
+
+  out.family("request_arena_capacity_bytes", "gauge", "Per-request arena size");
+  out.sample("request_arena_capacity_bytes", labels, (int64_t)capacity_);
+  out.family("request_arena_high_water_bytes", "gauge", "Most arena bytes one request used");
+  out.sample("request_arena_high_water_bytes", labels, (int64_t)highWater_);
+  out.family("request_arena_fallbacks_total", "counter",
+             "Allocations that did not fit and went to the heap");
+  out.sample("request_arena_fallbacks_total", labels, fallbackCount_);
+  out.family("request_arena_fallback_bytes_total", "counter", "Bytes of those heap fallbacks");
+  out.sample("request_arena_fallback_bytes_total", labels, (int64_t)fallbackBytes_);
+}
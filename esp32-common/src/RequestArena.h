@@ -0,0 +1,134 @@
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Metrics.h"
+
+/**
+ * @brief Bump-pointer memory for one request, released all at once
+ *
+ * A handler's response JSON, copies and temporary strings are carved from a
+ * fixed buffer and dropped together when the request ends, instead of
+ * growing and freeing Strings on the heap. Requests leave no holes behind,
+ * so fragmentation stays where boot left it.
+ *
+ * When the buffer is full, allocate() falls back to malloc(); those blocks
+ * are chained and freed by the same release, and counted in fallbacks()
+ * so an undersized arena shows up in /metrics rather than as a crash.
+ *
+ *   RequestArena::Scope scope(arena);     // Everything below is freed here
+ *   JsonWriter json(arena);
+ *
+ * Single task: the arena belongs to the task that serves the requests.
+ */
+class RequestArena {
+public:
+  static const size_t ALIGNMENT = 8;  // Enough for uint64_t and double on both targets
+
+  /**
+   * @brief Position to return to; taken by mark(), restored by release()
+   */
+  struct Marker {
+    size_t used;
+    void* fallbacks;
+  };
+
+  /**
+   * @brief mark() on construction, release() when the scope ends
+   */
+  class Scope {
+  public:
+    explicit Scope(RequestArena& arena) : arena_(arena), marker_(arena.mark()) {}
+    ~Scope() { arena_.release(marker_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    RequestArena& arena_;
+    Marker marker_;
+  };
+
+  RequestArena(uint8_t* buffer, size_t capacity);
+  ~RequestArena();
+
+  RequestArena(const RequestArena&) = delete;
+  RequestArena& operator=(const RequestArena&) = delete;
+
+  /**
+   * @brief Aligned block from the buffer, or from the heap once it is full
+   * @return nullptr only if the heap fallback fails too
+   */
+  void* allocate(size_t size);
+
+  /**
+   * @brief Resize the most recent buffer allocation in place
+   * @return false if `ptr` is not the last allocation or the buffer is too small
+   */
+  bool grow(void* ptr, size_t oldSize, size_t newSize);
+
+  /**
+   * @brief NUL-terminated copy of `length` chars
+   */
+  char* copy(const char* text, size_t length);
+
+  /**
+   * @brief printf() into a new arena string
+   */
+  char* format(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  Marker mark() const { return Marker{used_, fallbacks_}; }
+
+  /**
+   * @brief Drop everything allocated since `marker`, heap fallbacks included
+   */
+  void release(const Marker& marker);
+
+  /**
+   * @brief release() back to empty
+   */
+  void reset() { release(Marker{0, nullptr}); }
+
+  bool owns(const void* ptr) const {
+    return (const uint8_t*)ptr >= buffer_ && (const uint8_t*)ptr < buffer_ + capacity_;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t used() const { return used_; }
+  size_t highWater() const { return highWater_; }
+  uint32_t fallbacks() const { return fallbackCount_; }
+  uint64_t fallbackBytes() const { return fallbackBytes_; }
+
+  /**
+   * @brief request_arena_* families; `name` labels this arena (a literal)
+   */
+  void write(MetricsWriter& out, const char* name) const;
+
+private:
+  void* allocateFallback(size_t size);
+
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t used_ = 0;
+  size_t highWater_ = 0;
+  void* fallbacks_ = nullptr;  // Newest heap block first
+  uint32_t fallbackCount_ = 0;
+  uint64_t fallbackBytes_ = 0;
+};
+
+/**
+ * @brief RequestArena with its own storage
+ */
+template <size_t Capacity>
+class StaticRequestArena : public RequestArena {
+public:
+  StaticRequestArena() : RequestArena(storage_, Capacity) {}
+
+private:
+  alignas(RequestArena::ALIGNMENT) uint8_t storage_[Capacity];
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "ResponseBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+ResponseBuffer::ResponseBuffer(char* buffer, size_t capacity)
+    : buffer_(buffer), capacity_(capacity) {
+  buffer_[0] = '\0';
+}
+
+ResponseBuffer& ResponseBuffer::print(const char* text) {
+  size_t available = capacity_ - 1 - length_;
+  size_t size = strlen(text);
+  if (size > available) {
+    size = available;
+    truncated_ = true;
+  }
+  memcpy(buffer_ + length_, text, size);
+  length_ += size;
+  buffer_[length_] = '\0';
+  return *this;
+}
+
+ResponseBuffer& ResponseBuffer::println(const char* text) {
+  print(text);
+  return print("\r\n");
+}
+
+ResponseBuffer& ResponseBuffer::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  return *this;
+}
+
+ResponseBuffer& ResponseBuffer::vprintf(const char* format, va_list args) {
+  size_t available = capacity_ - length_;
+  int size = vsnprintf(buffer_ + length_, available, format, args);
+  if (size < 0) return *this;
+  if ((size_t)size >= available) {
+    length_ = capacity_ - 1;
+    truncated_ = true;
+  } else {
+    length_ += size;
+  }
+  return *this;
+}
+
+void ResponseBuffer::clear() {
+  length_ = 0;
+  buffer_[0] = '\0';
+  truncated_ = false;
+}
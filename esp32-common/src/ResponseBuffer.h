@@ -0,0 +1,70 @@
+#ifndef RESPONSE_BUFFER_H
+#define RESPONSE_BUFFER_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-size text buffer for assembling a whole response before sending
+ *
+ * A multi-line reply built with repeated println() calls on SerialBT becomes
+ * one RFCOMM packet per call. Building it here first and calling flushTo()
+ * sends it as a single write (or a few chunkSize writes). Text past the
+ * capacity is dropped and flagged with truncated().
+ */
+class ResponseBuffer {
+public:
+  ResponseBuffer(char* buffer, size_t capacity);
+
+  ResponseBuffer& print(const char* text);
+  ResponseBuffer& println(const char* text = "");
+  ResponseBuffer& printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  ResponseBuffer& vprintf(const char* format, va_list args);
+
+  const char* c_str() const { return buffer_; }
+  size_t length() const { return length_; }
+  size_t capacity() const { return capacity_ - 1; }
+  bool truncated() const { return truncated_; }
+
+  void clear();
+
+  /**
+   * @brief Write the buffered text to stream and clear the buffer
+   * @param chunkSize Maximum bytes per write call (0 = one write)
+   * @return Bytes written
+   */
+  template <typename StreamT>
+  size_t flushTo(StreamT& stream, size_t chunkSize = 0) {
+    size_t written = 0;
+    while (written < length_) {
+      size_t remaining = length_ - written;
+      size_t size = (chunkSize > 0 && remaining > chunkSize) ? chunkSize : remaining;
+      size_t sent = stream.write((const uint8_t*)buffer_ + written, size);
+      if (sent == 0) break;
+      written += sent;
+    }
+    clear();
+    return written;
+  }
+
+private:
+  char* buffer_;
+  size_t capacity_;
+  size_t length_ = 0;
+  bool truncated_ = false;
+};
+
+/**
+ * @brief ResponseBuffer with its own storage for up to Capacity chars
+ */
+template <size_t Capacity>
+class StaticResponseBuffer : public ResponseBuffer {
+public:
+  StaticResponseBuffer() : ResponseBuffer(storage_, sizeof(storage_)) {}
+
+private:
+  char storage_[Capacity + 1];
+};
+
+#endif
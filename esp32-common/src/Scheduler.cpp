@@ -0,0 +1,160 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(uint32_t tickMs) : tickMs_(tickMs == 0 ? 1 : tickMs) {
+  for (int i = 0; i < WHEEL_SLOTS; i++) slots_[i] = -1;
+  for (int i = 0; i < MAX_TASKS; i++) tasks_[i] = Task{nullptr, nullptr, 0, 0, 0, -1, TASK_FREE};
+}
+
+int Scheduler::allocate(TaskFunction fn, void* context, uint32_t intervalMs) {
+  if (fn == nullptr) return INVALID_TASK;
+  for (int i = 0; i < MAX_TASKS; i++) {
+    if (tasks_[i].state == TASK_FREE) {
+      tasks_[i] = Task{fn, context, intervalMs, 0, 0, -1, TASK_FREE};
+      return i;
+    }
+  }
+  return INVALID_TASK;
+}
+
+int Scheduler::every(uint32_t intervalMs, TaskFunction fn, void* context, uint32_t now) {
+  int task = allocate(fn, context, intervalMs == 0 ? 1 : intervalMs);
+  if (task != INVALID_TASK) insert(task, now + tasks_[task].intervalMs, now);
+  return task;
+}
+
+int Scheduler::after(uint32_t delayMs, TaskFunction fn, void* context, uint32_t now) {
+  int task = allocate(fn, context, 0);
+  if (task != INVALID_TASK) insert(task, now + delayMs, now);
+  return task;
+}
+
+bool Scheduler::reschedule(int task, uint32_t delayMs, uint32_t now) {
+  if (task < 0 || task >= MAX_TASKS || tasks_[task].state == TASK_FREE) return false;
+  if (tasks_[task].state == TASK_SCHEDULED) unlink(task);
+  insert(task, now + delayMs, now);
+  return true;
+}
+
+bool Scheduler::setInterval(int task, uint32_t intervalMs, uint32_t now) {
+  if (task < 0 || task >= MAX_TASKS || tasks_[task].intervalMs == 0) return false;
+  tasks_[task].intervalMs = intervalMs == 0 ? 1 : intervalMs;
+  return reschedule(task, tasks_[task].intervalMs, now);
+}
+
+bool Scheduler::cancel(int task) {
+  if (task < 0 || task >= MAX_TASKS || tasks_[task].state == TASK_FREE) return false;
+  if (tasks_[task].state == TASK_SCHEDULED) unlink(task);
+  tasks_[task].state = TASK_FREE;
+  return true;
+}
+
+// Links the task into the slot of the first tick starting at or after deadline
+void Scheduler::insert(int task, uint32_t deadline, uint32_t now) {
+  if (!started_) {
+    tickStartMs_ = now;
+    started_ = true;
+  }
+
+  // Ticks from the current one; a deadline in the past fires on the next tick
+  int32_t ahead = (int32_t)(deadline - tickStartMs_);
+  uint32_t ticks = ahead <= 0 ? 1 : ((uint32_t)ahead + tickMs_ - 1) / tickMs_;
+  if (ticks == 0) ticks = 1;
+
+  // Slot (current + ticks) is first visited (ticks - 1) % SLOTS + 1 ticks from
+  // now, then once per revolution
+  uint32_t rounds = (ticks - 1) / WHEEL_SLOTS;
+  Task& entry = tasks_[task];
+  entry.rounds = rounds > 0xFFFF ? 0xFFFF : (uint16_t)rounds;
+  entry.deadline = tickStartMs_ + ticks * tickMs_;
+  entry.state = TASK_SCHEDULED;
+
+  int slot = (int)((currentTick_ + ticks) % WHEEL_SLOTS);
+  entry.next = slots_[slot];
+  slots_[slot] = (int8_t)task;
+}
+
+void Scheduler::unlink(int task) {
+  for (int slot = 0; slot < WHEEL_SLOTS; slot++) {
+    int8_t* link = &slots_[slot];
+    while (*link != -1) {
+      if (*link == task) {
+        *link = tasks_[task].next;
+        tasks_[task].next = -1;
+        return;
+      }
+      link = &tasks_[*link].next;
+    }
+  }
+}
+
+// Detaches the slot: tasks still rounds away go back, the rest are due
+void Scheduler::collectSlot(int slot, int8_t* due, int& dueCount) {
+  int8_t task = slots_[slot];
+  slots_[slot] = -1;
+  while (task != -1) {
+    Task& entry = tasks_[task];
+    int8_t next = entry.next;
+    if (entry.rounds > 0) {
+      entry.rounds--;
+      entry.next = slots_[slot];
+      slots_[slot] = task;
+    } else {
+      entry.state = TASK_DUE;
+      entry.next = -1;
+      due[dueCount++] = task;
+    }
+    task = next;
+  }
+}
+
+uint32_t Scheduler::run(uint32_t now) {
+  if (!started_) return 0;
+
+  uint32_t ran = 0;
+  while (now - tickStartMs_ >= tickMs_) {
+    tickStartMs_ += tickMs_;
+    currentTick_++;
+
+    int8_t due[MAX_TASKS];
+    int dueCount = 0;
+    collectSlot((int)(currentTick_ % WHEEL_SLOTS), due, dueCount);
+
+    for (int i = 0; i < dueCount; i++) {
+      Task& entry = tasks_[due[i]];
+      if (entry.state != TASK_DUE) continue;  // Cancelled by an earlier callback
+
+      if (entry.intervalMs > 0) {
+        // Keep the cadence; after a stall, skip the missed runs
+        uint32_t next = entry.deadline + entry.intervalMs;
+        if ((int32_t)(next - now) <= 0) next = now + entry.intervalMs;
+        insert(due[i], next, now);
+        entry.fn(entry.context);
+      } else {
+        entry.state = TASK_RUNNING;
+        entry.fn(entry.context);
+        if (entry.state == TASK_RUNNING) entry.state = TASK_FREE;
+      }
+      ran++;
+    }
+  }
+  return ran;
+}
+
+uint32_t Scheduler::msUntilNext(uint32_t now) const {
+  uint32_t best = NO_DEADLINE;
+  for (int i = 0; i < MAX_TASKS; i++) {
+    if (tasks_[i].state != TASK_SCHEDULED) continue;
+    int32_t remaining = (int32_t)(tasks_[i].deadline - now);
+    if (remaining <= 0) return 0;
+    if ((uint32_t)remaining < best) best = (uint32_t)remaining;
+  }
+  return best;
+}
+
+int Scheduler::activeTasks() const {
+  int count = 0;
+  for (int i = 0; i < MAX_TASKS; i++) {
+    if (tasks_[i].state != TASK_FREE) count++;
+  }
+  return count;
+}
@@ -0,0 +1,97 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+typedef void (*TaskFunction)(void* context);
+
+/**
+ * @brief Cooperative timer-wheel scheduler for periodic and one-shot work in loop()
+ *
+ * Replaces the hand-rolled `if (millis() - last >= INTERVAL)` checks. Each
+ * deadline hashes into one of WHEEL_SLOTS buckets of `tickMs`; deadlines more
+ * than one revolution away carry a round count. run() only visits the
+ * buckets whose ticks have elapsed, and msUntilNext() tells loop() how long
+ * it may idle (see LoopIdle.h). Tasks run on the loop() task, never early,
+ * and at most one tick late.
+ *
+ * Time is passed in as millis() so the scheduler stays Arduino-free.
+ */
+class Scheduler {
+public:
+  static const int MAX_TASKS = 16;
+  static const int WHEEL_SLOTS = 32;
+  static const int INVALID_TASK = -1;
+  static const uint32_t NO_DEADLINE = 0xFFFFFFFFUL;
+
+  explicit Scheduler(uint32_t tickMs = 10);
+
+  /**
+   * @brief Run fn every intervalMs, first after one interval
+   * @return task id, or INVALID_TASK if all MAX_TASKS slots are in use
+   */
+  int every(uint32_t intervalMs, TaskFunction fn, void* context, uint32_t now);
+
+  /**
+   * @brief Run fn once after delayMs; the id is released when it has run
+   */
+  int after(uint32_t delayMs, TaskFunction fn, void* context, uint32_t now);
+
+  /**
+   * @brief Move a task's next run to now + delayMs (also re-arms a one-shot
+   *        from inside its own callback)
+   */
+  bool reschedule(int task, uint32_t delayMs, uint32_t now);
+
+  /**
+   * @brief Change a periodic task's interval; the next run is now + intervalMs
+   */
+  bool setInterval(int task, uint32_t intervalMs, uint32_t now);
+
+  bool cancel(int task);
+
+  /**
+   * @brief Run every task whose deadline has passed
+   * @return number of callbacks run
+   */
+  uint32_t run(uint32_t now);
+
+  /**
+   * @brief Milliseconds until the next deadline (0 if one is due, NO_DEADLINE if idle)
+   */
+  uint32_t msUntilNext(uint32_t now) const;
+
+  int activeTasks() const;
+
+private:
+  enum TaskState : uint8_t {
+    TASK_FREE,
+    TASK_SCHEDULED,  // Linked into a wheel slot
+    TASK_DUE,        // Collected by run(), callback pending
+    TASK_RUNNING     // One-shot inside its callback
+  };
+
+  struct Task {
+    TaskFunction fn;
+    void* context;
+    uint32_t intervalMs;  // 0 = one-shot
+    uint32_t deadline;    // millis() of the tick it fires on
+    uint16_t rounds;      // Full wheel revolutions left
+    int8_t next;          // Next task in the same slot, -1 = end
+    TaskState state;
+  };
+
+  int allocate(TaskFunction fn, void* context, uint32_t intervalMs);
+  void insert(int task, uint32_t deadline, uint32_t now);
+  void unlink(int task);
+  void collectSlot(int slot, int8_t* due, int& dueCount);
+
+  uint32_t tickMs_;
+  uint32_t tickStartMs_ = 0;  // millis() at the start of currentTick_
+  uint32_t currentTick_ = 0;
+  bool started_ = false;
+  int8_t slots_[WHEEL_SLOTS];
+  Task tasks_[MAX_TASKS];
+};
+
+#endif
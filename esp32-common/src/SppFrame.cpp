@@ -0,0 +1,92 @@
+#include "SppFrame.h"
+
+#include <string.h>
+
+uint16_t sppCrc16(const uint8_t* data, size_t length, uint16_t crc) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t sppEncodeFrame(uint8_t* out, uint8_t requestId, uint8_t command,
+                      const uint8_t* payload, uint8_t length) {
+  if (length > SPP_FRAME_MAX_PAYLOAD) return 0;
+
+  out[0] = SPP_FRAME_SYNC;
+  out[1] = length;
+  out[2] = requestId;
+  out[3] = command;
+  if (length > 0) memcpy(out + SPP_FRAME_HEADER_SIZE, payload, length);
+
+  uint16_t crc = sppCrc16(out + 1, SPP_FRAME_HEADER_SIZE - 1 + length);
+  out[SPP_FRAME_HEADER_SIZE + length] = (uint8_t)(crc >> 8);
+  out[SPP_FRAME_HEADER_SIZE + length + 1] = (uint8_t)(crc & 0xFF);
+  return SPP_FRAME_HEADER_SIZE + length + SPP_FRAME_CRC_SIZE;
+}
+
+SppFrameDecoder::Result SppFrameDecoder::feed(uint8_t b) {
+  switch (state_) {
+    case WAIT_SYNC:
+      if (b == SPP_FRAME_SYNC) {
+        crc_ = 0xFFFF;
+        frame_.requestId = 0;
+        state_ = READ_LENGTH;
+      }
+      return FRAME_PENDING;
+
+    case READ_LENGTH:
+      crc_ = sppCrc16(&b, 1, crc_);
+      // An oversized frame is still read to the end, so its payload never
+      // reaches the text path and the error can carry its request id
+      tooLong_ = b > SPP_FRAME_MAX_PAYLOAD;
+      frame_.length = tooLong_ ? 0 : b;
+      discard_ = (uint16_t)b + SPP_FRAME_CRC_SIZE;
+      state_ = READ_REQUEST_ID;
+      return FRAME_PENDING;
+
+    case READ_REQUEST_ID:
+      crc_ = sppCrc16(&b, 1, crc_);
+      frame_.requestId = b;
+      state_ = READ_COMMAND;
+      return FRAME_PENDING;
+
+    case READ_COMMAND:
+      crc_ = sppCrc16(&b, 1, crc_);
+      frame_.command = b;
+      received_ = 0;
+      if (tooLong_) {
+        state_ = DISCARD;
+      } else {
+        state_ = frame_.length > 0 ? READ_PAYLOAD : READ_CRC_HI;
+      }
+      return FRAME_PENDING;
+
+    case READ_PAYLOAD:
+      crc_ = sppCrc16(&b, 1, crc_);
+      frame_.payload[received_++] = b;
+      if (received_ == frame_.length) state_ = READ_CRC_HI;
+      return FRAME_PENDING;
+
+    case READ_CRC_HI:
+      crc_ ^= (uint16_t)b << 8;
+      state_ = READ_CRC_LO;
+      return FRAME_PENDING;
+
+    case READ_CRC_LO:
+      crc_ ^= b;
+      state_ = WAIT_SYNC;
+      return crc_ == 0 ? FRAME_READY : FRAME_BAD_CRC;
+
+    case DISCARD:
+      if (--discard_ > 0) return FRAME_PENDING;
+      state_ = WAIT_SYNC;
+      return FRAME_TOO_LONG;
+  }
+
+  state_ = WAIT_SYNC;
+  return FRAME_PENDING;
+}
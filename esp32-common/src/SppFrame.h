@@ -0,0 +1,120 @@
+#ifndef SPP_FRAME_H
+#define SPP_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary command framing for the Bluetooth SPP (RFCOMM) link
+ *
+ *   [0]    SYNC     0xA5 (never a printable character, so text terminals are unaffected)
+ *   [1]    LEN      Payload length, 0..SPP_FRAME_MAX_PAYLOAD
+ *   [2]    REQ_ID   Request id chosen by the client, echoed in the reply
+ *   [3]    CMD      Command id; replies use CMD | SPP_REPLY_FLAG
+ *   [4..]  PAYLOAD  LEN bytes
+ *   [..]   CRC16    CRC-16/CCITT-FALSE over LEN..PAYLOAD, big-endian
+ *
+ * Every reply payload starts with a result code (SppResult).
+ * Multi-byte payload fields are big-endian.
+ */
+
+const uint8_t SPP_FRAME_SYNC = 0xA5;
+const uint8_t SPP_FRAME_HEADER_SIZE = 4;
+const uint8_t SPP_FRAME_CRC_SIZE = 2;
+const uint8_t SPP_FRAME_MAX_PAYLOAD = 32;
+const uint8_t SPP_FRAME_MAX_SIZE = SPP_FRAME_HEADER_SIZE + SPP_FRAME_MAX_PAYLOAD + SPP_FRAME_CRC_SIZE;
+const uint8_t SPP_REPLY_FLAG = 0x80;
+
+/**
+ * @brief Command ids
+ */
+enum SppCommand : uint8_t {
+  SPP_CMD_PING       = 0x01,  // -> [result]
+  SPP_CMD_STATUS     = 0x02,  // -> [result][led][wifi][rssi:i8][uptime_s:u32][heap:u32]
+  SPP_CMD_LED_SET    = 0x10,  // [state] -> [result][led]
+  SPP_CMD_LED_TOGGLE = 0x11,  // -> [result][led]
+  SPP_CMD_ERROR      = 0x7F   // Device-originated reply to a frame it could not decode
+};
+
+/**
+ * @brief Result codes (first byte of every reply payload)
+ */
+enum SppResult : uint8_t {
+  SPP_OK              = 0x00,
+  SPP_ERR_UNKNOWN_CMD = 0x01,
+  SPP_ERR_BAD_LENGTH  = 0x02,
+  SPP_ERR_BAD_CRC     = 0x03,
+  SPP_ERR_TOO_LONG    = 0x04,
+  SPP_ERR_TIMEOUT     = 0x05
+};
+
+/**
+ * @brief Decoded frame
+ */
+struct SppFrame {
+  uint8_t requestId;
+  uint8_t command;
+  uint8_t length;
+  uint8_t payload[SPP_FRAME_MAX_PAYLOAD];
+};
+
+/**
+ * @brief Write a big-endian u32 payload field, returns bytes written
+ */
+inline uint8_t sppPutU32(uint8_t* out, uint32_t value) {
+  out[0] = (uint8_t)(value >> 24);
+  out[1] = (uint8_t)(value >> 16);
+  out[2] = (uint8_t)(value >> 8);
+  out[3] = (uint8_t)value;
+  return 4;
+}
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ */
+uint16_t sppCrc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Encode a frame into out (at least SPP_FRAME_MAX_SIZE bytes)
+ * @return Encoded size, or 0 if the payload is too long
+ */
+size_t sppEncodeFrame(uint8_t* out, uint8_t requestId, uint8_t command,
+                      const uint8_t* payload, uint8_t length);
+
+/**
+ * @brief Incremental frame decoder, fed one byte at a time
+ */
+class SppFrameDecoder {
+public:
+  enum Result : uint8_t {
+    FRAME_PENDING,
+    FRAME_READY,      // frame() holds a valid frame
+    FRAME_BAD_CRC,
+    FRAME_TOO_LONG    // Reported once the whole oversized frame has been skipped
+  };
+
+  Result feed(uint8_t b);
+
+  /**
+   * @brief True while a frame is partially received or being skipped
+   */
+  bool active() const { return state_ != WAIT_SYNC; }
+
+  /**
+   * @brief The last frame; requestId is 0 until the current frame's id is read
+   */
+  const SppFrame& frame() const { return frame_; }
+  void reset() { state_ = WAIT_SYNC; }
+
+private:
+  enum State : uint8_t { WAIT_SYNC, READ_LENGTH, READ_REQUEST_ID, READ_COMMAND, READ_PAYLOAD, READ_CRC_HI, READ_CRC_LO, DISCARD };
+
+  State state_ = WAIT_SYNC;
+  SppFrame frame_;
+  uint8_t received_ = 0;
+  uint16_t crc_ = 0;
+  bool tooLong_ = false;
+  uint16_t discard_ = 0;  // Payload and CRC bytes left of an oversized frame
+};
+
+#endif
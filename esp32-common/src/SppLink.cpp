@@ -0,0 +1,21 @@
+#include "SppLink.h"
+
+SppLink::Event SppLink::feedFrame(uint8_t b) {
+  switch (frames_.feed(b)) {
+    case SppFrameDecoder::FRAME_READY:
+      framesReceived_++;
+      return SPP_FRAME;
+    case SppFrameDecoder::FRAME_BAD_CRC:
+      return frameError(SPP_ERR_BAD_CRC);
+    case SppFrameDecoder::FRAME_TOO_LONG:
+      return frameError(SPP_ERR_TOO_LONG);
+    default:
+      return SPP_NONE;
+  }
+}
+
+SppLink::Event SppLink::frameError(SppResult error) {
+  error_ = error;
+  frameErrors_++;
+  return SPP_FRAME_ERROR;
+}
@@ -0,0 +1,108 @@
+#ifndef SPP_LINK_H
+#define SPP_LINK_H
+
+#include "LineAssembler.h"
+#include "SppFrame.h"
+
+/**
+ * @brief Text/binary demultiplexer for a Bluetooth SPP stream
+ *
+ * Each message is classified by its first byte: SPP_FRAME_SYNC starts a
+ * binary frame (see SppFrame.h), anything else goes to the line assembler.
+ * Text terminals keep working unchanged while a gateway app uses frames on
+ * the same link. Neither path ever blocks.
+ */
+class SppLink {
+public:
+  enum Event : uint8_t {
+    SPP_NONE,
+    SPP_LINE,           // line() holds a text command
+    SPP_LINE_OVERFLOW,  // A text command exceeded the line buffer
+    SPP_FRAME,          // frame() holds a valid binary frame
+    SPP_FRAME_ERROR     // A binary frame was dropped, see error()
+  };
+
+  static const uint32_t FRAME_TIMEOUT_MS = 250;  // Drop a frame stalled mid-way
+
+  explicit SppLink(LineAssembler& lines) : lines_(lines) {}
+
+  /**
+   * @brief Consume available bytes until one message completes or input runs dry
+   */
+  template <typename StreamT>
+  Event poll(StreamT& stream, uint32_t nowMs) {
+    while (stream.available() > 0) {
+      int c = stream.read();
+      if (c < 0) break;
+      lastByteMs_ = nowMs;
+
+      if (frames_.active() || (lines_.empty() && c == SPP_FRAME_SYNC)) {
+        // Text and frames start clean: a '\r' before a frame must not
+        // swallow the first '\n' after it
+        if (!frames_.active()) lines_.reset();
+        Event event = feedFrame((uint8_t)c);
+        if (event == SPP_NONE) continue;
+        lines_.reset();
+        return event;
+      }
+
+      switch (lines_.feed((char)c, nowMs)) {
+        case LineAssembler::LINE_READY: return SPP_LINE;
+        case LineAssembler::LINE_OVERFLOW: return SPP_LINE_OVERFLOW;
+        default: break;
+      }
+    }
+
+    if (frames_.active() && nowMs - lastByteMs_ >= FRAME_TIMEOUT_MS) {
+      frames_.reset();
+      lines_.reset();
+      return frameError(SPP_ERR_TIMEOUT);
+    }
+    return lines_.flushIfIdle(nowMs) == LineAssembler::LINE_READY ? SPP_LINE : SPP_NONE;
+  }
+
+  const char* line() const { return lines_.line(); }
+  size_t lineLength() const { return lines_.length(); }
+  const SppFrame& frame() const { return frames_.frame(); }
+  SppResult error() const { return error_; }
+
+  /**
+   * @brief Send a reply to request as a single write
+   */
+  template <typename StreamT>
+  void reply(StreamT& stream, const SppFrame& request, const uint8_t* payload, uint8_t length) {
+    uint8_t out[SPP_FRAME_MAX_SIZE];
+    size_t size = sppEncodeFrame(out, request.requestId, request.command | SPP_REPLY_FLAG, payload, length);
+    if (size > 0) stream.write(out, size);
+  }
+
+  /**
+   * @brief Report the last SPP_FRAME_ERROR to the client
+   *
+   * The request id is best effort: it may be corrupt when the CRC failed, and
+   * is 0 when the frame stalled before its id arrived.
+   */
+  template <typename StreamT>
+  void replyError(StreamT& stream) {
+    uint8_t out[SPP_FRAME_MAX_SIZE];
+    uint8_t code = error_;
+    size_t size = sppEncodeFrame(out, frames_.frame().requestId, SPP_CMD_ERROR | SPP_REPLY_FLAG, &code, 1);
+    stream.write(out, size);
+  }
+
+  uint32_t framesReceived() const { return framesReceived_; }
+  uint32_t frameErrors() const { return frameErrors_; }
+
+private:
+  Event feedFrame(uint8_t b);
+  Event frameError(SppResult error);
+
+  LineAssembler& lines_;
+  SppFrameDecoder frames_;
+  SppResult error_ = SPP_OK;
+  uint32_t lastByteMs_ = 0;
+  uint32_t framesReceived_ = 0;
+  uint32_t frameErrors_ = 0;
+};
+
+#endif
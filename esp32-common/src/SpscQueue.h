@@ -0,0 +1,99 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#if defined(ESP_PLATFORM)
+// Internal SRAM is not cached per core, so there is no false sharing to avoid
+#define QUEUE_INDEX_ALIGN 4
+#else
+#define QUEUE_INDEX_ALIGN 64
+#endif
+
+/**
+ * @brief Bounded lock-free queue between exactly one producer and one consumer task
+ *
+ * Carries commands and events between the network and application cores
+ * without a mutex or a FreeRTOS queue copy through the kernel. push() is
+ * only ever called from the producer task and pop() only from the consumer
+ * task; each side owns one index and reads the other's with acquire
+ * ordering. Neither call blocks: a full queue makes push() return false and
+ * the caller decides whether to drop or reply "busy".
+ *
+ *   SpscQueue<NetEvent, 32> events;
+ *
+ *   // Application task
+ *   events.push(event);
+ *
+ *   // Network task
+ *   NetEvent event;
+ *   while (events.pop(event)) deliver(event);
+ *
+ * CAPACITY must be a power of two. Items are copied, so T should be a small
+ * trivially copyable struct.
+ */
+template <typename T, uint32_t CAPACITY>
+class SpscQueue {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+                "SpscQueue capacity must be a power of two");
+
+public:
+  /**
+   * @brief Producer side
+   * @return false if the queue is full (item not queued)
+   */
+  bool push(const T& item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - headCache_ == CAPACITY) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail - headCache_ == CAPACITY) return false;
+    }
+    items_[tail & MASK] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Consumer side
+   * @return false if the queue is empty
+   */
+  bool pop(T& item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tailCache_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head == tailCache_) return false;
+    }
+    item = items_[head & MASK];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Approximate from any task, exact from the producer or consumer when the other is idle
+   */
+  uint32_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  static uint32_t capacity() { return CAPACITY; }
+
+private:
+  static const uint32_t MASK = CAPACITY - 1;
+
+  // Consumer-owned line: its index plus its cached view of the producer's
+  alignas(QUEUE_INDEX_ALIGN) std::atomic<uint32_t> head_{0};
+  uint32_t tailCache_ = 0;
+
+  // Producer-owned line
+  alignas(QUEUE_INDEX_ALIGN) std::atomic<uint32_t> tail_{0};
+  uint32_t headCache_ = 0;
+
+  alignas(QUEUE_INDEX_ALIGN) T items_[CAPACITY];
+};
+
+#endif
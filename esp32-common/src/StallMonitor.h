@@ -0,0 +1,92 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+
+#include "StallWatchdog.h"
+
+/**
+ * @brief Monitor task and section macro for StallWatchdog (header-only, ESP32)
+ *
+ *   StallWatchdog stallWatchdog(200);       // ms without a tick that count as a stall
+ *
+ *   bool sendDataToAPI() {
+ *     STALL_SECTION(stallWatchdog, "send_data");  // Rest of the function
+ *     ...
+ *   }
+ *
+ *   void setup() {
+ *     ...
+ *     StallMonitor::begin(stallWatchdog);    // Last, right before loop() starts
+ *   }
+ *
+ *   void loop() {
+ *     stallWatchdog.tick(millis());
+ *     ...
+ *   }
+ *
+ * The monitor task wakes every quarter threshold at the highest application
+ * priority, so it runs even while loop() spins, and prints one Serial line
+ * per stall while it is still going on. The table itself is recorded by
+ * the loop task when the stall ends; a stall that ends in a restart or a
+ * hang only leaves that line.
+ */
+namespace StallMonitor {
+
+const uint32_t TASK_STACK = 3072;  // Serial.printf()
+const UBaseType_t TASK_PRIORITY = configMAX_PRIORITIES - 1;  // Above loop() and the network tasks
+
+inline void monitorTask(void* parameter) {
+  StallWatchdog& watchdog = *(StallWatchdog*)parameter;
+  const uint32_t periodMs = watchdog.thresholdMs() >= 4 ? watchdog.thresholdMs() / 4 : 1;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(periodMs));
+    const uint32_t now = millis();
+    if (!watchdog.check(now)) continue;
+    const char* section = watchdog.stalledSection();
+    Serial.printf("⚠️ Stall: loop() blocked for %lu ms in %s\n",
+                  (unsigned long)watchdog.sinceTickMs(now),
+                  section != nullptr ? section : StallWatchdog::UNNAMED);
+  }
+}
+
+/**
+ * @brief Start ticking and the monitor task (end of setup())
+ */
+inline bool begin(StallWatchdog& watchdog) {
+  watchdog.tick(millis());
+  return xTaskCreate(monitorTask, "stall_monitor", TASK_STACK, &watchdog, TASK_PRIORITY,
+                     nullptr) == pdPASS;
+}
+
+/**
+ * @brief Names the enclosing scope for stalls; the name must be a literal
+ */
+class Section {
+public:
+  Section(StallWatchdog& watchdog, const char* name)
+      : watchdog_(watchdog), name_(name), previous_(watchdog.enter(name)), start_(millis()) {}
+  ~Section() { watchdog_.leave(previous_, name_, millis() - start_); }
+
+  Section(const Section&) = delete;
+  Section& operator=(const Section&) = delete;
+
+private:
+  StallWatchdog& watchdog_;
+  const char* name_;
+  const char* previous_;
+  uint32_t start_;
+};
+
+/**
+ * @brief watchdog.report() as of now
+ */
+inline void report(const StallWatchdog& watchdog, ResponseBuffer& out) {
+  watchdog.report(out, millis());
+}
+
+}  // namespace StallMonitor
+
+#define STALL_SECTION(watchdog, name) StallMonitor::Section stallSection_((watchdog), (name))
+
+#endif
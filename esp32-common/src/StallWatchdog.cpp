@@ -0,0 +1,84 @@
+#include "StallWatchdog.h"
+
+const char* const StallWatchdog::UNNAMED = "loop";
+
+StallWatchdog::StallWatchdog(uint32_t thresholdMs) : thresholdMs_(thresholdMs) {}
+
+void StallWatchdog::tick(uint32_t nowMs) {
+  const uint32_t pass = pass_.load(std::memory_order_relaxed);
+  const uint32_t last = lastTickMs_.load(std::memory_order_relaxed);
+  if (started_ && nowMs - last >= thresholdMs_) {
+    const char* section = passSection_;
+    if (section == nullptr && seenPass_.load(std::memory_order_acquire) == pass) {
+      section = seenSection_.load(std::memory_order_relaxed);
+    }
+    section = section != nullptr ? section : UNNAMED;
+    record(section, nowMs - last, last);
+    if (listener_ != nullptr) listener_(section, nowMs - last, true, listenerContext_);
+  }
+  started_ = true;
+  passSection_ = nullptr;
+  // Time first: check() reads the pass first, so a new pass always comes with its time
+  lastTickMs_.store(nowMs, std::memory_order_release);
+  pass_.store(pass + 1, std::memory_order_release);
+}
+
+bool StallWatchdog::check(uint32_t nowMs) {
+  const uint32_t pass = pass_.load(std::memory_order_acquire);
+  if (pass == 0 || pass == reportedPass_) return false;  // Not started / already seen
+  if (nowMs - lastTickMs_.load(std::memory_order_acquire) < thresholdMs_) return false;
+
+  const char* section = current_.load(std::memory_order_relaxed);
+  seenSection_.store(section, std::memory_order_relaxed);
+  seenPass_.store(pass, std::memory_order_release);
+  reportedPass_ = pass;
+  if (listener_ != nullptr) {
+    listener_(section != nullptr ? section : UNNAMED, sinceTickMs(nowMs), false,
+              listenerContext_);
+  }
+  return true;
+}
+
+void StallWatchdog::record(const char* section, uint32_t durationMs, uint32_t startMs) {
+  total_++;
+  totalMs_ += durationMs;
+
+  // Sorted longest first; a stall shorter than all TOP_STALLS is only counted
+  uint8_t index;
+  if (count_ < TOP_STALLS) {
+    index = count_++;
+  } else if (worst_[TOP_STALLS - 1].durationMs < durationMs) {
+    index = TOP_STALLS - 1;
+  } else {
+    return;
+  }
+  while (index > 0 && worst_[index - 1].durationMs < durationMs) {
+    worst_[index] = worst_[index - 1];
+    index--;
+  }
+  worst_[index] = Stall{section, durationMs, startMs};
+}
+
+void StallWatchdog::reset() {
+  total_ = 0;
+  totalMs_ = 0;
+  count_ = 0;
+}
+
+void StallWatchdog::report(ResponseBuffer& out, uint32_t nowMs) const {
+  out.printf("Stalls over %lu ms: %lu, %llu ms in total\n", (unsigned long)thresholdMs_,
+             (unsigned long)total_, (unsigned long long)totalMs_);
+  out.printf("%-20s %10s %12s\n", "section", "ms", "ago_s");
+  for (uint8_t i = 0; i < count_; i++) {
+    const Stall& s = worst_[i];
+    out.printf("%-20s %10lu %12lu\n", s.section, (unsigned long)s.durationMs,
+               (unsigned long)((nowMs - s.startMs) / 1000));
+  }
+}
+
+void StallWatchdog::write(MetricsWriter& out) const {
+  out.counter("loop_stalls_total", "loop() passes longer than the stall threshold", total_);
+  out.family("loop_stall_max_seconds", "gauge", "Longest loop() stall since boot or reset");
+  out.sampleSeconds("loop_stall_max_seconds", nullptr,
+                    count_ > 0 ? (uint64_t)worst_[0].durationMs * 1000 : 0);
+}
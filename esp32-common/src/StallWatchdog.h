@@ -0,0 +1,145 @@
+#ifndef STALL_WATCHDOG_H
+#define STALL_WATCHDOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "Metrics.h"
+#include "ResponseBuffer.h"
+
+/**
+ * @brief Records loop() passes that took longer than a threshold, and where
+ *
+ * The loop task calls tick() once per pass and wraps blocking calls
+ * (HTTP requests, delay() loops, broker connects) in named sections. When a
+ * pass runs over the threshold, the stall is attributed to the innermost
+ * section that took the threshold by itself; if none did, to the section a
+ * monitor task saw active through check() while the loop was stuck; else to
+ * "loop" (uninstrumented code). The worst TOP_STALLS are kept.
+ *
+ * check() runs on another, higher priority task, so a loop that never comes
+ * back is still noticed. It only reads atomics and publishes the section it
+ * saw; everything else belongs to the loop task. StallMonitor.h adds the
+ * clock, the monitor task and the section macro.
+ */
+class StallWatchdog {
+public:
+  static const uint8_t TOP_STALLS = 8;
+
+  /**
+   * @brief Name used when no section was active
+   */
+  static const char* const UNNAMED;
+
+  struct Stall {
+    const char* section;  // Literal passed to enter()
+    uint32_t durationMs;  // From the tick before the stall to the tick after it
+    uint32_t startMs;     // millis() of the tick before the stall
+  };
+
+  /**
+   * @brief Called when a stall is first seen (monitor task, `ended` false) and
+   *        when it ends (loop task, `ended` true)
+   */
+  typedef void (*StallListener)(const char* section, uint32_t durationMs, bool ended,
+                                void* context);
+
+  explicit StallWatchdog(uint32_t thresholdMs);
+
+  /**
+   * @brief Also report stalls to `listener` (setup(), before StallMonitor::begin())
+   */
+  void onStall(StallListener listener, void* context) {
+    listener_ = listener;
+    listenerContext_ = context;
+  }
+
+  /**
+   * @brief End of one loop() pass (loop task)
+   */
+  void tick(uint32_t nowMs);
+
+  /**
+   * @brief A named section starts (loop task); `section` must be a literal
+   * @return The enclosing section, to hand back to leave()
+   */
+  const char* enter(const char* section) {
+    return current_.exchange(section, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief The section entered with enter() ended after `elapsedMs` (loop task)
+   */
+  void leave(const char* previous, const char* section, uint32_t elapsedMs) {
+    current_.store(previous, std::memory_order_relaxed);
+    // Inner sections end first: the first one over the threshold is the most precise name
+    if (elapsedMs >= thresholdMs_ && passSection_ == nullptr) passSection_ = section;
+  }
+
+  /**
+   * @brief Look for a loop that has not ticked for the threshold (monitor task)
+   * @return true once per stall, when it is first seen
+   */
+  bool check(uint32_t nowMs);
+
+  /**
+   * @brief Section the last check() caught the loop in (nullptr: none)
+   */
+  const char* stalledSection() const { return seenSection_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief How long the loop has gone without a tick
+   */
+  uint32_t sinceTickMs(uint32_t nowMs) const {
+    return nowMs - lastTickMs_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Forget the recorded stalls (loop task)
+   */
+  void reset();
+
+  uint32_t thresholdMs() const { return thresholdMs_; }
+  uint32_t total() const { return total_; }
+  uint8_t count() const { return count_; }
+  const Stall& stall(uint8_t index) const { return worst_[index]; }
+
+  /**
+   * @brief Text table of the worst stalls, longest first (loop task)
+   */
+  void report(ResponseBuffer& out, uint32_t nowMs) const;
+
+  /**
+   * @brief loop_stalls_total and loop_stall_max_seconds (loop task)
+   */
+  void write(MetricsWriter& out) const;
+
+private:
+  void record(const char* section, uint32_t durationMs, uint32_t startMs);
+
+  const uint32_t thresholdMs_;
+  StallListener listener_ = nullptr;
+  void* listenerContext_ = nullptr;
+
+  // Shared with check()
+  std::atomic<const char*> current_{nullptr};
+  std::atomic<uint32_t> lastTickMs_{0};
+  std::atomic<uint32_t> pass_{0};            // Incremented by every tick()
+  std::atomic<uint32_t> seenPass_{UINT32_MAX};  // Pass check() caught stalling
+  std::atomic<const char*> seenSection_{nullptr};
+
+  // Loop task only
+  bool started_ = false;
+  const char* passSection_ = nullptr;
+  uint32_t total_ = 0;
+  uint64_t totalMs_ = 0;
+  uint8_t count_ = 0;
+  Stall worst_[TOP_STALLS];
+
+  // Monitor task only
+  uint32_t reportedPass_ = UINT32_MAX;
+};
+
+#endif
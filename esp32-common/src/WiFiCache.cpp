@@ -0,0 +1,101 @@
+#include "WiFiCache.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "SppFrame.h"  // sppCrc16
+
+void WiFiCache::clear() {
+  memset(&record_, 0, sizeof(record_));
+  record_.version = FORMAT_VERSION;
+}
+
+bool WiFiCache::setCredentials(const char* ssid, const char* password) {
+  if (password == nullptr) password = "";
+  size_t ssidLength = ssid != nullptr ? strlen(ssid) : 0;
+  size_t passwordLength = strlen(password);
+  if (ssidLength == 0 || ssidLength >= SSID_SIZE || passwordLength >= PASSWORD_SIZE) return false;
+
+  if (strcmp(record_.ssid, ssid) != 0) {
+    forgetAp();
+    if (!staticAddress()) forgetLease();  // A static address is set for the network in use
+  }
+  memset(record_.ssid, 0, sizeof(record_.ssid));
+  memset(record_.password, 0, sizeof(record_.password));
+  memcpy(record_.ssid, ssid, ssidLength);
+  memcpy(record_.password, password, passwordLength);
+  return true;
+}
+
+bool WiFiCache::rememberAp(const uint8_t bssid[6], uint8_t channel) {
+  if (hasAp() && record_.channel == channel && memcmp(record_.bssid, bssid, 6) == 0) return false;
+  memcpy(record_.bssid, bssid, 6);
+  record_.channel = channel;
+  record_.flags |= HAS_AP;
+  return true;
+}
+
+void WiFiCache::forgetAp() {
+  memset(record_.bssid, 0, sizeof(record_.bssid));
+  record_.channel = 0;
+  record_.flags &= ~HAS_AP;
+}
+
+bool WiFiCache::rememberLease(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns) {
+  if (staticAddress() || ip == 0) return false;
+  if ((record_.flags & HAS_LEASE) != 0 && record_.ip == ip && record_.gateway == gateway &&
+      record_.subnet == subnet && record_.dns == dns) {
+    return false;
+  }
+  setAddress(ip, gateway, subnet, dns);
+  record_.flags |= HAS_LEASE;
+  return true;
+}
+
+void WiFiCache::forgetLease() {
+  if (staticAddress()) return;
+  setAddress(0, 0, 0, 0);
+  record_.flags &= ~HAS_LEASE;
+}
+
+void WiFiCache::setStaticAddress(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns) {
+  record_.flags &= ~(HAS_LEASE | STATIC_ADDRESS);
+  if (ip == 0) {
+    setAddress(0, 0, 0, 0);
+    return;
+  }
+  setAddress(ip, gateway, subnet, dns);
+  record_.flags |= STATIC_ADDRESS;
+}
+
+void WiFiCache::setAddress(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns) {
+  record_.ip = ip;
+  record_.gateway = gateway;
+  record_.subnet = subnet;
+  record_.dns = dns;
+}
+
+uint16_t WiFiCache::checksum(const Record& record) {
+  static_assert(sizeof(Record) == STORED_SIZE, "record layout changed: bump FORMAT_VERSION and STORED_SIZE");
+  return sppCrc16((const uint8_t*)&record, offsetof(Record, crc));
+}
+
+void WiFiCache::store(uint8_t* out) const {
+  Record record;
+  memcpy(&record, &record_, sizeof(record));  // A plain copy may skip the padding
+  record.crc = checksum(record);
+  memcpy(out, &record, sizeof(record));
+}
+
+bool WiFiCache::restore(const uint8_t* data, size_t length) {
+  if (data != nullptr && length == STORED_SIZE) {
+    memcpy(&record_, data, sizeof(record_));
+    if (record_.version == FORMAT_VERSION && record_.crc == checksum(record_) &&
+        record_.ssid[SSID_SIZE - 1] == '\0' && record_.password[PASSWORD_SIZE - 1] == '\0') {
+      record_.crc = 0;
+      return true;
+    }
+  }
+  clear();
+  return false;
+}
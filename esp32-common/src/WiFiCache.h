@@ -0,0 +1,98 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief WiFi credentials plus what a reboot needs to skip the scan and DHCP
+ *
+ * Kept in NVS as one fixed-size, versioned, CRC-checked blob (FastWiFi.h
+ * does the NVS and WiFi calls). The access point is the BSSID and channel
+ * of the last connection; the address is either the last DHCP lease or a
+ * static one, which a lease never replaces. Changing the SSID drops both.
+ * Addresses are IPAddress values as uint32_t.
+ */
+class WiFiCache {
+public:
+  static const size_t SSID_SIZE = 33;      // 32 chars max per 802.11
+  static const size_t PASSWORD_SIZE = 65;  // 63-char passphrase or 64 hex digits
+  static const uint8_t FORMAT_VERSION = 1;
+
+  WiFiCache() { clear(); }
+
+  void clear();
+
+  /**
+   * @return false (nothing changed) when ssid is empty or either is too long
+   */
+  bool setCredentials(const char* ssid, const char* password);
+  bool hasCredentials() const { return record_.ssid[0] != '\0'; }
+  const char* ssid() const { return record_.ssid; }
+  const char* password() const { return record_.password; }
+
+  /**
+   * @return true when the AP differs from the cached one (save the cache)
+   */
+  bool rememberAp(const uint8_t bssid[6], uint8_t channel);
+  void forgetAp();
+  bool hasAp() const { return (record_.flags & HAS_AP) != 0; }
+  const uint8_t* bssid() const { return record_.bssid; }
+  uint8_t channel() const { return record_.channel; }
+
+  /**
+   * @return true when the lease differs from the cached address (save the
+   *         cache); always false with a static address
+   */
+  bool rememberLease(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns);
+  void forgetLease();
+
+  /**
+   * @brief Fixed address for every boot; ip 0 returns to DHCP
+   */
+  void setStaticAddress(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns);
+
+  bool hasAddress() const { return (record_.flags & (HAS_LEASE | STATIC_ADDRESS)) != 0; }
+  bool staticAddress() const { return (record_.flags & STATIC_ADDRESS) != 0; }
+  uint32_t ip() const { return record_.ip; }
+  uint32_t gateway() const { return record_.gateway; }
+  uint32_t subnet() const { return record_.subnet; }
+  uint32_t dns() const { return record_.dns; }
+
+  /**
+   * @brief Stored form: always STORED_SIZE bytes
+   */
+  static const size_t STORED_SIZE = 128;
+  void store(uint8_t* out) const;
+
+  /**
+   * @return false, with the cache cleared, on a wrong size, version or CRC
+   */
+  bool restore(const uint8_t* data, size_t length);
+
+private:
+  static const uint8_t HAS_AP = 0x01;
+  static const uint8_t HAS_LEASE = 0x02;
+  static const uint8_t STATIC_ADDRESS = 0x04;
+
+  struct Record {
+    uint8_t version;
+    uint8_t flags;
+    uint8_t channel;
+    uint8_t bssid[6];
+    char ssid[SSID_SIZE];
+    char password[PASSWORD_SIZE];
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint16_t crc;  // Over every byte before it, padding included (cleared)
+  };
+
+  static uint16_t checksum(const Record& record);
+  void setAddress(uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns);
+
+  Record record_;
+};
+
+#endif
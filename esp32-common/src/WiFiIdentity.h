@@ -0,0 +1,66 @@
+#ifndef WIFI_IDENTITY_H
+#define WIFI_IDENTITY_H
+
+#include <WiFi.h>
+
+#include "DeviceIdentity.h"
+
+/**
+ * @brief Keeps a DeviceIdentity in sync with the WiFi station interface
+ *
+ * WiFi events run on the system event task, so the handler only marks the
+ * cache dirty; refresh() re-reads MAC, IP and SSID from loop(). Header-only
+ * so Bluetooth-only sketches do not pull in the WiFi stack.
+ */
+namespace WiFiIdentity {
+
+inline volatile bool& dirtyFlag() {
+  static volatile bool dirty = true;
+  return dirty;
+}
+
+inline DeviceIdentity*& target() {
+  static DeviceIdentity* identity = nullptr;
+  return identity;
+}
+
+inline void onEvent(WiFiEvent_t) {
+  dirtyFlag() = true;
+}
+
+/**
+ * @brief Update the cache if a network event arrived since the last call
+ * @return true if the identity was refreshed
+ */
+inline bool refresh() {
+  DeviceIdentity* identity = target();
+  if (identity == nullptr || !dirtyFlag()) return false;
+  dirtyFlag() = false;
+
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  identity->setWifiMac(mac);
+
+  if (WiFi.status() == WL_CONNECTED) {
+    IPAddress ip = WiFi.localIP();
+    identity->setIp(ip[0], ip[1], ip[2], ip[3]);
+    identity->setSsid(WiFi.SSID().c_str());
+  } else {
+    identity->clearIp();
+  }
+  return true;
+}
+
+/**
+ * @brief Populate identity now and re-read it after every WiFi event
+ */
+inline void begin(DeviceIdentity& identity) {
+  target() = &identity;
+  WiFi.onEvent(onEvent);
+  dirtyFlag() = true;
+  refresh();
+}
+
+}  // namespace WiFiIdentity
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef WIFI_POWER_SAVE_H
+#define WIFI_POWER_SAVE_H
+
+#include <WiFi.h>
+
+#include "PowerSavePolicy.h"
+
+/**
+ * @brief Applies PowerSavePolicy with WiFi.setSleep() (header-only, ESP32)
+ *
+ *   WiFiPowerSave::begin(POWER_SAVE_IDLE_MS, POWER_SAVE_DEEP_IDLE_MS);  // After the connect
+ *
+ *   void loop() {
+ *     WiFiPowerSave::update(millis(), httpMetrics.total() + framesIn, clientCount);
+ *     ...
+ *   }
+ *
+ * Power save changes take effect at once and survive reconnects. The
+ * core's automatic light sleep needs a power-management build
+ * (CONFIG_PM_ENABLE), which the stock Arduino core is not, so the idle
+ * states stop at modem sleep.
+ *
+ * esp32_wifi_power_handler_latency_seconds excludes the wake latency: a
+ * request waits for the DTIM in the air, before the device sees it. Measure
+ * that as round-trip time from a client.
+ */
+namespace WiFiPowerSave {
+
+inline PowerSavePolicy& policy() {
+  static PowerSavePolicy instance;
+  return instance;
+}
+
+inline wifi_ps_type_t psType(PowerSavePolicy::Mode mode) {
+  switch (mode) {
+    case PowerSavePolicy::MIN_MODEM: return WIFI_PS_MIN_MODEM;
+    case PowerSavePolicy::MAX_MODEM: return WIFI_PS_MAX_MODEM;
+    default: return WIFI_PS_NONE;
+  }
+}
+
+/**
+ * @brief Start in ACTIVE (setup(), once WiFi is up); deepIdleMs 0 never uses MAX_MODEM
+ */
+inline void begin(uint32_t idleMs = PowerSavePolicy::DEFAULT_IDLE_MS,
+                  uint32_t deepIdleMs = PowerSavePolicy::DEFAULT_DEEP_IDLE_MS) {
+  policy().configure(idleMs, deepIdleMs, millis());
+  WiFi.setSleep(WIFI_PS_NONE);
+}
+
+/**
+ * @brief Once per loop() pass, before the handlers
+ */
+inline void update(uint32_t nowMs, uint32_t activity, uint16_t sessions) {
+  if (policy().update(nowMs, activity, sessions)) WiFi.setSleep(psType(policy().mode()));
+}
+
+/**
+ * @brief Members of an open /status object (see PowerSavePolicy::writeStatusJson())
+ */
+inline void writeStatusJson(JsonWriter& json) {
+  policy().writeStatusJson(json, millis());
+}
+
+inline void write(MetricsWriter& out) {
+  policy().write(out, millis());
+}
+
+}  // namespace WiFiPowerSave
+
+#endif
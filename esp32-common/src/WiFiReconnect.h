@@ -0,0 +1,167 @@
+#ifndef WIFI_RECONNECT_H
+#define WIFI_RECONNECT_H
+
+#include <WiFi.h>
+
+#include "ReconnectPolicy.h"
+
+/**
+ * @brief Event-driven WiFi reconnect with backoff (header-only, ESP32)
+ *
+ * Replaces the checkWiFi() poll every 30 s. The WiFi event handler runs on
+ * the system event task and only records that the link dropped, an attempt
+ * failed or an address arrived; poll() from loop() feeds ReconnectPolicy
+ * and starts the attempts, so a drop is acted on within one loop pass
+ * (LoopIdle waits at most 50 ms). The core's own auto-reconnect is turned
+ * off: it retries without backoff and would race the policy.
+ *
+ *   WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());
+ *
+ *   void loop() {
+ *     switch (WiFiReconnect::poll(millis())) {
+ *       case WiFiReconnect::LOST:       // Attempts have started
+ *       case WiFiReconnect::CONNECTED:  // Re-register, reconnect to the broker, ...
+ *     }
+ *   }
+ *
+ * begin() after the first connect only watches for drops; before it (or
+ * after it failed) begin() connects too, and the first CONNECTED is not
+ * counted as an outage. Attempts rejoin the AP of the last connect (the
+ * driver keeps its channel and BSSID). From the FULL_SCAN_AFTER-th attempt
+ * of an outage on they scan, in case the AP moved channel.
+ */
+namespace WiFiReconnect {
+
+const uint32_t FULL_SCAN_AFTER = 3;
+
+enum Event : uint8_t {
+  NONE,
+  LOST,       // The link went down; attempts have started
+  CONNECTED   // Address again, or for the first time (also after an outage
+              // too short for LOST to be seen)
+};
+
+struct Shared {
+  volatile bool disconnected = false;
+  volatile bool lostIp = false;
+  volatile bool gotIp = false;
+  volatile uint32_t disconnectedAtMs = 0;
+};
+
+inline Shared& shared() {
+  static Shared flags;
+  return flags;
+}
+
+inline ReconnectPolicy& policy() {
+  static ReconnectPolicy instance;
+  return instance;
+}
+
+struct Credentials {
+  const char* ssid = nullptr;
+  const char* password = nullptr;
+  bool joined = false;  // The driver holds a working configuration
+};
+
+inline Credentials& credentials() {
+  static Credentials saved;
+  return saved;
+}
+
+inline void onEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+  Shared& flags = shared();
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    flags.gotIp = true;
+  } else if (event == ARDUINO_EVENT_WIFI_STA_LOST_IP) {
+    flags.lostIp = true;  // DHCP renewal failed while still associated
+  } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+             info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) {  // Not our disconnect()
+    if (!flags.disconnected) flags.disconnectedAtMs = millis();
+    flags.disconnected = true;
+  }
+}
+
+/**
+ * @brief Take over connecting and reconnecting (setup())
+ *
+ * `ssid` and `password` must stay valid: full-scan attempts pass them to WiFi.begin().
+ */
+inline void begin(const char* ssid, const char* password) {
+  credentials().ssid = ssid;
+  credentials().password = password;
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  policy().seed((uint32_t)mac[2] << 24 | (uint32_t)mac[3] << 16 | (uint32_t)mac[4] << 8 | mac[5]);
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(onEvent);
+  credentials().joined = WiFi.status() == WL_CONNECTED;
+  if (!credentials().joined) policy().start(millis());
+}
+
+/**
+ * @brief Apply the events since the last call and start an attempt if one is due (loop())
+ */
+inline Event poll(uint32_t nowMs) {
+  Shared& flags = shared();
+  ReconnectPolicy& reconnect = policy();
+  Event event = NONE;
+  wl_status_t status = WiFi.status();  // On the host this also delivers the events
+
+  if (flags.disconnected) {
+    flags.disconnected = false;
+    if (!reconnect.down()) event = LOST;
+    reconnect.lost(flags.disconnectedAtMs);  // Or: the attempt in progress failed
+  }
+  if (flags.lostIp) {
+    flags.lostIp = false;
+    if (!reconnect.down()) {
+      event = LOST;
+      reconnect.lost(nowMs);
+    }
+  }
+  if (flags.gotIp) {
+    flags.gotIp = false;
+    if (status == WL_CONNECTED && reconnect.recovered(nowMs)) {
+      event = CONNECTED;
+      credentials().joined = true;
+    }
+  }
+
+  if (reconnect.attemptDue(nowMs)) {
+    const Credentials& saved = credentials();
+    if (saved.ssid != nullptr && (!saved.joined || reconnect.attempts() >= FULL_SCAN_AFTER)) {
+      WiFi.disconnect();
+      WiFi.begin(saved.ssid, saved.password);
+    } else {
+      WiFi.reconnect();
+    }
+  }
+  return event;
+}
+
+inline bool down() {
+  return policy().down();
+}
+
+/**
+ * @brief Upper bound for LoopIdle::wait() while an attempt is pending
+ */
+inline uint32_t msUntilNext(uint32_t nowMs) {
+  return policy().msUntilNext(nowMs);
+}
+
+/**
+ * @brief Members of an open /status object (see ReconnectPolicy::writeStatusJson())
+ */
+inline void writeStatusJson(JsonWriter& json) {
+  policy().writeStatusJson(json, millis());
+}
+
+inline void write(MetricsWriter& out) {
+  policy().write(out, millis());
+}
+
+}  // namespace WiFiReconnect
+
+#endif
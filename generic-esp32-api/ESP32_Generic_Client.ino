@@ -6,6 +6,7 @@
  * 2. Send sensor data periodically
  * 3. Handle incoming commands/config/updates
  * 4. Respond to custom requests
+ * 5. Run from a battery: deep sleep between samples, WiFi only to upload them
  * 
  * Compatible with the Generic ESP32 REST API server
  * API Server: http://your-server-ip:3001
@@ -16,6 +17,16 @@
 #include <WebServer.h>
 #include <ArduinoJson.h>
 #include <EEPROM.h>
+#include <Preferences.h>
+#include <esp_sleep.h>
+#include <Scheduler.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <LoopIdle.h>
+#include <StallMonitor.h>
+#include <FlightLog.h>
+#include <LineAssembler.h>
+#include <WiFiReconnect.h>
+#include <FastWiFi.h>
+#include <DutyCycle.h>
 
 // WiFi Configuration
 const char* ssid = "YOUR_WIFI_SSID";
@@ -39,9 +50,24 @@ const int BUTTON_PIN = 0;   // Boot button
 
 // Timing Configuration
 unsigned long lastDataSend = 0;
-unsigned long lastHeartbeat = 0;
 const unsigned long DATA_INTERVAL = 30000;    // Send data every 30 seconds
 const unsigned long HEARTBEAT_INTERVAL = 60000; // Heartbeat every minute
+const uint32_t STALL_THRESHOLD_MS = 200;  // loop() passes longer than this are stalls
+
+// Deep-sleep duty cycle, turned on by /config "deep_sleep_duration" (seconds,
+// 0: off) with optional "upload_every" (wakes per WiFi session). Each wake
+// takes one sample into RTC memory and sleeps again; WiFi comes up only to
+// send the held samples. The BOOT button wakes the board and turns it off.
+const uint16_t DEFAULT_UPLOAD_EVERY = 10;
+const uint32_t UPLOAD_WIFI_TIMEOUT_MS = 10000;
+const uint32_t REPLY_FLUSH_MS = 100;  // Lets the /config reply leave before the radio goes off
+const char DUTY_NVS_NAMESPACE[] = "duty";
+const char DUTY_NVS_KEY[] = "settings";
+
+// Upload sessions reuse the last DHCP address instead of asking again: saves
+// up to a second per session, but only safe where the router reserves it
+// (see FastWiFi.h)
+const bool REUSE_DHCP_LEASE = false;
 
 // Device State
 struct DeviceState {
@@ -53,34 +79,80 @@ struct DeviceState {
   int batteryLevel = 100;
 } deviceState;
 
-// Web Server for receiving API commands
+// Web Server for receiving API commands (started on the first WiFi connect)
 WebServer server(80);
+bool serverStarted = false;
+
+// Periodic data send and heartbeat
+Scheduler scheduler;
+int dataTask = Scheduler::INVALID_TASK;
+
+// Blocking sections that stall loop(): GET /stalls and the serial command "stalls"
+StallWatchdog stallWatchdog(STALL_THRESHOLD_MS);
+StaticResponseBuffer<640> stallReport;  // Header and TOP_STALLS rows
+StaticLineAssembler<32> serialCommand;
+
+// Last events before a reset: GET /flight and the serial command "flight"
+RTC_NOINIT_ATTR FlightRecorder::Storage flightStorage;
+
+// Samples and counters kept across deep sleep; the settings are in NVS as well
+RTC_NOINIT_ATTR DutyCycle::Storage dutyStorage;
+DutyCycle dutyCycle(dutyStorage);
+WiFiCache uploadWiFi;         // AP of the last session: the next one skips the scan
+bool sleepRequested = false;  // /config turned the duty cycle on: sleep after the reply
+
+struct DutySettings {
+  uint32_t sleepMs;
+  uint16_t uploadEvery;
+};
 
 // ============================================
 // WiFi Functions
 // ============================================
 
-void connectToWiFi() {
-  Serial.print("Connecting to WiFi");
-  WiFi.begin(ssid, password);
-  
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(1000);
-    Serial.print(".");
-    attempts++;
-  }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println();
-    Serial.println("WiFi connected successfully!");
-    Serial.print("IP address: ");
-    Serial.println(WiFi.localIP());
-    Serial.print("Signal strength: ");
-    Serial.println(WiFi.RSSI());
-  } else {
-    Serial.println();
-    Serial.println("Failed to connect to WiFi!");
+bool registerWithAPI();
+bool uploadSamples();
+
+/**
+ * @brief Act on WiFi events; WiFiReconnect.h does the (re)connecting
+ *
+ * The first connect and every reconnect register with the API again (the
+ * address may have changed) and send data at once instead of waiting out
+ * the interval.
+ */
+void checkWiFi() {
+  switch (WiFiReconnect::poll(millis())) {
+    case WiFiReconnect::LOST:
+      Serial.println("WiFi lost - reconnecting");
+      break;
+    case WiFiReconnect::CONNECTED:
+      if (WiFiReconnect::policy().outages() > 0) {
+        Serial.println("WiFi back after " + String(WiFiReconnect::policy().lastRecoveryMs()) + " ms");
+      } else {
+        Serial.println("WiFi connected successfully!");
+      }
+      Serial.print("IP address: ");
+      Serial.println(WiFi.localIP());
+      Serial.print("Signal strength: ");
+      Serial.println(WiFi.RSSI());
+      if (!serverStarted) {
+        server.begin();
+        serverStarted = true;
+        Serial.println("🌐 Web server started on port 80");
+      }
+      if (registerWithAPI()) {
+        Serial.println("✅ Ready to communicate with API!");
+      } else {
+        Serial.println("⚠️ Failed to register, but continuing...");
+      }
+      if (dutyCycle.count() > 0) {
+        uint16_t held = dutyCycle.count();
+        if (uploadSamples()) Serial.println("📦 Sent " + String(held) + " samples held from deep sleep");
+      }
+      scheduler.reschedule(dataTask, 0, millis());
+      break;
+    case WiFiReconnect::NONE:
+      break;
   }
 }
 
@@ -132,6 +204,7 @@ bool registerWithAPI() {
     
     if (responseDoc["success"]) {
       Serial.println("✅ Successfully registered with API!");
+      dutyCycle.setRegistered((uint32_t)WiFi.localIP());
       http.end();
       return true;
     } else {
@@ -146,6 +219,7 @@ bool registerWithAPI() {
 }
 
 bool sendDataToAPI() {
+  STALL_SECTION(stallWatchdog, "send_data");
   if (WiFi.status() != WL_CONNECTED) {
     return false;
   }
@@ -206,6 +280,180 @@ bool sendDataToAPI() {
   return false;
 }
 
+// ============================================
+// Deep-Sleep Duty Cycle
+// ============================================
+
+/**
+ * @brief Keep the settings in NVS, so a power cycle resumes the duty cycle
+ */
+void saveDutySettings() {
+  DutySettings settings = {dutyCycle.active() ? dutyCycle.sleepMs() : 0, dutyCycle.uploadEvery()};
+  Preferences prefs;
+  if (!prefs.begin(DUTY_NVS_NAMESPACE, false)) return;
+  prefs.putBytes(DUTY_NVS_KEY, &settings, sizeof(settings));
+  prefs.end();
+}
+
+void loadDutySettings() {
+  DutySettings settings = {0, DEFAULT_UPLOAD_EVERY};
+  Preferences prefs;
+  if (!prefs.begin(DUTY_NVS_NAMESPACE, true)) return;
+  size_t length = prefs.getBytes(DUTY_NVS_KEY, &settings, sizeof(settings));
+  prefs.end();
+  if (length == sizeof(settings) && settings.sleepMs > 0) {
+    dutyCycle.enable(settings.sleepMs, settings.uploadEvery, millis());
+  }
+}
+
+DutyCycle::Sample readSample() {
+  DutyCycle::Sample sample = {};
+  sample.atMs = dutyCycle.clockMs(millis());
+  sample.analog = analogRead(SENSOR_PIN);
+  sample.temperature = random(200, 300);  // Simulated, 0.1 °C as in sendDataToAPI()
+  sample.humidity = random(400, 800);     // Simulated, 0.1 %
+  sample.button = digitalRead(BUTTON_PIN) == LOW;
+  return sample;
+}
+
+/**
+ * @brief POST every held sample to /data as one burst
+ * @return HTTP status, or a negative HTTPClient error
+ */
+int postSamples() {
+  STALL_SECTION(stallWatchdog, "send_samples");
+  HTTPClient http;
+  String url = String("http://") + apiServer + ":" + apiPort + "/data";
+  
+  http.begin(url);
+  http.addHeader("Content-Type", "application/json");
+  http.addHeader("X-ESP32-ID", deviceId);
+  
+  const uint16_t count = dutyCycle.count();
+  const uint32_t clockMs = dutyCycle.clockMs(millis());
+  DynamicJsonDocument doc(1024 + JSON_ARRAY_SIZE(count) + count * JSON_OBJECT_SIZE(6));
+  doc["device_id"] = deviceId;
+  doc["timestamp"] = millis();
+  doc["wifi_rssi"] = WiFi.RSSI();
+  doc["free_heap"] = ESP.getFreeHeap();
+  
+  // Counters before this session
+  JsonObject duty = doc.createNestedObject("duty_cycle");
+  duty["sleep_seconds"] = dutyCycle.sleepMs() / 1000;
+  duty["upload_every"] = dutyCycle.uploadEvery();
+  duty["wakes"] = dutyCycle.wakes();
+  duty["sessions"] = dutyCycle.sessions();
+  duty["failed_sessions"] = dutyCycle.failedSessions();
+  duty["dropped_samples"] = dutyCycle.dropped();
+  duty["samples_per_session"] = dutyCycle.samplesPerSession();
+  duty["awake_ms_per_sample"] = dutyCycle.awakeUsPerSample() / 1000.0;
+  duty["sample_wake_ms"] = dutyCycle.sampleWakeUs() / 1000.0;
+  duty["session_wake_ms"] = dutyCycle.sessionWakeUs() / 1000.0;
+  
+  // Oldest first; age_ms is how long before this request each was taken
+  JsonArray samples = doc.createNestedArray("samples");
+  for (uint16_t i = 0; i < count; i++) {
+    const DutyCycle::Sample& sample = dutyCycle.sample(i);
+    JsonObject entry = samples.createNestedObject();
+    entry["age_ms"] = clockMs - sample.atMs;
+    entry["analog_value"] = sample.analog;
+    entry["voltage"] = sample.analog * (3.3 / 4095.0);
+    entry["temperature"] = sample.temperature / 10.0;
+    entry["humidity"] = sample.humidity / 10.0;
+    entry["button_pressed"] = sample.button != 0;
+  }
+  
+  String jsonString;
+  serializeJson(doc, jsonString);
+  int httpResponseCode = http.POST(jsonString);
+  http.end();
+  return httpResponseCode;
+}
+
+/**
+ * @brief Send the held samples; registers only if the address changed
+ *
+ * The registration outlives deep sleep, so a session on the same address
+ * is one request. A 403 means the API forgot the device (restarted): it
+ * registers and sends again.
+ * @return true once the API has them (they are dropped from RTC memory)
+ */
+bool uploadSamples() {
+  if (!dutyCycle.registered((uint32_t)WiFi.localIP()) && !registerWithAPI()) return false;
+  int httpResponseCode = postSamples();
+  if (httpResponseCode == 403 && registerWithAPI()) httpResponseCode = postSamples();
+  if (httpResponseCode != 200) {
+    Serial.println("❌ Failed to send samples: " + String(httpResponseCode));
+    return false;
+  }
+  dutyCycle.uploaded(dutyCycle.count());
+  return true;
+}
+
+/**
+ * @brief Join for an upload session: after the first, no scan (cached channel and BSSID)
+ */
+bool connectForUpload() {
+  FastWiFi::load(uploadWiFi);
+  uploadWiFi.setCredentials(ssid, password);
+  if (FastWiFi::connect(uploadWiFi, UPLOAD_WIFI_TIMEOUT_MS, REUSE_DHCP_LEASE) == FastWiFi::FAILED) {
+    Serial.println("WiFi not found - samples kept for the next session");
+    return false;
+  }
+  FastWiFi::remember(uploadWiFi, REUSE_DHCP_LEASE);
+  return true;
+}
+
+/**
+ * @brief Count this wake and deep sleep until the next one
+ *
+ * awakeUs 0: the first sleep, from the awake client, which is not a wake.
+ * Only wakes with a session print, to keep the others short.
+ */
+[[noreturn]] void sleepNow(uint32_t awakeUs, bool session) {
+  uint64_t sleepUs = dutyCycle.sleep(millis(), awakeUs, session);
+  if (session) {
+    Serial.printf("💤 Wake %lu: %u samples held, %.1f per session, %.1f ms awake per sample "
+                  "(%.1f ms per sampling wake, %.1f ms per session)\n",
+                  (unsigned long)dutyCycle.wakes(), dutyCycle.count(), dutyCycle.samplesPerSession(),
+                  dutyCycle.awakeUsPerSample() / 1000.0, dutyCycle.sampleWakeUs() / 1000.0,
+                  dutyCycle.sessionWakeUs() / 1000.0);
+  }
+  Serial.flush();
+  WiFi.mode(WIFI_OFF);
+  esp_sleep_enable_timer_wakeup(sleepUs);
+  // BOOT button (external pull-up on dev boards): wake and stay awake
+  esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_PIN, LOW);
+  esp_deep_sleep_start();
+}
+
+/**
+ * @brief A duty-cycle wake: sample, upload every uploadEvery() wakes, sleep again
+ *
+ * First thing in setup(). Returns only if the client should stay awake:
+ * the duty cycle is off, or the BOOT button woke the board, which turns
+ * it off until /config turns it on again.
+ */
+void runDutyCycle() {
+  if (!dutyCycle.begin()) loadDutySettings();  // Power-on: the RTC state is gone
+  if (!dutyCycle.active()) return;
+  
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0) {
+    dutyCycle.disable();
+    saveDutySettings();
+    Serial.println("\n🔘 Woken by the button - deep sleep off, " + String(dutyCycle.count()) +
+                   " samples to send");
+    return;
+  }
+  
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  dutyCycle.wake();
+  dutyCycle.add(readSample());
+  bool session = dutyCycle.uploadDue();
+  if (session && !(connectForUpload() && uploadSamples())) dutyCycle.uploadFailed();
+  sleepNow(micros(), session);
+}
+
 // ============================================
 // Web Server Endpoints (Receive from API)
 // ============================================
@@ -250,6 +498,7 @@ void handleCommand() {
   } else if (command == "set_interval") {
     int newInterval = parameters["interval"] | deviceState.sensorInterval;
     deviceState.sensorInterval = newInterval;
+    scheduler.setInterval(dataTask, newInterval, millis());
     response["new_interval"] = newInterval;
     Serial.println("⏱️ Sensor interval changed to: " + String(newInterval) + "ms");
     
@@ -258,9 +507,9 @@ void handleCommand() {
     String responseString;
     serializeJson(response, responseString);
     server.send(200, "application/json", responseString);
+    STALL_SECTION(stallWatchdog, "restart_delay");
     delay(2000);
-    ESP.restart();
-    return;
+    FlightLog::restart("http_command");
     
   } else {
     response["success"] = false;
@@ -300,6 +549,7 @@ void handleConfig() {
   // Apply configuration settings
   if (config.containsKey("sensor_interval")) {
     deviceState.sensorInterval = config["sensor_interval"];
+    scheduler.setInterval(dataTask, deviceState.sensorInterval, millis());
     appliedConfigs.add("sensor_interval");
     Serial.println("📊 Sensor interval set to: " + String(deviceState.sensorInterval));
   }
@@ -311,10 +561,21 @@ void handleConfig() {
   }
   
   if (config.containsKey("deep_sleep_duration")) {
-    int sleepDuration = config["deep_sleep_duration"];
-    // Note: Implementing deep sleep would require careful handling
+    uint32_t sleepSeconds = config["deep_sleep_duration"];
+    uint16_t uploadEvery = config["upload_every"] | DEFAULT_UPLOAD_EVERY;
+    if (sleepSeconds > 0) {
+      dutyCycle.enable(sleepSeconds * 1000, uploadEvery, millis());
+      sleepRequested = true;  // loop() sleeps once this reply is sent
+      response["upload_every"] = dutyCycle.uploadEvery();
+      Serial.println("💤 Deep sleep for " + String(sleepSeconds) + " s between samples, upload every " +
+                     String(dutyCycle.uploadEvery()) + " wakes");
+    } else {
+      dutyCycle.disable();
+      Serial.println("💤 Deep sleep off");
+    }
+    saveDutySettings();
+    deviceState.deepSleepEnabled = dutyCycle.active();
     appliedConfigs.add("deep_sleep_duration");
-    Serial.println("💤 Deep sleep duration set to: " + String(sleepDuration));
   }
   
   String responseString;
@@ -404,6 +665,7 @@ void handleCustom() {
       response["blink_duration"] = duration;
       
       // Blink LED
+      STALL_SECTION(stallWatchdog, "blink_led");
       for (int i = 0; i < 5; i++) {
         digitalWrite(LED_PIN, HIGH);
         delay(duration / 10);
@@ -432,99 +694,157 @@ void handleStatus() {
   doc["sensor_interval"] = deviceState.sensorInterval;
   doc["last_data_send"] = lastDataSend;
   doc["ip_address"] = WiFi.localIP().toString();
+  doc["wifi_down_ms"] = WiFiReconnect::policy().downMs(millis());
+  doc["wifi_outages"] = WiFiReconnect::policy().outages();
+  doc["wifi_last_recovery_ms"] = WiFiReconnect::policy().lastRecoveryMs();
+  doc["wifi_max_recovery_ms"] = WiFiReconnect::policy().maxRecoveryMs();
+  doc["deep_sleep_enabled"] = dutyCycle.active();
+  doc["deep_sleep_duration"] = dutyCycle.sleepMs() / 1000;
+  doc["upload_every"] = dutyCycle.uploadEvery();
+  doc["held_samples"] = dutyCycle.count();
+  doc["duty_wakes"] = dutyCycle.wakes();
+  doc["samples_per_session"] = dutyCycle.samplesPerSession();
+  doc["awake_ms_per_sample"] = dutyCycle.awakeUsPerSample() / 1000.0;
   
   String response;
   serializeJson(doc, response);
   server.send(200, "application/json", response);
 }
 
+void handleStalls() {
+  StallMonitor::report(stallWatchdog, stallReport);
+  server.send(200, "text/plain", stallReport.c_str());
+  stallReport.clear();
+  if (server.hasArg("reset")) stallWatchdog.reset();
+}
+
 void handleNotFound() {
   server.send(404, "application/json", 
     "{\"success\": false, \"error\": \"Endpoint not found\", \"device_id\": \"" + deviceId + "\"}");
 }
 
+// ============================================
+// Scheduled Tasks
+// ============================================
+
+void sendDataTask(void*) {
+  if (WiFi.status() == WL_CONNECTED) {
+    sendDataToAPI();
+    lastDataSend = millis();
+  } else {
+    Serial.println("WiFi disconnected, data sent once it is back");
+  }
+}
+
+/**
+ * @brief Serial "stalls" / "stalls reset" / "flight" / "flight clear"
+ */
+void pollSerialCommands() {
+  if (serialCommand.poll(Serial, millis()) != LineAssembler::LINE_READY) return;
+  if (strcmp(serialCommand.line(), "stalls") == 0) {
+    StallMonitor::report(stallWatchdog, stallReport);
+    stallReport.flushTo(Serial);
+  } else if (strcmp(serialCommand.line(), "stalls reset") == 0) {
+    stallWatchdog.reset();
+    Serial.println("Stalls reset");
+  } else if (strcmp(serialCommand.line(), "flight") == 0) {
+    FlightLog::print();
+  } else if (strcmp(serialCommand.line(), "flight clear") == 0) {
+    FlightLog::recorder()->clear(millis());
+    Serial.println("Flight log cleared");
+  }
+}
+
+void heartbeatTask(void*) {
+  FlightLog::noteHeap(ESP.getFreeHeap());
+  if (WiFi.status() == WL_CONNECTED) {
+    Serial.println("💓 Heartbeat - Device online");
+    // Could send a simple ping to API here
+  }
+}
+
 // ============================================
 // Setup and Main Loop
 // ============================================
 
 void setup() {
   Serial.begin(115200);
+  runDutyCycle();  // Sleeps again unless the client is to stay awake
+  deviceState.deepSleepEnabled = dutyCycle.active();
   Serial.println("\n🚀 ESP32 Generic API Client Starting...");
+  FlightLog::begin(flightStorage);  // Prints the events before the last reset
+  FlightLog::watch(stallWatchdog);
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
   pinMode(BUTTON_PIN, INPUT_PULLUP);
   digitalWrite(LED_PIN, LOW);
   
-  // Connect to WiFi
-  connectToWiFi();
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    // Register with API
-    if (registerWithAPI()) {
-      Serial.println("✅ Ready to communicate with API!");
-    } else {
-      Serial.println("⚠️ Failed to register, but continuing...");
-    }
-    
-    // Setup web server endpoints
-    server.on("/command", HTTP_POST, handleCommand);
-    server.on("/config", HTTP_POST, handleConfig);
-    server.on("/update", HTTP_POST, handleUpdate);
-    server.on("/custom", HTTP_POST, handleCustom);
-    server.on("/status", HTTP_GET, handleStatus);
-    server.onNotFound(handleNotFound);
-    
-    server.begin();
-    Serial.println("🌐 Web server started on port 80");
-    Serial.println("📡 Endpoints available:");
-    Serial.println("   POST /command - Receive commands");
-    Serial.println("   POST /config - Receive configuration");
-    Serial.println("   POST /update - Receive update info");
-    Serial.println("   POST /custom - Receive custom data");
-    Serial.println("   GET /status - Device status");
-  }
+  // Connect to WiFi in the background: checkWiFi() registers once it is up
+  Serial.println("Connecting to WiFi: " + String(ssid));
+  WiFi.mode(WIFI_STA);
+  WiFiReconnect::begin(ssid, password);
+  
+  // Setup web server endpoints
+  server.on("/command", HTTP_POST, handleCommand);
+  server.on("/config", HTTP_POST, handleConfig);
+  server.on("/update", HTTP_POST, handleUpdate);
+  server.on("/custom", HTTP_POST, handleCustom);
+  server.on("/status", HTTP_GET, handleStatus);
+  server.on("/stalls", HTTP_GET, handleStalls);
+  FlightLog::on(server);
+  server.onNotFound(handleNotFound);
+  Serial.println("📡 Endpoints available:");
+  Serial.println("   POST /command - Receive commands");
+  Serial.println("   POST /config - Receive configuration");
+  Serial.println("   POST /update - Receive update info");
+  Serial.println("   POST /custom - Receive custom data");
+  Serial.println("   GET /status - Device status");
+  Serial.println("   GET /stalls - Worst loop() stalls (?reset=1 clears)");
+  Serial.println("   GET /flight - Events before the last reset (?clear=1 clears)");
+  
+  dataTask = scheduler.every(deviceState.sensorInterval, sendDataTask, nullptr, millis());
+  scheduler.every(HEARTBEAT_INTERVAL, heartbeatTask, nullptr, millis());
   
   Serial.println("=================================");
   Serial.println("ESP32 Generic API Client Ready!");
   Serial.println("Device ID: " + deviceId);
   Serial.println("API Server: " + String(apiServer) + ":" + String(apiPort));
   Serial.println("=================================");
+  
+  StallMonitor::begin(stallWatchdog);
 }
 
 void loop() {
-  // Handle web server requests
-  server.handleClient();
+  stallWatchdog.tick(millis());
   
-  unsigned long currentTime = millis();
+  // Reconnect with backoff; register and send again once back
+  checkWiFi();
   
-  // Send data periodically
-  if (currentTime - lastDataSend >= deviceState.sensorInterval) {
-    if (WiFi.status() == WL_CONNECTED) {
-      sendDataToAPI();
-      lastDataSend = currentTime;
-    } else {
-      Serial.println("WiFi disconnected, attempting reconnection...");
-      connectToWiFi();
-    }
-  }
+  // Handle web server requests
+  server.handleClient();
   
-  // Optional: Send heartbeat less frequently
-  if (currentTime - lastHeartbeat >= HEARTBEAT_INTERVAL) {
-    if (WiFi.status() == WL_CONNECTED) {
-      Serial.println("💓 Heartbeat - Device online");
-      // Could send a simple ping to API here
-    }
-    lastHeartbeat = currentTime;
-  }
+  // Periodic data send and heartbeat
+  scheduler.run(millis());
   
   // Check button for manual data send
   if (digitalRead(BUTTON_PIN) == LOW) {
+    STALL_SECTION(stallWatchdog, "button");
     delay(200); // Debounce
     Serial.println("🔘 Button pressed - sending immediate data");
     sendDataToAPI();
     while (digitalRead(BUTTON_PIN) == LOW) delay(100); // Wait for release
   }
   
-  delay(100); // Small delay to prevent watchdog issues
+  pollSerialCommands();
+  
+  if (sleepRequested) {
+    delay(REPLY_FLUSH_MS);
+    sleepNow(0, false);
+  }
+  
+  // Sleep until the next task or WiFi attempt, a request, or the next button poll (max 50 ms)
+  uint32_t idleMs = scheduler.msUntilNext(millis());
+  uint32_t wifiMs = WiFiReconnect::msUntilNext(millis());
+  LoopIdle::wait(wifiMs < idleMs ? wifiMs : idleMs);
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Host (Linux) emulation of the Arduino-ESP32 core subset used by the sketches.
+// Timing is real (steady clock), networking uses real loopback sockets.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+static const uint8_t A0 = 36;  // ADC1 channel 0, as on ESP32 dev boards
+
+#define PROGMEM
+#define PGM_P const char*
+#define F(string_literal) (string_literal)
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+// Kept across ESP.restart() like on the chip (see HostRuntime.h); the
+// section name gives the linker's __start_ / __stop_ bounds
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_noinit")))
+
+using std::max;
+using std::min;
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// Implemented by the sketch
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef BLE2902_H
+#define BLE2902_H
+
+#include "BLEDevice.h"
+
+// Client Characteristic Configuration descriptor (notifications on/off)
+class BLE2902 : public BLEDescriptor {
+public:
+  void setNotifications(bool enable) { notifications_ = enable; }
+  bool getNotifications() const { return notifications_; }
+
+private:
+  bool notifications_ = false;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef BLEDEVICE_H
+#define BLEDEVICE_H
+
+#include <string>
+
+#include "Arduino.h"
+
+class BLEServer;
+class BLECharacteristic;
+
+/**
+ * @brief ESP32 BLE Arduino API without a radio
+ *
+ * Enough of BLEDevice/BLEServer/BLECharacteristic for the BLE sketches to
+ * build and run on the host. Nothing is advertised; the host*() members
+ * let benchmarks drive connects and characteristic writes directly.
+ */
+class BLEServerCallbacks {
+public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer* server) { (void)server; }
+  virtual void onDisconnect(BLEServer* server) { (void)server; }
+};
+
+class BLECharacteristicCallbacks {
+public:
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onRead(BLECharacteristic* characteristic) { (void)characteristic; }
+  virtual void onWrite(BLECharacteristic* characteristic) { (void)characteristic; }
+};
+
+class BLEDescriptor {
+public:
+  virtual ~BLEDescriptor() {}
+};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+  static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+  static const uint32_t PROPERTY_INDICATE = 1 << 4;
+  static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+  BLECharacteristic(const char* uuid, uint32_t properties) : uuid_(uuid), properties_(properties) {}
+
+  void setCallbacks(BLECharacteristicCallbacks* callbacks) { callbacks_ = callbacks; }
+  void addDescriptor(BLEDescriptor* descriptor) { (void)descriptor; }
+  void setValue(const char* value) { value_.assign(value); }
+  void setValue(const std::string& value) { value_ = value; }
+  void setValue(const String& value) { value_.assign(value.c_str(), value.length()); }
+  void setValue(const uint8_t* data, size_t length) { value_.assign((const char*)data, length); }
+  std::string getValue() const { return value_; }
+  const char* getUUID() const { return uuid_; }
+  uint32_t getProperties() const { return properties_; }
+  void notify() { notifications_++; }
+  void indicate() { notifications_++; }
+
+  // Host-only: a central wrote `length` bytes to this characteristic
+  void hostWrite(const char* data, size_t length);
+  uint32_t hostNotifications() const { return notifications_; }
+
+private:
+  const char* uuid_;
+  uint32_t properties_;
+  BLECharacteristicCallbacks* callbacks_ = nullptr;
+  std::string value_;
+  uint32_t notifications_ = 0;
+};
+
+class BLEService {
+public:
+  static const int MAX_CHARACTERISTICS = 8;
+
+  explicit BLEService(const char* uuid) : uuid_(uuid) {}
+  ~BLEService();
+
+  BLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties);
+  void start() {}
+  const char* getUUID() const { return uuid_; }
+
+private:
+  const char* uuid_;
+  BLECharacteristic* characteristics_[MAX_CHARACTERISTICS] = {};
+  int characteristicCount_ = 0;
+};
+
+class BLEServer {
+public:
+  static const int MAX_SERVICES = 4;
+
+  ~BLEServer();
+
+  void setCallbacks(BLEServerCallbacks* callbacks) { callbacks_ = callbacks; }
+  BLEService* createService(const char* uuid);
+  void startAdvertising() {}
+  uint32_t getConnectedCount() const { return connected_; }
+
+  // Host-only: simulate a central connecting / disconnecting
+  void hostConnect();
+  void hostDisconnect();
+
+private:
+  BLEServerCallbacks* callbacks_ = nullptr;
+  BLEService* services_[MAX_SERVICES] = {};
+  int serviceCount_ = 0;
+  uint32_t connected_ = 0;
+};
+
+class BLEAdvertising {
+public:
+  void addServiceUUID(const char* uuid) { (void)uuid; }
+  void setScanResponse(bool enable) { (void)enable; }
+  void setMinPreferred(uint16_t interval) { (void)interval; }
+  void setMaxPreferred(uint16_t interval) { (void)interval; }
+  void start() {}
+  void stop() {}
+};
+
+class BLEDevice {
+public:
+  static void init(const char* deviceName);
+  static void deinit(bool releaseMemory = false);
+  static BLEServer* createServer();
+  static BLEAdvertising* getAdvertising();
+  static void startAdvertising() {}
+  static void stopAdvertising() {}
+  static std::string getDeviceName();
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef BLEUTILS_H
+#define BLEUTILS_H
+
+#include "BLEDevice.h"
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef BLUETOOTHSERIAL_H
+#define BLUETOOTHSERIAL_H
+
+#include "Arduino.h"
+#include "esp_gap_bt_api.h"
+#include "esp_spp_api.h"
+
+// sdkconfig of a Bluetooth Classic build, checked by the sketches
+#ifndef CONFIG_BT_ENABLED
+#define CONFIG_BT_ENABLED 1
+#endif
+#ifndef CONFIG_BLUEDROID_ENABLED
+#define CONFIG_BLUEDROID_ENABLED 1
+#endif
+
+/**
+ * @brief Arduino-ESP32 BluetoothSerial with a TCP socket as the RFCOMM link
+ *
+ * begin() listens on port HOST_PORT (plus ESP32_HOST_PORT_OFFSET, so 9000 by
+ * default); one client at a time is the SPP peer, like the board's single
+ * server channel. Bytes are delivered as TCP sends them, so a write() is
+ * one segment where an RFCOMM write is one or more packets.
+ *
+ * Callbacks run on the loop() thread from available() and read(), where
+ * the board runs them on the Bluetooth task.
+ */
+class BluetoothSerial : public Stream {
+public:
+  static const uint16_t HOST_PORT = 1000;
+
+  ~BluetoothSerial();
+
+  bool begin(const String& localName = String(), bool isMaster = false);
+  void end();
+  bool hasClient();
+  void enableSSP() {}
+  esp_err_t register_callback(esp_spp_cb_t callback);
+
+  // 02:00:00:00:00:02, a locally administered address
+  bool getBtAddress(uint8_t* mac);
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return clientFd_ >= 0 ? 330 : 0; }
+  void flush() override {}
+
+private:
+  void poll();
+  void dropClient();
+  void notify(esp_spp_cb_event_t event);
+
+  esp_spp_cb_t callback_ = nullptr;
+  int listenFd_ = -1;
+  int clientFd_ = -1;
+  uint8_t rx_[512];
+  size_t rxHead_ = 0;
+  size_t rxTail_ = 0;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef DNSSERVER_H
+#define DNSSERVER_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+/**
+ * @brief ESP32 DNSServer without a resolver
+ *
+ * On the target it answers every name with the setup AP's address so
+ * phones open the captive page. The host has no AP for clients to join:
+ * open the page on its port directly (see ESP32_HOST_PORT_OFFSET).
+ */
+class DNSServer {
+public:
+  bool start(uint16_t port, const String& domainName, const IPAddress& resolvedIP) {
+    (void)port;
+    (void)domainName;
+    (void)resolvedIP;
+    return true;
+  }
+  void processNextRequest() {}
+  void stop() {}
+};
+
+#endif
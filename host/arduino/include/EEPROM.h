@@ -0,0 +1,43 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief EEPROM emulation backed by a file (ESP32_HOST_EEPROM, default
+ *        ./esp32-host-eeprom.bin) so settings survive restarts like flash
+ */
+class EEPROMClass {
+public:
+  ~EEPROMClass() { end(); }
+
+  bool begin(size_t size);
+  void end();
+  bool commit();
+  size_t length() const { return size_; }
+
+  uint8_t read(int address) const;
+  void write(int address, uint8_t value);
+
+  template <typename T>
+  T& get(int address, T& value) const {
+    if (address >= 0 && (size_t)address + sizeof(T) <= size_) memcpy(&value, data_ + address, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  const T& put(int address, const T& value) {
+    if (address >= 0 && (size_t)address + sizeof(T) <= size_) memcpy(data_ + address, &value, sizeof(T));
+    return value;
+  }
+
+private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef ESP_H
+#define ESP_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+/**
+ * @brief ESP.* on the host
+ *
+ * The heap figures model the ESP32's internal heap (HOST_HEAP_SIZE) minus
+ * what the process currently has allocated, so leaks and growth show up in
+ * the same /status fields as on the target.
+ */
+class EspClass {
+public:
+  static const uint32_t HOST_HEAP_SIZE = 320 * 1024;
+
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getHeapSize() { return HOST_HEAP_SIZE; }
+  const char* getChipModel() { return "ESP32-HOST"; }
+  uint8_t getChipRevision() { return 0; }
+  uint8_t getChipCores() { return 2; }
+  uint32_t getCpuFreqMHz() { return 240; }
+  const char* getSdkVersion() { return "host"; }
+  uint64_t getEfuseMac();
+  uint32_t getCycleCount();
+
+  [[noreturn]] void restart();
+
+private:
+  std::atomic<uint32_t> minFreeHeap_{HOST_HEAP_SIZE};  // Updated from any task
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_CREATED = 201,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_MOVED_PERMANENTLY = 301,
+  HTTP_CODE_FOUND = 302,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_UNAUTHORIZED = 401,
+  HTTP_CODE_FORBIDDEN = 403,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+  HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+/**
+ * @brief ESP32 HTTPClient subset over host sockets (plain http:// only)
+ *
+ * One request per connection (Connection: close); the response headers are
+ * read by the request call, the body by getString().
+ */
+class HTTPClient {
+public:
+  HTTPClient() {}
+  ~HTTPClient() { end(); }
+
+  bool begin(const String& url);
+  bool begin(WiFiClient& client, const String& url);
+  bool begin(const String& host, uint16_t port, const String& uri = "/");
+  void end();
+  bool connected();
+
+  void setTimeout(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+  void setConnectTimeout(int32_t timeoutMs) { connectTimeoutMs_ = timeoutMs; }
+  void setReuse(bool) {}
+  void setUserAgent(const String& userAgent) { userAgent_ = userAgent; }
+  void addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+
+  int GET();
+  int POST(const String& payload);
+  int POST(const uint8_t* payload, size_t size);
+  int PUT(const String& payload);
+  int PATCH(const String& payload);
+  int sendRequest(const char* type, const String& payload);
+  int sendRequest(const char* type, const uint8_t* payload = nullptr, size_t size = 0);
+
+  String getString();
+  int getSize() const { return contentLength_; }
+  WiFiClient& getStream() { return *client_; }
+  String header(const char* name) const;
+
+  static String errorToString(int error);
+
+private:
+  bool readLine(String& line);
+  int readResponseHeaders();
+
+  WiFiClient ownClient_;
+  WiFiClient* client_ = &ownClient_;
+  String host_;
+  uint16_t port_ = 80;
+  String uri_;
+  String headers_;
+  String userAgent_ = "ESP32HTTPClient";
+  String responseHeaders_;
+  uint16_t timeoutMs_ = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+  int32_t connectTimeoutMs_ = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+  int contentLength_ = -1;
+  bool chunked_ = false;
+  bool haveRequest_ = false;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef HARDWARESERIAL_H
+#define HARDWARESERIAL_H
+
+#include "Stream.h"
+
+/**
+ * @brief Serial on the host: output goes to stdout, input comes from stdin
+ *        and from ESP32_HOST_SERIAL ("\n" escapes allowed)
+ *
+ * Seeded input is "typed" one line at a time: a line is released only after
+ * the sketch has polled an empty buffer, so the usual boot-time
+ * `while (Serial.available()) Serial.read();` does not swallow it.
+ */
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  operator bool() const { return true; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return 128; }
+  void flush() override;
+
+private:
+  void fill();
+
+  void releaseSeedLine();
+
+  char rx_[256];
+  size_t rxHead_ = 0;
+  size_t rxTail_ = 0;
+  char seed_[256];
+  size_t seedLength_ = 0;
+  size_t seedPosition_ = 0;
+  uint8_t emptyPolls_ = 0;
+  bool stdinOpen_ = true;
+  bool quiet_ = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <stdint.h>
+
+#include "Print.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : IPAddress(0, 0, 0, 0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    bytes_[0] = a;
+    bytes_[1] = b;
+    bytes_[2] = c;
+    bytes_[3] = d;
+  }
+  // Network byte order, as stored by lwIP
+  IPAddress(uint32_t address) {
+    for (int i = 0; i < 4; i++) bytes_[i] = (address >> (8 * i)) & 0xFF;
+  }
+
+  operator uint32_t() const {
+    return (uint32_t)bytes_[0] | ((uint32_t)bytes_[1] << 8) |
+           ((uint32_t)bytes_[2] << 16) | ((uint32_t)bytes_[3] << 24);
+  }
+  bool operator==(const IPAddress& rhs) const { return (uint32_t)*this == (uint32_t)rhs; }
+  bool operator!=(const IPAddress& rhs) const { return !(*this == rhs); }
+  uint8_t operator[](int index) const { return bytes_[index]; }
+  uint8_t& operator[](int index) { return bytes_[index]; }
+
+  bool fromString(const char* address);
+  bool fromString(const String& address) { return fromString(address.c_str()); }
+  String toString() const;
+  size_t printTo(Print& p) const override;
+
+private:
+  uint8_t bytes_[4];
+};
+
+#endif
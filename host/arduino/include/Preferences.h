@@ -0,0 +1,36 @@
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief NVS key-value store backed by files: one per key, named
+ *        <namespace>.<key> in ESP32_HOST_NVS (default ./esp32-host-nvs/)
+ *
+ * Only the blob calls the sketches use; values survive restarts like NVS.
+ */
+class Preferences {
+public:
+  ~Preferences() { end(); }
+
+  bool begin(const char* name, bool readOnly = false, const char* partition = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putBytes(const char* key, const void* value, size_t length);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+private:
+  bool path(const char* key, char* out, size_t size) const;
+
+  char name_[16] = {0};  // NVS namespaces are at most 15 characters
+  bool open_ = false;
+  bool readOnly_ = false;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef PUBSUBCLIENT_H
+#define PUBSUBCLIENT_H
+
+#include <functional>
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+#ifndef MQTT_MAX_PACKET_SIZE
+#define MQTT_MAX_PACKET_SIZE 256
+#endif
+#ifndef MQTT_KEEPALIVE
+#define MQTT_KEEPALIVE 15
+#endif
+#ifndef MQTT_SOCKET_TIMEOUT
+#define MQTT_SOCKET_TIMEOUT 15
+#endif
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+/**
+ * @brief knolleary PubSubClient (MQTT 3.1.1, QoS 0/1 receive, QoS 0 publish)
+ *
+ * Same limits as the library: packets larger than the buffer size
+ * (MQTT_MAX_PACKET_SIZE = 256 by default) are refused by publish().
+ * ESP32_HOST_MQTT_BROKER=host[:port] overrides the sketch's broker.
+ */
+class PubSubClient : public Print {
+public:
+  PubSubClient() {}
+  explicit PubSubClient(Client& client) : client_(&client) {}
+  ~PubSubClient();
+
+  PubSubClient& setServer(IPAddress ip, uint16_t port);
+  PubSubClient& setServer(const char* domain, uint16_t port);
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+  PubSubClient& setClient(Client& client);
+  PubSubClient& setKeepAlive(uint16_t keepAlive);
+  PubSubClient& setSocketTimeout(uint16_t timeout);
+  bool setBufferSize(uint16_t size);
+  uint16_t getBufferSize() const { return bufferSize_; }
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain,
+               const char* willMessage);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+               uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession = true);
+  void disconnect();
+
+  bool publish(const char* topic, const char* payload);
+  bool publish(const char* topic, const char* payload, bool retained);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int length);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+  bool publish_P(const char* topic, const char* payload, bool retained) {
+    return publish(topic, payload, retained);
+  }
+
+  bool beginPublish(const char* topic, unsigned int length, bool retained);
+  int endPublish();
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  bool subscribe(const char* topic, uint8_t qos = 0);
+  bool unsubscribe(const char* topic);
+  bool loop();
+  bool connected();
+  int state() const { return state_; }
+
+private:
+  bool readByte(uint8_t* result);
+  uint32_t readPacket(uint8_t* headerByte);
+  bool writePacket(uint8_t header, const uint8_t* body, size_t length);
+  size_t writeString(const char* text, uint8_t* out, size_t position);
+  void handlePacket(uint8_t header, uint32_t length);
+
+  Client* client_ = nullptr;
+  uint8_t* buffer_ = nullptr;
+  uint16_t bufferSize_ = 0;
+  uint16_t keepAlive_ = MQTT_KEEPALIVE;
+  uint16_t socketTimeout_ = MQTT_SOCKET_TIMEOUT;
+  uint16_t nextMsgId_ = 1;
+  unsigned long lastOutActivity_ = 0;
+  unsigned long lastInActivity_ = 0;
+  bool pingOutstanding_ = false;
+  int state_ = MQTT_DISCONNECTED;
+  char domain_[64] = {0};
+  IPAddress ip_;
+  uint16_t port_ = 1883;
+  MQTT_CALLBACK_SIGNATURE;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef WEBSERVER_H
+#define WEBSERVER_H
+
+#include <functional>
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+typedef enum {
+  HTTP_DELETE = 0,
+  HTTP_GET = 1,
+  HTTP_HEAD = 2,
+  HTTP_POST = 3,
+  HTTP_PUT = 4,
+  HTTP_OPTIONS = 6,
+  HTTP_PATCH = 28,
+  HTTP_ANY = 255
+} HTTPMethod;
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+#define HTTP_MAX_DATA_WAIT 5000  // ms to wait for the request
+#define HTTP_MAX_SEND_WAIT 5000  // ms to wait for data chunk to be ACKed
+
+/**
+ * @brief ESP32 WebServer on a host socket
+ *
+ * Same model as the target: handleClient() serves at most one connection per
+ * call, one request per connection, "Connection: close". Request reading is
+ * non-blocking; the request is dispatched once headers and body have arrived.
+ */
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80);
+  ~WebServer();
+
+  void begin();
+  void begin(uint16_t port);
+  void close();
+  void stop() { close(); }
+  void handleClient();
+
+  void on(const String& uri, THandlerFunction handler);
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+  void onNotFound(THandlerFunction handler) { notFoundHandler_ = handler; }
+  void enableCORS(bool enable = true) { cors_ = enable; }
+  void enableCrossOrigin(bool enable = true) { enableCORS(enable); }
+
+  String uri() const { return uri_; }
+  HTTPMethod method() const { return method_; }
+  String arg(const String& name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  int args() const { return argCount_; }
+  bool hasArg(const String& name) const;
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+  void collectHeaders(const char* headerKeys[], size_t count);
+  String hostHeader() const { return header("Host"); }
+  IPAddress remoteIP() const { return remoteIp_; }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String(""));
+  void send(int code, const String& contentType, const String& content) {
+    send(code, contentType.c_str(), content);
+  }
+  void send(int code, const char* contentType, const char* content, size_t length);
+  void send_P(int code, PGM_P contentType, PGM_P content);
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t length);
+  void setContentLength(size_t length) { contentLength_ = length; }
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t length);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+
+  static const char* responseCodeToString(int code);
+
+private:
+  static const int MAX_ARGS = 16;
+  static const int MAX_ROUTES = 32;
+  static const size_t MAX_REQUEST = 16384;
+
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+
+  struct Arg {
+    String key;
+    String value;
+  };
+
+  bool parseRequest();
+  void parseArguments(const char* data, size_t length);
+  void dispatch();
+  void sendHeaderBlock(int code, const char* contentType, size_t contentLength);
+  void finishResponse();
+  void closeClient();
+
+  uint16_t port_;
+  int listenFd_ = -1;
+  int clientFd_ = -1;
+  unsigned long clientSince_ = 0;
+  IPAddress remoteIp_;
+  String request_;
+
+  Route routes_[MAX_ROUTES];
+  int routeCount_ = 0;
+  THandlerFunction notFoundHandler_;
+  bool cors_ = false;
+
+  HTTPMethod method_ = HTTP_GET;
+  String uri_;
+  Arg args_[MAX_ARGS];
+  int argCount_ = 0;
+  Arg headers_[MAX_ARGS];
+  int headerCount_ = 0;
+
+  String responseHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool headersSent_ = false;
+  bool chunked_ = false;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef WEBSOCKETSSERVER_H
+#define WEBSOCKETSSERVER_H
+
+#include <functional>
+#include <vector>
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#ifndef WEBSOCKETS_SERVER_CLIENT_MAX
+#define WEBSOCKETS_SERVER_CLIENT_MAX (5)
+#endif
+
+#ifndef WEBSOCKETS_MAX_DATA_SIZE
+#define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
+#endif
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG
+} WStype_t;
+
+/**
+ * @brief links2004 WebSocketsServer API over host sockets (RFC 6455, no TLS)
+ *
+ * Single-threaded like the library: begin() listens, loop() accepts,
+ * completes handshakes and delivers frames to the onEvent() callback.
+ */
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)>
+      WebSocketServerEvent;
+
+  WebSocketsServer(uint16_t port, const String& origin = "", const String& protocol = "arduino");
+  ~WebSocketsServer();
+
+  void begin();
+  void close();
+  void loop();
+  void onEvent(WebSocketServerEvent callback) { callback_ = callback; }
+
+  bool sendTXT(uint8_t num, const uint8_t* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+  bool sendTXT(uint8_t num, const String& payload);
+  bool broadcastTXT(const uint8_t* payload, size_t length = 0);
+  bool broadcastTXT(const char* payload, size_t length = 0);
+  bool broadcastTXT(const String& payload);
+  bool sendBIN(uint8_t num, const uint8_t* payload, size_t length);
+  bool broadcastBIN(const uint8_t* payload, size_t length);
+  bool sendPing(uint8_t num);
+  bool broadcastPing();
+
+  void disconnect();
+  void disconnect(uint8_t num);
+  IPAddress remoteIP(uint8_t num) const;
+  bool clientIsConnected(uint8_t num) const;
+  uint8_t connectedClients(bool ping = false);
+
+  void enableHeartbeat(uint32_t pingIntervalMs, uint32_t pongTimeoutMs, uint8_t disconnectTimeoutCount);
+  void disableHeartbeat() { pingIntervalMs_ = 0; }
+
+private:
+  enum ClientState : uint8_t { CLIENT_EMPTY, CLIENT_HANDSHAKE, CLIENT_CONNECTED };
+
+  struct Client {
+    ClientState state = CLIENT_EMPTY;
+    int fd = -1;
+    IPAddress ip;
+    unsigned long since = 0;
+    std::vector<uint8_t> rx;
+    std::vector<uint8_t> fragments;
+    bool fragmentText = false;
+    unsigned long lastPing = 0;
+    bool awaitingPong = false;
+    uint8_t missedPongs = 0;
+  };
+
+  void acceptClients();
+  void handleHandshake(uint8_t num);
+  void readFrames(uint8_t num);
+  bool processFrame(uint8_t num, uint8_t opcode, bool fin, uint8_t* payload, size_t length);
+  bool sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length);
+  void heartbeat(uint8_t num);
+  void dropClient(uint8_t num, bool notify);
+  void emit(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
+
+  uint16_t port_;
+  int listenFd_ = -1;
+  Client clients_[WEBSOCKETS_SERVER_CLIENT_MAX];
+  WebSocketServerEvent callback_;
+
+  uint32_t pingIntervalMs_ = 0;
+  uint32_t pongTimeoutMs_ = 0;
+  uint8_t disconnectTimeoutCount_ = 0;
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <functional>
+#include <mutex>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+typedef enum {
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+
+typedef union {
+  struct {
+    uint8_t reason;
+  } wifi_sta_disconnected;
+  struct {
+    uint32_t ip;
+  } got_ip;
+} arduino_event_info_t;
+
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef size_t wifi_event_id_t;
+
+#define WIFI_REASON_UNSPECIFIED 1
+#define WIFI_REASON_ASSOC_LEAVE 8
+#define WIFI_REASON_BEACON_TIMEOUT 200
+#define WIFI_REASON_NO_AP_FOUND 201
+
+/**
+ * @brief WiFi station on the host
+ *
+ * begin() "associates" after ESP32_HOST_WIFI_CONNECT_MS (default 50 ms) and
+ * the station then owns the loopback address. ESP32_HOST_WIFI_SCAN_MS is
+ * added unless begin() names the AP's channel and BSSID, and
+ * ESP32_HOST_WIFI_DHCP_MS unless config() set a static address (both
+ * default 0). The one AP is 02:00:00:00:00:01 on ESP32_HOST_WIFI_CHANNEL
+ * (default 6); a begin() naming another BSSID or channel does not find it.
+ * ESP32_HOST_WIFI_DROP_MS after the first connect the AP disappears for
+ * ESP32_HOST_WIFI_OUTAGE_MS (both default 0: never). Events are delivered from the
+ * WiFi calls themselves (status(), begin(), ...), not from another thread.
+ * Calls are serialized by a mutex, so a sketch may use WiFi from more than
+ * one FreeRTOS task as it can on the board.
+ */
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode() const { return mode_; }
+
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+  wl_status_t begin(const String& ssid, const String& passphrase = String()) {
+    return begin(ssid.c_str(), passphrase.c_str());
+  }
+  /**
+   * @brief Connect to one AP on one channel: the ESP32 then skips the full scan
+   */
+  wl_status_t begin(const char* ssid, const char* passphrase, int32_t channel,
+                    const uint8_t* bssid = nullptr, bool connect = true);
+  bool reconnect();
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  bool setAutoReconnect(bool autoReconnect) {
+    autoReconnect_ = autoReconnect;
+    return true;
+  }
+  bool getAutoReconnect() const { return autoReconnect_; }
+  /**
+   * @brief Recorded only: the host radio never sleeps, so no DTIM delay is added
+   */
+  bool setSleep(bool enabled) { return setSleep(enabled ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE); }
+  bool setSleep(wifi_ps_type_t type) {
+    sleep_ = type;
+    return true;
+  }
+  wifi_ps_type_t getSleep() const { return sleep_; }
+  void persistent(bool) {}  // The host never stores credentials itself
+  /**
+   * @brief Static address (no DHCP); a 0.0.0.0 local address returns to DHCP
+   */
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool setHostname(const char* hostname);
+  const char* getHostname() const { return hostname_; }
+
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t = 0) { return gatewayIP(); }
+  String SSID();
+  int8_t RSSI();
+  int32_t channel();
+  uint8_t* BSSID();
+  uint8_t* macAddress(uint8_t* mac);
+  String macAddress();
+
+  bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1,
+              int ssidHidden = 0, int maxConnection = 4);
+  bool softAPdisconnect(bool wifiOff = false);
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+
+  wifi_event_id_t onEvent(WiFiEventCb callback, arduino_event_id_t event = ARDUINO_EVENT_WIFI_READY);
+  wifi_event_id_t onEvent(WiFiEventFuncCb callback, arduino_event_id_t event = ARDUINO_EVENT_WIFI_READY);
+  void removeEvent(wifi_event_id_t id);
+
+  /**
+   * @brief Host only: drop the association as if the AP disappeared
+   */
+  void hostSimulateDisconnect(uint8_t reason = WIFI_REASON_BEACON_TIMEOUT);
+
+private:
+  struct Handler {
+    WiFiEventCb plain;
+    WiFiEventFuncCb func;
+    arduino_event_id_t event;
+    bool active;
+  };
+
+  void update();
+  void fire(arduino_event_id_t event, uint8_t reason = 0);
+
+  wifi_mode_t mode_ = WIFI_OFF;
+  wifi_ps_type_t sleep_ = WIFI_PS_MIN_MODEM;  // The core's default
+  wl_status_t status_ = WL_IDLE_STATUS;
+  unsigned long connectAt_ = 0;
+  bool connecting_ = false;
+  bool autoReconnect_ = true;
+  bool staticIp_ = false;
+  int32_t channel_ = 0;  // From begin(); 0 = scan every channel
+  uint8_t bssid_[6] = {0};
+  bool bssidSet_ = false;
+  bool apMatched_ = true;  // The begin() channel/BSSID are the AP's
+  unsigned long firstConnectMs_ = 0;
+  unsigned long apBackAt_ = 0;  // Simulated outage: connects fail until then
+  bool dropped_ = false;
+  char ssid_[33] = {0};
+  char hostname_[33] = "esp32-host";
+  Handler handlers_[8] = {};
+  std::recursive_mutex mutex_;  // Event handlers may call back into WiFi
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef WIFICLIENT_H
+#define WIFICLIENT_H
+
+#include "Client.h"
+
+/**
+ * @brief TCP client over a real (non-blocking) host socket
+ */
+class WiFiClient : public Client {
+public:
+  WiFiClient() {}
+  ~WiFiClient();
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  void setNoDelay(bool) {}
+  IPAddress remoteIP() const { return remoteIp_; }
+  int fd() const { return fd_; }
+
+private:
+  bool fill();
+
+  int fd_ = -1;
+  bool peerClosed_ = false;
+  IPAddress remoteIp_;
+  uint8_t rx_[1460];
+  size_t rxHead_ = 0;
+  size_t rxTail_ = 0;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef ESP_BT_DEVICE_H
+#define ESP_BT_DEVICE_H
+
+// Host stand-in for ESP-IDF's esp_bt_device.h (see BluetoothSerial::getBtAddress())
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef ESP_BT_MAIN_H
+#define ESP_BT_MAIN_H
+
+// Host stand-in for ESP-IDF's esp_bt_main.h: Bluedroid is always "enabled"
+
+#endif
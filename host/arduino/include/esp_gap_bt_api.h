@@ -0,0 +1,22 @@
+#ifndef ESP_GAP_BT_API_H
+#define ESP_GAP_BT_API_H
+
+// Host subset of ESP-IDF's esp_gap_bt_api.h. The scan mode is recorded only:
+// the host SPP socket accepts a client either way.
+
+typedef int esp_err_t;
+
+typedef enum {
+  ESP_BT_NON_CONNECTABLE,
+  ESP_BT_CONNECTABLE,
+} esp_bt_connection_mode_t;
+
+typedef enum {
+  ESP_BT_NON_DISCOVERABLE,
+  ESP_BT_LIMITED_DISCOVERABLE,
+  ESP_BT_GENERAL_DISCOVERABLE,
+} esp_bt_discovery_mode_t;
+
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t c_mode, esp_bt_discovery_mode_t d_mode);
+
+#endif
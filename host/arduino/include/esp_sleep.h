@@ -0,0 +1,36 @@
+#ifndef ESP_SLEEP_H
+#define ESP_SLEEP_H
+
+#include <stdint.h>
+
+// Host subset of ESP-IDF's esp_sleep.h. esp_deep_sleep_start() waits out
+// the timer, then re-executes the sketch like ESP.restart() with
+// ESP_RST_DEEPSLEEP: RTC_NOINIT_ATTR variables are kept. Wake sources other
+// than the timer are recorded only.
+
+typedef int esp_err_t;
+
+// The pins the sketches pass to wake sources
+typedef enum {
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_2 = 2,
+} gpio_num_t;
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level);
+void esp_deep_sleep_start(void) __attribute__((noreturn));
+
+// ESP_SLEEP_WAKEUP_TIMER after esp_deep_sleep_start(), else UNDEFINED
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+#endif
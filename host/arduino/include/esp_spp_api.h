@@ -0,0 +1,31 @@
+#ifndef ESP_SPP_API_H
+#define ESP_SPP_API_H
+
+#include <stdint.h>
+
+// Host subset of ESP-IDF's esp_spp_api.h: the events BluetoothSerial reports
+
+typedef enum {
+  ESP_SPP_INIT_EVT = 0,
+  ESP_SPP_UNINIT_EVT = 1,
+  ESP_SPP_DISCOVERY_COMP_EVT = 8,
+  ESP_SPP_OPEN_EVT = 26,
+  ESP_SPP_CLOSE_EVT = 27,
+  ESP_SPP_START_EVT = 28,
+  ESP_SPP_CL_INIT_EVT = 29,
+  ESP_SPP_DATA_IND_EVT = 30,
+  ESP_SPP_CONG_EVT = 31,
+  ESP_SPP_WRITE_EVT = 33,
+  ESP_SPP_SRV_OPEN_EVT = 34,
+} esp_spp_cb_event_t;
+
+// The sketches never read the event parameters
+typedef union {
+  struct {
+    uint32_t handle;
+  } srv_open;
+} esp_spp_cb_param_t;
+
+typedef void (*esp_spp_cb_t)(esp_spp_cb_event_t event, esp_spp_cb_param_t* param);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// Host subset of the ESP-IDF FreeRTOS types and macros the sketches use.
+// The tick is 1 ms, as in the Arduino-ESP32 configuration.
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+// Dual-core ESP32: protocol CPU (WiFi, lwIP) and application CPU (Arduino loop)
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+#define ARDUINO_RUNNING_CORE APP_CPU_NUM
+
+#endif
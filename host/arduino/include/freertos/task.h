@@ -0,0 +1,43 @@
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief FreeRTOS tasks on the host: one POSIX thread per task
+ *
+ * The core id is only recorded (xPortGetCoreID() returns it), both "cores"
+ * run wherever Linux schedules them, and priorities are ignored. setup() and
+ * loop() run as the Arduino loop task on ARDUINO_RUNNING_CORE. Direct-to-task
+ * notifications behave as on the board, so a task blocked in
+ * ulTaskNotifyTake() wakes as soon as another task gives it a notification.
+ *
+ * With ESP32_HOST_TASKS=0 tasks are created but never started, which lets a
+ * benchmark drive a task's work function from its own thread.
+ */
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* parameter);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId);
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                              void* parameter, UBaseType_t priority, TaskHandle_t* created) {
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, created,
+                                 tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+BaseType_t xPortGetCoreID();
+
+#endif
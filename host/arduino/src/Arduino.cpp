@@ -0,0 +1,262 @@
+#include "Arduino.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "HostRuntime.h"
+#include "esp_sleep.h"
+
+// ---------------------------------------------------------------------------
+// Time
+
+namespace {
+
+uint64_t monotonicNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t bootNs() {
+  static const uint64_t boot = monotonicNs();
+  return boot;
+}
+
+uint8_t pinStates[64];
+
+}  // namespace
+
+// bootNs() first: on the very first call it sets the boot time, which must
+// not come after the monotonicNs() it is subtracted from
+unsigned long millis() {
+  const uint64_t boot = bootNs();
+  return (unsigned long)(uint32_t)((monotonicNs() - boot) / 1000000ULL);
+}
+
+unsigned long micros() {
+  const uint64_t boot = bootNs();
+  return (unsigned long)(uint32_t)((monotonicNs() - boot) / 1000ULL);
+}
+
+void delay(uint32_t ms) {
+  timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    if (host::stopRequested()) break;
+  }
+}
+
+void delayMicroseconds(uint32_t us) {
+  timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000L};
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+void yield() {
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(pinStates)) pinStates[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pinStates) ? pinStates[pin] : LOW;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  (void)pin;
+  return (uint16_t)(::random() & 0x0FFF);
+}
+
+long random(long max) {
+  return max <= 0 ? 0 : ::random() % max;
+}
+
+long random(long min, long max) {
+  return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) srandom((unsigned)seed);
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+  (void)baud;
+  quiet_ = host::envLong("ESP32_HOST_QUIET", 0) != 0;
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  seedLength_ = seedPosition_ = 0;
+  const char* seed = host::env("ESP32_HOST_SERIAL", "");
+  for (const char* p = seed; *p != '\0' && seedLength_ < sizeof(seed_); p++) {
+    char c = *p;
+    if (c == '\\' && p[1] == 'n') {
+      c = '\n';
+      p++;
+    }
+    seed_[seedLength_++] = c;
+  }
+}
+
+void HardwareSerial::releaseSeedLine() {
+  while (seedPosition_ < seedLength_ && rxTail_ < sizeof(rx_)) {
+    char c = seed_[seedPosition_++];
+    rx_[rxTail_++] = c;
+    if (c == '\n') break;
+  }
+}
+
+void HardwareSerial::fill() {
+  if (rxHead_ == rxTail_) rxHead_ = rxTail_ = 0;
+
+  pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  if (stdinOpen_ && rxTail_ < sizeof(rx_) && poll(&pfd, 1, 0) > 0) {
+    ssize_t n = ::read(STDIN_FILENO, rx_ + rxTail_, sizeof(rx_) - rxTail_);
+    if (n > 0) {
+      rxTail_ += (size_t)n;
+    } else if (n == 0 || (pfd.revents & (POLLHUP | POLLNVAL))) {
+      stdinOpen_ = false;  // EOF - stop polling a closed pipe
+    }
+  }
+
+  if (rxHead_ == rxTail_ && seedPosition_ < seedLength_) {
+    if (emptyPolls_++ > 0) {
+      releaseSeedLine();
+      emptyPolls_ = 0;
+    }
+  }
+}
+
+int HardwareSerial::available() {
+  fill();
+  return (int)(rxTail_ - rxHead_);
+}
+
+int HardwareSerial::read() {
+  if (available() == 0) return -1;
+  return (uint8_t)rx_[rxHead_++];
+}
+
+int HardwareSerial::peek() {
+  if (available() == 0) return -1;
+  return (uint8_t)rx_[rxHead_];
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (!quiet_) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+// ---------------------------------------------------------------------------
+// ESP
+
+EspClass ESP;
+
+uint64_t EspClass::getEfuseMac() {
+  return 0x0100C40A2400ULL;  // 24:0A:C4:00:00:01, little-endian as on the chip
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(monotonicNs() * 240 / 1000);  // 240 MHz equivalent
+}
+
+void EspClass::restart() {
+  fflush(stdout);
+  fprintf(stderr, "[host] ESP.restart() - re-executing\n");
+  host::prepareRestart(ESP_RST_SW);
+  char** args = host::argv();
+  if (args != nullptr) execv("/proc/self/exe", args);
+  exit(0);
+}
+
+esp_reset_reason_t esp_reset_reason() {
+  return (esp_reset_reason_t)host::resetReason();
+}
+
+// ---------------------------------------------------------------------------
+// Deep sleep
+
+namespace {
+
+uint64_t sleepTimerUs = 0;
+
+}  // namespace
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+  sleepTimerUs = time_in_us;
+  return 0;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level) {
+  (void)gpio_num;
+  (void)level;
+  return 0;
+}
+
+void esp_deep_sleep_start() {
+  fflush(stdout);
+  fprintf(stderr, "[host] deep sleep for %llu ms - re-executing\n",
+          (unsigned long long)(sleepTimerUs / 1000));
+  timespec ts = {(time_t)(sleepTimerUs / 1000000), (long)(sleepTimerUs % 1000000) * 1000};
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    if (host::stopRequested()) exit(0);
+  }
+  host::prepareRestart(ESP_RST_DEEPSLEEP);
+  char** args = host::argv();
+  if (args != nullptr) execv("/proc/self/exe", args);
+  exit(0);
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return host::resetReason() == ESP_RST_DEEPSLEEP ? ESP_SLEEP_WAKEUP_TIMER
+                                                   : ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+// ---------------------------------------------------------------------------
+// IPAddress
+
+bool IPAddress::fromString(const char* address) {
+  unsigned int parts[4];
+  char tail;
+  if (sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) {
+    return false;
+  }
+  for (int i = 0; i < 4; i++) {
+    if (parts[i] > 255) return false;
+    bytes_[i] = (uint8_t)parts[i];
+  }
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+  return String(buf);
+}
+
+size_t IPAddress::printTo(Print& p) const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+  return p.print(buf);
+}
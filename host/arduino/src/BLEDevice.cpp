@@ -0,0 +1,69 @@
+// BLE stubs: object graph only, no radio (see BLEDevice.h)
+
+#include "BLEDevice.h"
+
+namespace {
+
+std::string deviceName;
+BLEServer* server = nullptr;
+BLEAdvertising advertising;
+
+}  // namespace
+
+void BLECharacteristic::hostWrite(const char* data, size_t length) {
+  value_.assign(data, length);
+  if (callbacks_ != nullptr) callbacks_->onWrite(this);
+}
+
+BLEService::~BLEService() {
+  for (int i = 0; i < characteristicCount_; i++) delete characteristics_[i];
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const char* uuid, uint32_t properties) {
+  if (characteristicCount_ >= MAX_CHARACTERISTICS) return nullptr;
+  BLECharacteristic* characteristic = new BLECharacteristic(uuid, properties);
+  characteristics_[characteristicCount_++] = characteristic;
+  return characteristic;
+}
+
+BLEServer::~BLEServer() {
+  for (int i = 0; i < serviceCount_; i++) delete services_[i];
+}
+
+BLEService* BLEServer::createService(const char* uuid) {
+  if (serviceCount_ >= MAX_SERVICES) return nullptr;
+  BLEService* service = new BLEService(uuid);
+  services_[serviceCount_++] = service;
+  return service;
+}
+
+void BLEServer::hostConnect() {
+  connected_++;
+  if (callbacks_ != nullptr) callbacks_->onConnect(this);
+}
+
+void BLEServer::hostDisconnect() {
+  if (connected_ > 0) connected_--;
+  if (callbacks_ != nullptr) callbacks_->onDisconnect(this);
+}
+
+void BLEDevice::init(const char* name) {
+  deviceName = name != nullptr ? name : "";
+}
+
+void BLEDevice::deinit(bool releaseMemory) {
+  (void)releaseMemory;
+}
+
+BLEServer* BLEDevice::createServer() {
+  if (server == nullptr) server = new BLEServer();
+  return server;
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+  return &advertising;
+}
+
+std::string BLEDevice::getDeviceName() {
+  return deviceName;
+}
@@ -0,0 +1,124 @@
+// Bluetooth Classic SPP over a loopback TCP socket (see BluetoothSerial.h)
+
+#include "BluetoothSerial.h"
+
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "HostRuntime.h"
+
+namespace {
+
+const uint32_t SEND_TIMEOUT_MS = 5000;
+
+}  // namespace
+
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t c_mode, esp_bt_discovery_mode_t d_mode) {
+  (void)c_mode;
+  (void)d_mode;
+  return 0;
+}
+
+BluetoothSerial::~BluetoothSerial() {
+  end();
+}
+
+bool BluetoothSerial::begin(const String& localName, bool isMaster) {
+  (void)isMaster;
+  end();
+  notify(ESP_SPP_INIT_EVT);
+  listenFd_ = host::listenTcp(HOST_PORT);
+  if (listenFd_ < 0) return false;
+  fprintf(stderr, "[host] BluetoothSerial '%s' (SPP) listening on %s:%u\n", localName.c_str(),
+          host::bindAddress(), host::listenPort(HOST_PORT));
+  notify(ESP_SPP_START_EVT);
+  return true;
+}
+
+void BluetoothSerial::end() {
+  dropClient();
+  host::closeSocket(listenFd_);
+  listenFd_ = -1;
+}
+
+bool BluetoothSerial::hasClient() {
+  poll();
+  return clientFd_ >= 0;
+}
+
+esp_err_t BluetoothSerial::register_callback(esp_spp_cb_t callback) {
+  callback_ = callback;
+  return 0;
+}
+
+bool BluetoothSerial::getBtAddress(uint8_t* mac) {
+  static const uint8_t ADDRESS[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+  memcpy(mac, ADDRESS, sizeof(ADDRESS));
+  return true;
+}
+
+int BluetoothSerial::available() {
+  poll();
+  return (int)(rxTail_ - rxHead_);
+}
+
+int BluetoothSerial::read() {
+  if (available() == 0) return -1;
+  return rx_[rxHead_++];
+}
+
+int BluetoothSerial::peek() {
+  if (available() == 0) return -1;
+  return rx_[rxHead_];
+}
+
+size_t BluetoothSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t BluetoothSerial::write(const uint8_t* buffer, size_t size) {
+  if (clientFd_ < 0) return 0;
+  if (!host::sendAll(clientFd_, buffer, size, SEND_TIMEOUT_MS)) {
+    dropClient();
+    return 0;
+  }
+  return size;
+}
+
+void BluetoothSerial::poll() {
+  if (listenFd_ < 0) return;
+
+  for (;;) {
+    int fd = host::acceptClient(listenFd_, nullptr);
+    if (fd < 0) break;
+    if (clientFd_ >= 0) {
+      host::closeSocket(fd);  // One SPP peer at a time
+      continue;
+    }
+    clientFd_ = fd;
+    rxHead_ = rxTail_ = 0;
+    notify(ESP_SPP_SRV_OPEN_EVT);
+  }
+  if (clientFd_ < 0) return;
+
+  if (rxHead_ == rxTail_) rxHead_ = rxTail_ = 0;
+  if (rxTail_ == sizeof(rx_)) return;
+  ssize_t n = recv(clientFd_, rx_ + rxTail_, sizeof(rx_) - rxTail_, 0);
+  if (n > 0) {
+    rxTail_ += (size_t)n;
+  } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    dropClient();
+  }
+}
+
+void BluetoothSerial::dropClient() {
+  if (clientFd_ < 0) return;
+  host::closeSocket(clientFd_);
+  clientFd_ = -1;  // Bytes already received can still be read
+  notify(ESP_SPP_CLOSE_EVT);
+}
+
+void BluetoothSerial::notify(esp_spp_cb_event_t event) {
+  esp_spp_cb_param_t param = {};
+  if (callback_ != nullptr) callback_(event, &param);
+}
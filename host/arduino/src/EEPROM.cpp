@@ -0,0 +1,54 @@
+#include "EEPROM.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HostRuntime.h"
+
+EEPROMClass EEPROM;
+
+namespace {
+
+const char* eepromPath() {
+  return host::env("ESP32_HOST_EEPROM", "esp32-host-eeprom.bin");
+}
+
+}  // namespace
+
+bool EEPROMClass::begin(size_t size) {
+  end();
+  data_ = (uint8_t*)malloc(size);
+  if (data_ == nullptr) return false;
+  size_ = size;
+  memset(data_, 0xFF, size_);  // Erased flash
+
+  FILE* file = fopen(eepromPath(), "rb");
+  if (file != nullptr) {
+    size_t n = fread(data_, 1, size_, file);
+    (void)n;
+    fclose(file);
+  }
+  return true;
+}
+
+void EEPROMClass::end() {
+  free(data_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool EEPROMClass::commit() {
+  if (data_ == nullptr) return false;
+  FILE* file = fopen(eepromPath(), "wb");
+  if (file == nullptr) return false;
+  bool ok = fwrite(data_, 1, size_, file) == size_;
+  return fclose(file) == 0 && ok;
+}
+
+uint8_t EEPROMClass::read(int address) const {
+  return (address >= 0 && (size_t)address < size_) ? data_[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  if (address >= 0 && (size_t)address < size_) data_[address] = value;
+}
@@ -0,0 +1,142 @@
+#include "freertos/task.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "Arduino.h"
+#include "HostRuntime.h"
+
+struct HostTask {
+  TaskFunction_t function;
+  void* parameter;
+  char name[16];
+  BaseType_t core;
+  pthread_t thread;
+  bool started;
+
+  std::mutex mutex;
+  std::condition_variable notified;
+  uint32_t notifications;
+};
+
+namespace {
+
+const int MAX_TASKS = 16;
+// ulTaskNotifyTake() re-checks host::stopRequested() at least this often
+const uint32_t STOP_POLL_MS = 50;
+
+HostTask loopTask;  // setup()/loop() on the main thread
+HostTask tasks[MAX_TASKS];
+int taskCount = 0;
+std::mutex tasksMutex;
+
+thread_local HostTask* currentTask = nullptr;
+
+void* runTask(void* argument) {
+  HostTask* task = static_cast<HostTask*>(argument);
+  currentTask = task;
+  task->function(task->parameter);
+  return nullptr;  // A FreeRTOS task must not return; treat it as vTaskDelete(NULL)
+}
+
+}  // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId) {
+  (void)stackDepth;
+  (void)priority;
+
+  HostTask* task;
+  {
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    if (taskCount == MAX_TASKS) return pdFAIL;
+    task = &tasks[taskCount++];
+  }
+  task->function = function;
+  task->parameter = parameter;
+  strncpy(task->name, name != nullptr ? name : "", sizeof(task->name) - 1);
+  task->core = coreId == tskNO_AFFINITY ? PRO_CPU_NUM : coreId;
+  task->notifications = 0;
+  if (created != nullptr) *created = task;
+
+  if (host::envLong("ESP32_HOST_TASKS", 1) == 0) return pdPASS;
+  if (pthread_create(&task->thread, nullptr, runTask, task) != 0) return pdFAIL;
+  task->started = true;
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == currentTask) pthread_exit(nullptr);
+  if (task->started) {
+    pthread_cancel(task->thread);
+    pthread_join(task->thread, nullptr);
+    task->started = false;
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (currentTask == nullptr) {
+    // First call from the main thread: it is the Arduino loop task
+    strncpy(loopTask.name, "loopTask", sizeof(loopTask.name) - 1);
+    loopTask.core = ARDUINO_RUNNING_CORE;
+    currentTask = &loopTask;
+  }
+  return currentTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+  if (task == nullptr) task = xTaskGetCurrentTaskHandle();
+  return task->name;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notifications++;
+  }
+  task->notified.notify_one();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  HostTask* task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(task->mutex);
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticksToWait);
+  while (task->notifications == 0 && !host::stopRequested()) {
+    auto slice = std::chrono::steady_clock::now() + std::chrono::milliseconds(STOP_POLL_MS);
+    if (ticksToWait != portMAX_DELAY) {
+      if (std::chrono::steady_clock::now() >= deadline) break;
+      if (deadline < slice) slice = deadline;
+    }
+    task->notified.wait_until(lock, slice);
+  }
+
+  const uint32_t value = task->notifications;
+  if (value != 0) task->notifications = clearCountOnExit ? 0 : value - 1;
+  return value;
+}
+
+BaseType_t xPortGetCoreID() {
+  return xTaskGetCurrentTaskHandle()->core;
+}
+
+void host::stopTasks() {
+  std::lock_guard<std::mutex> lock(tasksMutex);
+  for (int i = 0; i < taskCount; i++) {
+    if (!tasks[i].started) continue;
+    // Tasks loop forever; cancellation ends them at their next blocking call
+    pthread_cancel(tasks[i].thread);
+    pthread_join(tasks[i].thread, nullptr);
+    tasks[i].started = false;
+  }
+}
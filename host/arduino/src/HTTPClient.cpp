@@ -0,0 +1,209 @@
+#include "HTTPClient.h"
+
+#include <strings.h>
+
+bool HTTPClient::begin(const String& url) {
+  end();
+  if (!url.startsWith("http://")) return false;  // No TLS on the host
+
+  String rest = url.substring(7);
+  int slash = rest.indexOf('/');
+  String authority = slash >= 0 ? rest.substring(0, slash) : rest;
+  uri_ = slash >= 0 ? rest.substring(slash) : String("/");
+
+  int colon = authority.indexOf(':');
+  if (colon >= 0) {
+    host_ = authority.substring(0, colon);
+    port_ = (uint16_t)authority.substring(colon + 1).toInt();
+  } else {
+    host_ = authority;
+    port_ = 80;
+  }
+  haveRequest_ = host_.length() > 0;
+  return haveRequest_;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  bool ok = begin(url);
+  client_ = &client;
+  return ok;
+}
+
+bool HTTPClient::begin(const String& host, uint16_t port, const String& uri) {
+  end();
+  host_ = host;
+  port_ = port;
+  uri_ = uri;
+  haveRequest_ = true;
+  return true;
+}
+
+void HTTPClient::end() {
+  if (client_ != nullptr) client_->stop();
+  client_ = &ownClient_;
+  headers_ = "";
+  responseHeaders_ = "";
+  contentLength_ = -1;
+  chunked_ = false;
+  haveRequest_ = false;
+}
+
+bool HTTPClient::connected() {
+  return client_->connected();
+}
+
+void HTTPClient::addHeader(const String& name, const String& value, bool first, bool replace) {
+  (void)replace;
+  String line = name + ": " + value + "\r\n";
+  if (first) {
+    headers_ = line + headers_;
+  } else {
+    headers_ += line;
+  }
+}
+
+int HTTPClient::GET() { return sendRequest("GET"); }
+int HTTPClient::POST(const String& payload) { return sendRequest("POST", payload); }
+int HTTPClient::POST(const uint8_t* payload, size_t size) { return sendRequest("POST", payload, size); }
+int HTTPClient::PUT(const String& payload) { return sendRequest("PUT", payload); }
+int HTTPClient::PATCH(const String& payload) { return sendRequest("PATCH", payload); }
+
+int HTTPClient::sendRequest(const char* type, const String& payload) {
+  return sendRequest(type, (const uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::sendRequest(const char* type, const uint8_t* payload, size_t size) {
+  if (!haveRequest_) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!client_->connect(host_.c_str(), port_, connectTimeoutMs_)) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  String request = String(type) + " " + uri_ + " HTTP/1.1\r\n";
+  request += "Host: " + host_;
+  if (port_ != 80) request += ":" + String((unsigned int)port_);
+  request += "\r\nUser-Agent: " + userAgent_ + "\r\n";
+  request += "Connection: close\r\n";
+  request += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+  request += headers_;
+  if (payload != nullptr && size > 0) {
+    request += "Content-Length: " + String((unsigned long)size) + "\r\n";
+  }
+  request += "\r\n";
+
+  if (client_->write((const uint8_t*)request.c_str(), request.length()) != request.length()) {
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (payload != nullptr && size > 0 && client_->write(payload, size) != size) {
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+  return readResponseHeaders();
+}
+
+bool HTTPClient::readLine(String& line) {
+  line = "";
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs_) {
+    int c = client_->read();
+    if (c < 0) {
+      if (!client_->connected()) return false;
+      delay(1);
+      continue;
+    }
+    if (c == '\n') {
+      if (line.endsWith("\r")) line.remove(line.length() - 1);
+      return true;
+    }
+    line += (char)c;
+  }
+  return false;
+}
+
+int HTTPClient::readResponseHeaders() {
+  String line;
+  if (!readLine(line)) return client_->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+  if (!line.startsWith("HTTP/")) return HTTPC_ERROR_NO_HTTP_SERVER;
+  int space = line.indexOf(' ');
+  int code = space >= 0 ? (int)line.substring(space + 1).toInt() : 0;
+
+  contentLength_ = -1;
+  chunked_ = false;
+  responseHeaders_ = "";
+  while (readLine(line) && line.length() > 0) {
+    responseHeaders_ += line + "\n";
+    int colon = line.indexOf(':');
+    if (colon < 0) continue;
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    value.trim();
+    if (name.equalsIgnoreCase("Content-Length")) contentLength_ = (int)value.toInt();
+    if (name.equalsIgnoreCase("Transfer-Encoding") && value.equalsIgnoreCase("chunked")) chunked_ = true;
+  }
+  return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+String HTTPClient::getString() {
+  String body;
+  if (!chunked_) {
+    if (contentLength_ > 0) body.reserve((unsigned int)contentLength_);
+    unsigned long start = millis();
+    while ((contentLength_ < 0 || (int)body.length() < contentLength_) && millis() - start < timeoutMs_) {
+      int c = client_->read();
+      if (c < 0) {
+        if (!client_->connected()) break;
+        delay(1);
+        continue;
+      }
+      body += (char)c;
+    }
+    return body;
+  }
+
+  String line;
+  while (readLine(line)) {
+    long size = strtol(line.c_str(), nullptr, 16);
+    if (size <= 0) break;
+    for (long i = 0; i < size; i++) {
+      int c = client_->read();
+      unsigned long start = millis();
+      while (c < 0 && client_->connected() && millis() - start < timeoutMs_) {
+        delay(1);
+        c = client_->read();
+      }
+      if (c < 0) return body;
+      body += (char)c;
+    }
+    readLine(line);  // CRLF after the chunk
+  }
+  return body;
+}
+
+String HTTPClient::header(const char* name) const {
+  size_t nameLength = strlen(name);
+  const char* p = responseHeaders_.c_str();
+  while (*p != '\0') {
+    const char* end = strchr(p, '\n');
+    if (end == nullptr) end = p + strlen(p);
+    if (strncasecmp(p, name, nameLength) == 0 && p[nameLength] == ':') {
+      String value(p + nameLength + 1, (unsigned int)(end - p - nameLength - 1));
+      value.trim();
+      return value;
+    }
+    p = *end != '\0' ? end + 1 : end;
+  }
+  return String();
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_STREAM: return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+    case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
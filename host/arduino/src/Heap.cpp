@@ -0,0 +1,206 @@
+// Modelled ESP32 heap: ESP.getFreeHeap() & co, heap_caps_*(), and the
+// allocator hooks (esp_heap_trace_alloc_hook / _free_hook), fed by
+// interposing the malloc family
+
+#include <errno.h>
+#include <malloc.h>
+
+#include <atomic>
+
+#include "Arduino.h"
+#include "HostRuntime.h"
+#include "esp_heap_caps.h"
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define HOST_INTERPOSE_MALLOC 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || \
+    __has_feature(memory_sanitizer)
+#define HOST_INTERPOSE_MALLOC 0
+#endif
+#endif
+#ifndef HOST_INTERPOSE_MALLOC
+#define HOST_INTERPOSE_MALLOC 1
+#endif
+
+namespace {
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+typedef struct mallinfo2 HostMallinfo;
+HostMallinfo hostMallinfo() { return mallinfo2(); }
+#else
+typedef struct mallinfo HostMallinfo;
+HostMallinfo hostMallinfo() { return mallinfo(); }
+#endif
+
+std::atomic<long> liveBlocks(0);
+std::atomic<long> liveBytes(0);
+std::atomic<host::AllocationObserver> observer(nullptr);
+
+// Counted by the interposer when it is active: mallinfo() walks the free
+// lists and costs microseconds, too much for a per-request figure
+size_t heapInUse() {
+  if (host::allocationHooksAvailable()) {
+    const long bytes = liveBytes.load(std::memory_order_relaxed);
+    return bytes > 0 ? (size_t)bytes : 0;
+  }
+  return (size_t)hostMallinfo().uordblks;
+}
+
+// Free chunks below the top of the arena: holes between live allocations
+size_t heapHoles() {
+  HostMallinfo info = hostMallinfo();
+  return (size_t)info.fordblks > (size_t)info.keepcost
+             ? (size_t)info.fordblks - (size_t)info.keepcost
+             : 0;
+}
+
+// Allocations made before setup() (runtime, static constructors) are not
+// part of the modelled ESP32 heap
+size_t baselineHeap = 0;
+size_t baselineHoles = 0;
+
+inline void noteAllocation(void* ptr, size_t size, bool newBlock) {
+  if (newBlock) liveBlocks.fetch_add(1, std::memory_order_relaxed);
+  liveBytes.fetch_add((long)malloc_usable_size(ptr), std::memory_order_relaxed);
+  host::AllocationObserver observe = observer.load(std::memory_order_relaxed);
+  if (observe != nullptr) observe(size);
+  if (esp_heap_trace_alloc_hook != nullptr) esp_heap_trace_alloc_hook(ptr, size, MALLOC_CAP_8BIT);
+}
+
+inline void noteFree(void* ptr) {
+  liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+  liveBytes.fetch_sub((long)malloc_usable_size(ptr), std::memory_order_relaxed);
+  if (esp_heap_trace_free_hook != nullptr) esp_heap_trace_free_hook(ptr);
+}
+
+}  // namespace
+
+#if HOST_INTERPOSE_MALLOC
+
+// glibc's allocator entry points; the definitions below take precedence over
+// libc's malloc family for the whole process, including operator new.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  if (ptr != nullptr) noteAllocation(ptr, size, true);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  if (ptr != nullptr) noteAllocation(ptr, count * size, true);
+  return ptr;
+}
+
+// A growing String reallocs; each call counts as one allocation of the new size
+void* realloc(void* ptr, size_t size) {
+  if (ptr != nullptr && size == 0) {
+    noteFree(ptr);
+    return __libc_realloc(ptr, size);
+  }
+  const size_t oldSize = ptr != nullptr ? malloc_usable_size(ptr) : 0;
+  void* resized = __libc_realloc(ptr, size);
+  if (resized != nullptr) {
+    liveBytes.fetch_sub((long)oldSize, std::memory_order_relaxed);
+    noteAllocation(resized, size, ptr == nullptr);
+  }
+  return resized;
+}
+
+void free(void* ptr) {
+  if (ptr != nullptr) noteFree(ptr);
+  __libc_free(ptr);
+}
+
+// Aligned operator new and friends, so their free() is balanced
+void* memalign(size_t alignment, size_t size) {
+  void* ptr = __libc_memalign(alignment, size);
+  if (ptr != nullptr) noteAllocation(ptr, size, true);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+  void* ptr = memalign(alignment, size);
+  if (ptr == nullptr) return ENOMEM;
+  *result = ptr;
+  return 0;
+}
+}
+
+#endif
+
+bool host::allocationHooksAvailable() {
+  return HOST_INTERPOSE_MALLOC != 0;
+}
+
+void host::setAllocationObserver(AllocationObserver observe) {
+  observer.store(observe, std::memory_order_relaxed);
+}
+
+void host::markHeapBaseline() {
+  // One arena for every thread, so mallinfo() sees the tasks' allocations too
+  mallopt(M_ARENA_MAX, 1);
+  baselineHeap = heapInUse();
+  baselineHoles = heapHoles();
+}
+
+uint32_t EspClass::getFreeHeap() {
+  size_t used = heapInUse();
+  used = used > baselineHeap ? used - baselineHeap : 0;
+  uint32_t free = used >= HOST_HEAP_SIZE ? 0 : HOST_HEAP_SIZE - (uint32_t)used;
+  uint32_t lowest = minFreeHeap_.load(std::memory_order_relaxed);
+  while (free < lowest && !minFreeHeap_.compare_exchange_weak(lowest, free)) {
+  }
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  getFreeHeap();
+  return minFreeHeap_;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+  return ESP.getFreeHeap();
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+  return ESP.getMinFreeHeap();
+}
+
+// Approximation: the free heap minus the holes opened since boot, i.e. the
+// contiguous space past the last live allocation
+size_t heap_caps_get_largest_free_block(uint32_t) {
+  const size_t free = ESP.getFreeHeap();
+  size_t holes = heapHoles();
+  holes = holes > baselineHoles ? holes - baselineHoles : 0;
+  return holes >= free ? 0 : free - holes;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  const HostMallinfo mallinfo = hostMallinfo();
+  const long live = liveBlocks.load(std::memory_order_relaxed);
+
+  info->total_free_bytes = heap_caps_get_free_size(caps);
+  info->total_allocated_bytes = EspClass::HOST_HEAP_SIZE - info->total_free_bytes;
+  info->largest_free_block = heap_caps_get_largest_free_block(caps);
+  info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+  info->allocated_blocks = live > 0 ? (size_t)live : 0;  // 0 under sanitizers
+  info->free_blocks = (size_t)mallinfo.ordblks + (size_t)mallinfo.smblks;
+  info->total_blocks = info->allocated_blocks + info->free_blocks;
+}
@@ -0,0 +1,229 @@
+#include "HostRuntime.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include "esp_system.h"
+
+// Bounds of RTC_NOINIT_ATTR (Arduino.h), defined by the linker when a
+// sketch declares any such variable
+extern "C" char __start_rtc_noinit[] __attribute__((weak));
+extern "C" char __stop_rtc_noinit[] __attribute__((weak));
+
+namespace host {
+namespace {
+
+char** savedArgv = nullptr;
+std::atomic<bool> stopFlag(false);
+int runResetReason = ESP_RST_POWERON;
+
+size_t rtcSize() {
+  return __start_rtc_noinit != nullptr ? (size_t)(__stop_rtc_noinit - __start_rtc_noinit) : 0;
+}
+
+// Power-on leaves the memory as the loader did (zeroed); a restart brings back the saved bytes
+void restoreRtc() {
+  const char* path = getenv("ESP32_HOST_RTC_STATE");
+  if (path == nullptr) return;
+  FILE* file = fopen(path, "rb");
+  if (file != nullptr) {
+    if (fread(__start_rtc_noinit, 1, rtcSize(), file) != rtcSize()) {
+      fprintf(stderr, "[host] RTC memory not restored: the saved state has another size\n");
+    }
+    fclose(file);
+  }
+  unlink(path);
+  unsetenv("ESP32_HOST_RTC_STATE");
+}
+
+}  // namespace
+
+void init(int argc, char** argv) {
+  (void)argc;
+  savedArgv = argv;
+  signal(SIGPIPE, SIG_IGN);  // Peer resets surface as send() errors
+  runResetReason = (int)envLong("ESP32_HOST_RESET_REASON", ESP_RST_POWERON);
+  unsetenv("ESP32_HOST_RESET_REASON");
+  restoreRtc();
+}
+
+char** argv() {
+  return savedArgv;
+}
+
+int resetReason() {
+  return runResetReason;
+}
+
+void prepareRestart(int reason) {
+  char value[8];
+  snprintf(value, sizeof(value), "%d", reason);
+  setenv("ESP32_HOST_RESET_REASON", value, 1);
+  if (rtcSize() == 0) return;
+
+  char path[] = "/tmp/esp32-host-rtc-XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return;
+  const bool saved = write(fd, __start_rtc_noinit, rtcSize()) == (ssize_t)rtcSize();
+  close(fd);
+  if (saved) {
+    setenv("ESP32_HOST_RTC_STATE", path, 1);
+  } else {
+    unlink(path);
+  }
+}
+
+const char* env(const char* name, const char* fallback) {
+  const char* value = getenv(name);
+  return (value != nullptr && value[0] != '\0') ? value : fallback;
+}
+
+long envLong(const char* name, long fallback) {
+  const char* value = getenv(name);
+  if (value == nullptr || value[0] == '\0') return fallback;
+  return strtol(value, nullptr, 10);
+}
+
+uint16_t listenPort(uint16_t port) {
+  static const long offset = envLong("ESP32_HOST_PORT_OFFSET", 8000);
+  return (uint16_t)(port + offset);
+}
+
+const char* bindAddress() {
+  return env("ESP32_HOST_BIND", "127.0.0.1");
+}
+
+bool stopRequested() {
+  return stopFlag.load(std::memory_order_relaxed);
+}
+
+void requestStop() {
+  stopFlag.store(true, std::memory_order_relaxed);
+}
+
+bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+int listenTcp(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(listenPort(port));
+  if (inet_pton(AF_INET, bindAddress(), &address.sin_addr) != 1) {
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+    fprintf(stderr, "[host] cannot listen on %s:%u: %s\n", bindAddress(),
+            listenPort(port), strerror(errno));
+    close(fd);
+    return -1;
+  }
+  setNonBlocking(fd);
+  return fd;
+}
+
+int acceptClient(int listenFd, uint32_t* remoteAddress) {
+  sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  int fd = accept(listenFd, (sockaddr*)&address, &length);
+  if (fd < 0) return -1;
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  setNonBlocking(fd);
+  if (remoteAddress != nullptr) *remoteAddress = address.sin_addr.s_addr;
+  return fd;
+}
+
+int connectTcp(const char* hostname, uint16_t port, uint32_t timeoutMs) {
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(hostname, service, &hints, &result) != 0 || result == nullptr) return -1;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    freeaddrinfo(result);
+    return -1;
+  }
+  setNonBlocking(fd);
+
+  int rc = connect(fd, result->ai_addr, result->ai_addrlen);
+  freeaddrinfo(result);
+  if (rc != 0 && errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+
+  pollfd pfd = {fd, POLLOUT, 0};
+  if (rc != 0 && poll(&pfd, 1, (int)timeoutMs) <= 0) {
+    close(fd);
+    return -1;
+  }
+  int error = 0;
+  socklen_t length = sizeof(error);
+  getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+  if (error != 0) {
+    close(fd);
+    return -1;
+  }
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+bool sendAll(int fd, const void* data, size_t length, uint32_t timeoutMs) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (length > 0) {
+    ssize_t n = send(fd, p, length, MSG_NOSIGNAL);
+    if (n > 0) {
+      p += n;
+      length -= (size_t)n;
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      pollfd pfd = {fd, POLLOUT, 0};
+      if (poll(&pfd, 1, (int)timeoutMs) <= 0) return false;
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool waitReadable(int fd, uint32_t timeoutMs) {
+  pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, (int)timeoutMs) > 0;
+}
+
+void closeSocket(int fd) {
+  if (fd >= 0) close(fd);
+}
+
+}  // namespace host
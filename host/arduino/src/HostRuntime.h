@@ -0,0 +1,69 @@
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Process-level settings and socket helpers shared by the emulated libraries
+ *
+ * Environment:
+ *   ESP32_HOST_PORT_OFFSET  added to every listen port (default 8000, so :80 -> :8080)
+ *   ESP32_HOST_BIND         listen address (default 127.0.0.1)
+ *   ESP32_HOST_SERIAL       text fed to Serial before stdin ("\n" escapes allowed)
+ *   ESP32_HOST_QUIET        1 = discard Serial output
+ *   ESP32_HOST_RUN_MS       exit cleanly after this many ms (0 = run forever)
+ *   ESP32_HOST_MQTT_BROKER  host[:port] used instead of the sketch's broker
+ *   ESP32_HOST_TASKS        0 = FreeRTOS tasks are created but not started (benchmarks)
+ *
+ * Set by ESP.restart() for the next run (not meant to be set by hand):
+ *   ESP32_HOST_RESET_REASON esp_reset_reason_t of the new run (default poweron)
+ *   ESP32_HOST_RTC_STATE    file with the RTC_NOINIT_ATTR variables to restore
+ */
+namespace host {
+
+void init(int argc, char** argv);
+char** argv();
+
+// esp_reset_reason() of this run
+int resetReason();
+
+// Save the RTC_NOINIT_ATTR variables and the reset reason for the process
+// that ESP.restart() is about to exec; init() restores them
+void prepareRestart(int reason);
+
+const char* env(const char* name, const char* fallback);
+long envLong(const char* name, long fallback);
+
+uint16_t listenPort(uint16_t port);
+const char* bindAddress();
+
+// Heap in use at this point is excluded from ESP.getFreeHeap(); call
+// before any task starts (it also limits malloc to one arena)
+void markHeapBaseline();
+
+// Called with the size of every malloc / calloc / realloc, from any thread
+typedef void (*AllocationObserver)(size_t size);
+
+// False under ASan/TSan, which own malloc: no observer, no heap hooks
+bool allocationHooksAvailable();
+void setAllocationObserver(AllocationObserver observer);
+
+bool stopRequested();
+void requestStop();
+
+// Cancel and join every started FreeRTOS task (before main() returns)
+void stopTasks();
+
+// Sockets
+int listenTcp(uint16_t port);
+int acceptClient(int listenFd, uint32_t* remoteAddress);
+int connectTcp(const char* hostname, uint16_t port, uint32_t timeoutMs);
+bool setNonBlocking(int fd);
+bool sendAll(int fd, const void* data, size_t length, uint32_t timeoutMs);
+bool waitReadable(int fd, uint32_t timeoutMs);
+void closeSocket(int fd);
+
+}  // namespace host
+
+#endif
@@ -0,0 +1,102 @@
+#include "Preferences.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "HostRuntime.h"
+
+namespace {
+
+const char* nvsDirectory() {
+  return host::env("ESP32_HOST_NVS", "esp32-host-nvs");
+}
+
+}  // namespace
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partition) {
+  (void)partition;
+  end();
+  if (name == nullptr || name[0] == '\0' || strlen(name) >= sizeof(name_)) return false;
+  if (!readOnly) mkdir(nvsDirectory(), 0755);  // Fails harmlessly when it exists
+  strcpy(name_, name);
+  readOnly_ = readOnly;
+  open_ = true;
+  return true;
+}
+
+void Preferences::end() {
+  open_ = false;
+}
+
+bool Preferences::path(const char* key, char* out, size_t size) const {
+  if (!open_ || key == nullptr || key[0] == '\0' || strlen(key) > 15) return false;
+  int n = snprintf(out, size, "%s/%s.%s", nvsDirectory(), name_, key);
+  return n > 0 && (size_t)n < size;
+}
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  DIR* dir = opendir(nvsDirectory());
+  if (dir == nullptr) return true;
+  size_t prefix = strlen(name_);
+  while (dirent* entry = readdir(dir)) {
+    if (strncmp(entry->d_name, name_, prefix) == 0 && entry->d_name[prefix] == '.') {
+      char file[512];
+      snprintf(file, sizeof(file), "%s/%s", nvsDirectory(), entry->d_name);
+      unlink(file);
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  char file[512];
+  if (readOnly_ || !path(key, file, sizeof(file))) return false;
+  return unlink(file) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  char file[512];
+  struct stat info;
+  return path(key, file, sizeof(file)) && stat(file, &info) == 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  char file[512];
+  if (readOnly_ || value == nullptr || !path(key, file, sizeof(file))) return 0;
+  // Write then rename, so a killed process leaves the old value, as NVS does
+  char temp[520];
+  snprintf(temp, sizeof(temp), "%s.tmp", file);
+  FILE* out = fopen(temp, "wb");
+  if (out == nullptr) return 0;
+  bool ok = fwrite(value, 1, length, out) == length;
+  ok = fclose(out) == 0 && ok;
+  if (!ok || rename(temp, file) != 0) {
+    unlink(temp);
+    return 0;
+  }
+  return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  char file[512];
+  struct stat info;
+  if (!path(key, file, sizeof(file)) || stat(file, &info) != 0) return 0;
+  return (size_t)info.st_size;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+  char file[512];
+  if (buffer == nullptr || !path(key, file, sizeof(file))) return 0;
+  size_t length = getBytesLength(key);
+  if (length == 0 || length > maxLength) return 0;  // NVS refuses a short buffer
+  FILE* in = fopen(file, "rb");
+  if (in == nullptr) return 0;
+  size_t n = fread(buffer, 1, length, in);
+  fclose(in);
+  return n == length ? length : 0;
+}
@@ -0,0 +1,420 @@
+#include "PubSubClient.h"
+
+#include "HostRuntime.h"
+
+namespace {
+
+const uint8_t MQTTCONNECT = 1 << 4;
+const uint8_t MQTTCONNACK = 2 << 4;
+const uint8_t MQTTPUBLISH = 3 << 4;
+const uint8_t MQTTPUBACK = 4 << 4;
+const uint8_t MQTTSUBSCRIBE = 8 << 4;
+const uint8_t MQTTSUBACK = 9 << 4;
+const uint8_t MQTTUNSUBSCRIBE = 10 << 4;
+const uint8_t MQTTPINGREQ = 12 << 4;
+const uint8_t MQTTPINGRESP = 13 << 4;
+const uint8_t MQTTDISCONNECT = 14 << 4;
+const uint8_t MQTTQOS1 = 1 << 1;
+
+const size_t MQTT_MAX_HEADER_SIZE = 5;
+
+size_t encodeLength(uint32_t length, uint8_t* out) {
+  size_t n = 0;
+  do {
+    uint8_t digit = length & 0x7F;
+    length >>= 7;
+    if (length > 0) digit |= 0x80;
+    out[n++] = digit;
+  } while (length > 0);
+  return n;
+}
+
+}  // namespace
+
+PubSubClient::~PubSubClient() {
+  free(buffer_);
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ip, uint16_t port) {
+  ip_ = ip;
+  domain_[0] = '\0';
+  port_ = port;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+  strncpy(domain_, domain, sizeof(domain_) - 1);
+  domain_[sizeof(domain_) - 1] = '\0';
+  port_ = port;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+  this->callback = callback;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& client) {
+  client_ = &client;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
+  keepAlive_ = keepAlive;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
+  socketTimeout_ = timeout;
+  return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+  if (size == 0) return false;
+  uint8_t* resized = (uint8_t*)realloc(buffer_, size);
+  if (resized == nullptr) return false;
+  buffer_ = resized;
+  bufferSize_ = size;
+  return true;
+}
+
+bool PubSubClient::connect(const char* id) {
+  return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  return connect(id, user, pass, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain,
+                           const char* willMessage) {
+  return connect(id, nullptr, nullptr, willTopic, willQos, willRetain, willMessage, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage,
+                           bool cleanSession) {
+  if (client_ == nullptr) return false;
+  if (connected()) return true;
+  if (buffer_ == nullptr && !setBufferSize(MQTT_MAX_PACKET_SIZE)) return false;
+
+  // Host override for the broker the sketch hard-codes
+  char broker[64];
+  uint16_t port = port_;
+  const char* overrideBroker = host::env("ESP32_HOST_MQTT_BROKER", "");
+  if (overrideBroker[0] != '\0') {
+    strncpy(broker, overrideBroker, sizeof(broker) - 1);
+    broker[sizeof(broker) - 1] = '\0';
+    char* colon = strchr(broker, ':');
+    if (colon != nullptr) {
+      *colon = '\0';
+      port = (uint16_t)atoi(colon + 1);
+    }
+  } else if (domain_[0] != '\0') {
+    strcpy(broker, domain_);
+  } else {
+    strncpy(broker, ip_.toString().c_str(), sizeof(broker) - 1);
+    broker[sizeof(broker) - 1] = '\0';
+  }
+
+  if (!client_->connect(broker, port)) {
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  nextMsgId_ = 1;
+  size_t length = MQTT_MAX_HEADER_SIZE;
+  static const uint8_t PROTOCOL[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04};
+  memcpy(buffer_ + length, PROTOCOL, sizeof(PROTOCOL));
+  length += sizeof(PROTOCOL);
+
+  uint8_t flags = cleanSession ? 0x02 : 0x00;
+  if (willTopic != nullptr) flags |= 0x04 | (willQos << 3) | (willRetain ? 0x20 : 0x00);
+  if (user != nullptr) {
+    flags |= 0x80;
+    if (pass != nullptr) flags |= 0x40;
+  }
+  buffer_[length++] = flags;
+  buffer_[length++] = (uint8_t)(keepAlive_ >> 8);
+  buffer_[length++] = (uint8_t)keepAlive_;
+
+  size_t needed = length + 2 + strlen(id);
+  if (willTopic != nullptr) needed += 4 + strlen(willTopic) + strlen(willMessage);
+  if (user != nullptr) needed += 2 + strlen(user) + (pass != nullptr ? 2 + strlen(pass) : 0);
+  if (needed > bufferSize_) {
+    client_->stop();
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  length = writeString(id, buffer_, length);
+  if (willTopic != nullptr) {
+    length = writeString(willTopic, buffer_, length);
+    length = writeString(willMessage, buffer_, length);
+  }
+  if (user != nullptr) {
+    length = writeString(user, buffer_, length);
+    if (pass != nullptr) length = writeString(pass, buffer_, length);
+  }
+
+  if (!writePacket(MQTTCONNECT, buffer_ + MQTT_MAX_HEADER_SIZE, length - MQTT_MAX_HEADER_SIZE)) {
+    client_->stop();
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  lastInActivity_ = lastOutActivity_ = millis();
+  unsigned long start = millis();
+  while (!client_->available()) {
+    if (millis() - start >= socketTimeout_ * 1000UL || !client_->connected()) {
+      state_ = MQTT_CONNECTION_TIMEOUT;
+      client_->stop();
+      return false;
+    }
+    delay(1);
+  }
+
+  uint8_t header = 0;
+  uint32_t received = readPacket(&header);
+  if (received == 4 && (header & 0xF0) == MQTTCONNACK) {
+    if (buffer_[3] == 0) {
+      lastInActivity_ = millis();
+      pingOutstanding_ = false;
+      state_ = MQTT_CONNECTED;
+      return true;
+    }
+    state_ = buffer_[3];
+  } else {
+    state_ = MQTT_CONNECT_FAILED;
+  }
+  client_->stop();
+  return false;
+}
+
+void PubSubClient::disconnect() {
+  if (client_ != nullptr && client_->connected()) {
+    uint8_t packet[2] = {MQTTDISCONNECT, 0};
+    client_->write(packet, 2);
+    client_->stop();
+  }
+  state_ = MQTT_DISCONNECTED;
+  lastInActivity_ = lastOutActivity_ = millis();
+}
+
+bool PubSubClient::connected() {
+  if (client_ == nullptr) return false;
+  if (!client_->connected()) {
+    if (state_ == MQTT_CONNECTED) {
+      state_ = MQTT_CONNECTION_LOST;
+      client_->stop();
+    }
+    return false;
+  }
+  return state_ == MQTT_CONNECTED;
+}
+
+bool PubSubClient::readByte(uint8_t* result) {
+  unsigned long start = millis();
+  while (!client_->available()) {
+    if (millis() - start >= socketTimeout_ * 1000UL || !client_->connected()) return false;
+    delay(1);
+  }
+  *result = (uint8_t)client_->read();
+  return true;
+}
+
+uint32_t PubSubClient::readPacket(uint8_t* headerByte) {
+  uint8_t header;
+  if (!readByte(&header)) return 0;
+  *headerByte = header;
+
+  uint32_t length = 0;
+  uint32_t multiplier = 1;
+  uint8_t digit;
+  size_t headerLength = 1;
+  do {
+    if (headerLength == 5 || !readByte(&digit)) return 0;
+    length += (digit & 0x7F) * multiplier;
+    multiplier <<= 7;
+    buffer_[headerLength++] = digit;
+  } while (digit & 0x80);
+  buffer_[0] = header;
+
+  // Payloads that do not fit the buffer are read and discarded, as in the library
+  uint32_t total = headerLength + length;
+  for (uint32_t i = headerLength; i < total; i++) {
+    if (!readByte(&digit)) return 0;
+    if (i < bufferSize_) buffer_[i] = digit;
+  }
+  lastInActivity_ = millis();
+  return total <= bufferSize_ ? total : 0;
+}
+
+bool PubSubClient::writePacket(uint8_t header, const uint8_t* body, size_t length) {
+  uint8_t fixed[MQTT_MAX_HEADER_SIZE];
+  fixed[0] = header;
+  size_t lengthBytes = encodeLength((uint32_t)length, fixed + 1);
+  // body sits right after MQTT_MAX_HEADER_SIZE reserved bytes when it is in buffer_,
+  // so the fixed header can be placed in front and sent in one write
+  if (body == buffer_ + MQTT_MAX_HEADER_SIZE) {
+    uint8_t* start = buffer_ + MQTT_MAX_HEADER_SIZE - 1 - lengthBytes;
+    memcpy(start, fixed, 1 + lengthBytes);
+    size_t total = 1 + lengthBytes + length;
+    lastOutActivity_ = millis();
+    return client_->write(start, total) == total;
+  }
+  lastOutActivity_ = millis();
+  return client_->write(fixed, 1 + lengthBytes) == 1 + lengthBytes &&
+         (length == 0 || client_->write(body, length) == length);
+}
+
+size_t PubSubClient::writeString(const char* text, uint8_t* out, size_t position) {
+  size_t length = strlen(text);
+  out[position++] = (uint8_t)(length >> 8);
+  out[position++] = (uint8_t)length;
+  memcpy(out + position, text, length);
+  return position + length;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+  return publish(topic, (const uint8_t*)payload, payload != nullptr ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  return publish(topic, (const uint8_t*)payload, payload != nullptr ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+  return publish(topic, payload, length, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length,
+                           bool retained) {
+  if (!connected()) return false;
+  if (bufferSize_ < MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length) return false;
+
+  size_t position = writeString(topic, buffer_, MQTT_MAX_HEADER_SIZE);
+  if (length > 0) memcpy(buffer_ + position, payload, length);
+  position += length;
+  uint8_t header = MQTTPUBLISH | (retained ? 1 : 0);
+  return writePacket(header, buffer_ + MQTT_MAX_HEADER_SIZE, position - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int length, bool retained) {
+  if (!connected()) return false;
+  size_t topicLength = strlen(topic);
+  uint8_t fixed[MQTT_MAX_HEADER_SIZE];
+  fixed[0] = MQTTPUBLISH | (retained ? 1 : 0);
+  size_t lengthBytes = encodeLength((uint32_t)(2 + topicLength + length), fixed + 1);
+  uint8_t topicHeader[2] = {(uint8_t)(topicLength >> 8), (uint8_t)topicLength};
+  lastOutActivity_ = millis();
+  return client_->write(fixed, 1 + lengthBytes) == 1 + lengthBytes &&
+         client_->write(topicHeader, 2) == 2 &&
+         client_->write((const uint8_t*)topic, topicLength) == topicLength;
+}
+
+int PubSubClient::endPublish() {
+  return 1;
+}
+
+size_t PubSubClient::write(uint8_t c) {
+  lastOutActivity_ = millis();
+  return client_ != nullptr ? client_->write(c) : 0;
+}
+
+size_t PubSubClient::write(const uint8_t* buffer, size_t size) {
+  lastOutActivity_ = millis();
+  return client_ != nullptr ? client_->write(buffer, size) : 0;
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+  if (qos > 1 || !connected()) return false;
+  if (bufferSize_ < 9 + strlen(topic)) return false;
+
+  size_t position = MQTT_MAX_HEADER_SIZE;
+  uint16_t id = nextMsgId_++;
+  if (nextMsgId_ == 0) nextMsgId_ = 1;
+  buffer_[position++] = (uint8_t)(id >> 8);
+  buffer_[position++] = (uint8_t)id;
+  position = writeString(topic, buffer_, position);
+  buffer_[position++] = qos;
+  return writePacket(MQTTSUBSCRIBE | MQTTQOS1, buffer_ + MQTT_MAX_HEADER_SIZE,
+                     position - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+  if (!connected()) return false;
+  if (bufferSize_ < 9 + strlen(topic)) return false;
+
+  size_t position = MQTT_MAX_HEADER_SIZE;
+  uint16_t id = nextMsgId_++;
+  if (nextMsgId_ == 0) nextMsgId_ = 1;
+  buffer_[position++] = (uint8_t)(id >> 8);
+  buffer_[position++] = (uint8_t)id;
+  position = writeString(topic, buffer_, position);
+  return writePacket(MQTTUNSUBSCRIBE | MQTTQOS1, buffer_ + MQTT_MAX_HEADER_SIZE,
+                     position - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::loop() {
+  if (!connected()) return false;
+
+  unsigned long now = millis();
+  unsigned long keepAliveMs = keepAlive_ * 1000UL;
+  if (keepAliveMs > 0 && (now - lastInActivity_ > keepAliveMs || now - lastOutActivity_ > keepAliveMs)) {
+    if (pingOutstanding_) {
+      state_ = MQTT_CONNECTION_TIMEOUT;
+      client_->stop();
+      return false;
+    }
+    uint8_t packet[2] = {MQTTPINGREQ, 0};
+    client_->write(packet, 2);
+    lastOutActivity_ = lastInActivity_ = now;
+    pingOutstanding_ = true;
+  }
+
+  while (client_->available()) {
+    uint8_t header = 0;
+    uint32_t length = readPacket(&header);
+    if (length > 0) handlePacket(header, length);
+    if (!connected()) return false;
+  }
+  return true;
+}
+
+void PubSubClient::handlePacket(uint8_t header, uint32_t length) {
+  uint8_t type = header & 0xF0;
+  if (type == MQTTPINGRESP) {
+    pingOutstanding_ = false;
+    return;
+  }
+  if (type == MQTTPINGREQ) {
+    uint8_t packet[2] = {MQTTPINGRESP, 0};
+    client_->write(packet, 2);
+    return;
+  }
+  if (type != MQTTPUBLISH || !callback) return;
+
+  // Skip the remaining-length bytes
+  size_t position = 1;
+  while (buffer_[position] & 0x80) position++;
+  position++;
+
+  uint16_t topicLength = ((uint16_t)buffer_[position] << 8) | buffer_[position + 1];
+  // Shift the topic down one byte so it can be null-terminated in place
+  memmove(buffer_ + position, buffer_ + position + 2, topicLength);
+  buffer_[position + topicLength] = '\0';
+  char* topic = (char*)buffer_ + position;
+  size_t payloadStart = position + topicLength + 2;
+
+  if ((header & 0x06) == MQTTQOS1) {
+    uint16_t msgId = ((uint16_t)buffer_[payloadStart] << 8) | buffer_[payloadStart + 1];
+    payloadStart += 2;
+    callback(topic, buffer_ + payloadStart, length - payloadStart);
+    uint8_t ack[4] = {MQTTPUBACK, 2, (uint8_t)(msgId >> 8), (uint8_t)msgId};
+    client_->write(ack, 4);
+    lastOutActivity_ = millis();
+  } else {
+    callback(topic, buffer_ + payloadStart, length - payloadStart);
+  }
+}
@@ -0,0 +1,92 @@
+#include "Sha1.h"
+
+#include <string.h>
+
+namespace host {
+namespace {
+
+uint32_t rotl(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+void processBlock(const uint8_t block[64], uint32_t state[5]) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+           ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+  }
+  for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rotl(b, 30);
+    b = a;
+    a = temp;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+}
+
+}  // namespace
+
+void sha1(const uint8_t* data, size_t length, uint8_t digest[20]) {
+  uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+  size_t offset = 0;
+  for (; offset + 64 <= length; offset += 64) processBlock(data + offset, state);
+
+  uint8_t tail[128] = {0};
+  size_t remaining = length - offset;
+  memcpy(tail, data + offset, remaining);
+  tail[remaining] = 0x80;
+  size_t tailLength = remaining + 1 + 8 <= 64 ? 64 : 128;
+  uint64_t bits = (uint64_t)length * 8;
+  for (int i = 0; i < 8; i++) tail[tailLength - 1 - i] = (uint8_t)(bits >> (8 * i));
+  processBlock(tail, state);
+  if (tailLength == 128) processBlock(tail + 64, state);
+
+  for (int i = 0; i < 5; i++) {
+    digest[i * 4] = (uint8_t)(state[i] >> 24);
+    digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+    digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+    digest[i * 4 + 3] = (uint8_t)state[i];
+  }
+}
+
+size_t base64Encode(const uint8_t* data, size_t length, char* out) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t n = 0;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t chunk = (uint32_t)data[i] << 16;
+    if (i + 1 < length) chunk |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) chunk |= data[i + 2];
+    out[n++] = ALPHABET[(chunk >> 18) & 0x3F];
+    out[n++] = ALPHABET[(chunk >> 12) & 0x3F];
+    out[n++] = i + 1 < length ? ALPHABET[(chunk >> 6) & 0x3F] : '=';
+    out[n++] = i + 2 < length ? ALPHABET[chunk & 0x3F] : '=';
+  }
+  out[n] = '\0';
+  return n;
+}
+
+}  // namespace host
@@ -0,0 +1,21 @@
+#ifndef HOST_SHA1_H
+#define HOST_SHA1_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace host {
+
+/**
+ * @brief SHA-1 digest (WebSocket handshake only - not for security)
+ */
+void sha1(const uint8_t* data, size_t length, uint8_t digest[20]);
+
+/**
+ * @brief Base64-encode into out (needs 4 * ((length + 2) / 3) + 1 bytes)
+ */
+size_t base64Encode(const uint8_t* data, size_t length, char* out);
+
+}  // namespace host
+
+#endif
@@ -0,0 +1,440 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+// Same digit formatting as the ESP32 core's itoa/ultoa family
+void formatUnsigned(unsigned long long value, unsigned char base, char* out) {
+  char tmp[66];
+  int n = 0;
+  if (base < 2 || base > 36) base = 10;
+  do {
+    int digit = value % base;
+    tmp[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value != 0);
+  for (int i = 0; i < n; i++) out[i] = tmp[n - 1 - i];
+  out[n] = '\0';
+}
+
+void formatSigned(long long value, unsigned char base, char* out) {
+  if (value < 0 && base == 10) {
+    out[0] = '-';
+    formatUnsigned(0ULL - (unsigned long long)value, base, out + 1);
+  } else {
+    formatUnsigned((unsigned long long)value, base, out);
+  }
+}
+
+void formatFloat(double value, unsigned int decimalPlaces, char* out, size_t size) {
+  if (decimalPlaces > 15) decimalPlaces = 15;
+  snprintf(out, size, "%.*f", (int)decimalPlaces, value);
+}
+
+}  // namespace
+
+String::String(const char* cstr) {
+  if (cstr != nullptr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length) {
+  if (cstr != nullptr) copy(cstr, length);
+}
+
+String::String(const String& str) {
+  copy(str.buffer(), str.len_);
+}
+
+String::String(String&& str) noexcept {
+  move(str);
+}
+
+String::String(char c) {
+  char buf[2] = {c, '\0'};
+  copy(buf, 1);
+}
+
+String::String(unsigned char value, unsigned char base) {
+  char buf[10];
+  formatUnsigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(int value, unsigned char base) {
+  char buf[36];
+  formatSigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned int value, unsigned char base) {
+  char buf[36];
+  formatUnsigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(long value, unsigned char base) {
+  char buf[68];
+  formatSigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base) {
+  char buf[68];
+  formatUnsigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(long long value, unsigned char base) {
+  char buf[68];
+  formatSigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(unsigned long long value, unsigned char base) {
+  char buf[68];
+  formatUnsigned(value, base, buf);
+  copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned int decimalPlaces) {
+  char buf[64];
+  formatFloat(value, decimalPlaces, buf, sizeof(buf));
+  copy(buf, strlen(buf));
+}
+
+String::String(double value, unsigned int decimalPlaces) {
+  char buf[64];
+  formatFloat(value, decimalPlaces, buf, sizeof(buf));
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  invalidate();
+}
+
+void String::invalidate() {
+  free(heap_);
+  heap_ = nullptr;
+  capacity_ = 0;
+  len_ = 0;
+  sso_[0] = '\0';
+}
+
+bool String::reserve(unsigned int size) {
+  if (capacity() >= size) return true;
+  return changeBuffer(size);
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+  if (maxStrLen < SSO_SIZE) {
+    if (!isSSO()) {
+      // Shrinking back into the inline buffer
+      memcpy(sso_, heap_, len_ + 1);
+      free(heap_);
+      heap_ = nullptr;
+      capacity_ = 0;
+    }
+    return true;
+  }
+
+  unsigned int newSize = (maxStrLen + 16) & ~0xfu;
+  char* newBuffer = (char*)realloc(heap_, newSize);
+  if (newBuffer == nullptr) return false;
+  if (isSSO()) memcpy(newBuffer, sso_, len_ + 1);
+  heap_ = newBuffer;
+  capacity_ = newSize - 1;
+  return true;
+}
+
+String& String::copy(const char* cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  memmove(wbuffer(), cstr, length);
+  len_ = length;
+  wbuffer()[len_] = '\0';
+  return *this;
+}
+
+void String::move(String& rhs) {
+  if (this == &rhs) return;
+  free(heap_);
+  heap_ = rhs.heap_;
+  capacity_ = rhs.capacity_;
+  len_ = rhs.len_;
+  memcpy(sso_, rhs.sso_, SSO_SIZE);
+  rhs.heap_ = nullptr;
+  rhs.capacity_ = 0;
+  rhs.len_ = 0;
+  rhs.sso_[0] = '\0';
+}
+
+String& String::operator=(const String& rhs) {
+  if (this != &rhs) copy(rhs.buffer(), rhs.len_);
+  return *this;
+}
+
+String& String::operator=(String&& rhs) noexcept {
+  move(rhs);
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  if (cstr == nullptr) {
+    invalidate();
+    return *this;
+  }
+  return copy(cstr, strlen(cstr));
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+  if (cstr == nullptr) return false;
+  if (length == 0) return true;
+  unsigned int newLength = len_ + length;
+  // cstr may point into our own buffer, which reserve() can move
+  if (cstr >= buffer() && cstr < buffer() + len_ + 1) {
+    size_t offset = cstr - buffer();
+    if (!reserve(newLength)) return false;
+    cstr = buffer() + offset;
+  } else if (!reserve(newLength)) {
+    return false;
+  }
+  memmove(wbuffer() + len_, cstr, length);
+  len_ = newLength;
+  wbuffer()[len_] = '\0';
+  return true;
+}
+
+bool String::concat(const String& str) { return concat(str.buffer(), str.len_); }
+bool String::concat(const char* cstr) { return cstr != nullptr && concat(cstr, strlen(cstr)); }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(unsigned char value) { return concat(String(value)); }
+bool String::concat(int value) { return concat(String(value)); }
+bool String::concat(unsigned int value) { return concat(String(value)); }
+bool String::concat(long value) { return concat(String(value)); }
+bool String::concat(unsigned long value) { return concat(String(value)); }
+bool String::concat(long long value) { return concat(String(value)); }
+bool String::concat(unsigned long long value) { return concat(String(value)); }
+bool String::concat(float value) { return concat(String(value)); }
+bool String::concat(double value) { return concat(String(value)); }
+
+int String::compareTo(const String& s) const {
+  return strcmp(buffer(), s.buffer());
+}
+
+bool String::equals(const String& s) const {
+  return len_ == s.len_ && memcmp(buffer(), s.buffer(), len_) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  if (cstr == nullptr) return len_ == 0;
+  return strcmp(buffer(), cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (len_ != s.len_) return false;
+  return strncasecmp(buffer(), s.buffer(), len_) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > len_ || prefix.len_ > len_ - offset) return false;
+  return memcmp(buffer() + offset, prefix.buffer(), prefix.len_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.len_ > len_) return false;
+  return memcmp(buffer() + len_ - suffix.len_, suffix.buffer(), suffix.len_) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return operator[](index);
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < len_) wbuffer()[index] = c;
+}
+
+char String::operator[](unsigned int index) const {
+  return index < len_ ? buffer()[index] : '\0';
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= len_) {
+    dummy = '\0';
+    return dummy;
+  }
+  return wbuffer()[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+  if (bufsize == 0 || buf == nullptr) return;
+  if (index >= len_) {
+    buf[0] = '\0';
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > len_ - index) n = len_ - index;
+  memcpy(buf, buffer() + index, n);
+  buf[n] = '\0';
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+  getBytes((unsigned char*)buf, bufsize, index);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len_) return -1;
+  const char* found = (const char*)memchr(buffer() + fromIndex, ch, len_ - fromIndex);
+  return found == nullptr ? -1 : (int)(found - buffer());
+}
+
+int String::indexOf(const char* str, unsigned int fromIndex) const {
+  if (fromIndex > len_) return -1;
+  const char* found = strstr(buffer() + fromIndex, str);
+  return found == nullptr ? -1 : (int)(found - buffer());
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  return indexOf(str.buffer(), fromIndex);
+}
+
+int String::lastIndexOf(char ch) const {
+  const char* found = strrchr(buffer(), ch);
+  return found == nullptr ? -1 : (int)(found - buffer());
+}
+
+int String::lastIndexOf(const String& str) const {
+  if (str.len_ > len_) return -1;
+  for (int i = (int)(len_ - str.len_); i >= 0; i--) {
+    if (memcmp(buffer() + i, str.buffer(), str.len_) == 0) return i;
+  }
+  return -1;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int tmp = beginIndex;
+    beginIndex = endIndex;
+    endIndex = tmp;
+  }
+  if (beginIndex >= len_) return String();
+  if (endIndex > len_) endIndex = len_;
+  return String(buffer() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  char* p = wbuffer();
+  for (unsigned int i = 0; i < len_; i++) {
+    if (p[i] == find) p[i] = replace;
+  }
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (len_ == 0 || find.len_ == 0) return;
+  String result;
+  result.reserve(len_);
+  unsigned int i = 0;
+  while (i < len_) {
+    const char* found = strstr(buffer() + i, find.buffer());
+    if (found == nullptr) break;
+    unsigned int at = found - buffer();
+    result.concat(buffer() + i, at - i);
+    result.concat(replace);
+    i = at + find.len_;
+  }
+  if (i < len_) result.concat(buffer() + i, len_ - i);
+  *this = static_cast<String&&>(result);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len_) return;
+  if (count > len_ - index) count = len_ - index;
+  char* p = wbuffer();
+  memmove(p + index, p + index + count, len_ - index - count);
+  len_ -= count;
+  p[len_] = '\0';
+}
+
+void String::toLowerCase() {
+  char* p = wbuffer();
+  for (unsigned int i = 0; i < len_; i++) p[i] = tolower((unsigned char)p[i]);
+}
+
+void String::toUpperCase() {
+  char* p = wbuffer();
+  for (unsigned int i = 0; i < len_; i++) p[i] = toupper((unsigned char)p[i]);
+}
+
+void String::trim() {
+  if (len_ == 0) return;
+  char* p = wbuffer();
+  unsigned int begin = 0;
+  while (begin < len_ && isspace((unsigned char)p[begin])) begin++;
+  unsigned int end = len_;
+  while (end > begin && isspace((unsigned char)p[end - 1])) end--;
+  len_ = end - begin;
+  if (begin > 0) memmove(p, p + begin, len_);
+  p[len_] = '\0';
+}
+
+long String::toInt() const {
+  return atol(buffer());
+}
+
+float String::toFloat() const {
+  return (float)atof(buffer());
+}
+
+double String::toDouble() const {
+  return atof(buffer());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(String&& lhs, const String& rhs) {
+  lhs.concat(rhs);
+  return static_cast<String&&>(lhs);
+}
+
+String operator+(String&& lhs, const char* rhs) {
+  lhs.concat(rhs);
+  return static_cast<String&&>(lhs);
+}
+
+String operator+(const String& lhs, char rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, float rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, double rhs) { return lhs + String(rhs); }
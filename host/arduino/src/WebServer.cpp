@@ -0,0 +1,372 @@
+#include "WebServer.h"
+
+#include <errno.h>
+#include <strings.h>
+#include <sys/socket.h>
+
+#include "HostRuntime.h"
+
+namespace {
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+String urlDecode(const char* text, size_t length) {
+  String decoded;
+  decoded.reserve(length);
+  for (size_t i = 0; i < length; i++) {
+    char c = text[i];
+    if (c == '+') {
+      c = ' ';
+    } else if (c == '%' && i + 2 < length && hexValue(text[i + 1]) >= 0 &&
+               hexValue(text[i + 2]) >= 0) {
+      c = (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+      i += 2;
+    }
+    decoded += c;
+  }
+  return decoded;
+}
+
+HTTPMethod parseMethod(const char* method, size_t length) {
+  struct Entry {
+    const char* name;
+    HTTPMethod method;
+  };
+  static const Entry METHODS[] = {
+    {"GET", HTTP_GET}, {"POST", HTTP_POST}, {"PUT", HTTP_PUT}, {"DELETE", HTTP_DELETE},
+    {"HEAD", HTTP_HEAD}, {"OPTIONS", HTTP_OPTIONS}, {"PATCH", HTTP_PATCH},
+  };
+  for (const Entry& entry : METHODS) {
+    if (strlen(entry.name) == length && strncmp(entry.name, method, length) == 0) return entry.method;
+  }
+  return HTTP_ANY;
+}
+
+}  // namespace
+
+WebServer::WebServer(int port) : port_((uint16_t)port) {
+}
+
+WebServer::~WebServer() {
+  close();
+}
+
+void WebServer::begin() {
+  close();
+  listenFd_ = host::listenTcp(port_);
+  if (listenFd_ >= 0) {
+    fprintf(stderr, "[host] WebServer :%u listening on %s:%u\n", port_, host::bindAddress(),
+            host::listenPort(port_));
+  }
+}
+
+void WebServer::begin(uint16_t port) {
+  port_ = port;
+  begin();
+}
+
+void WebServer::close() {
+  closeClient();
+  host::closeSocket(listenFd_);
+  listenFd_ = -1;
+}
+
+void WebServer::on(const String& uri, THandlerFunction handler) {
+  on(uri, HTTP_ANY, handler);
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+  if (routeCount_ >= MAX_ROUTES) return;
+  routes_[routeCount_++] = Route{uri, method, handler};
+}
+
+void WebServer::handleClient() {
+  if (listenFd_ < 0) return;
+
+  if (clientFd_ < 0) {
+    uint32_t remote = 0;
+    clientFd_ = host::acceptClient(listenFd_, &remote);
+    if (clientFd_ < 0) return;
+    remoteIp_ = IPAddress(remote);
+    clientSince_ = millis();
+    request_ = "";
+  }
+
+  char buffer[1460];
+  for (;;) {
+    ssize_t n = recv(clientFd_, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      request_.concat(buffer, (unsigned int)n);
+      if (request_.length() > MAX_REQUEST) {
+        closeClient();
+        return;
+      }
+      continue;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      closeClient();  // Client went away before sending a full request
+      return;
+    }
+    break;
+  }
+
+  if (parseRequest()) {
+    dispatch();
+    closeClient();
+  } else if (millis() - clientSince_ > HTTP_MAX_DATA_WAIT) {
+    closeClient();
+  }
+}
+
+bool WebServer::parseRequest() {
+  const char* data = request_.c_str();
+  const char* headerEnd = strstr(data, "\r\n\r\n");
+  if (headerEnd == nullptr) return false;
+  size_t headerLength = headerEnd - data + 4;
+
+  // Request line: METHOD SP URI SP VERSION
+  const char* lineEnd = strstr(data, "\r\n");
+  const char* space1 = (const char*)memchr(data, ' ', lineEnd - data);
+  if (space1 == nullptr) return false;
+  const char* space2 = (const char*)memchr(space1 + 1, ' ', lineEnd - space1 - 1);
+  if (space2 == nullptr) space2 = lineEnd;
+
+  method_ = parseMethod(data, space1 - data);
+  const char* path = space1 + 1;
+  const char* query = (const char*)memchr(path, '?', space2 - path);
+  const char* pathEnd = query != nullptr ? query : space2;
+  uri_ = urlDecode(path, pathEnd - path);
+
+  headerCount_ = 0;
+  size_t contentLength = 0;
+  bool isForm = false;
+  for (const char* line = lineEnd + 2; line < headerEnd;) {
+    const char* end = strstr(line, "\r\n");
+    const char* colon = (const char*)memchr(line, ':', end - line);
+    if (colon != nullptr && headerCount_ < MAX_ARGS) {
+      const char* value = colon + 1;
+      while (value < end && *value == ' ') value++;
+      Arg& header = headers_[headerCount_++];
+      header.key = String(line, colon - line);
+      header.value = String(value, end - value);
+      if (header.key.equalsIgnoreCase("Content-Length")) contentLength = header.value.toInt();
+      if (header.key.equalsIgnoreCase("Content-Type") &&
+          header.value.startsWith("application/x-www-form-urlencoded")) {
+        isForm = true;
+      }
+    }
+    line = end + 2;
+  }
+
+  if (request_.length() < headerLength + contentLength) return false;
+
+  argCount_ = 0;
+  if (query != nullptr) parseArguments(query + 1, space2 - query - 1);
+  const char* body = data + headerLength;
+  if (isForm) {
+    parseArguments(body, contentLength);
+  } else if (contentLength > 0 && argCount_ < MAX_ARGS) {
+    args_[argCount_].key = "plain";
+    args_[argCount_].value = String(body, contentLength);
+    argCount_++;
+  }
+  return true;
+}
+
+void WebServer::parseArguments(const char* data, size_t length) {
+  const char* end = data + length;
+  while (data < end && argCount_ < MAX_ARGS) {
+    const char* amp = (const char*)memchr(data, '&', end - data);
+    const char* pairEnd = amp != nullptr ? amp : end;
+    const char* eq = (const char*)memchr(data, '=', pairEnd - data);
+    if (pairEnd > data) {
+      Arg& arg = args_[argCount_++];
+      if (eq != nullptr) {
+        arg.key = urlDecode(data, eq - data);
+        arg.value = urlDecode(eq + 1, pairEnd - eq - 1);
+      } else {
+        arg.key = urlDecode(data, pairEnd - data);
+        arg.value = "";
+      }
+    }
+    data = pairEnd + 1;
+  }
+}
+
+void WebServer::dispatch() {
+  responseHeaders_ = "";
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  headersSent_ = false;
+  chunked_ = false;
+
+  for (int i = 0; i < routeCount_; i++) {
+    const Route& route = routes_[i];
+    if ((route.method == HTTP_ANY || route.method == method_) && route.uri == uri_) {
+      route.handler();
+      finishResponse();
+      return;
+    }
+  }
+
+  if (notFoundHandler_) {
+    notFoundHandler_();
+  } else {
+    send(404, "text/plain", String("Not found: ") + uri_);
+  }
+  finishResponse();
+}
+
+void WebServer::finishResponse() {
+  if (chunked_ && clientFd_ >= 0) {
+    host::sendAll(clientFd_, "0\r\n\r\n", 5, HTTP_MAX_SEND_WAIT);
+  }
+  chunked_ = false;
+}
+
+void WebServer::closeClient() {
+  if (clientFd_ >= 0) {
+    shutdown(clientFd_, SHUT_WR);
+    host::closeSocket(clientFd_);
+  }
+  clientFd_ = -1;
+  request_ = "";
+}
+
+String WebServer::arg(const String& name) const {
+  for (int i = 0; i < argCount_; i++) {
+    if (args_[i].key == name) return args_[i].value;
+  }
+  return String();
+}
+
+String WebServer::arg(int i) const {
+  return i >= 0 && i < argCount_ ? args_[i].value : String();
+}
+
+String WebServer::argName(int i) const {
+  return i >= 0 && i < argCount_ ? args_[i].key : String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+  for (int i = 0; i < argCount_; i++) {
+    if (args_[i].key == name) return true;
+  }
+  return false;
+}
+
+String WebServer::header(const String& name) const {
+  for (int i = 0; i < headerCount_; i++) {
+    if (headers_[i].key.equalsIgnoreCase(name)) return headers_[i].value;
+  }
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+  for (int i = 0; i < headerCount_; i++) {
+    if (headers_[i].key.equalsIgnoreCase(name)) return true;
+  }
+  return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], size_t count) {
+  // Every header is kept on the host (up to MAX_ARGS)
+  (void)headerKeys;
+  (void)count;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  if (first) {
+    responseHeaders_ = line + responseHeaders_;
+  } else {
+    responseHeaders_ += line;
+  }
+}
+
+void WebServer::sendHeaderBlock(int code, const char* contentType, size_t contentLength) {
+  String head = "HTTP/1.1 ";
+  head += code;
+  head += " ";
+  head += responseCodeToString(code);
+  head += "\r\n";
+  if (contentType != nullptr && contentType[0] != '\0') {
+    head += "Content-Type: ";
+    head += contentType;
+    head += "\r\n";
+  }
+  if (contentLength == CONTENT_LENGTH_UNKNOWN) {
+    head += "Transfer-Encoding: chunked\r\n";
+    chunked_ = true;
+  } else {
+    head += "Content-Length: ";
+    head += (unsigned long)contentLength;
+    head += "\r\n";
+  }
+  if (cors_) head += "Access-Control-Allow-Origin: *\r\n";
+  head += responseHeaders_;
+  head += "Connection: close\r\n\r\n";
+  responseHeaders_ = "";
+  headersSent_ = true;
+
+  if (clientFd_ >= 0) host::sendAll(clientFd_, head.c_str(), head.length(), HTTP_MAX_SEND_WAIT);
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  send(code, contentType, content.c_str(), content.length());
+}
+
+void WebServer::send(int code, const char* contentType, const char* content, size_t length) {
+  size_t declared = contentLength_ == CONTENT_LENGTH_NOT_SET ? length : contentLength_;
+  sendHeaderBlock(code, contentType, declared);
+  if (length > 0) sendContent(content, length);
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content) {
+  send(code, contentType, content, content != nullptr ? strlen(content) : 0);
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t length) {
+  send(code, contentType, content, length);
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+  if (clientFd_ < 0) return;
+  if (chunked_) {
+    if (length == 0) return;  // The terminating chunk is sent by finishResponse()
+    char size[12];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", length);
+    host::sendAll(clientFd_, size, (size_t)n, HTTP_MAX_SEND_WAIT);
+    host::sendAll(clientFd_, content, length, HTTP_MAX_SEND_WAIT);
+    host::sendAll(clientFd_, "\r\n", 2, HTTP_MAX_SEND_WAIT);
+  } else {
+    host::sendAll(clientFd_, content, length, HTTP_MAX_SEND_WAIT);
+  }
+}
+
+const char* WebServer::responseCodeToString(int code) {
+  switch (code) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Time-out";
+    case 413: return "Request Entity Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
@@ -0,0 +1,462 @@
+#include "WebSocketsServer.h"
+
+#include <errno.h>
+#include <strings.h>
+#include <sys/socket.h>
+
+#include "HostRuntime.h"
+#include "Sha1.h"
+
+namespace {
+
+const uint8_t OP_CONTINUATION = 0x0;
+const uint8_t OP_TEXT = 0x1;
+const uint8_t OP_BINARY = 0x2;
+const uint8_t OP_CLOSE = 0x8;
+const uint8_t OP_PING = 0x9;
+const uint8_t OP_PONG = 0xA;
+
+const uint32_t HANDSHAKE_TIMEOUT_MS = 5000;
+const uint32_t SEND_TIMEOUT_MS = 5000;
+
+/**
+ * @brief Find a header value in a raw request (case-insensitive name)
+ */
+bool findHeader(const char* request, const char* name, char* value, size_t size) {
+  size_t nameLength = strlen(name);
+  for (const char* line = strstr(request, "\r\n"); line != nullptr; line = strstr(line, "\r\n")) {
+    line += 2;
+    if (strncasecmp(line, name, nameLength) == 0 && line[nameLength] == ':') {
+      const char* start = line + nameLength + 1;
+      while (*start == ' ') start++;
+      const char* end = strstr(start, "\r\n");
+      if (end == nullptr) return false;
+      size_t length = (size_t)(end - start);
+      if (length >= size) length = size - 1;
+      memcpy(value, start, length);
+      value[length] = '\0';
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+WebSocketsServer::WebSocketsServer(uint16_t port, const String& origin, const String& protocol)
+    : port_(port) {
+  (void)origin;
+  (void)protocol;
+}
+
+WebSocketsServer::~WebSocketsServer() {
+  close();
+}
+
+void WebSocketsServer::begin() {
+  close();
+  listenFd_ = host::listenTcp(port_);
+  if (listenFd_ >= 0) {
+    fprintf(stderr, "[host] WebSocketsServer :%u listening on %s:%u\n", port_,
+            host::bindAddress(), host::listenPort(port_));
+  }
+}
+
+void WebSocketsServer::close() {
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) dropClient(i, false);
+  host::closeSocket(listenFd_);
+  listenFd_ = -1;
+}
+
+void WebSocketsServer::loop() {
+  if (listenFd_ < 0) return;
+  acceptClients();
+
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    switch (clients_[i].state) {
+      case CLIENT_HANDSHAKE:
+        handleHandshake(i);
+        break;
+      case CLIENT_CONNECTED:
+        readFrames(i);
+        if (clients_[i].state == CLIENT_CONNECTED) heartbeat(i);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void WebSocketsServer::acceptClients() {
+  for (;;) {
+    uint32_t remote = 0;
+    int fd = host::acceptClient(listenFd_, &remote);
+    if (fd < 0) return;
+
+    uint8_t slot = WEBSOCKETS_SERVER_CLIENT_MAX;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+      if (clients_[i].state == CLIENT_EMPTY) {
+        slot = i;
+        break;
+      }
+    }
+    if (slot == WEBSOCKETS_SERVER_CLIENT_MAX) {
+      static const char FULL[] = "HTTP/1.1 503 Service Unavailable\r\nServer: arduino-WebSocket-Server\r\n"
+                                 "Content-Length: 32\r\nConnection: close\r\n\r\n"
+                                 "This Websocket server is full\r\n\r\n";
+      host::sendAll(fd, FULL, sizeof(FULL) - 1, 100);
+      host::closeSocket(fd);
+      continue;
+    }
+
+    Client& client = clients_[slot];
+    client = Client();
+    client.state = CLIENT_HANDSHAKE;
+    client.fd = fd;
+    client.ip = IPAddress(remote);
+    client.since = millis();
+  }
+}
+
+void WebSocketsServer::handleHandshake(uint8_t num) {
+  Client& client = clients_[num];
+  uint8_t buffer[1024];
+  ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+  if (n > 0) {
+    client.rx.insert(client.rx.end(), buffer, buffer + n);
+  } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    dropClient(num, false);
+    return;
+  }
+
+  client.rx.push_back('\0');
+  const char* request = (const char*)client.rx.data();
+  const char* headerEnd = strstr(request, "\r\n\r\n");
+  client.rx.pop_back();
+
+  if (headerEnd == nullptr) {
+    if (millis() - client.since > HANDSHAKE_TIMEOUT_MS || client.rx.size() > 4096) dropClient(num, false);
+    return;
+  }
+
+  char key[64];
+  char upgrade[32];
+  if (!findHeader(request, "Sec-WebSocket-Key", key, sizeof(key)) ||
+      !findHeader(request, "Upgrade", upgrade, sizeof(upgrade)) ||
+      strcasecmp(upgrade, "websocket") != 0) {
+    static const char BAD[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    host::sendAll(client.fd, BAD, sizeof(BAD) - 1, SEND_TIMEOUT_MS);
+    dropClient(num, false);
+    return;
+  }
+
+  // Keep the request path for the CONNECTED event
+  char path[256] = "/";
+  const char* pathStart = strchr(request, ' ');
+  if (pathStart != nullptr) {
+    pathStart++;
+    const char* pathEnd = strchr(pathStart, ' ');
+    size_t length = pathEnd != nullptr ? (size_t)(pathEnd - pathStart) : 0;
+    if (length > 0 && length < sizeof(path)) {
+      memcpy(path, pathStart, length);
+      path[length] = '\0';
+    }
+  }
+
+  char material[128];
+  snprintf(material, sizeof(material), "%s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", key);
+  uint8_t digest[20];
+  host::sha1((const uint8_t*)material, strlen(material), digest);
+  char accept[32];
+  host::base64Encode(digest, sizeof(digest), accept);
+
+  char response[256];
+  int length = snprintf(response, sizeof(response),
+                        "HTTP/1.1 101 Switching Protocols\r\n"
+                        "Server: arduino-WebSocketsServer\r\n"
+                        "Upgrade: websocket\r\n"
+                        "Connection: Upgrade\r\n"
+                        "Sec-WebSocket-Version: 13\r\n"
+                        "Sec-WebSocket-Accept: %s\r\n\r\n",
+                        accept);
+  size_t consumed = (size_t)(headerEnd - request) + 4;
+  client.rx.erase(client.rx.begin(), client.rx.begin() + consumed);
+
+  if (!host::sendAll(client.fd, response, (size_t)length, SEND_TIMEOUT_MS)) {
+    dropClient(num, false);
+    return;
+  }
+
+  client.state = CLIENT_CONNECTED;
+  client.lastPing = millis();
+  emit(num, WStype_CONNECTED, (uint8_t*)path, strlen(path));
+}
+
+void WebSocketsServer::readFrames(uint8_t num) {
+  Client& client = clients_[num];
+  uint8_t buffer[4096];
+  for (;;) {
+    ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      client.rx.insert(client.rx.end(), buffer, buffer + n);
+      continue;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      dropClient(num, true);
+      return;
+    }
+    break;
+  }
+
+  size_t offset = 0;
+  while (client.state == CLIENT_CONNECTED) {
+    size_t available = client.rx.size() - offset;
+    if (available < 2) break;
+    uint8_t* frame = client.rx.data() + offset;
+
+    bool fin = frame[0] & 0x80;
+    uint8_t opcode = frame[0] & 0x0F;
+    bool masked = frame[1] & 0x80;
+    uint64_t length = frame[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+      if (available < 4) break;
+      length = ((uint64_t)frame[2] << 8) | frame[3];
+      header = 4;
+    } else if (length == 127) {
+      if (available < 10) break;
+      length = 0;
+      for (int i = 0; i < 8; i++) length = (length << 8) | frame[2 + i];
+      header = 10;
+    }
+    if (length > WEBSOCKETS_MAX_DATA_SIZE) {
+      dropClient(num, true);
+      return;
+    }
+    size_t maskOffset = header;
+    if (masked) header += 4;
+    if (available < header + length) break;
+
+    uint8_t* payload = frame + header;
+    if (masked) {
+      const uint8_t* mask = frame + maskOffset;
+      for (uint64_t i = 0; i < length; i++) payload[i] ^= mask[i & 3];
+    }
+
+    // Null-terminate in place for TEXT consumers, as the library does
+    uint8_t saved = 0;
+    bool hasNext = offset + header + length < client.rx.size();
+    if (hasNext) saved = payload[length];
+    else client.rx.push_back(0);
+    payload = client.rx.data() + offset + header;  // push_back may reallocate
+    payload[length] = 0;
+
+    bool keep = processFrame(num, opcode, fin, payload, (size_t)length);
+    if (!keep || clients_[num].state != CLIENT_CONNECTED) return;
+
+    if (hasNext) client.rx[offset + header + length] = saved;
+    else client.rx.pop_back();
+    offset += header + length;
+  }
+
+  if (offset > 0 && clients_[num].state == CLIENT_CONNECTED) {
+    client.rx.erase(client.rx.begin(), client.rx.begin() + offset);
+  }
+}
+
+bool WebSocketsServer::processFrame(uint8_t num, uint8_t opcode, bool fin, uint8_t* payload,
+                                    size_t length) {
+  Client& client = clients_[num];
+  switch (opcode) {
+    case OP_TEXT:
+    case OP_BINARY:
+      if (fin) {
+        emit(num, opcode == OP_TEXT ? WStype_TEXT : WStype_BIN, payload, length);
+      } else {
+        client.fragmentText = opcode == OP_TEXT;
+        emit(num, client.fragmentText ? WStype_FRAGMENT_TEXT_START : WStype_FRAGMENT_BIN_START,
+             payload, length);
+      }
+      return true;
+
+    case OP_CONTINUATION:
+      emit(num, fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT, payload, length);
+      return true;
+
+    case OP_PING:
+      sendFrame(num, OP_PONG, payload, length);
+      emit(num, WStype_PING, payload, length);
+      return true;
+
+    case OP_PONG:
+      client.awaitingPong = false;
+      client.missedPongs = 0;
+      emit(num, WStype_PONG, payload, length);
+      return true;
+
+    case OP_CLOSE:
+      sendFrame(num, OP_CLOSE, payload, length < 2 ? length : 2);
+      dropClient(num, true);
+      return false;
+
+    default:
+      dropClient(num, true);
+      return false;
+  }
+}
+
+bool WebSocketsServer::sendFrame(uint8_t num, uint8_t opcode, const uint8_t* payload, size_t length) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || clients_[num].state != CLIENT_CONNECTED) return false;
+
+  uint8_t header[10];
+  size_t headerLength = 2;
+  header[0] = 0x80 | opcode;
+  if (length < 126) {
+    header[1] = (uint8_t)length;
+  } else if (length <= 0xFFFF) {
+    header[1] = 126;
+    header[2] = (uint8_t)(length >> 8);
+    header[3] = (uint8_t)length;
+    headerLength = 4;
+  } else {
+    header[1] = 127;
+    for (int i = 0; i < 8; i++) header[2 + i] = (uint8_t)((uint64_t)length >> (8 * (7 - i)));
+    headerLength = 10;
+  }
+
+  // One write per frame, like the library's headerToPayload path
+  uint8_t stackFrame[512];
+  bool ok;
+  if (headerLength + length <= sizeof(stackFrame)) {
+    memcpy(stackFrame, header, headerLength);
+    if (length > 0) memcpy(stackFrame + headerLength, payload, length);
+    ok = host::sendAll(clients_[num].fd, stackFrame, headerLength + length, SEND_TIMEOUT_MS);
+  } else {
+    ok = host::sendAll(clients_[num].fd, header, headerLength, SEND_TIMEOUT_MS) &&
+         host::sendAll(clients_[num].fd, payload, length, SEND_TIMEOUT_MS);
+  }
+  if (!ok) dropClient(num, true);
+  return ok;
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const uint8_t* payload, size_t length) {
+  if (length == 0 && payload != nullptr) length = strlen((const char*)payload);
+  return sendFrame(num, OP_TEXT, payload, length);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+  return sendTXT(num, (const uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, const String& payload) {
+  return sendFrame(num, OP_TEXT, (const uint8_t*)payload.c_str(), payload.length());
+}
+
+bool WebSocketsServer::broadcastTXT(const uint8_t* payload, size_t length) {
+  if (length == 0 && payload != nullptr) length = strlen((const char*)payload);
+  bool ok = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clients_[i].state == CLIENT_CONNECTED && !sendFrame(i, OP_TEXT, payload, length)) ok = false;
+  }
+  return ok;
+}
+
+bool WebSocketsServer::broadcastTXT(const char* payload, size_t length) {
+  return broadcastTXT((const uint8_t*)payload, length);
+}
+
+bool WebSocketsServer::broadcastTXT(const String& payload) {
+  return broadcastTXT((const uint8_t*)payload.c_str(), payload.length());
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t* payload, size_t length) {
+  return sendFrame(num, OP_BINARY, payload, length);
+}
+
+bool WebSocketsServer::broadcastBIN(const uint8_t* payload, size_t length) {
+  bool ok = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clients_[i].state == CLIENT_CONNECTED && !sendFrame(i, OP_BINARY, payload, length)) ok = false;
+  }
+  return ok;
+}
+
+bool WebSocketsServer::sendPing(uint8_t num) {
+  if (!sendFrame(num, OP_PING, nullptr, 0)) return false;
+  clients_[num].awaitingPong = true;
+  clients_[num].lastPing = millis();
+  return true;
+}
+
+bool WebSocketsServer::broadcastPing() {
+  bool ok = true;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clients_[i].state == CLIENT_CONNECTED && !sendPing(i)) ok = false;
+  }
+  return ok;
+}
+
+void WebSocketsServer::enableHeartbeat(uint32_t pingIntervalMs, uint32_t pongTimeoutMs,
+                                       uint8_t disconnectTimeoutCount) {
+  pingIntervalMs_ = pingIntervalMs;
+  pongTimeoutMs_ = pongTimeoutMs;
+  disconnectTimeoutCount_ = disconnectTimeoutCount;
+}
+
+void WebSocketsServer::heartbeat(uint8_t num) {
+  if (pingIntervalMs_ == 0) return;
+  Client& client = clients_[num];
+  unsigned long now = millis();
+
+  if (client.awaitingPong && now - client.lastPing > pongTimeoutMs_) {
+    client.awaitingPong = false;
+    if (disconnectTimeoutCount_ > 0 && ++client.missedPongs >= disconnectTimeoutCount_) {
+      dropClient(num, true);
+      return;
+    }
+  }
+  if (!client.awaitingPong && now - client.lastPing > pingIntervalMs_) sendPing(num);
+}
+
+void WebSocketsServer::disconnect() {
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) disconnect(i);
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || clients_[num].state != CLIENT_CONNECTED) return;
+  static const uint8_t NORMAL_CLOSURE[2] = {0x03, 0xE8};  // 1000
+  sendFrame(num, OP_CLOSE, NORMAL_CLOSURE, sizeof(NORMAL_CLOSURE));
+  dropClient(num, true);
+}
+
+IPAddress WebSocketsServer::remoteIP(uint8_t num) const {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || clients_[num].state == CLIENT_EMPTY) return IPAddress();
+  return clients_[num].ip;
+}
+
+bool WebSocketsServer::clientIsConnected(uint8_t num) const {
+  return num < WEBSOCKETS_SERVER_CLIENT_MAX && clients_[num].state == CLIENT_CONNECTED;
+}
+
+uint8_t WebSocketsServer::connectedClients(bool ping) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (clients_[i].state != CLIENT_CONNECTED) continue;
+    if (ping && !sendPing(i)) continue;
+    count++;
+  }
+  return count;
+}
+
+void WebSocketsServer::dropClient(uint8_t num, bool notify) {
+  Client& client = clients_[num];
+  if (client.state == CLIENT_EMPTY) return;
+  bool wasConnected = client.state == CLIENT_CONNECTED;
+  host::closeSocket(client.fd);
+  client = Client();
+  if (notify && wasConnected) emit(num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+void WebSocketsServer::emit(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+  if (callback_) callback_(num, type, payload, length);
+}
@@ -0,0 +1,335 @@
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "HostRuntime.h"
+
+WiFiClass WiFi;
+
+namespace {
+
+const uint8_t AP_BSSID[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+int32_t apChannel() {
+  return (int32_t)host::envLong("ESP32_HOST_WIFI_CHANNEL", 6);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// WiFiClass
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (mode_ == WIFI_OFF && mode != WIFI_OFF) fire(ARDUINO_EVENT_WIFI_STA_START);
+  mode_ = mode;
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  return begin(ssid, passphrase, 0, nullptr, true);
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel,
+                             const uint8_t* bssid, bool connect) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  (void)passphrase;
+  if (mode_ == WIFI_OFF) mode(WIFI_STA);
+  if (ssid != nullptr && ssid != ssid_) {
+    strncpy(ssid_, ssid, sizeof(ssid_) - 1);
+    ssid_[sizeof(ssid_) - 1] = '\0';
+  }
+  channel_ = channel;
+  bssidSet_ = bssid != nullptr;
+  if (bssid != nullptr && bssid != bssid_) memcpy(bssid_, bssid, sizeof(bssid_));
+  apMatched_ = (channel_ == 0 || channel_ == apChannel()) &&
+               (!bssidSet_ || memcmp(bssid_, AP_BSSID, sizeof(bssid_)) == 0);
+  status_ = WL_DISCONNECTED;
+  if (!connect) return status_;
+
+  long delayMs = host::envLong("ESP32_HOST_WIFI_CONNECT_MS", 50);
+  if (channel_ == 0 || !bssidSet_) delayMs += host::envLong("ESP32_HOST_WIFI_SCAN_MS", 0);
+  if (!staticIp_) delayMs += host::envLong("ESP32_HOST_WIFI_DHCP_MS", 0);
+  connecting_ = true;
+  connectAt_ = millis() + (unsigned long)delayMs;
+  return status_;
+}
+
+bool WiFiClass::reconnect() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (status_ == WL_CONNECTED) return true;
+  begin(ssid_, nullptr, channel_, bssidSet_ ? bssid_ : nullptr);
+  return true;
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet,
+                       IPAddress dns1, IPAddress dns2) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  (void)gateway;
+  (void)subnet;
+  (void)dns1;
+  (void)dns2;
+  staticIp_ = (uint32_t)local != 0;  // The host keeps its own address either way
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  bool wasConnected = status_ == WL_CONNECTED;
+  connecting_ = false;
+  status_ = WL_DISCONNECTED;
+  if (eraseAp) ssid_[0] = '\0';
+  if (wasConnected) fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+  if (wifiOff) mode_ = WIFI_OFF;
+  return true;
+}
+
+void WiFiClass::hostSimulateDisconnect(uint8_t reason) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (status_ != WL_CONNECTED) return;
+  status_ = WL_CONNECTION_LOST;
+  fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, reason);
+  fire(ARDUINO_EVENT_WIFI_STA_LOST_IP);
+  if (autoReconnect_) reconnect();
+}
+
+bool WiFiClass::setHostname(const char* hostname) {
+  strncpy(hostname_, hostname, sizeof(hostname_) - 1);
+  hostname_[sizeof(hostname_) - 1] = '\0';
+  return true;
+}
+
+void WiFiClass::update() {
+  // ESP32_HOST_WIFI_DROP_MS after the first connect the AP vanishes for ESP32_HOST_WIFI_OUTAGE_MS
+  static const long dropMs = host::envLong("ESP32_HOST_WIFI_DROP_MS", 0);
+  if (dropMs > 0 && !dropped_ && status_ == WL_CONNECTED &&
+      (long)(millis() - firstConnectMs_) >= dropMs) {
+    dropped_ = true;
+    apBackAt_ = millis() + (unsigned long)host::envLong("ESP32_HOST_WIFI_OUTAGE_MS", 0);
+    hostSimulateDisconnect();
+    return;
+  }
+  // ESP32_HOST_WIFI_SSID names the one AP; unset, it answers to any SSID
+  static const char* apSsid = host::env("ESP32_HOST_WIFI_SSID", "");
+  if (connecting_ && (long)(millis() - connectAt_) >= 0) {
+    connecting_ = false;
+    if (ssid_[0] == '\0' || (apSsid[0] != '\0' && strcmp(ssid_, apSsid) != 0) || !apMatched_ ||
+        (long)(millis() - apBackAt_) < 0) {
+      status_ = WL_NO_SSID_AVAIL;
+      fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND);
+      return;
+    }
+    status_ = WL_CONNECTED;
+    if (firstConnectMs_ == 0) firstConnectMs_ = millis();
+    fire(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  }
+}
+
+wl_status_t WiFiClass::status() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  update();
+  return status_;
+}
+
+IPAddress WiFiClass::localIP() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  update();
+  if (status_ != WL_CONNECTED) return IPAddress();
+  IPAddress ip;
+  if (!ip.fromString(host::bindAddress()) || (uint32_t)ip == 0) ip = IPAddress(127, 0, 0, 1);
+  return ip;
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  return status() == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+String WiFiClass::SSID() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  return status() == WL_CONNECTED ? String(ssid_) : String();
+}
+
+int32_t WiFiClass::channel() {
+  return status() == WL_CONNECTED ? apChannel() : 0;
+}
+
+uint8_t* WiFiClass::BSSID() {
+  // Like the ESP32 core: a pointer into the connected AP record, or nullptr
+  static uint8_t bssid[6];
+  if (status() != WL_CONNECTED) return nullptr;
+  memcpy(bssid, AP_BSSID, sizeof(bssid));
+  return bssid;
+}
+
+int8_t WiFiClass::RSSI() {
+  return status() == WL_CONNECTED ? -55 : 0;
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  uint64_t efuse = ESP.getEfuseMac();
+  for (int i = 0; i < 6; i++) mac[i] = (efuse >> (8 * i)) & 0xFF;
+  return mac;
+}
+
+String WiFiClass::macAddress() {
+  uint8_t mac[6];
+  macAddress(mac);
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  return String(buf);
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel,
+                       int ssidHidden, int maxConnection) {
+  (void)ssid;
+  (void)passphrase;
+  (void)channel;
+  (void)ssidHidden;
+  (void)maxConnection;
+  mode_ = mode_ == WIFI_STA ? WIFI_AP_STA : WIFI_AP;
+  fire(ARDUINO_EVENT_WIFI_AP_START);
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+  mode_ = (mode_ == WIFI_AP_STA && !wifiOff) ? WIFI_STA : WIFI_OFF;
+  fire(ARDUINO_EVENT_WIFI_AP_STOP);
+  return true;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb callback, arduino_event_id_t event) {
+  for (size_t i = 0; i < 8; i++) {
+    if (!handlers_[i].active) {
+      handlers_[i] = Handler{callback, nullptr, event, true};
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+  for (size_t i = 0; i < 8; i++) {
+    if (!handlers_[i].active) {
+      handlers_[i] = Handler{nullptr, callback, event, true};
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  if (id >= 1 && id <= 8) handlers_[id - 1] = Handler{nullptr, nullptr, ARDUINO_EVENT_WIFI_READY, false};
+}
+
+void WiFiClass::fire(arduino_event_id_t event, uint8_t reason) {
+  arduino_event_info_t info = {};
+  if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) info.wifi_sta_disconnected.reason = reason;
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) info.got_ip.ip = (uint32_t)localIP();
+
+  for (size_t i = 0; i < 8; i++) {
+    const Handler& handler = handlers_[i];
+    if (!handler.active) continue;
+    if (handler.event != ARDUINO_EVENT_WIFI_READY && handler.event != event) continue;
+    if (handler.plain != nullptr) handler.plain(event);
+    if (handler.func) handler.func(event, info);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// WiFiClient
+
+WiFiClient::~WiFiClient() {
+  stop();
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, 3000);
+}
+
+int WiFiClient::connect(const char* hostname, uint16_t port, int32_t timeoutMs) {
+  stop();
+  fd_ = host::connectTcp(hostname, port, (uint32_t)timeoutMs);
+  if (fd_ < 0) return 0;
+
+  sockaddr_in address = {};
+  socklen_t length = sizeof(address);
+  if (getpeername(fd_, (sockaddr*)&address, &length) == 0) {
+    remoteIp_ = IPAddress((uint32_t)address.sin_addr.s_addr);
+  }
+  return 1;
+}
+
+bool WiFiClient::fill() {
+  if (fd_ < 0 || peerClosed_) return false;
+  if (rxHead_ == rxTail_) rxHead_ = rxTail_ = 0;
+  if (rxTail_ == sizeof(rx_)) return true;
+
+  ssize_t n = recv(fd_, rx_ + rxTail_, sizeof(rx_) - rxTail_, 0);
+  if (n > 0) {
+    rxTail_ += (size_t)n;
+    return true;
+  }
+  if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    peerClosed_ = true;
+  }
+  return false;
+}
+
+int WiFiClient::available() {
+  if (rxHead_ == rxTail_) fill();
+  return (int)(rxTail_ - rxHead_);
+}
+
+int WiFiClient::read() {
+  if (available() == 0) return -1;
+  return rx_[rxHead_++];
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (available() == 0) return -1;
+  size_t n = rxTail_ - rxHead_;
+  if (n > size) n = size;
+  memcpy(buffer, rx_ + rxHead_, n);
+  rxHead_ += n;
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  if (available() == 0) return -1;
+  return rx_[rxHead_];
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (fd_ < 0) return 0;
+  if (!host::sendAll(fd_, buffer, size, 5000)) {
+    peerClosed_ = true;
+    return 0;
+  }
+  return size;
+}
+
+void WiFiClient::stop() {
+  host::closeSocket(fd_);
+  fd_ = -1;
+  peerClosed_ = false;
+  rxHead_ = rxTail_ = 0;
+}
+
+uint8_t WiFiClient::connected() {
+  if (fd_ < 0) return 0;
+  if (rxHead_ == rxTail_) fill();
+  // Like the ESP32 core: still "connected" while unread data remains
+  return (!peerClosed_ || rxHead_ != rxTail_) ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+// Entry point for sketches built on the host: setup() once, then loop() until
+// SIGINT/SIGTERM or ESP32_HOST_RUN_MS elapses, and exit normally so
+// sanitizers and profilers can write their reports.
+
+#include <signal.h>
+
+#include "Arduino.h"
+#include "HostRuntime.h"
+
+namespace {
+
+void onSignal(int) {
+  host::requestStop();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  host::init(argc, argv);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  const unsigned long runMs = (unsigned long)host::envLong("ESP32_HOST_RUN_MS", 0);
+
+  host::markHeapBaseline();
+  setup();
+  unsigned long start = millis();
+  while (!host::stopRequested()) {
+    loop();
+    if (runMs != 0 && millis() - start >= runMs) break;
+  }
+
+  host::stopTasks();
+  Serial.flush();
+  return 0;
+}
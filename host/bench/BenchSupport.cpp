@@ -0,0 +1,66 @@
+// Allocation counting and sketch boot for the sketch benchmarks (see BenchSupport.h)
+
+#include "BenchSupport.h"
+
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "HostRuntime.h"
+
+namespace {
+
+// Benchmarks run on one thread; the observer is only set while measuring
+uint64_t allocations = 0;
+uint64_t allocatedBytes = 0;
+
+void record(size_t size) {
+  allocations++;
+  allocatedBytes += size;
+}
+
+}  // namespace
+
+namespace bench {
+
+bool allocationTrackingAvailable() {
+  return host::allocationHooksAvailable();
+}
+
+void startAllocationTracking() {
+  allocations = 0;
+  allocatedBytes = 0;
+  host::setAllocationObserver(record);
+}
+
+AllocationCount stopAllocationTracking() {
+  host::setAllocationObserver(nullptr);
+  return AllocationCount{allocations, allocatedBytes};
+}
+
+void bootSketch(int argc, char** argv) {
+  setenv("ESP32_HOST_QUIET", "1", 0);
+  setenv("ESP32_HOST_SERIAL", "HostNet\\n\\n", 0);
+  setenv("ESP32_HOST_NVS", "/dev/null/nvs", 0);  // Unwritable: every run is a first boot
+  setenv("ESP32_HOST_PORT_OFFSET", "30000", 0);
+  setenv("ESP32_HOST_TASKS", "0", 0);  // Benchmarks call task bodies themselves
+
+  host::init(argc, argv);
+  host::markHeapBaseline();
+  setup();
+}
+
+void runMeasured(benchmark::State& state, void (*body)(benchmark::State&)) {
+  startAllocationTracking();
+  for (auto _ : state) {
+    body(state);
+  }
+  AllocationCount count = stopAllocationTracking();
+
+  if (!allocationTrackingAvailable()) state.SetLabel("allocations not tracked (sanitizer)");
+  state.counters["bytes/op"] =
+      benchmark::Counter((double)count.bytes, benchmark::Counter::kAvgIterations);
+  state.counters["allocs/op"] =
+      benchmark::Counter((double)count.allocations, benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace bench
@@ -0,0 +1,77 @@
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <benchmark/benchmark.h>
+
+#include <stdint.h>
+
+/**
+ * @brief Shared helpers for the sketch benchmarks
+ *
+ * Every FIRMWARE_BENCHMARK reports ns/op (Google Benchmark's time column)
+ * plus bytes/op and allocs/op, counted for the measured loop only through
+ * the host's malloc/calloc/realloc interposer (arduino/src/Heap.cpp). Adding a benchmark for a new response builder
+ * is one block in the sketch's *_bench.cpp:
+ *
+ *   FIRMWARE_BENCHMARK(BM_SendJson) {
+ *     sendJson(200, "LED ON");
+ *   }
+ *
+ * Parameterised benchmarks pass the registration chain separately and read
+ * state.range(0) in the body:
+ *
+ *   FIRMWARE_BENCHMARK_ARGS(BM_Broadcast, ->Arg(1)->Arg(5)) { ... }
+ */
+namespace bench {
+
+struct AllocationCount {
+  uint64_t allocations;
+  uint64_t bytes;
+};
+
+// False under ASan/TSan, which own malloc; counters then report 0
+bool allocationTrackingAvailable();
+
+void startAllocationTracking();
+AllocationCount stopAllocationTracking();
+
+/**
+ * @brief Run the sketch's setup() once, as the device would boot
+ *
+ * Serial output is discarded and the WiFi prompts are answered from
+ * ESP32_HOST_SERIAL (default: open network "HostNet"), so the benchmarks
+ * see the same globals - identity strings, bus subscriptions, servers - as
+ * the running firmware. Servers listen on ESP32_HOST_PORT_OFFSET (default
+ * 30000) so a bench run does not collide with a sketch on the default ports.
+ * FreeRTOS tasks the sketch creates are not started (ESP32_HOST_TASKS=0);
+ * the benchmark thread calls their work functions directly.
+ */
+void bootSketch(int argc, char** argv);
+
+// Runs body once per iteration and attaches the bytes/op and allocs/op counters
+void runMeasured(benchmark::State& state, void (*body)(benchmark::State&));
+
+}  // namespace bench
+
+#define FIRMWARE_BENCHMARK_ARGS(name, args)                  \
+  static void name##Body(benchmark::State& state);           \
+  static void name(benchmark::State& state) {                \
+    bench::runMeasured(state, name##Body);                   \
+  }                                                          \
+  BENCHMARK(name) args;                                      \
+  static void name##Body([[maybe_unused]] benchmark::State& state)
+
+#define FIRMWARE_BENCHMARK(name) FIRMWARE_BENCHMARK_ARGS(name, )
+
+// main() for a sketch benchmark: boot the sketch, then run every benchmark
+#define FIRMWARE_BENCHMARK_MAIN()                            \
+  int main(int argc, char** argv) {                          \
+    benchmark::Initialize(&argc, argv);                      \
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1; \
+    bench::bootSketch(argc, argv);                                   \
+    benchmark::RunSpecifiedBenchmarks();                     \
+    benchmark::Shutdown();                                   \
+    return 0;                                                \
+  }
+
+#endif
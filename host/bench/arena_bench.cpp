@@ -0,0 +1,75 @@
+// Per-request arena (esp32-common/src/RequestArena.h) and the JsonWriter on
+// top of it: a bump allocation, a /status-sized object, and the cost of
+// spilling to the heap when the arena is too small
+
+#include <benchmark/benchmark.h>
+
+#include "JsonWriter.h"
+#include "RequestArena.h"
+
+namespace {
+
+// The fields of the hybrid sketch's /status response
+void writeStatus(JsonWriter& json, uint32_t timestamp) {
+  json.beginObject()
+      .field("device", "ESP32")
+      .field("ip", "192.168.1.42")
+      .field("ssid", "HomeNetwork")
+      .field("rssi", -61)
+      .field("led", true)
+      .field("uptime", timestamp / 1000)
+      .field("heap", 231456u)
+      .field("heap_largest_block", 110580u)
+      .field("heap_free_blocks", 14u)
+      .field("heap_fragmentation", 52)
+      .beginArray("alloc_growth")
+      .endArray()
+      .field("ws_clients", 4)
+      .field("timestamp", timestamp)
+      .endObject();
+}
+
+void BM_ArenaAllocate(benchmark::State& state) {
+  StaticRequestArena<2048> arena;
+  for (auto _ : state) {
+    RequestArena::Scope scope(arena);
+    benchmark::DoNotOptimize(arena.allocate(64));
+    benchmark::DoNotOptimize(arena.allocate(200));
+  }
+}
+BENCHMARK(BM_ArenaAllocate);
+
+void BM_JsonWriterStatus(benchmark::State& state) {
+  StaticRequestArena<2048> arena;
+  uint32_t timestamp = 123456;
+  size_t length = 0;
+  for (auto _ : state) {
+    RequestArena::Scope scope(arena);
+    JsonWriter json(arena);
+    writeStatus(json, timestamp++);
+    benchmark::DoNotOptimize(json.c_str());
+    length = json.length();
+  }
+  if (arena.fallbacks() > 0) state.SkipWithError("status spilled to the heap");
+  state.SetBytesProcessed((int64_t)(state.iterations() * length));
+}
+BENCHMARK(BM_JsonWriterStatus);
+
+// Arena smaller than one response: every request goes through malloc()
+void BM_JsonWriterFallback(benchmark::State& state) {
+  StaticRequestArena<64> arena;
+  uint32_t timestamp = 123456;
+  for (auto _ : state) {
+    RequestArena::Scope scope(arena);
+    JsonWriter json(arena);
+    writeStatus(json, timestamp++);
+    benchmark::DoNotOptimize(json.c_str());
+  }
+  state.counters["fallbacks/op"] =
+      benchmark::Counter((double)arena.fallbacks() / (double)state.iterations());
+}
+BENCHMARK(BM_JsonWriterFallback);
+
+}  // namespace
+
+BENCHMARK_MAIN();
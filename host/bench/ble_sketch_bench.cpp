@@ -0,0 +1,45 @@
+// Hot paths of bluetooth/ESP32_BLE_Server_FIXED.ino on the host BLE stubs.
+// A central is "connected" so every command builds and notifies its reply.
+
+#include "BenchSupport.h"
+
+#include "bluetooth/ESP32_BLE_Server_FIXED.ino"
+
+namespace {
+
+const char TOGGLE[] = "toggle";
+const char STATUS[] = "status";
+const char DATA[] = "data";
+
+void connectBenchCentral() {
+  if (!deviceConnected) pServer->hostConnect();
+}
+
+}  // namespace
+
+FIRMWARE_BENCHMARK(BM_GetDeviceStatus) {
+  String json = getDeviceStatus();
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_GetSensorData) {
+  String json = getSensorData();
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_ProcessCommandToggle) {
+  connectBenchCentral();
+  processCommand(TOGGLE, sizeof(TOGGLE) - 1, TRANSPORT_BLE);
+}
+
+FIRMWARE_BENCHMARK(BM_ProcessCommandStatus) {
+  connectBenchCentral();
+  processCommand(STATUS, sizeof(STATUS) - 1, TRANSPORT_BLE);
+}
+
+FIRMWARE_BENCHMARK(BM_ProcessCommandData) {
+  connectBenchCentral();
+  processCommand(DATA, sizeof(DATA) - 1, TRANSPORT_BLE);
+}
+
+FIRMWARE_BENCHMARK_MAIN();
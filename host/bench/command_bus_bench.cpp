@@ -0,0 +1,128 @@
+// Benchmarks for the transport-agnostic command bus (esp32-common/src/CommandBus.h)
+
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "CommandBus.h"
+#include "CommandParser.h"
+#include "CommandTrace.h"
+
+namespace {
+
+volatile bool outputPin = false;
+
+void writeOutput(const DeviceState& state) {
+  outputPin = state.led;
+}
+
+void countEvent(const StateEvent& event, void* context) {
+  benchmark::DoNotOptimize(event.state.led);
+  (*static_cast<uint32_t*>(context))++;
+}
+
+void BM_DispatchToggle(benchmark::State& state) {
+  CommandBus bus;
+  bus.setOutput(writeOutput);
+  uint32_t received[CommandBus::MAX_SUBSCRIBERS] = {};
+  int subscribers = state.range(0);
+  for (int i = 0; i < subscribers; i++) {
+    bus.subscribe(countEvent, &received[i]);
+  }
+
+  Command toggle = Command::toggle(TRANSPORT_REST);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bus.dispatch(toggle));
+  }
+
+  // Every transport must see every change exactly once
+  for (int i = 0; i < subscribers; i++) {
+    if (received[i] != bus.eventsPublished()) state.SkipWithError("fan-out mismatch");
+  }
+  state.counters["events"] = bus.eventsPublished();
+}
+BENCHMARK(BM_DispatchToggle)->Arg(0)->Arg(1)->Arg(5)->Arg(CommandBus::MAX_SUBSCRIBERS);
+
+// led_on while on: published to the subscriber, output skipped
+void BM_DispatchUnchanged(benchmark::State& state) {
+  CommandBus bus;
+  bus.setOutput(writeOutput);
+  uint32_t received = 0;
+  bus.subscribe(countEvent, &received);
+  bus.dispatch(Command::ledSet(true, TRANSPORT_LOCAL));
+
+  Command on = Command::ledSet(true, TRANSPORT_WEBSOCKET);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bus.dispatch(on));
+  }
+}
+BENCHMARK(BM_DispatchUnchanged);
+
+void BM_ParseTextCommand(benchmark::State& state) {
+  static const char* const INPUTS[] = {"led on", "  LED OFF\r", "toggle", "wifi status", "bogus"};
+  size_t lengths[5];
+  for (int i = 0; i < 5; i++) lengths[i] = strlen(INPUTS[i]);
+
+  Command command;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parseTextCommand(INPUTS[i], lengths[i], TRANSPORT_SPP, command));
+    i = (i + 1) % 5;
+  }
+}
+BENCHMARK(BM_ParseTextCommand);
+
+void BM_ParseJsonCommand(benchmark::State& state) {
+  static const char* const INPUTS[] = {
+    "{\"command\":\"led_on\"}",
+    "{\"command\": \"TOGGLE\", \"trace\": 12}",
+    "{\"state\": false}",
+    "{\"command\":\"unknown\"}",
+  };
+  size_t lengths[4];
+  for (int i = 0; i < 4; i++) lengths[i] = strlen(INPUTS[i]);
+
+  Command command;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parseJsonCommand(INPUTS[i], lengths[i], TRANSPORT_WEBSOCKET, command));
+    i = (i + 1) % 4;
+  }
+}
+BENCHMARK(BM_ParseJsonCommand);
+
+void BM_ParseAndDispatch(benchmark::State& state) {
+  CommandBus bus;
+  bus.setOutput(writeOutput);
+  uint32_t received[3] = {};
+  for (auto& counter : received) bus.subscribe(countEvent, &counter);
+
+  const char* payload = "{\"command\":\"toggle\"}";
+  size_t length = strlen(payload);
+  Command command;
+  for (auto _ : state) {
+    parseJsonCommand(payload, length, TRANSPORT_WEBSOCKET, command);
+    benchmark::DoNotOptimize(bus.dispatch(command));
+  }
+}
+BENCHMARK(BM_ParseAndDispatch);
+
+// One traced command: begin, four marks and the Serial line
+void BM_TraceCommand(benchmark::State& state) {
+  CommandTrace traces;
+  StaticResponseBuffer<96> line;
+  uint32_t now = 0;
+  for (auto _ : state) {
+    uint32_t id = traces.begin(0, TRANSPORT_REST, now);
+    traces.mark(id, TRACE_PARSE, now + 20);
+    traces.mark(id, TRACE_REPLY, now + 40);
+    traces.mark(id, TRACE_EXECUTE, now + 110);
+    traces.mark(id, TRACE_BROADCAST, now + 500);
+    benchmark::DoNotOptimize(traces.format(id, line));
+    line.clear();
+    now += 1000;
+  }
+}
+BENCHMARK(BM_TraceCommand);
+
+}  // namespace
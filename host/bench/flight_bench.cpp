@@ -0,0 +1,60 @@
+// What one flight recorder event (esp32-common/src/FlightRecorder.h) costs
+// the task that records it, with and without a name lookup, and what a
+// full GET /flight costs to format
+
+#include <benchmark/benchmark.h>
+
+#include "FlightRecorder.h"
+
+namespace {
+
+FlightRecorder::Storage storage;
+
+void BM_Record(benchmark::State& state) {
+  FlightRecorder flight(storage);
+  flight.begin(1, 0);
+  uint32_t now = 0;
+  for (auto _ : state) {
+    flight.record(FLIGHT_LED, 1, (uint16_t)(now & 1), now);
+    now++;
+  }
+  benchmark::DoNotOptimize(flight.total());
+}
+BENCHMARK(BM_Record);
+
+// STALL events: nameId() finds the section among the names already stored
+void BM_RecordNamed(benchmark::State& state) {
+  FlightRecorder flight(storage);
+  flight.begin(1, 0);
+  const char* const sections[] = {"wifi_connect", "send_data", "mqtt_connect", "restart_delay"};
+  for (const char* section : sections) flight.nameId(section);
+  uint32_t now = 0;
+  for (auto _ : state) {
+    flight.record(FLIGHT_STALL, flight.nameId(sections[now & 3]), 250, now);
+    now++;
+  }
+  benchmark::DoNotOptimize(flight.total());
+}
+BENCHMARK(BM_RecordNamed);
+
+void BM_Report(benchmark::State& state) {
+  FlightRecorder flight(storage);
+  flight.begin(1, 0);
+  for (uint32_t i = 0; i < FlightRecorder::CAPACITY; i++) {
+    flight.record(i % 7 == 0 ? FLIGHT_WIFI_DOWN : FLIGHT_LED, 1, (uint16_t)i, i * 10);
+  }
+  StaticResponseBuffer<512> chunk;
+  for (auto _ : state) {
+    uint16_t next = 0;
+    do {
+      next = flight.report(chunk, next);
+      benchmark::DoNotOptimize(chunk.c_str());
+      chunk.clear();
+    } while (next < flight.count());
+  }
+}
+BENCHMARK(BM_Report);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,69 @@
+// Hot paths of ESP32_Hybrid_REST_WebSocket.cpp, compiled unmodified against
+// the host emulation. No peer is connected, so send() and sendTXT() stop
+// before the socket write: the numbers are the firmware's own work.
+// The network task is not started; each benchmark plays both tasks' parts.
+
+#include "BenchSupport.h"
+
+#include "ESP32_Hybrid_REST_WebSocket.cpp"
+
+namespace {
+
+const char TOGGLE[] = "{\"command\":\"toggle\"}";
+const char STATUS[] = "{\"command\":\"status\"}";
+const char UNKNOWN[] = "{\"command\":\"dance\"}";
+
+// handleWebSocketMessage() ignores slots without a registered session
+void registerBenchClient() {
+  if (!clients[0].active) registerClient(0, IPAddress(127, 0, 0, 1));
+}
+
+}  // namespace
+
+FIRMWARE_BENCHMARK(BM_BuildStatusJson) {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject();
+  writeStatusJson(json);
+  json.endObject();
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_SendWsResponse) {
+  registerBenchClient();
+  sendWsResponse(0, true, "LED ON");
+}
+
+FIRMWARE_BENCHMARK(BM_SendJson) {
+  sendJson(200, "LED ON");
+}
+
+FIRMWARE_BENCHMARK(BM_HandleStatus) {
+  handleStatus();
+}
+
+// Network task queues the command, application applies it, network task
+// broadcasts led_update and replies
+FIRMWARE_BENCHMARK(BM_HandleWebSocketToggle) {
+  registerBenchClient();
+  handleWebSocketMessage(0, TOGGLE, sizeof(TOGGLE) - 1);
+  processCommands();
+  deliverEvents();
+}
+
+FIRMWARE_BENCHMARK(BM_HandleWebSocketStatus) {
+  registerBenchClient();
+  handleWebSocketMessage(0, STATUS, sizeof(STATUS) - 1);
+}
+
+FIRMWARE_BENCHMARK(BM_HandleWebSocketUnknown) {
+  registerBenchClient();
+  handleWebSocketMessage(0, UNKNOWN, sizeof(UNKNOWN) - 1);
+}
+
+// One GET /metrics page, streamed in MetricsEndpoint::CHUNK_SIZE pieces
+FIRMWARE_BENCHMARK(BM_HandleMetrics) {
+  MetricsEndpoint::handleMetrics();
+}
+
+FIRMWARE_BENCHMARK_MAIN();
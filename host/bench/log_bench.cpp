@@ -0,0 +1,69 @@
+// Cost of one log statement (esp32-common/src/Log.h) as a formatted text
+// line and as a LOG_BINARY frame, with the bytes each puts on the UART
+
+#include <benchmark/benchmark.h>
+
+#include "Log.h"
+
+namespace {
+
+size_t bytesOut = 0;
+
+void countBytes(const char*, size_t length) {
+  bytesOut += length;
+}
+
+const char PAYLOAD[] = "{\"command\":\"toggle\"}";
+
+// The hybrid server's per-message DEBUG line
+void BM_TextLine(benchmark::State& state) {
+  Log::setSink(countBytes);
+  bytesOut = 0;
+  uint32_t session = 1;
+  for (auto _ : state) {
+    Log::write(LOG_LEVEL_DEBUG, "Session #%lu (Slot %u): %.*s", (unsigned long)session++, 3u,
+               (int)(sizeof(PAYLOAD) - 1), PAYLOAD);
+  }
+  state.counters["bytes/line"] = benchmark::Counter((double)bytesOut / state.iterations());
+}
+BENCHMARK(BM_TextLine);
+
+void BM_BinaryFrame(benchmark::State& state) {
+  Log::setSink(countBytes);
+  bytesOut = 0;
+  uint32_t session = 1;
+  for (auto _ : state) {
+    Log::emit(std::integral_constant<uint32_t, Log::formatId("Session #%lu (Slot %u): %.*s")>::value,
+              (unsigned long)session++, 3u, (int)(sizeof(PAYLOAD) - 1), PAYLOAD);
+  }
+  state.counters["bytes/line"] = benchmark::Counter((double)bytesOut / state.iterations());
+}
+BENCHMARK(BM_BinaryFrame);
+
+// The LED broadcast INFO line: numbers and short strings only
+void BM_TextLineNumbers(benchmark::State& state) {
+  Log::setSink(countBytes);
+  bytesOut = 0;
+  int clients = 0;
+  for (auto _ : state) {
+    Log::write(LOG_LEVEL_INFO, "LED %s via %s | Broadcast to %d client(s)", "ON", "websocket",
+               clients++ & 7);
+  }
+  state.counters["bytes/line"] = benchmark::Counter((double)bytesOut / state.iterations());
+}
+BENCHMARK(BM_TextLineNumbers);
+
+void BM_BinaryFrameNumbers(benchmark::State& state) {
+  Log::setSink(countBytes);
+  bytesOut = 0;
+  int clients = 0;
+  for (auto _ : state) {
+    Log::emit(std::integral_constant<uint32_t,
+                                     Log::formatId("LED %s via %s | Broadcast to %d client(s)")>::value,
+              "ON", "websocket", clients++ & 7);
+  }
+  state.counters["bytes/line"] = benchmark::Counter((double)bytesOut / state.iterations());
+}
+BENCHMARK(BM_BinaryFrameNumbers);
+
+}  // namespace
@@ -0,0 +1,79 @@
+// Benchmarks for the /metrics building blocks (esp32-common/src/Metrics.h,
+// HeapAccounting.h)
+
+#include <benchmark/benchmark.h>
+
+#include "HeapAccounting.h"
+#include "Metrics.h"
+
+namespace {
+
+const char* const ROUTES[] = {"/status", "/led/on", "/led/off", "/led", "unmatched"};
+
+void discard(const char* data, size_t length, void* context) {
+  *static_cast<size_t*>(context) += length;
+  benchmark::DoNotOptimize(data);
+}
+
+// Recorded once per request and once per loop() pass
+void BM_HistogramObserve(benchmark::State& state) {
+  LatencyHistogram histogram;
+  uint32_t micros = 1;
+  for (auto _ : state) {
+    histogram.observe(micros);
+    micros = micros * 7 % 2000003;  // Spread over every bucket
+  }
+  benchmark::DoNotOptimize(histogram.count());
+}
+BENCHMARK(BM_HistogramObserve);
+
+// One scrape of the hybrid sketch's route families through a 512-byte chunk buffer
+void BM_WriteHttpMetrics(benchmark::State& state) {
+  HttpMetrics metrics;
+  for (const char* route : ROUTES) {
+    int id = metrics.addRoute(route);
+    for (uint32_t i = 0; i < 1000; i++) metrics.record(id, 50 + i * 37);
+  }
+
+  StaticResponseBuffer<512> chunk;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    MetricsWriter out(chunk, discard, &bytes);
+    metrics.write(out);
+    out.finish();
+  }
+  state.SetBytesProcessed((int64_t)bytes);
+}
+BENCHMARK(BM_WriteHttpMetrics);
+
+// Per tagged request: begin(), ten allocator hook calls from the owning task
+// and two from another task, end()
+void BM_HeapAccountingRequest(benchmark::State& state) {
+  HeapAccounting accounting;
+  int tag = accounting.addTag("/status");
+  int owner = 0;
+  int other = 0;
+  for (auto _ : state) {
+    accounting.begin(tag, &owner, 300000);
+    for (int i = 0; i < 10; i++) HeapAccounting::noteAllocation(&owner, 64);
+    HeapAccounting::noteAllocation(&other, 64);
+    HeapAccounting::noteAllocation(&other, 64);
+    accounting.end(300000);
+  }
+  benchmark::DoNotOptimize(accounting.tag(tag).allocations);
+}
+BENCHMARK(BM_HeapAccountingRequest);
+
+// The allocator hook while no request is open (every other allocation)
+void BM_HeapAccountingIdleHook(benchmark::State& state) {
+  int task = 0;
+  for (auto _ : state) {
+    if (HeapAccounting::recording()) HeapAccounting::noteAllocation(&task, 64);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_HeapAccountingIdleHook);
+
+}  // namespace
+
+BENCHMARK_MAIN();
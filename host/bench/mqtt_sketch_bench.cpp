@@ -0,0 +1,18 @@
+// Hot paths of mqtt/ESP32_MQTT_Minimal.cpp (ArduinoJson documents) on the
+// host emulation. No broker is connected; only the JSON building is measured.
+
+#include "BenchSupport.h"
+
+#include "mqtt/ESP32_MQTT_Minimal.cpp"
+
+FIRMWARE_BENCHMARK(BM_CreateStatusJson) {
+  String json = createStatusJson();
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_CreateJsonResponse) {
+  String json = createJsonResponse(true, "LED ON");
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK_MAIN();
@@ -0,0 +1,47 @@
+// Cost of the loop() phase profiler (esp32-common/src/PhaseProfiler.h):
+// what LOOP_PHASE adds per phase, besides two cycle counter reads, and one
+// report as served by GET /profile
+
+#include <benchmark/benchmark.h>
+
+#include "PhaseProfiler.h"
+
+namespace {
+
+const char* const PHASES[] = {"wifi_identity", "http", "websocket", "events",
+                              "check_wifi", "broadcast", "serial"};
+const uint8_t PHASE_COUNT = sizeof(PHASES) / sizeof(PHASES[0]);
+
+void BM_Record(benchmark::State& state) {
+  PhaseProfiler profiler(PHASES, PHASE_COUNT);
+  uint32_t cycles = 1;
+  uint8_t phase = 0;
+  for (auto _ : state) {
+    profiler.record(phase, cycles);
+    cycles = cycles * 7 % 8000009;  // Spread over every bucket
+    if (++phase == PHASE_COUNT) phase = 0;
+  }
+  benchmark::DoNotOptimize(profiler.phase(0).calls);
+}
+BENCHMARK(BM_Record);
+
+void BM_Report(benchmark::State& state) {
+  PhaseProfiler profiler(PHASES, PHASE_COUNT);
+  for (uint8_t phase = 0; phase < PHASE_COUNT; phase++) {
+    for (uint32_t i = 0; i < 1000; i++) profiler.record(phase, 200 + i * 997);
+  }
+
+  StaticResponseBuffer<1536> out;
+  for (auto _ : state) {
+    out.clear();
+    profiler.report(out, 240);
+    benchmark::DoNotOptimize(out.c_str());
+  }
+  if (out.truncated()) state.SkipWithError("report truncated");
+  state.SetBytesProcessed((int64_t)(state.iterations() * out.length()));
+}
+BENCHMARK(BM_Report);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+// Stress benchmarks for the inter-task queues (esp32-common/src/SpscQueue.h,
+// MpscQueue.h). Producers and the consumer are real std::threads, and every
+// transfer checks that each producer's items arrive complete and in order, so
+// a -DHOST_SANITIZE=thread build doubles as the queues' race test.
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MpscQueue.h"
+#include "SpscQueue.h"
+
+namespace {
+
+// Same size as the sketches' Command / NetEvent payloads
+struct Message {
+  uint32_t producer;
+  uint32_t sequence;
+};
+
+const uint32_t CAPACITY = 32;
+const uint32_t ITEMS_PER_TRANSFER = 1 << 16;
+
+// Baseline: the same ring behind a mutex, as a FreeRTOS queue would serialize it
+class MutexQueue {
+public:
+  bool push(const Message& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tail_ - head_ == CAPACITY) return false;
+    items_[tail_++ % CAPACITY] = item;
+    return true;
+  }
+
+  bool pop(Message& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (head_ == tail_) return false;
+    item = items_[head_++ % CAPACITY];
+    return true;
+  }
+
+private:
+  std::mutex mutex_;
+  uint32_t head_ = 0;
+  uint32_t tail_ = 0;
+  Message items_[CAPACITY];
+};
+
+template <typename Queue>
+void produce(Queue& queue, uint32_t producer, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    while (!queue.push(Message{producer, i})) std::this_thread::yield();
+  }
+}
+
+/**
+ * @brief Move ITEMS_PER_TRANSFER items from `producers` threads to this one
+ * @return false if an item was lost, duplicated or reordered
+ */
+template <typename Queue>
+bool transfer(Queue& queue, int producers) {
+  const uint32_t perProducer = ITEMS_PER_TRANSFER / producers;
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back(produce<Queue>, std::ref(queue), (uint32_t)p, perProducer);
+  }
+
+  std::vector<uint32_t> next(producers, 0);
+  bool ordered = true;
+  uint32_t received = 0;
+  Message message;
+  while (received < perProducer * producers) {
+    if (!queue.pop(message)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (message.producer >= (uint32_t)producers || message.sequence != next[message.producer]) {
+      ordered = false;
+    } else {
+      next[message.producer]++;
+    }
+    received++;
+  }
+
+  for (std::thread& thread : threads) thread.join();
+  return ordered && !queue.pop(message);
+}
+
+// Uncontended cost of one push + pop on the same task
+template <typename Queue>
+void BM_PushPop(benchmark::State& state) {
+  Queue queue;
+  Message message = {0, 0};
+  for (auto _ : state) {
+    queue.push(message);
+    queue.pop(message);
+    benchmark::DoNotOptimize(message);
+  }
+}
+BENCHMARK_TEMPLATE(BM_PushPop, SpscQueue<Message, CAPACITY>);
+BENCHMARK_TEMPLATE(BM_PushPop, MpscQueue<Message, CAPACITY>);
+BENCHMARK_TEMPLATE(BM_PushPop, MutexQueue);
+
+// Producer thread(s) -> this thread, arg = number of producers
+template <typename Queue>
+void BM_Transfer(benchmark::State& state) {
+  const int producers = (int)state.range(0);
+  for (auto _ : state) {
+    Queue queue;
+    if (!transfer(queue, producers)) {
+      state.SkipWithError("items lost or reordered");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (ITEMS_PER_TRANSFER / producers) * producers);
+}
+BENCHMARK_TEMPLATE(BM_Transfer, SpscQueue<Message, CAPACITY>)->Arg(1)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Transfer, MpscQueue<Message, CAPACITY>)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Transfer, MutexQueue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,20 @@
+// Hot paths of ESP32_REST_Minimal.cpp on the host emulation. No HTTP client
+// is connected, so send() stops before the socket write.
+
+#include "BenchSupport.h"
+
+#include "ESP32_REST_Minimal.cpp"
+
+FIRMWARE_BENCHMARK(BM_SendJson) {
+  sendJson(200, "LED ON");
+}
+
+FIRMWARE_BENCHMARK(BM_HandleStatus) {
+  handleStatus();
+}
+
+FIRMWARE_BENCHMARK(BM_HandleLedOn) {
+  handleLedOn();
+}
+
+FIRMWARE_BENCHMARK_MAIN();
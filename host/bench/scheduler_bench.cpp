@@ -0,0 +1,61 @@
+// Benchmarks for the loop() scheduler (esp32-common/src/Scheduler.h)
+
+#include <benchmark/benchmark.h>
+
+#include "Scheduler.h"
+
+namespace {
+
+void countRun(void* context) {
+  (*static_cast<uint32_t*>(context))++;
+}
+
+// The common case: loop() spins (or wakes on a packet) with nothing due
+void BM_RunNothingDue(benchmark::State& state) {
+  Scheduler scheduler;
+  uint32_t runs = 0;
+  for (int i = 0; i < state.range(0); i++) {
+    scheduler.every(5000 + i * 1000, countRun, &runs, 0);
+  }
+
+  uint32_t now = 1;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(scheduler.run(now));
+    benchmark::DoNotOptimize(scheduler.msUntilNext(now));
+  }
+  if (runs != 0) state.SkipWithError("task ran early");
+}
+BENCHMARK(BM_RunNothingDue)->Arg(2)->Arg(Scheduler::MAX_TASKS);
+
+// One 10 ms tick per iteration with every task firing on some tick
+void BM_RunTicks(benchmark::State& state) {
+  Scheduler scheduler(10);
+  uint32_t runs = 0;
+  for (int i = 0; i < state.range(0); i++) {
+    scheduler.every(10 * (i + 1), countRun, &runs, 0);
+  }
+
+  uint32_t now = 0;
+  for (auto _ : state) {
+    now += 10;
+    benchmark::DoNotOptimize(scheduler.run(now));
+  }
+  state.counters["runs/tick"] =
+      benchmark::Counter((double)runs, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RunTicks)->Arg(2)->Arg(Scheduler::MAX_TASKS);
+
+void BM_OneShotChurn(benchmark::State& state) {
+  Scheduler scheduler(10);
+  uint32_t runs = 0;
+  uint32_t now = 0;
+  for (auto _ : state) {
+    scheduler.after(25, countRun, &runs, now);
+    now += 10;
+    scheduler.run(now);
+  }
+  benchmark::DoNotOptimize(runs);
+}
+BENCHMARK(BM_OneShotChurn);
+
+}  // namespace
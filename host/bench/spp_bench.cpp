@@ -0,0 +1,94 @@
+// Benchmarks for SppLink (esp32-common/src/SppLink.h): text commands and
+// binary frames sharing one Bluetooth link
+
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "LineAssembler.h"
+#include "SppFrame.h"
+#include "SppLink.h"
+
+namespace {
+
+// The bytes one loop() pass finds in the SerialBT receive buffer
+struct ByteStream {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t pos = 0;
+
+  int available() const { return (int)(size - pos); }
+  int read() { return pos < size ? data[pos++] : -1; }
+  void rewind(const uint8_t* bytes, size_t length) {
+    data = bytes;
+    size = length;
+    pos = 0;
+  }
+};
+
+// Count what poll() hands out until the stream runs dry
+void drain(SppLink& link, ByteStream& stream, uint32_t& lines, uint32_t& frames) {
+  for (;;) {
+    switch (link.poll(stream, 0)) {
+      case SppLink::SPP_LINE: lines++; break;
+      case SppLink::SPP_FRAME: frames++; break;
+      case SppLink::SPP_NONE: return;
+      default: break;
+    }
+  }
+}
+
+void BM_TextCommand(benchmark::State& state) {
+  StaticLineAssembler<64> lines;
+  SppLink link(lines);
+  const char* text = "status\r\n";
+  ByteStream stream;
+  uint32_t lineCount = 0, frameCount = 0;
+
+  for (auto _ : state) {
+    stream.rewind((const uint8_t*)text, strlen(text));
+    drain(link, stream, lineCount, frameCount);
+  }
+  if (lineCount != state.iterations()) state.SkipWithError("line lost");
+}
+BENCHMARK(BM_TextCommand);
+
+void BM_Frame(benchmark::State& state) {
+  StaticLineAssembler<64> lines;
+  SppLink link(lines);
+  uint8_t frame[SPP_FRAME_MAX_SIZE];
+  const uint8_t on = 1;
+  size_t size = sppEncodeFrame(frame, 7, SPP_CMD_LED_SET, &on, 1);
+  ByteStream stream;
+  uint32_t lineCount = 0, frameCount = 0;
+
+  for (auto _ : state) {
+    stream.rewind(frame, size);
+    drain(link, stream, lineCount, frameCount);
+  }
+  if (frameCount != state.iterations()) state.SkipWithError("frame lost");
+}
+BENCHMARK(BM_Frame);
+
+// A terminal's lone "\r", a frame, then "\n": the "\n" is a line of its own,
+// not the second half of a CRLF split by the frame
+void BM_CrAroundFrame(benchmark::State& state) {
+  StaticLineAssembler<64> lines;
+  SppLink link(lines);
+  uint8_t bytes[SPP_FRAME_MAX_SIZE + 2];
+  bytes[0] = '\r';
+  size_t size = 1 + sppEncodeFrame(bytes + 1, 7, SPP_CMD_PING, nullptr, 0);
+  bytes[size++] = '\n';
+  ByteStream stream;
+  uint32_t lineCount = 0, frameCount = 0;
+
+  for (auto _ : state) {
+    stream.rewind(bytes, size);
+    drain(link, stream, lineCount, frameCount);
+  }
+  if (lineCount != 2 * state.iterations()) state.SkipWithError("'\\n' after a frame swallowed");
+  if (frameCount != state.iterations()) state.SkipWithError("frame lost");
+}
+BENCHMARK(BM_CrAroundFrame);
+
+}  // namespace
@@ -0,0 +1,39 @@
+// What the stall watchdog (esp32-common/src/StallWatchdog.h) adds to loop():
+// one tick() per pass and an enter() / leave() pair per STALL_SECTION,
+// besides the millis() reads, and one check() of the monitor task
+
+#include <benchmark/benchmark.h>
+
+#include "StallWatchdog.h"
+
+namespace {
+
+void BM_Tick(benchmark::State& state) {
+  StallWatchdog watchdog(200);
+  uint32_t now = 0;
+  for (auto _ : state) watchdog.tick(now++);
+  benchmark::DoNotOptimize(watchdog.total());
+}
+BENCHMARK(BM_Tick);
+
+void BM_Section(benchmark::State& state) {
+  StallWatchdog watchdog(200);
+  for (auto _ : state) {
+    const char* previous = watchdog.enter("send_data");
+    watchdog.leave(previous, "send_data", 3);
+  }
+  benchmark::DoNotOptimize(watchdog.total());
+}
+BENCHMARK(BM_Section);
+
+void BM_Check(benchmark::State& state) {
+  StallWatchdog watchdog(200);
+  watchdog.tick(0);
+  uint32_t now = 0;
+  for (auto _ : state) benchmark::DoNotOptimize(watchdog.check(now++ % 100));
+}
+BENCHMARK(BM_Check);
+
+}  // namespace
+
+BENCHMARK_MAIN();
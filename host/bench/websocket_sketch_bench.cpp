@@ -0,0 +1,37 @@
+// Hot paths of websocket/ESP32_WebSocket_Minimal.cpp on the host emulation.
+// No peer is connected, so sendTXT() stops before the socket write.
+
+#include "BenchSupport.h"
+
+#include "websocket/ESP32_WebSocket_Minimal.cpp"
+
+namespace {
+
+const char TOGGLE[] = "{\"command\":\"toggle\"}";
+const char STATUS[] = "{\"command\":\"status\"}";
+
+}  // namespace
+
+FIRMWARE_BENCHMARK(BM_BuildStatusJson) {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  buildStatusJson(json);
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_BuildResponseJson) {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  buildResponseJson(json, true, "LED ON");
+  benchmark::DoNotOptimize(json.c_str());
+}
+
+FIRMWARE_BENCHMARK(BM_HandleWebSocketToggle) {
+  handleWebSocketMessage(0, TOGGLE, sizeof(TOGGLE) - 1);
+}
+
+FIRMWARE_BENCHMARK(BM_HandleWebSocketStatus) {
+  handleWebSocketMessage(0, STATUS, sizeof(STATUS) - 1);
+}
+
+FIRMWARE_BENCHMARK_MAIN();
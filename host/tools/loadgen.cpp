@@ -0,0 +1,849 @@
+// Load generator for the HTTP + WebSocket sketches (board or host build).
+//
+// Opens N WebSocket clients and M HTTP pollers against one target, drives a
+// weighted command mix, matches every reply and led_update broadcast back to
+// the command that caused it, and reports throughput and latency percentiles
+// as JSON (see host/README.md).
+//
+//   loadgen --host 192.168.1.50 --ws-clients 8 --http-clients 2 --duration 30
+//   loadgen --http-port 8080 --ws-port 8081 --json result.json   # host build
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Sha1.h"
+
+namespace {
+
+const char* const WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+const size_t MAX_MESSAGE = 16384;
+
+uint64_t nowUs() {
+  using namespace std::chrono;
+  return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ========== CONFIGURATION ==========
+
+struct MixEntry {
+  std::string command;  // value of "command" in the WebSocket message
+  uint32_t weight;
+};
+
+struct Options {
+  std::string host = "127.0.0.1";
+  uint16_t httpPort = 80;
+  uint16_t wsPort = 81;
+  int wsClients = 8;
+  int httpClients = 2;
+  double durationS = 10.0;
+  uint32_t wsIntervalMs = 0;     // per client, 0 = next command as soon as the reply arrives
+  uint32_t httpIntervalMs = 100;
+  uint32_t timeoutMs = 2000;
+  bool senderGetsUpdate = true;  // Hybrid broadcasts led_update to the sender too
+  std::vector<MixEntry> mix;
+  std::vector<std::string> httpPaths;
+  std::string jsonPath = "-";
+  uint32_t seed = 1;
+};
+
+void printUsage() {
+  fprintf(stderr,
+          "Usage: loadgen [options]\n"
+          "  --host H              target address (default 127.0.0.1)\n"
+          "  --http-port P         REST port (default 80)\n"
+          "  --ws-port P           WebSocket port (default 81)\n"
+          "  --ws-clients N        WebSocket connections (default 8)\n"
+          "  --http-clients M      concurrent HTTP pollers (default 2)\n"
+          "  --duration S          seconds to run (default 10)\n"
+          "  --mix LIST            command:weight,... (default toggle:1)\n"
+          "  --ws-interval-ms T    gap between commands per client (default 0 = closed loop)\n"
+          "  --http-path PATH      GET path, repeat for a round-robin mix (default /status)\n"
+          "  --http-interval-ms T  gap between requests per poller (default 100)\n"
+          "  --timeout-ms T        reply timeout (default 2000)\n"
+          "  --no-sender-update    target does not echo led_update to the sender\n"
+          "  --json FILE           write results to FILE ('-' = stdout, default)\n"
+          "  --seed N              command mix RNG seed (default 1)\n");
+}
+
+bool parseMix(const char* spec, std::vector<MixEntry>& mix) {
+  std::string list(spec);
+  size_t start = 0;
+  while (start < list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    std::string item = list.substr(start, end - start);
+    size_t colon = item.find(':');
+    MixEntry entry;
+    entry.command = item.substr(0, colon);
+    entry.weight = colon == std::string::npos ? 1 : (uint32_t)atoi(item.c_str() + colon + 1);
+    if (entry.command.empty() || entry.weight == 0) return false;
+    mix.push_back(entry);
+    start = end + 1;
+  }
+  return !mix.empty();
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    bool needsValue = arg != "--no-sender-update" && arg != "--help";
+    if (needsValue && value == nullptr) {
+      fprintf(stderr, "loadgen: %s needs a value\n", arg.c_str());
+      return false;
+    }
+
+    if (arg == "--host") options.host = value;
+    else if (arg == "--http-port") options.httpPort = (uint16_t)atoi(value);
+    else if (arg == "--ws-port") options.wsPort = (uint16_t)atoi(value);
+    else if (arg == "--ws-clients") options.wsClients = atoi(value);
+    else if (arg == "--http-clients") options.httpClients = atoi(value);
+    else if (arg == "--duration") options.durationS = atof(value);
+    else if (arg == "--ws-interval-ms") options.wsIntervalMs = (uint32_t)atoi(value);
+    else if (arg == "--http-interval-ms") options.httpIntervalMs = (uint32_t)atoi(value);
+    else if (arg == "--http-path") options.httpPaths.push_back(value);
+    else if (arg == "--timeout-ms") options.timeoutMs = (uint32_t)atoi(value);
+    else if (arg == "--json") options.jsonPath = value;
+    else if (arg == "--seed") options.seed = (uint32_t)atoi(value);
+    else if (arg == "--no-sender-update") {
+      options.senderGetsUpdate = false;
+      continue;
+    } else if (arg == "--mix") {
+      if (!parseMix(value, options.mix)) {
+        fprintf(stderr, "loadgen: bad --mix '%s'\n", value);
+        return false;
+      }
+    } else {
+      printUsage();
+      return false;
+    }
+    i++;
+  }
+
+  if (options.mix.empty()) parseMix("toggle:1", options.mix);
+  if (options.httpPaths.empty()) options.httpPaths.push_back("/status");
+  if (options.wsClients < 0 || options.wsClients > 64 || options.httpClients < 0 ||
+      options.durationS <= 0) {
+    fprintf(stderr, "loadgen: ws-clients must be 0..64, http-clients >= 0, duration > 0\n");
+    return false;
+  }
+  return true;
+}
+
+// ========== STATISTICS ==========
+
+/**
+ * @brief Latency samples plus failure counts for one kind of operation
+ */
+struct Stats {
+  std::vector<uint32_t> samplesUs;
+  uint64_t errors = 0;
+  uint64_t timeouts = 0;
+
+  void add(uint64_t latencyUs) {
+    samplesUs.push_back((uint32_t)std::min<uint64_t>(latencyUs, UINT32_MAX));
+  }
+
+  void merge(const Stats& other) {
+    samplesUs.insert(samplesUs.end(), other.samplesUs.begin(), other.samplesUs.end());
+    errors += other.errors;
+    timeouts += other.timeouts;
+  }
+};
+
+// Nearest-rank percentile of sorted samples
+uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t rank = (size_t)((p / 100.0) * sorted.size() + 0.999999);
+  if (rank == 0) rank = 1;
+  return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+void writeStats(FILE* out, Stats stats, double elapsedS) {
+  std::sort(stats.samplesUs.begin(), stats.samplesUs.end());
+  uint64_t total = 0;
+  for (uint32_t sample : stats.samplesUs) total += sample;
+  size_t count = stats.samplesUs.size();
+
+  fprintf(out,
+          "{\"count\":%zu,\"errors\":%llu,\"timeouts\":%llu,\"throughput_per_s\":%.1f,"
+          "\"latency_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u,\"mean\":%llu}}",
+          count, (unsigned long long)stats.errors, (unsigned long long)stats.timeouts,
+          elapsedS > 0 ? count / elapsedS : 0.0, percentile(stats.samplesUs, 50),
+          percentile(stats.samplesUs, 90), percentile(stats.samplesUs, 99),
+          count ? stats.samplesUs.back() : 0,
+          count ? (unsigned long long)(total / count) : 0ULL);
+}
+
+void printStatsLine(const char* name, Stats stats, double elapsedS) {
+  std::sort(stats.samplesUs.begin(), stats.samplesUs.end());
+  size_t count = stats.samplesUs.size();
+  fprintf(stderr, "  %-22s %8zu %9.1f/s %8.2f %8.2f %8.2f %8.2f ms  err=%llu timeout=%llu\n",
+          name, count, count / elapsedS, percentile(stats.samplesUs, 50) / 1000.0,
+          percentile(stats.samplesUs, 90) / 1000.0, percentile(stats.samplesUs, 99) / 1000.0,
+          (count ? stats.samplesUs.back() : 0) / 1000.0, (unsigned long long)stats.errors,
+          (unsigned long long)stats.timeouts);
+}
+
+// ========== SOCKETS ==========
+
+bool resolve(const std::string& host, uint16_t port, sockaddr_in& address) {
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) return false;
+  address = *(sockaddr_in*)result->ai_addr;
+  address.sin_port = htons(port);
+  freeaddrinfo(result);
+  return true;
+}
+
+// Nonblocking connect; completion is signalled by POLLOUT
+int startConnect(const sockaddr_in& address) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (connect(fd, (const sockaddr*)&address, sizeof(address)) < 0 && errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool connectFinished(int fd) {
+  int error = 0;
+  socklen_t length = sizeof(error);
+  return getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+}
+
+// Returns false when the peer is gone
+bool flushOutput(int fd, std::string& out) {
+  while (!out.empty()) {
+    ssize_t n = send(fd, out.data(), out.size(), MSG_NOSIGNAL);
+    if (n > 0) {
+      out.erase(0, (size_t)n);
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Appends what is readable; returns false on EOF or error
+bool readAvailable(int fd, std::string& in) {
+  char buffer[4096];
+  while (true) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      in.append(buffer, (size_t)n);
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    } else {
+      return false;
+    }
+  }
+}
+
+// Value of a top-level "key":"string" field, empty if absent
+std::string jsonString(const std::string& json, const char* key) {
+  std::string pattern = std::string("\"") + key + "\":\"";
+  size_t start = json.find(pattern);
+  if (start == std::string::npos) return "";
+  start += pattern.size();
+  size_t end = json.find('"', start);
+  return end == std::string::npos ? "" : json.substr(start, end - start);
+}
+
+// Status replies look like the periodic status broadcasts, so only their
+// "request" tag tells them apart; everything else gets a "response"
+bool isReply(const MixEntry& entry, const std::string& message, const std::string& type) {
+  if (entry.command == "status") return jsonString(message, "request") == "status";
+  return type == "response";
+}
+
+// ========== WEBSOCKET CLIENTS ==========
+
+/**
+ * @brief A toggle whose led_update broadcast is still expected
+ *
+ * The device dispatches commands one at a time, so every client receives
+ * led_updates in dispatch order. Each client keeps a cursor into this
+ * sequence and attributes its next led_update to the oldest toggle it has
+ * not yet seen. Near-simultaneous toggles from different clients may be
+ * swapped, which bounds the error by their send gap.
+ */
+struct PendingToggle {
+  uint64_t seq;
+  uint64_t sentUs;
+  int sender;
+};
+
+struct WsClient {
+  enum Phase { CONNECTING, HANDSHAKE, OPEN, FAILED };
+
+  int index = 0;
+  int fd = -1;
+  Phase phase = CONNECTING;
+  std::string key;
+  std::string expectedAccept;
+  std::string in;
+  std::string out;
+  uint64_t openedUs = 0;
+  bool greeted = false;     // initial status frame seen
+  int pending = -1;         // mix index awaiting its reply
+  uint64_t sentUs = 0;
+  uint64_t nextSendUs = 0;
+  uint64_t nextToggleSeq = 0;
+};
+
+struct HttpClient {
+  enum Phase { IDLE, CONNECTING, WAITING };
+
+  int fd = -1;
+  Phase phase = IDLE;
+  size_t pathIndex = 0;
+  std::string in;
+  std::string out;
+  uint64_t startUs = 0;
+  uint64_t nextStartUs = 0;
+};
+
+/**
+ * @brief Single-threaded poll() loop driving every connection
+ */
+class LoadGenerator {
+public:
+  explicit LoadGenerator(const Options& options)
+      : options_(options), rng_(options.seed), commandStats_(options.mix.size()),
+        httpStats_(options.httpPaths.size()) {
+    for (const MixEntry& entry : options_.mix) totalWeight_ += entry.weight;
+  }
+
+  bool run();
+  void report(FILE* out) const;
+  void printSummary() const;
+  bool printFailures() const;
+
+private:
+  void startWebSocket(WsClient& client);
+  void onWebSocketWritable(WsClient& client);
+  void onWebSocketReadable(WsClient& client);
+  void handleFrame(WsClient& client, uint8_t opcode, const std::string& payload);
+  void handleText(WsClient& client, const std::string& message);
+  void sendFrame(WsClient& client, uint8_t opcode, const std::string& payload);
+  void sendCommand(WsClient& client, uint64_t now);
+  void failWebSocket(WsClient& client);
+  void expireToggles(uint64_t now);
+
+  void startHttp(HttpClient& client, uint64_t now);
+  void onHttpReadable(HttpClient& client, uint64_t now);
+  void finishHttp(HttpClient& client, uint64_t now, bool complete);
+
+  bool toggleVisibleTo(const PendingToggle& toggle, const WsClient& client) const {
+    return toggle.sentUs >= client.openedUs &&
+           (toggle.sender != client.index || options_.senderGetsUpdate);
+  }
+
+  Options options_;
+  std::mt19937 rng_;
+  uint32_t totalWeight_ = 0;
+  sockaddr_in wsAddress_ = {};
+  sockaddr_in httpAddress_ = {};
+  std::vector<WsClient> wsClients_;
+  std::vector<HttpClient> httpClients_;
+  std::deque<PendingToggle> toggles_;
+  uint64_t nextToggleSeq_ = 0;
+
+  std::vector<Stats> commandStats_;
+  std::vector<Stats> httpStats_;
+  Stats broadcastStats_;
+  uint64_t unmatchedBroadcasts_ = 0;
+  uint64_t wsConnectFailures_ = 0;
+  uint64_t wsDisconnects_ = 0;
+  int wsOpen_ = 0;
+  double elapsedS_ = 0;
+};
+
+void LoadGenerator::startWebSocket(WsClient& client) {
+  client.fd = startConnect(wsAddress_);
+  if (client.fd < 0) {
+    failWebSocket(client);
+    return;
+  }
+
+  uint8_t nonce[16];
+  for (uint8_t& byte : nonce) byte = (uint8_t)rng_();
+  char key[32];
+  host::base64Encode(nonce, sizeof(nonce), key);
+  client.key = key;
+
+  std::string accept = client.key + WS_GUID;
+  uint8_t digest[20];
+  host::sha1((const uint8_t*)accept.data(), accept.size(), digest);
+  char expected[32];
+  host::base64Encode(digest, sizeof(digest), expected);
+  client.expectedAccept = expected;
+
+  client.out = "GET / HTTP/1.1\r\nHost: " + options_.host + ":" + std::to_string(options_.wsPort) +
+               "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " +
+               client.key + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  client.phase = WsClient::CONNECTING;
+}
+
+void LoadGenerator::failWebSocket(WsClient& client) {
+  if (client.phase == WsClient::OPEN) {
+    wsOpen_--;
+    wsDisconnects_++;
+  } else if (client.phase != WsClient::FAILED) {
+    wsConnectFailures_++;
+  }
+  if (client.fd >= 0) close(client.fd);
+  client.fd = -1;
+  client.phase = WsClient::FAILED;
+}
+
+void LoadGenerator::onWebSocketWritable(WsClient& client) {
+  if (client.phase == WsClient::CONNECTING) {
+    if (!connectFinished(client.fd)) {
+      failWebSocket(client);
+      return;
+    }
+    client.phase = WsClient::HANDSHAKE;
+  }
+  if (!flushOutput(client.fd, client.out)) failWebSocket(client);
+}
+
+void LoadGenerator::onWebSocketReadable(WsClient& client) {
+  bool alive = readAvailable(client.fd, client.in);
+
+  if (client.phase == WsClient::HANDSHAKE) {
+    size_t end = client.in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      if (!alive) failWebSocket(client);
+      return;
+    }
+    std::string head = client.in.substr(0, end);
+    client.in.erase(0, end + 4);
+    if (head.compare(0, 12, "HTTP/1.1 101") != 0 ||
+        head.find(client.expectedAccept) == std::string::npos) {
+      failWebSocket(client);  // e.g. 503 when the server's client slots are full
+      return;
+    }
+    client.phase = WsClient::OPEN;
+    client.openedUs = nowUs();
+    client.nextToggleSeq = nextToggleSeq_;
+    client.nextSendUs = client.openedUs + 500000;  // start anyway if no greeting arrives
+    wsOpen_++;
+  }
+
+  // Server frames are unmasked: 2-byte header, optional 16/64-bit length
+  while (client.phase == WsClient::OPEN && client.in.size() >= 2) {
+    const uint8_t* data = (const uint8_t*)client.in.data();
+    uint8_t opcode = data[0] & 0x0F;
+    uint64_t length = data[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+      if (client.in.size() < 4) break;
+      length = ((uint64_t)data[2] << 8) | data[3];
+      header = 4;
+    } else if (length == 127) {
+      if (client.in.size() < 10) break;
+      length = 0;
+      for (int i = 0; i < 8; i++) length = (length << 8) | data[2 + i];
+      header = 10;
+    }
+    if (length > MAX_MESSAGE) {
+      failWebSocket(client);
+      return;
+    }
+    if (client.in.size() < header + length) break;
+
+    std::string payload = client.in.substr(header, (size_t)length);
+    client.in.erase(0, header + (size_t)length);
+    handleFrame(client, opcode, payload);
+  }
+
+  if (!alive && client.phase != WsClient::FAILED) failWebSocket(client);
+}
+
+void LoadGenerator::handleFrame(WsClient& client, uint8_t opcode, const std::string& payload) {
+  switch (opcode) {
+    case 0x1:
+      handleText(client, payload);
+      break;
+    case 0x8:
+      failWebSocket(client);
+      break;
+    case 0x9:
+      sendFrame(client, 0xA, payload);
+      break;
+    default:
+      break;
+  }
+}
+
+void LoadGenerator::handleText(WsClient& client, const std::string& message) {
+  uint64_t now = nowUs();
+  std::string type = jsonString(message, "type");
+
+  if (type == "led_update") {
+    for (const PendingToggle& toggle : toggles_) {
+      if (toggle.seq < client.nextToggleSeq || !toggleVisibleTo(toggle, client)) continue;
+      broadcastStats_.add(now - toggle.sentUs);
+      client.nextToggleSeq = toggle.seq + 1;
+      return;
+    }
+    unmatchedBroadcasts_++;  // caused by led_on/led_off, REST or another controller
+    return;
+  }
+
+  if (client.pending >= 0 && isReply(options_.mix[client.pending], message, type)) {
+    Stats& stats = commandStats_[client.pending];
+    if (message.find("\"success\":false") != std::string::npos) {
+      stats.errors++;
+    } else {
+      stats.add(now - client.sentUs);
+    }
+    client.pending = -1;
+    client.nextSendUs = std::max<uint64_t>(now, client.sentUs + options_.wsIntervalMs * 1000ULL);
+    return;
+  }
+
+  if (!client.greeted && type == "status") {
+    client.greeted = true;
+    client.nextSendUs = now;
+  }
+  // Anything else is a periodic status broadcast
+}
+
+void LoadGenerator::sendFrame(WsClient& client, uint8_t opcode, const std::string& payload) {
+  std::string frame;
+  frame.push_back((char)(0x80 | opcode));
+  if (payload.size() < 126) {
+    frame.push_back((char)(0x80 | payload.size()));
+  } else {
+    frame.push_back((char)(0x80 | 126));
+    frame.push_back((char)(payload.size() >> 8));
+    frame.push_back((char)(payload.size() & 0xFF));
+  }
+  uint8_t mask[4];
+  for (uint8_t& byte : mask) byte = (uint8_t)rng_();
+  frame.append((const char*)mask, 4);
+  for (size_t i = 0; i < payload.size(); i++) frame.push_back((char)(payload[i] ^ mask[i % 4]));
+
+  client.out += frame;
+  if (!flushOutput(client.fd, client.out)) failWebSocket(client);
+}
+
+void LoadGenerator::sendCommand(WsClient& client, uint64_t now) {
+  uint32_t pick = rng_() % totalWeight_;
+  int entry = 0;
+  while (pick >= options_.mix[entry].weight) {
+    pick -= options_.mix[entry].weight;
+    entry++;
+  }
+
+  client.pending = entry;
+  client.sentUs = now;
+  if (options_.mix[entry].command == "toggle") {
+    toggles_.push_back(PendingToggle{nextToggleSeq_++, now, client.index});
+  }
+  sendFrame(client, 0x1, "{\"command\":\"" + options_.mix[entry].command + "\"}");
+}
+
+// Toggles older than the timeout can no longer be matched: count who missed them
+void LoadGenerator::expireToggles(uint64_t now) {
+  uint64_t timeoutUs = options_.timeoutMs * 1000ULL;
+  while (!toggles_.empty() && now - toggles_.front().sentUs > timeoutUs) {
+    const PendingToggle& toggle = toggles_.front();
+    for (WsClient& client : wsClients_) {
+      if (client.phase != WsClient::OPEN || !toggleVisibleTo(toggle, client)) continue;
+      if (client.nextToggleSeq <= toggle.seq) {
+        broadcastStats_.timeouts++;
+        client.nextToggleSeq = toggle.seq + 1;
+      }
+    }
+    toggles_.pop_front();
+  }
+}
+
+void LoadGenerator::startHttp(HttpClient& client, uint64_t now) {
+  client.fd = startConnect(httpAddress_);
+  client.startUs = now;
+  client.in.clear();
+  const std::string& path = options_.httpPaths[client.pathIndex];
+  client.out = "GET " + path + " HTTP/1.1\r\nHost: " + options_.host +
+               "\r\nConnection: close\r\n\r\n";
+  if (client.fd < 0) {
+    httpStats_[client.pathIndex].errors++;
+    client.nextStartUs = now + options_.httpIntervalMs * 1000ULL;
+    return;
+  }
+  client.phase = HttpClient::CONNECTING;
+}
+
+void LoadGenerator::onHttpReadable(HttpClient& client, uint64_t now) {
+  bool alive = readAvailable(client.fd, client.in);
+
+  // Complete once Content-Length bytes of body are in, or at EOF
+  size_t end = client.in.find("\r\n\r\n");
+  if (end != std::string::npos) {
+    const char* length = strcasestr(client.in.c_str(), "\r\nContent-Length:");
+    if (length != nullptr && length < client.in.c_str() + end &&
+        client.in.size() >= end + 4 + (size_t)atol(length + 17)) {
+      finishHttp(client, now, true);
+      return;
+    }
+  }
+  if (!alive) finishHttp(client, now, end != std::string::npos);
+}
+
+void LoadGenerator::finishHttp(HttpClient& client, uint64_t now, bool complete) {
+  Stats& stats = httpStats_[client.pathIndex];
+  if (complete && client.in.compare(0, 12, "HTTP/1.1 200") == 0) {
+    stats.add(now - client.startUs);
+  } else {
+    stats.errors++;
+  }
+  close(client.fd);
+  client.fd = -1;
+  client.phase = HttpClient::IDLE;
+  client.pathIndex = (client.pathIndex + 1) % options_.httpPaths.size();
+  client.nextStartUs = std::max<uint64_t>(now, client.startUs + options_.httpIntervalMs * 1000ULL);
+}
+
+bool LoadGenerator::run() {
+  if (!resolve(options_.host, options_.wsPort, wsAddress_) ||
+      !resolve(options_.host, options_.httpPort, httpAddress_)) {
+    fprintf(stderr, "loadgen: cannot resolve %s\n", options_.host.c_str());
+    return false;
+  }
+
+  wsClients_.resize(options_.wsClients);
+  for (int i = 0; i < options_.wsClients; i++) {
+    wsClients_[i].index = i;
+    startWebSocket(wsClients_[i]);
+  }
+  httpClients_.resize(options_.httpClients);
+  uint64_t start = nowUs();
+  for (int i = 0; i < options_.httpClients; i++) {
+    httpClients_[i].pathIndex = i % options_.httpPaths.size();
+    httpClients_[i].nextStartUs = start;
+  }
+
+  uint64_t end = start + (uint64_t)(options_.durationS * 1e6);
+  uint64_t timeoutUs = options_.timeoutMs * 1000ULL;
+  std::vector<pollfd> fds;
+  std::vector<int> owners;  // >= 0: WebSocket index, < 0: -1 - HTTP index
+
+  while (true) {
+    uint64_t now = nowUs();
+    if (now >= end) break;
+
+    uint64_t wake = std::min<uint64_t>(end, now + 10000);
+    for (WsClient& client : wsClients_) {
+      if (client.phase != WsClient::OPEN) continue;
+      if (client.pending >= 0 && now - client.sentUs > timeoutUs) {
+        commandStats_[client.pending].timeouts++;
+        client.pending = -1;
+        client.nextSendUs = now;
+      }
+      if (client.pending < 0 && now >= client.nextSendUs) {
+        sendCommand(client, now);
+      } else if (client.pending < 0) {
+        wake = std::min(wake, client.nextSendUs);
+      }
+    }
+    for (HttpClient& client : httpClients_) {
+      if (client.phase == HttpClient::IDLE && now >= client.nextStartUs) {
+        startHttp(client, now);
+      } else if (client.phase == HttpClient::IDLE) {
+        wake = std::min(wake, client.nextStartUs);
+      } else if (now - client.startUs > timeoutUs) {
+        httpStats_[client.pathIndex].timeouts++;
+        close(client.fd);
+        client.fd = -1;
+        client.phase = HttpClient::IDLE;
+        client.nextStartUs = now;
+      }
+    }
+    expireToggles(now);
+
+    fds.clear();
+    owners.clear();
+    for (WsClient& client : wsClients_) {
+      if (client.fd < 0) continue;
+      short events = POLLIN;
+      if (client.phase == WsClient::CONNECTING || !client.out.empty()) events |= POLLOUT;
+      fds.push_back(pollfd{client.fd, events, 0});
+      owners.push_back(client.index);
+    }
+    for (size_t i = 0; i < httpClients_.size(); i++) {
+      HttpClient& client = httpClients_[i];
+      if (client.fd < 0) continue;
+      short events = client.phase == HttpClient::CONNECTING ? POLLOUT : POLLIN;
+      fds.push_back(pollfd{client.fd, events, 0});
+      owners.push_back(-1 - (int)i);
+    }
+
+    uint64_t after = nowUs();
+    int waitMs = wake > after ? (int)((wake - after + 999) / 1000) : 0;
+    if (poll(fds.data(), fds.size(), waitMs) < 0 && errno != EINTR) return false;
+
+    now = nowUs();
+    for (size_t i = 0; i < fds.size(); i++) {
+      short revents = fds[i].revents;
+      if (revents == 0) continue;
+
+      if (owners[i] >= 0) {
+        WsClient& client = wsClients_[owners[i]];
+        if (revents & POLLOUT) onWebSocketWritable(client);
+        if (client.phase != WsClient::FAILED && (revents & (POLLIN | POLLHUP | POLLERR))) {
+          onWebSocketReadable(client);
+        }
+        continue;
+      }
+
+      HttpClient& client = httpClients_[-1 - owners[i]];
+      if (client.phase == HttpClient::CONNECTING) {
+        if (!connectFinished(client.fd)) {
+          finishHttp(client, now, false);
+          continue;
+        }
+        client.phase = HttpClient::WAITING;
+        if (!flushOutput(client.fd, client.out)) finishHttp(client, now, false);
+      } else if (revents & (POLLIN | POLLHUP | POLLERR)) {
+        onHttpReadable(client, now);
+      }
+    }
+  }
+
+  elapsedS_ = (nowUs() - start) / 1e6;
+  for (WsClient& client : wsClients_) {
+    if (client.fd >= 0) close(client.fd);
+  }
+  for (HttpClient& client : httpClients_) {
+    if (client.fd >= 0) close(client.fd);
+  }
+  return true;
+}
+
+void LoadGenerator::report(FILE* out) const {
+  fprintf(out, "{\"target\":{\"host\":\"%s\",\"http_port\":%u,\"ws_port\":%u},",
+          options_.host.c_str(), options_.httpPort, options_.wsPort);
+  fprintf(out, "\"config\":{\"ws_clients\":%d,\"http_clients\":%d,\"ws_interval_ms\":%u,"
+               "\"http_interval_ms\":%u,\"timeout_ms\":%u,\"mix\":{",
+          options_.wsClients, options_.httpClients, options_.wsIntervalMs,
+          options_.httpIntervalMs, options_.timeoutMs);
+  for (size_t i = 0; i < options_.mix.size(); i++) {
+    fprintf(out, "%s\"%s\":%u", i ? "," : "", options_.mix[i].command.c_str(),
+            options_.mix[i].weight);
+  }
+  fprintf(out, "}},\"duration_s\":%.3f,", elapsedS_);
+
+  Stats allCommands;
+  for (const Stats& stats : commandStats_) allCommands.merge(stats);
+  fprintf(out, "\"ws\":{\"connected\":%d,\"connect_failures\":%llu,\"disconnects\":%llu,"
+               "\"commands\":{",
+          wsOpen_, (unsigned long long)wsConnectFailures_, (unsigned long long)wsDisconnects_);
+  for (size_t i = 0; i < options_.mix.size(); i++) {
+    fprintf(out, "%s\"%s\":", i ? "," : "", options_.mix[i].command.c_str());
+    writeStats(out, commandStats_[i], elapsedS_);
+  }
+  fprintf(out, "},\"all\":");
+  writeStats(out, allCommands, elapsedS_);
+  fprintf(out, "},\"broadcast\":{\"unmatched\":%llu,\"led_update\":",
+          (unsigned long long)unmatchedBroadcasts_);
+  writeStats(out, broadcastStats_, elapsedS_);
+
+  Stats allHttp;
+  for (const Stats& stats : httpStats_) allHttp.merge(stats);
+  fprintf(out, "},\"http\":{\"paths\":{");
+  for (size_t i = 0; i < options_.httpPaths.size(); i++) {
+    fprintf(out, "%s\"%s\":", i ? "," : "", options_.httpPaths[i].c_str());
+    writeStats(out, httpStats_[i], elapsedS_);
+  }
+  fprintf(out, "},\"all\":");
+  writeStats(out, allHttp, elapsedS_);
+  fprintf(out, "}}\n");
+}
+
+void LoadGenerator::printSummary() const {
+  fprintf(stderr, "\n%s  ws %d/%d connected (%llu refused, %llu dropped), %d http pollers, %.1f s\n",
+          options_.host.c_str(), wsOpen_, options_.wsClients,
+          (unsigned long long)wsConnectFailures_, (unsigned long long)wsDisconnects_,
+          options_.httpClients, elapsedS_);
+  fprintf(stderr, "  %-22s %8s %11s %8s %8s %8s %8s\n", "operation", "count", "rate", "p50",
+          "p90", "p99", "max");
+  for (size_t i = 0; i < options_.mix.size(); i++) {
+    printStatsLine(("ws " + options_.mix[i].command).c_str(), commandStats_[i], elapsedS_);
+  }
+  printStatsLine("ws led_update fan-out", broadcastStats_, elapsedS_);
+  for (size_t i = 0; options_.httpClients > 0 && i < options_.httpPaths.size(); i++) {
+    printStatsLine(("http " + options_.httpPaths[i]).c_str(), httpStats_[i], elapsedS_);
+  }
+  if (unmatchedBroadcasts_ > 0) {
+    fprintf(stderr, "  %llu led_update(s) not caused by a toggle from this run\n",
+            (unsigned long long)unmatchedBroadcasts_);
+  }
+}
+
+// A command that timed out without one matched reply is not slow: the
+// target never answers it in a form this tool recognises
+bool LoadGenerator::printFailures() const {
+  bool failed = false;
+  for (size_t i = 0; i < options_.mix.size(); i++) {
+    const Stats& stats = commandStats_[i];
+    if (stats.timeouts == 0 || !stats.samplesUs.empty() || stats.errors > 0) continue;
+    fprintf(stderr, "loadgen: FAILED: no reply to any of %llu '%s' command(s)\n",
+            (unsigned long long)stats.timeouts, options_.mix[i].command.c_str());
+    failed = true;
+  }
+  return failed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) return 2;
+  signal(SIGPIPE, SIG_IGN);
+
+  LoadGenerator generator(options);
+  if (!generator.run()) return 1;
+  generator.printSummary();
+
+  FILE* out = options.jsonPath == "-" ? stdout : fopen(options.jsonPath.c_str(), "w");
+  if (out == nullptr) {
+    fprintf(stderr, "loadgen: cannot write %s\n", options.jsonPath.c_str());
+    return 1;
+  }
+  generator.report(out);
+  if (out != stdout) fclose(out);
+  return generator.printFailures() ? 3 : 0;
+}
@@ -0,0 +1,454 @@
+// String table generator and decoder for LOG_BINARY firmware logs.
+//
+// With LOG_BINARY 1 the device sends each LOG_* statement as a frame holding
+// the FNV-1a hash of its format string and the raw arguments (see
+// esp32-common/src/Log.h). --generate scans the sources for LOG_* statements
+// and writes the id -> format table; decoding reads the Serial capture,
+// passes plain text through and prints each frame as the line the text
+// build would have printed.
+//
+//   logdecode --generate log_table.tsv ESP32_Hybrid_REST_WebSocket.cpp ...
+//   stty -F /dev/ttyUSB0 115200 raw && logdecode --table log_table.tsv /dev/ttyUSB0
+//   sketch_hybrid_rest_websocket_binlog | logdecode --table build/log_table.tsv
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint8_t FRAME_START = 0x1F;  // Log::FRAME_START
+const char* const LEVELS[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+const char* const PREFIXES[] = {"[E] ", "[W] ", "[I] ", "[D] "};
+
+struct Entry {
+  int level;           // Index into LEVELS
+  std::string format;  // Unescaped, as the compiler sees it
+  std::string where;   // file:line of the first statement using it
+};
+
+uint32_t formatId(const std::string& format) {
+  uint32_t hash = 2166136261u;  // Log::formatId()
+  for (unsigned char c : format) hash = (hash ^ c) * 16777619u;
+  return hash;
+}
+
+// ========== TABLE GENERATION ==========
+
+bool readFile(const char* path, std::string& out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  out = buffer.str();
+  return true;
+}
+
+// Skips whitespace and comments; returns the new position
+size_t skipSpace(const std::string& text, size_t i) {
+  while (i < text.size()) {
+    if (isspace((unsigned char)text[i])) {
+      i++;
+    } else if (text.compare(i, 2, "//") == 0) {
+      i = text.find('\n', i);
+      if (i == std::string::npos) return text.size();
+    } else if (text.compare(i, 2, "/*") == 0) {
+      i = text.find("*/", i + 2);
+      if (i == std::string::npos) return text.size();
+      i += 2;
+    } else {
+      break;
+    }
+  }
+  return i;
+}
+
+// One "..." literal at text[i] appended to out, escapes resolved
+bool readLiteral(const std::string& text, size_t& i, std::string& out) {
+  if (text[i] != '"') return false;
+  for (i++; i < text.size() && text[i] != '"'; i++) {
+    char c = text[i];
+    if (c != '\\') {
+      out += c;
+      continue;
+    }
+    if (++i >= text.size()) return false;
+    c = text[i];
+    switch (c) {
+      case 'n': out += '\n'; break;
+      case 't': out += '\t'; break;
+      case 'r': out += '\r'; break;
+      case 'a': out += '\a'; break;
+      case 'b': out += '\b'; break;
+      case 'f': out += '\f'; break;
+      case 'v': out += '\v'; break;
+      case 'x': {
+        unsigned value = 0;
+        while (i + 1 < text.size() && isxdigit((unsigned char)text[i + 1])) {
+          value = value * 16 + (unsigned)strtol(text.substr(++i, 1).c_str(), nullptr, 16);
+        }
+        out += (char)value;
+        break;
+      }
+      default:
+        if (c >= '0' && c <= '7') {
+          unsigned value = c - '0';
+          for (int n = 0; n < 2 && i + 1 < text.size() && text[i + 1] >= '0' && text[i + 1] <= '7'; n++) {
+            value = value * 8 + (text[++i] - '0');
+          }
+          out += (char)value;
+        } else {
+          out += c;  // \\ \" \' \?
+        }
+    }
+  }
+  if (i >= text.size()) return false;
+  i++;  // Closing quote
+  return true;
+}
+
+int lineOf(const std::string& text, size_t position) {
+  int line = 1;
+  for (size_t i = 0; i < position; i++) {
+    if (text[i] == '\n') line++;
+  }
+  return line;
+}
+
+// Adds every LOG_<LEVEL>("literal" ...) of one file; false on an id collision
+bool scanFile(const char* path, std::map<uint32_t, Entry>& table) {
+  std::string text;
+  if (!readFile(path, text)) {
+    fprintf(stderr, "logdecode: cannot read %s\n", path);
+    return false;
+  }
+  const char* name = strrchr(path, '/') != nullptr ? strrchr(path, '/') + 1 : path;
+
+  bool ok = true;
+  for (size_t at = text.find("LOG_"); at != std::string::npos; at = text.find("LOG_", at + 4)) {
+    if (at > 0 && (isalnum((unsigned char)text[at - 1]) || text[at - 1] == '_')) continue;
+    int level = -1;
+    size_t i = at + 4;
+    for (int l = 0; l < 4; l++) {
+      size_t length = strlen(LEVELS[l]);
+      if (text.compare(i, length, LEVELS[l]) == 0 && text[i + length] != '_' &&
+          !isalnum((unsigned char)text[i + length])) {
+        level = l;
+        i += length;
+        break;
+      }
+    }
+    if (level < 0) continue;
+    i = skipSpace(text, i);
+    if (i >= text.size() || text[i] != '(') continue;
+    i = skipSpace(text, i + 1);
+    if (i >= text.size() || text[i] != '"') continue;  // Macro definitions: LOG_INFO(format, ...)
+
+    std::string format;
+    while (i < text.size() && text[i] == '"') {  // Adjacent literals concatenate
+      if (!readLiteral(text, i, format)) break;
+      i = skipSpace(text, i);
+    }
+
+    uint32_t id = formatId(format);
+    auto found = table.find(id);
+    if (found == table.end()) {
+      table[id] = Entry{level, format, std::string(name) + ":" + std::to_string(lineOf(text, at))};
+    } else if (found->second.format != format) {
+      fprintf(stderr, "logdecode: id %08x of %s:%d collides with %s - reword one of them\n",
+              id, name, lineOf(text, at), found->second.where.c_str());
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+std::string escape(const std::string& text) {
+  std::string out;
+  for (char c : text) {
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '\t': out += "\\t"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      default: out += c;
+    }
+  }
+  return out;
+}
+
+std::string unescape(const std::string& text) {
+  std::string out;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] != '\\' || i + 1 >= text.size()) {
+      out += text[i];
+      continue;
+    }
+    switch (text[++i]) {
+      case 't': out += '\t'; break;
+      case 'n': out += '\n'; break;
+      case 'r': out += '\r'; break;
+      default: out += text[i];
+    }
+  }
+  return out;
+}
+
+int generate(const char* output, int count, char** sources) {
+  std::map<uint32_t, Entry> table;
+  bool ok = true;
+  for (int i = 0; i < count; i++) ok = scanFile(sources[i], table) && ok;
+  if (!ok) return 1;
+
+  FILE* out = fopen(output, "w");
+  if (out == nullptr) {
+    fprintf(stderr, "logdecode: cannot write %s\n", output);
+    return 1;
+  }
+  fprintf(out, "# id\tlevel\tsource\tformat (LOG_BINARY table, generated by logdecode)\n");
+  for (const auto& item : table) {
+    fprintf(out, "%08x\t%s\t%s\t%s\n", item.first, LEVELS[item.second.level],
+            item.second.where.c_str(), escape(item.second.format).c_str());
+  }
+  fclose(out);
+  return 0;
+}
+
+// ========== DECODING ==========
+
+bool loadTable(const char* path, std::map<uint32_t, Entry>& table) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "logdecode: cannot read %s\n", path);
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (int n = 0; n < 3; n++) {
+      size_t tab = line.find('\t', start);
+      if (tab == std::string::npos) break;
+      fields.push_back(line.substr(start, tab - start));
+      start = tab + 1;
+    }
+    if (fields.size() != 3) continue;
+    int level = 2;
+    for (int l = 0; l < 4; l++) {
+      if (fields[1] == LEVELS[l]) level = l;
+    }
+    table[(uint32_t)strtoul(fields[0].c_str(), nullptr, 16)] =
+        Entry{level, unescape(line.substr(start)), fields[2]};
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the arguments of one frame in order
+ */
+class Arguments {
+public:
+  Arguments(const uint8_t* data, size_t length) : data_(data), end_(data + length) {}
+
+  bool readInt(int64_t& value) {
+    uint64_t raw;
+    if (!readVarint(raw)) return false;
+    value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);  // Zigzag
+    return true;
+  }
+
+  bool readFloat(double& value) {
+    float f;
+    if (end_ - data_ < (ptrdiff_t)sizeof(f)) return false;
+    memcpy(&f, data_, sizeof(f));
+    data_ += sizeof(f);
+    value = f;
+    return true;
+  }
+
+  bool readString(std::string& value) {
+    uint64_t length;
+    if (!readVarint(length) || (uint64_t)(end_ - data_) < length) return false;
+    value.assign((const char*)data_, (size_t)length);
+    data_ += length;
+    return true;
+  }
+
+private:
+  bool readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (data_ >= end_) return false;
+      uint8_t byte = *data_++;
+      value |= (uint64_t)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+  }
+
+  const uint8_t* data_;
+  const uint8_t* end_;
+};
+
+// The line the text build would have printed for one frame
+std::string render(const std::string& format, Arguments& args) {
+  std::string out;
+  char piece[256];
+  for (size_t i = 0; i < format.size(); i++) {
+    if (format[i] != '%') {
+      out += format[i];
+      continue;
+    }
+    if (i + 1 < format.size() && format[i + 1] == '%') {
+      out += '%';
+      i++;
+      continue;
+    }
+
+    // %[flags][width][.precision][length]conversion; '*' takes an int argument
+    std::string spec = "%";
+    int stars[2];
+    int starCount = 0;
+    size_t j = i + 1;
+    bool ok = true;
+    while (j < format.size() && strchr("-+ #0", format[j]) != nullptr) spec += format[j++];
+    for (int part = 0; part < 2 && ok; part++) {
+      if (part == 1) {
+        if (j >= format.size() || format[j] != '.') break;
+        spec += format[j++];
+      }
+      if (j < format.size() && format[j] == '*') {
+        int64_t value = 0;
+        ok = args.readInt(value);
+        stars[starCount++] = (int)value;
+        spec += '*';
+        j++;
+      } else {
+        while (j < format.size() && isdigit((unsigned char)format[j])) spec += format[j++];
+      }
+    }
+    while (j < format.size() && strchr("hlLqjzt", format[j]) != nullptr) j++;  // Sizes: see encode()
+    if (j >= format.size()) break;
+    char conversion = format[j];
+    i = j;
+
+    int length = -1;
+    if (ok && conversion == 'c') {
+      int64_t value;
+      if ((ok = args.readInt(value))) length = snprintf(piece, sizeof(piece), "%c", (int)value);
+    } else if (ok && strchr("diuxXo", conversion) != nullptr) {
+      int64_t value;
+      if ((ok = args.readInt(value))) {
+        spec += "ll";
+        spec += conversion;
+        long long signedValue = value;
+        // An int passed to %u / %x: print it as the device's 32-bit unsigned
+        unsigned long long unsignedValue =
+            value < 0 && value >= INT32_MIN ? (uint32_t)value : (unsigned long long)value;
+        bool isSigned = conversion == 'd' || conversion == 'i';
+        if (starCount == 2) {
+          length = isSigned ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], stars[1], signedValue)
+                            : snprintf(piece, sizeof(piece), spec.c_str(), stars[0], stars[1], unsignedValue);
+        } else if (starCount == 1) {
+          length = isSigned ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], signedValue)
+                            : snprintf(piece, sizeof(piece), spec.c_str(), stars[0], unsignedValue);
+        } else {
+          length = isSigned ? snprintf(piece, sizeof(piece), spec.c_str(), signedValue)
+                            : snprintf(piece, sizeof(piece), spec.c_str(), unsignedValue);
+        }
+      }
+    } else if (ok && conversion == 'p') {
+      int64_t value;
+      if ((ok = args.readInt(value))) {
+        length = snprintf(piece, sizeof(piece), "0x%llx", (unsigned long long)value);
+      }
+    } else if (ok && strchr("fFeEgGaA", conversion) != nullptr) {
+      double value;
+      if ((ok = args.readFloat(value))) {
+        spec += conversion;
+        length = starCount == 2 ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], stars[1], value)
+               : starCount == 1 ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], value)
+                                : snprintf(piece, sizeof(piece), spec.c_str(), value);
+      }
+    } else if (ok && conversion == 's') {
+      std::string value;
+      if ((ok = args.readString(value))) {
+        spec += 's';
+        length = starCount == 2 ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], stars[1], value.c_str())
+               : starCount == 1 ? snprintf(piece, sizeof(piece), spec.c_str(), stars[0], value.c_str())
+                                : snprintf(piece, sizeof(piece), spec.c_str(), value.c_str());
+      }
+    }
+
+    if (length >= 0) {
+      out.append(piece, length < (int)sizeof(piece) ? length : sizeof(piece) - 1);
+    } else {
+      out += "<?>";  // Argument missing (frame cut on the device) or unknown conversion
+    }
+  }
+  return out;
+}
+
+int decode(const char* tablePath, FILE* in) {
+  std::map<uint32_t, Entry> table;
+  if (!loadTable(tablePath, table)) return 1;
+
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (c != FRAME_START) {
+      fputc(c, stdout);
+      if (c == '\n') fflush(stdout);
+      continue;
+    }
+    int length = fgetc(in);
+    if (length == EOF) break;
+    uint8_t frame[256];
+    if (length < 4 || fread(frame, 1, length, in) != (size_t)length) {
+      printf("<bad log frame>\n");
+      continue;
+    }
+    uint32_t id = frame[0] | frame[1] << 8 | frame[2] << 16 | (uint32_t)frame[3] << 24;
+    auto entry = table.find(id);
+    if (entry == table.end()) {
+      printf("[?] unknown log id %08x (%d argument bytes) - table older than the firmware?\n",
+             id, length - 4);
+    } else {
+      Arguments args(frame + 4, length - 4);
+      printf("%s%s\n", PREFIXES[entry->second.level], render(entry->second.format, args).c_str());
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: logdecode --generate TABLE SOURCE...   write the id -> format table\n"
+          "       logdecode --table TABLE [CAPTURE]       decode CAPTURE (default stdin)\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && strcmp(argv[1], "--generate") == 0) {
+    return generate(argv[2], argc - 3, argv + 3);
+  }
+  if ((argc == 3 || argc == 4) && strcmp(argv[1], "--table") == 0) {
+    FILE* in = argc == 4 ? fopen(argv[3], "rb") : stdin;
+    if (in == nullptr) {
+      fprintf(stderr, "logdecode: cannot read %s\n", argv[3]);
+      return 1;
+    }
+    return decode(argv[2], in);
+  }
+  usage();
+  return 2;
+}
@@ -2,6 +2,7 @@ const express = require('express');
 const axios = require('axios');
 const cors = require('cors');
 const os = require('os');
+const crypto = require('crypto');
 const { MongoClient } = require('mongodb');
 require('dotenv').config();
 
@@ -29,6 +30,12 @@ const MONGODB_CONFIG = {
   password: process.env.MONGODB_PASSWORD || ''
 };
 
+// Command tracing: every ESP32 call carries an X-Trace-Id header. The device
+// times the command under the same id (GET /traces on the ESP32); the last
+// TRACE_HISTORY calls are kept here for trace-merge.js.
+const TRACE_HISTORY = 64;
+const recentTraces = [];
+
 // MongoDB Client
 let mongoClient = null;
 let isMongoConnected = false;
@@ -87,15 +94,39 @@ async function saveStatusToMongoDB(statusData) {
 // Utility function to get ESP32 base URL
 const getESP32BaseURL = () => `http://${ESP32_CONFIG.ip}:${ESP32_CONFIG.port}`;
 
+// New trace id: 8 hex digits, top bit clear (the ESP32 sets it in its own ids)
+function newTraceId() {
+  const id = crypto.randomBytes(4).readUInt32BE(0) & 0x7fffffff;
+  return (id || 1).toString(16).padStart(8, '0');
+}
+
+// Keep the controller's side of a traced call and log it in one line
+function recordTrace(trace) {
+  recentTraces.push(trace);
+  if (recentTraces.length > TRACE_HISTORY) recentTraces.shift();
+  const status = trace.status !== undefined ? trace.status : trace.error;
+  console.log(`trace ${trace.id} ${trace.method} ${trace.endpoint} ${status} rtt=${trace.rtt_us}`);
+}
+
 // Utility function to handle ESP32 requests
 async function callESP32(endpoint, method = 'GET', data = null) {
+  const trace = {
+    id: newTraceId(),
+    method,
+    endpoint,
+    sent_at: Date.now()
+  };
+  const sentNs = process.hrtime.bigint();
+  const elapsedUs = () => Number((process.hrtime.bigint() - sentNs) / 1000n);
+
   try {
     const config = {
       method,
       url: `${getESP32BaseURL()}${endpoint}`,
       timeout: ESP32_CONFIG.timeout,
       headers: {
-        'Content-Type': 'application/json'
+        'Content-Type': 'application/json',
+        'X-Trace-Id': trace.id
       }
     };
 
@@ -105,6 +136,10 @@ async function callESP32(endpoint, method = 'GET', data = null) {
 
     console.log(`[${new Date().toISOString()}] ${method} ${config.url}`);
     const response = await axios(config);
+    trace.rtt_us = elapsedUs();
+    trace.status = response.status;
+    if (response.data && response.data.trace) trace.device = response.data.trace;
+    recordTrace(trace);
     
     return {
       success: true,
@@ -112,6 +147,9 @@ async function callESP32(endpoint, method = 'GET', data = null) {
       status: response.status
     };
   } catch (error) {
+    trace.rtt_us = elapsedUs();
+    trace.error = error.code || 'UNKNOWN_ERROR';
+    recordTrace(trace);
     console.error(`ESP32 Error:`, error.message);
     
     if (error.code === 'ECONNREFUSED') {
@@ -163,6 +201,7 @@ app.get('/', (req, res) => {
       'POST /api/led/control': 'Control LED with JSON payload {"state": true/false}',
       'POST /api/status/save': 'Save current ESP32 status to MongoDB',
       'GET /api/health': 'Check if ESP32 is reachable',
+      'GET /api/traces': 'Timing of the last ESP32 calls, by trace id (see trace-merge.js)',
       'PUT /api/config': 'Update ESP32 IP configuration'
     },
     mongodb_config: {
@@ -451,6 +490,16 @@ app.post('/api/status/save', async (req, res) => {
   }
 });
 
+/**
+ * GET /api/traces - Controller side of the last traced ESP32 calls
+ */
+app.get('/api/traces', (req, res) => {
+  res.json({
+    esp32: getESP32BaseURL(),
+    traces: recentTraces
+  });
+});
+
 /**
  * PUT /api/config - Update ESP32 IP configuration
  */
@@ -507,6 +556,7 @@ app.use('*', (req, res) => {
       'POST /api/led/toggle',
       'POST /api/led/control',
       'POST /api/status/save',
+      'GET /api/traces',
       'PUT /api/config'
     ]
   });
@@ -559,6 +609,7 @@ app.listen(PORT, '0.0.0.0', async () => {
   console.log('  POST /api/led/toggle - Toggle LED');
   console.log('  POST /api/led/control - Control with JSON');
   console.log('  POST /api/status/save - Save status to MongoDB');
+  console.log('  GET  /api/traces - Timing of the last ESP32 calls');
   console.log('=================================');
   
   // Initialize MongoDB connection
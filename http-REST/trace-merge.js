@@ -0,0 +1,99 @@
+#!/usr/bin/env node
+/**
+ * Per-command latency breakdown from controller and ESP32 traces
+ *
+ * The controller (esp32-controller.js) sends every ESP32 call with an
+ * X-Trace-Id header and keeps its send time and round trip (GET /api/traces).
+ * The hybrid server times the same command in microseconds after receiving
+ * it (GET /traces on the ESP32). Both sides measure durations on their own
+ * clock, so no clock sync is needed: the time outside the device is the
+ * round trip minus the device's time to reply.
+ *
+ * Usage:
+ *   node trace-merge.js [controller] [esp32]
+ *
+ *   controller  URL of the backend or a saved /api/traces JSON file
+ *               (default http://localhost:3000)
+ *   esp32       URL of the ESP32 or a saved /traces JSON file
+ *               (default: the ESP32 the controller reports)
+ */
+
+const fs = require('fs');
+const axios = require('axios');
+
+const DEVICE_POINTS = ['parse', 'reply', 'exec', 'bcast'];
+
+async function load(source, path) {
+  if (fs.existsSync(source)) {
+    return JSON.parse(fs.readFileSync(source, 'utf8'));
+  }
+  const response = await axios.get(`${source.replace(/\/$/, '')}${path}`, { timeout: 5000 });
+  return response.data;
+}
+
+function ms(us) {
+  return us === undefined ? '-' : (us / 1000).toFixed(2);
+}
+
+function merge(controllerTraces, deviceTraces) {
+  const device = new Map(deviceTraces.map(trace => [trace.id, trace]));
+  return controllerTraces.map(trace => {
+    // The device's list wins: it has the points reached after the reply
+    const timing = (device.get(trace.id) || trace.device || {}).us || {};
+    const row = {
+      id: trace.id,
+      request: `${trace.method} ${trace.endpoint}`,
+      status: trace.status !== undefined ? trace.status : trace.error,
+      rtt: trace.rtt_us,
+      network: timing.reply !== undefined ? trace.rtt_us - timing.reply : undefined
+    };
+    for (const point of DEVICE_POINTS) row[point] = timing[point];
+    return row;
+  });
+}
+
+function print(rows) {
+  const header = ['trace', 'request', 'status', 'rtt', 'network', ...DEVICE_POINTS];
+  const lines = rows.map(row => [
+    row.id,
+    row.request,
+    String(row.status),
+    ms(row.rtt),
+    ms(row.network),
+    ...DEVICE_POINTS.map(point => ms(row[point]))
+  ]);
+  const widths = header.map((title, i) =>
+    Math.max(title.length, ...lines.map(line => line[i].length)));
+  const format = line => line.map((cell, i) =>
+    i < 2 ? cell.padEnd(widths[i]) : cell.padStart(widths[i])).join('  ');
+
+  console.log('Times in ms. network = rtt - reply (wire, WiFi and TCP, both ways);');
+  console.log('device times are after the ESP32 received the request.\n');
+  console.log(format(header));
+  lines.forEach(line => console.log(format(line)));
+
+  const traced = rows.filter(row => row.network !== undefined);
+  if (traced.length > 0) {
+    const mean = key => traced.reduce((sum, row) => sum + (row[key] || 0), 0) / traced.length;
+    console.log(`\n${traced.length} of ${rows.length} calls matched | mean rtt ${ms(mean('rtt'))}` +
+                ` | network ${ms(mean('network'))} | on device ${ms(mean('reply'))}`);
+  }
+}
+
+async function main() {
+  const controllerSource = process.argv[2] || 'http://localhost:3000';
+  const controller = await load(controllerSource, '/api/traces');
+  const deviceSource = process.argv[3] || controller.esp32;
+  let deviceTraces = [];
+  try {
+    deviceTraces = (await load(deviceSource, '/traces')).traces || [];
+  } catch (error) {
+    console.error(`ESP32 traces unavailable (${error.message}) - using the replies only\n`);
+  }
+  print(merge(controller.traces || [], deviceTraces));
+}
+
+main().catch(error => {
+  console.error('trace-merge:', error.message);
+  process.exit(1);
+});
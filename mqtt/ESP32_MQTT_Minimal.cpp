@@ -1,16 +1,36 @@
 #include <WiFi.h>
+#include <WebServer.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <WiFiIdentity.h>
+#include <WiFiReconnect.h>
+#include <Scheduler.h>
+#include <LoopIdle.h>
+#include <MetricsEndpoint.h>
+#include <StallMonitor.h>
+#include <FlightLog.h>
+#include <LineAssembler.h>
+#include <FastWiFi.h>
+#include <ProvisioningPortal.h>
+#include <BootTimeline.h>
 
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
+const uint16_t METRICS_PORT = 80;  // GET /metrics for Prometheus
 
 // Timing Configuration
 const uint32_t WIFI_TIMEOUT_MS = 10000;
-const uint32_t WIFI_CHECK_INTERVAL_MS = 30000;
-const uint32_t SERIAL_TIMEOUT_MS = 30000;  // 30 seconds to enter info
+const uint32_t PROVISION_TIMEOUT_MS = 30000;  // Saved network down: wait this long for new credentials
 const uint32_t MQTT_RECONNECT_INTERVAL_MS = 5000;
 const uint32_t STATUS_PUBLISH_INTERVAL_MS = 30000; // Publish status every 30 seconds
+const uint32_t STALL_THRESHOLD_MS = 200;  // loop() passes longer than this are stalls
+
+// Reboots reuse the last DHCP address instead of asking again: saves up to
+// a second, but only safe where the router reserves it (see FastWiFi.h)
+const bool REUSE_DHCP_LEASE = false;
 
 // MQTT Configuration
 const char* MQTT_SERVER = "broker.hivemq.com"; // Public MQTT broker
@@ -26,89 +46,46 @@ const char* TOPIC_DEVICE_COMMAND = "esp32/device/command"; // Subscribe: Command
 // Global Objects
 WiFiClient wifiClient;
 PubSubClient mqttClient(wifiClient);
+WebServer metricsServer(METRICS_PORT);
 
 // State
-bool ledState = false;
-uint32_t lastWifiCheck = 0;
-uint32_t lastMqttReconnect = 0;
-uint32_t lastStatusPublish = 0;
-String wifiSSID = "";
-String wifiPassword = "";
-String deviceId = "";
+CommandBus bus;  // LED state store
+Scheduler scheduler;  // MQTT check and periodic status
+WiFiCache wifiCache;  // Credentials, AP and address saved in NVS
+BootTimeline boot;    // Reset to the first broker connection: Serial and /metrics
+FastWiFi::Connector wifiConnector;  // Associates while setup() does the rest
+uint8_t wifiPhase = BootTimeline::NO_PHASE;
+DeviceIdentity identity;  // Device ID/IP/SSID formatted once, not per message
 
 /**
- * @brief Read line from Serial with timeout
+ * @brief MQTT traffic counters for /metrics
  */
-String readSerialLine(uint32_t timeout) {
-  String input = "";
-  uint32_t start = millis();
-  
-  while (millis() - start < timeout) {
-    if (Serial.available()) {
-      char c = Serial.read();
-      if (c == '\n' || c == '\r') {
-        return input;
-      } else {
-        input += c;
-      }
-    }
-    delay(10);
-  }
-  return input;
-}
+struct MqttMetrics {
+  uint32_t published;
+  uint32_t publishFailed;
+  uint32_t received;
+  uint32_t connects;
+  uint32_t connectFailed;
+};
 
-/**
- * @brief Get WiFi credentials from Serial Monitor
- */
-bool getWiFiCredentials() {
-  Serial.println("\n=== WiFi Configuration ===");
-  Serial.println("Please enter your WiFi credentials");
-  Serial.println();
-  
-  Serial.print("Enter WiFi SSID: ");
-  wifiSSID = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiSSID.length() == 0) {
-    Serial.println("\nERROR: Empty input - SSID is required");
-    Serial.println("Please try again\n");
-    return false;
-  }
-  
-  Serial.println(wifiSSID);
-  
-  Serial.print("Enter WiFi Password (press Enter if open network): ");
-  wifiPassword = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiPassword.length() == 0) {
-    Serial.println("[OPEN NETWORK]");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.println("  Password: [NONE - Open Network]");
-  } else {
-    Serial.println("********");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.print("  Password: ");
-    for (int i = 0; i < wifiPassword.length(); i++) {
-      Serial.print("*");
-    }
-    Serial.println();
-  }
-  
-  return true;
-}
+MqttMetrics mqttMetrics = {0, 0, 0, 0, 0};
+LatencyHistogram loopTime;  // Work per loop() pass
+
+// Blocking sections that stall loop(): GET /stalls and the serial command "stalls"
+StallWatchdog stallWatchdog(STALL_THRESHOLD_MS);
+StaticResponseBuffer<640> stallReport;  // Header and TOP_STALLS rows
+StaticLineAssembler<32> serialCommand;
+
+// Last events before a reset: GET /flight and the serial command "flight"
+RTC_NOINIT_ATTR FlightRecorder::Storage flightStorage;
+bool mqttWasConnected = false;  // MQTT drops go to the flight log once each
 
 /**
- * @brief Control LED state
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
-  Serial.println(state ? "LED: ON" : "LED: OFF");
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
+  Serial.println(state.led ? "LED: ON" : "LED: OFF");
 }
 
 /**
@@ -121,10 +98,10 @@ String createJsonResponse(bool success, const char* message, bool includeState =
   doc["message"] = message;
   
   if (includeState) {
-    doc["led_state"] = ledState;
+    doc["led_state"] = bus.led();
   }
   
-  doc["device_id"] = deviceId;
+  doc["device_id"] = identity.deviceId();
   doc["api_version"] = "1.0";
   doc["timestamp"] = millis();
   
@@ -140,13 +117,26 @@ String createStatusJson() {
   DynamicJsonDocument doc(512);
   
   doc["device"] = "ESP32";
-  doc["device_id"] = deviceId;
-  doc["ip"] = WiFi.localIP().toString();
-  doc["ssid"] = WiFi.SSID();
+  doc["device_id"] = identity.deviceId();
+  doc["ip"] = identity.ip();
+  doc["ssid"] = identity.ssid();
   doc["rssi"] = WiFi.RSSI();
-  doc["led_state"] = ledState;
+  doc["led_state"] = bus.led();
   doc["uptime"] = millis() / 1000;
-  doc["heap"] = ESP.getFreeHeap();
+  HeapSnapshot heap = HeapMonitor::snapshot();
+  doc["heap"] = heap.freeBytes;
+  doc["heap_largest_block"] = heap.largestFreeBlock;
+  doc["heap_free_blocks"] = heap.freeBlocks;
+  doc["heap_fragmentation"] = heap.fragmentationPercent();
+  JsonArray growth = doc.createNestedArray("alloc_growth");
+  for (uint8_t i = 0; i < HeapMonitor::accounting().count(); i++) {
+    const HeapAccounting::Tag& tag = HeapMonitor::accounting().tag(i);
+    if (tag.growing) growth.add(tag.name);
+  }
+  const ReconnectPolicy& wifi = WiFiReconnect::policy();
+  doc["wifi_outages"] = wifi.outages();
+  doc["wifi_last_recovery_ms"] = wifi.lastRecoveryMs();
+  doc["wifi_max_recovery_ms"] = wifi.maxRecoveryMs();
   doc["mqtt_connected"] = mqttClient.connected();
   doc["api_version"] = "1.0";
   
@@ -159,22 +149,36 @@ String createStatusJson() {
  * @brief Publish LED status change
  */
 void publishLedStatus() {
-  String response = createJsonResponse(true, ledState ? "LED ON" : "LED OFF");
+  String response = createJsonResponse(true, bus.led() ? "LED ON" : "LED OFF");
   if (mqttClient.publish(TOPIC_LED_STATUS, response.c_str())) {
+    mqttMetrics.published++;
     Serial.println("Published LED status: " + response);
   } else {
+    mqttMetrics.publishFailed++;
     Serial.println("Failed to publish LED status");
   }
 }
 
+/**
+ * @brief MQTT adapter - publish every LED change to esp32/led/status and log it
+ */
+void onLedChangedMqtt(const StateEvent& event, void*) {
+  FlightLog::record(FLIGHT_LED, event.source, event.state.led);
+  if (mqttClient.connected()) {
+    publishLedStatus();
+  }
+}
+
 /**
  * @brief Publish device status
  */
 void publishDeviceStatus() {
   String status = createStatusJson();
   if (mqttClient.publish(TOPIC_DEVICE_STATUS, status.c_str())) {
+    mqttMetrics.published++;
     Serial.println("Published device status");
   } else {
+    mqttMetrics.publishFailed++;
     Serial.println("Failed to publish device status");
   }
 }
@@ -183,84 +187,96 @@ void publishDeviceStatus() {
  * @brief Handle MQTT message callback
  */
 void onMqttMessage(char* topic, byte* payload, unsigned int length) {
-  // Convert payload to string
-  String message = "";
-  for (int i = 0; i < length; i++) {
-    message += (char)payload[i];
-  }
+  HEAP_TAG("mqtt_message");
+  LoopIdle::markBusy();  // More packets may already be buffered; don't idle yet
+  mqttMetrics.received++;
+  
+  const char* message = (const char*)payload;  // Not null-terminated
   
   Serial.println("Received MQTT message:");
   Serial.println("  Topic: " + String(topic));
-  Serial.println("  Message: " + message);
+  Serial.print("  Message: ");
+  Serial.write(payload, length);
+  Serial.println();
+  
+  Command command;
   
   // Handle LED control
-  if (String(topic) == TOPIC_LED_CONTROL) {
-    DynamicJsonDocument doc(128);
-    deserializeJson(doc, message);
-    
-    if (doc.containsKey("state")) {
-      bool newState = doc["state"];
-      setLED(newState);
-      publishLedStatus();
+  if (strcmp(topic, TOPIC_LED_CONTROL) == 0) {
+    if (parseJsonCommand(message, length, TRANSPORT_MQTT, command) &&
+        command.type == CMD_LED_SET) {
+      bus.dispatch(command);  // Published by onLedChangedMqtt
     } else {
       Serial.println("Invalid LED control message - missing 'state' field");
     }
   }
   // Handle device commands
-  else if (String(topic) == TOPIC_DEVICE_COMMAND) {
-    if (message == "status") {
+  else if (strcmp(topic, TOPIC_DEVICE_COMMAND) == 0) {
+    parseTextCommand(message, length, TRANSPORT_MQTT, command);
+    
+    if (command.type == CMD_STATUS) {
       publishDeviceStatus();
-    } else if (message == "restart") {
+    } else if (command.type == CMD_RESTART) {
       Serial.println("Restart command received - restarting in 3 seconds...");
+      STALL_SECTION(stallWatchdog, "restart_delay");
       delay(3000);
-      ESP.restart();
+      FlightLog::restart("mqtt_command");
     } else {
-      Serial.println("Unknown command: " + message);
+      Serial.print("Unknown command: ");
+      Serial.write(payload, length);
+      Serial.println();
     }
   }
 }
 
 /**
- * @brief Connect to WiFi with timeout
+ * @brief Start connecting to WiFi; finishWiFi() waits for the result
+ *
+ * After the first connect the channel and BSSID are cached, so a reboot
+ * skips the scan (FastWiFi.h)
  */
-bool connectWiFi() {
+void startWiFi() {
+  Serial.println("\n=== Connecting to WiFi ===");
   Serial.print("Connecting to WiFi: ");
-  Serial.println(wifiSSID);
-  
-  WiFi.mode(WIFI_STA);
+  Serial.println(wifiCache.ssid());
+  Serial.println(wifiCache.password()[0] != '\0' ? "(Secured network)" : "(Open network)");
   
-  // Connect with or without password
-  if (wifiPassword.length() > 0) {
-    Serial.println("(Secured network)");
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-  } else {
-    Serial.println("(Open network)");
-    WiFi.begin(wifiSSID.c_str());
+  wifiPhase = boot.begin("wifi", micros());
+  wifiConnector.start(wifiCache, WIFI_TIMEOUT_MS, REUSE_DHCP_LEASE);
+}
+
+/**
+ * @brief Wait for the connection startWiFi() began, with timeout
+ */
+bool finishWiFi() {
+  FastWiFi::Result result;
+  while ((result = wifiConnector.update()) == FastWiFi::PENDING) {
+    delay(FastWiFi::POLL_MS);
   }
-  
-  uint32_t start = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - start > WIFI_TIMEOUT_MS) {
-      Serial.println(" FAILED");
-      Serial.println("Connection timeout - check credentials");
-      return false;
-    }
-    delay(500);
-    Serial.print(".");
+  boot.end(wifiPhase, micros());
+  boot.setNote(FastWiFi::describe(result, wifiCache, REUSE_DHCP_LEASE));
+  if (result == FastWiFi::FAILED) {
+    Serial.println(" FAILED");
+    Serial.println("Connection timeout - check credentials");
+    return false;
   }
   
-  Serial.println(" CONNECTED");
+  Serial.print(" CONNECTED (");
+  Serial.print(result == FastWiFi::CACHED_AP ? "cached AP" : "full scan");
+  Serial.println(")");
   Serial.print("IP Address: ");
   Serial.println(WiFi.localIP());
   Serial.print("Signal: ");
   Serial.print(WiFi.RSSI());
   Serial.println(" dBm");
+  if (!FastWiFi::remember(wifiCache, REUSE_DHCP_LEASE)) {
+    Serial.println("WARNING: could not save WiFi settings - next boot will ask again");
+  }
   
-  // Generate device ID from MAC address
-  deviceId = WiFi.macAddress();
-  deviceId.replace(":", "");
+  // Device ID is the MAC address without separators
+  WiFiIdentity::begin(identity);
   Serial.print("Device ID: ");
-  Serial.println(deviceId);
+  Serial.println(identity.deviceId());
   
   return true;
 }
@@ -269,14 +285,24 @@ bool connectWiFi() {
  * @brief Connect to MQTT broker
  */
 bool connectMqtt() {
+  STALL_SECTION(stallWatchdog, "mqtt_connect");  // Blocks until the broker answers or times out
   Serial.print("Connecting to MQTT broker: ");
   Serial.println(MQTT_SERVER);
   
   String clientId = CLIENT_ID;
-  clientId += "_" + deviceId;
+  clientId += "_";
+  clientId += identity.deviceId();
   
   if (mqttClient.connect(clientId.c_str())) {
+    mqttMetrics.connects++;
+    mqttWasConnected = true;
+    FlightLog::record(FLIGHT_MQTT_UP);
     Serial.println("MQTT connected successfully");
+    if (boot.ready("mqtt_connect", micros())) {
+      StaticResponseBuffer<192> line;
+      boot.report(line);
+      Serial.println(line.c_str());
+    }
     
     // Subscribe to topics
     mqttClient.subscribe(TOPIC_LED_CONTROL);
@@ -291,6 +317,7 @@ bool connectMqtt() {
     
     return true;
   } else {
+    mqttMetrics.connectFailed++;
     Serial.print("MQTT connection failed, rc=");
     Serial.println(mqttClient.state());
     return false;
@@ -298,93 +325,142 @@ bool connectMqtt() {
 }
 
 /**
- * @brief Monitor WiFi connection
+ * @brief Monitor MQTT connection (scheduled task)
+ */
+void checkMqtt(void*) {
+  if (WiFiReconnect::down()) return;  // A broker connect would only block until it times out
+  if (!mqttClient.connected()) {
+    Serial.println("MQTT disconnected - attempting reconnection");
+    if (mqttWasConnected) {
+      mqttWasConnected = false;
+      FlightLog::record(FLIGHT_MQTT_DOWN, 0, (uint16_t)mqttClient.state());
+    }
+    connectMqtt();
+  }
+}
+
+/**
+ * @brief Act on WiFi events; WiFiReconnect.h retries with backoff
+ *
+ * The broker session is re-established as soon as there is an address,
+ * not at the next MQTT check.
  */
 void checkWiFi() {
-  uint32_t now = millis();
-  if (now - lastWifiCheck < WIFI_CHECK_INTERVAL_MS) return;
-  
-  lastWifiCheck = now;
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi lost - reconnecting");
-    WiFi.reconnect();
+  switch (WiFiReconnect::poll(millis())) {
+    case WiFiReconnect::LOST:
+      Serial.println("WiFi lost - reconnecting");
+      break;
+    case WiFiReconnect::CONNECTED:
+      Serial.print("WiFi back after ");
+      Serial.print(WiFiReconnect::policy().lastRecoveryMs());
+      Serial.println(" ms");
+      checkMqtt(nullptr);
+      break;
+    default:
+      break;
   }
 }
 
 /**
- * @brief Monitor MQTT connection
+ * @brief Publish status periodically (scheduled task)
  */
-void checkMqtt() {
-  if (!mqttClient.connected()) {
-    uint32_t now = millis();
-    if (now - lastMqttReconnect > MQTT_RECONNECT_INTERVAL_MS) {
-      lastMqttReconnect = now;
-      Serial.println("MQTT disconnected - attempting reconnection");
-      connectMqtt();
-    }
+void handlePeriodicStatus(void*) {
+  HEAP_TAG("mqtt_status");
+  FlightLog::noteHeap(ESP.getFreeHeap());
+  if (mqttClient.connected()) {
+    publishDeviceStatus();
   }
 }
 
 /**
- * @brief Publish status periodically
+ * @brief Everything GET /metrics reports
  */
-void handlePeriodicStatus() {
-  uint32_t now = millis();
-  if (now - lastStatusPublish > STATUS_PUBLISH_INTERVAL_MS) {
-    lastStatusPublish = now;
-    if (mqttClient.connected()) {
-      publishDeviceStatus();
-    }
+void collectMetrics(MetricsWriter& out) {
+  out.counter("mqtt_publish_total", "MQTT publishes accepted by the client", mqttMetrics.published);
+  out.counter("mqtt_publish_failures_total", "MQTT publishes that failed",
+              mqttMetrics.publishFailed);
+  out.counter("mqtt_messages_received_total", "MQTT messages received", mqttMetrics.received);
+  out.counter("mqtt_connects_total", "Successful broker connections", mqttMetrics.connects);
+  out.counter("mqtt_connect_failures_total", "Failed broker connections",
+              mqttMetrics.connectFailed);
+  out.gauge("mqtt_connected", "1 while connected to the broker", mqttClient.connected() ? 1 : 0);
+  out.counter("led_state_changes_total", "LED changes from any transport", bus.state().revision);
+  stallWatchdog.write(out);
+  MetricsEndpoint::writeDevice(out, loopTime);
+  boot.write(out);
+  WiFiReconnect::write(out);
+}
+
+/**
+ * @brief GET /stalls - worst loop() stalls (?reset=1 clears them)
+ */
+void handleStalls() {
+  StallMonitor::report(stallWatchdog, stallReport);
+  metricsServer.send(200, "text/plain", stallReport.c_str());
+  stallReport.clear();
+  if (metricsServer.hasArg("reset")) stallWatchdog.reset();
+}
+
+/**
+ * @brief Serial "stalls" / "stalls reset" / "flight" / "flight clear"
+ */
+void pollSerialCommands() {
+  if (serialCommand.poll(Serial, millis()) != LineAssembler::LINE_READY) return;
+  if (strcmp(serialCommand.line(), "stalls") == 0) {
+    StallMonitor::report(stallWatchdog, stallReport);
+    stallReport.flushTo(Serial);
+  } else if (strcmp(serialCommand.line(), "stalls reset") == 0) {
+    stallWatchdog.reset();
+    Serial.println("Stalls reset");
+  } else if (strcmp(serialCommand.line(), "flight") == 0) {
+    FlightLog::print();
+  } else if (strcmp(serialCommand.line(), "flight clear") == 0) {
+    FlightLog::recorder()->clear(millis());
+    Serial.println("Flight log cleared");
   }
 }
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);
+  
+  // With saved credentials WiFi associates while the rest of setup() runs,
+  // and there is no prompt to wait for a serial monitor
+  bool saved = FastWiFi::load(wifiCache);
+  if (saved) {
+    startWiFi();
+  } else {
+    delay(1000);
+  }
   
   // Clear serial buffer
   while (Serial.available()) {
     Serial.read();
   }
+  FlightLog::begin(flightStorage);  // Prints the events before the last reset
+  FlightLog::watch(stallWatchdog);
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.subscribe(onLedChangedMqtt);
+  bus.applyOutput();  // LED off
   
   Serial.println("\n\n=== ESP32 MQTT Controller ===");
   Serial.println("Firmware Version: 1.0");
   Serial.println();
   
-  // Get WiFi credentials from user (retry until valid input)
-  while (!getWiFiCredentials()) {
-    delay(2000);  // Wait 2 seconds before prompting again
-  }
-  
-  // Connect to WiFi
-  Serial.println("\n=== Connecting to WiFi ===");
-  if (!connectWiFi()) {
-    Serial.println("\nERROR: WiFi connection failed");
-    Serial.println("Please reset and check:");
-    Serial.println("  1. SSID is correct");
-    Serial.println("  2. Password is correct (if secured)");
-    Serial.println("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
-    Serial.println("  4. Router is powered on");
-    while(1) {
-      delay(1000);
-    }
-  }
-  
-  // Configure MQTT
-  Serial.println("\n=== Setting up MQTT ===");
+  // Configure MQTT and the metrics server; both start once WiFi has an address
   mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
   mqttClient.setCallback(onMqttMessage);
+  MetricsEndpoint::begin(metricsServer, collectMetrics);
+  metricsServer.on("/stalls", HTTP_GET, handleStalls);
+  FlightLog::on(metricsServer);
   
-  // Connect to MQTT
-  if (!connectMqtt()) {
-    Serial.println("WARNING: MQTT connection failed - will retry in loop");
-  }
+  uint32_t now = millis();
+  scheduler.every(MQTT_RECONNECT_INTERVAL_MS, checkMqtt, nullptr, now);
+  scheduler.every(STATUS_PUBLISH_INTERVAL_MS, handlePeriodicStatus, nullptr, now);
   
-  Serial.println("\n=== MQTT Topics ===");
+  Serial.println("=== MQTT Topics ===");
   Serial.println("Subscribe to control LED:");
   Serial.println("  Topic: " + String(TOPIC_LED_CONTROL));
   Serial.println("  Payload: {\"state\": true} or {\"state\": false}");
@@ -396,26 +472,76 @@ void setup() {
   Serial.println("Device publishes to:");
   Serial.println("  " + String(TOPIC_LED_STATUS) + " (LED state changes)");
   Serial.println("  " + String(TOPIC_DEVICE_STATUS) + " (Full status)");
-  Serial.println();
-  Serial.println("=== Device Information ===");
-  Serial.println("Device ID: " + deviceId);
+  boot.mark("init", micros());  // Includes the banner: Serial output blocks at 115200 baud
+  
+  // Serial, BLE or the setup AP, whichever delivers first, unless saved
+  if (!wifiCache.hasCredentials()) {
+    ProvisioningPortal::run(wifiCache);
+    boot.mark("credentials", micros());
+    startWiFi();
+  }
+  
+  while (!finishWiFi()) {
+    if (!saved) {
+      // Just entered, so never saved: drop them and ask again
+      Serial.println("\nERROR: WiFi connection failed");
+      Serial.println("Enter the credentials again, and check:");
+      Serial.println("  1. SSID is correct");
+      Serial.println("  2. Password is correct (if secured)");
+      Serial.println("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
+      Serial.println("  4. Router is powered on");
+      wifiCache.clear();
+      ProvisioningPortal::run(wifiCache);
+      startWiFi();
+      continue;
+    }
+    // The saved network may just be down: new credentials, or retry on timeout
+    Serial.println("\nSaved WiFi network not reachable");
+    Serial.println("Enter new credentials, or wait to retry the saved ones");
+    if (ProvisioningPortal::run(wifiCache, PROVISION_TIMEOUT_MS)) saved = false;
+    startWiFi();
+  }
+  boot.mark("wifi_wait", micros());  // Setup time spent waiting for the address
+  WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());  // Drops from here on
+  
+  metricsServer.begin();
+  boot.mark("listen", micros());
+  
+  // Connect to MQTT
+  Serial.println("\n=== Connecting to MQTT ===");
+  if (!connectMqtt()) {
+    Serial.println("WARNING: MQTT connection failed - will retry in loop");
+  }
+  
+  Serial.println("\n=== Device Information ===");
+  Serial.println("Device ID: " + String(identity.deviceId()));
   Serial.print("IP Address: ");
   Serial.println(WiFi.localIP());
   Serial.println("MQTT Broker: " + String(MQTT_SERVER) + ":" + String(MQTT_PORT));
+  Serial.print("Metrics: http://");
+  Serial.print(WiFi.localIP());
+  Serial.println("/metrics");
   Serial.println("=======================");
   Serial.println("\nReady! Listening for MQTT messages...\n");
+  
+  StallMonitor::begin(stallWatchdog);
 }
 
 void loop() {
+  stallWatchdog.tick(millis());
+  uint32_t start = micros();
+  checkWiFi();
+  WiFiIdentity::refresh();  // Re-format IP/SSID only after a WiFi event
+  
   // Handle MQTT
   mqttClient.loop();
+  metricsServer.handleClient();
   
-  // Monitor connections
-  checkWiFi();
-  checkMqtt();
-  
-  // Periodic status updates
-  handlePeriodicStatus();
+  // MQTT check and periodic status updates
+  scheduler.run(millis());
+  pollSerialCommands();
+  loopTime.observe(micros() - start);
   
-  delay(10);
+  // Sleep until the next task is due or a packet arrives (no fixed delay)
+  LoopIdle::wait(scheduler.msUntilNext(millis()), mqttMetrics.received);
 }
\ No newline at end of file
@@ -1,5 +1,24 @@
 #include <WiFi.h>
 #include <WebSocketsServer.h>
+#include <CommandBus.h>  // From esp32-common/ (see esp32-common/README.md)
+#include <CommandParser.h>
+#include <DeviceIdentity.h>
+#include <WiFiIdentity.h>
+#include <WiFiReconnect.h>
+#include <WiFiPowerSave.h>
+#include <Scheduler.h>
+#include <LoopIdle.h>
+#include <RequestArena.h>
+#include <JsonWriter.h>
+#include <FastWiFi.h>
+#include <ProvisioningPortal.h>
+#include <BootTimeline.h>
+
+// Serial log lines above this level are compiled out (see esp32-common Log.h)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#include <Log.h>
 
 // Hardware Configuration
 const uint8_t LED_PIN = 2;
@@ -7,205 +26,172 @@ const uint16_t WEBSOCKET_PORT = 81;
 
 // Timing Configuration
 const uint32_t WIFI_TIMEOUT_MS = 10000;
-const uint32_t WIFI_CHECK_INTERVAL_MS = 30000;
-const uint32_t SERIAL_TIMEOUT_MS = 30000;
+const uint32_t PROVISION_TIMEOUT_MS = 30000;  // Saved network down: wait this long for new credentials
 const uint32_t STATUS_BROADCAST_INTERVAL_MS = 5000;
 
+// WiFi power save: off while clients are connected or for
+// POWER_SAVE_IDLE_MS after a frame, then modem sleep, deeper after
+// POWER_SAVE_DEEP_IDLE_MS (0: never). See WiFiPowerSave.h
+const uint32_t POWER_SAVE_IDLE_MS = 10000;
+const uint32_t POWER_SAVE_DEEP_IDLE_MS = 120000;
+
+// Reboots reuse the last DHCP address instead of asking again: saves up to
+// a second, but only safe where the router reserves it (see FastWiFi.h)
+const bool REUSE_DHCP_LEASE = false;
+
+// Per-message memory for response JSON; overflow spills to the heap
+const size_t REQUEST_ARENA_SIZE = 512;
+
 // Global Objects
 WebSocketsServer webSocket = WebSocketsServer(WEBSOCKET_PORT);
 
 // State
-bool ledState = false;
-uint32_t lastWifiCheck = 0;
-uint32_t lastStatusBroadcast = 0;
-String wifiSSID = "";
-String wifiPassword = "";
+CommandBus bus;  // LED state store
+DeviceIdentity identity;  // MAC/IP/SSID formatted once, not per request
+Scheduler scheduler;      // Periodic status broadcast
+StaticRequestArena<REQUEST_ARENA_SIZE> requestArena;  // Reset after every message
+WiFiCache wifiCache;  // Credentials, AP and address saved in NVS
+BootTimeline boot;    // Reset to the first client's status, logged once
+FastWiFi::Connector wifiConnector;  // Associates while setup() does the rest
+uint8_t wifiPhase = BootTimeline::NO_PHASE;
+uint32_t framesReceived = 0;  // Activity for WiFiPowerSave
 
 /**
- * @brief Read line from Serial with timeout
+ * @brief Drive the LED pin (CommandBus output hook)
  */
-String readSerialLine(uint32_t timeout) {
-  String input = "";
-  uint32_t start = millis();
-  
-  while (millis() - start < timeout) {
-    if (Serial.available()) {
-      char c = Serial.read();
-      if (c == '\n' || c == '\r') {
-        return input;
-      } else {
-        input += c;
-      }
-    }
-    delay(10);
-  }
-  return input;
+void writeLed(const DeviceState& state) {
+  digitalWrite(LED_PIN, state.led ? HIGH : LOW);
 }
 
 /**
- * @brief Get WiFi credentials from Serial Monitor
+ * @brief WebSocket adapter - tell the other clients about an LED change
+ *
+ * The client that issued the command already gets a response message.
  */
-bool getWiFiCredentials() {
-  Serial.println("\n=== WiFi Configuration ===");
-  Serial.println("Please enter your WiFi credentials");
-  Serial.println();
-  
-  // Get SSID
-  Serial.print("Enter WiFi SSID: ");
-  wifiSSID = readSerialLine(SERIAL_TIMEOUT_MS);
+void onLedChangedWebSocket(const StateEvent& event, void*) {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  json.beginObject()
+      .field("type", "led_update")
+      .field("led", event.state.led)
+      .field("source", transportName(event.source))
+      .field("timestamp", millis())
+      .endObject();
   
-  if (wifiSSID.length() == 0) {
-    Serial.println("\nERROR: Empty input - SSID is required");
-    Serial.println("Please try again\n");
-    return false;
-  }
-  
-  Serial.println(wifiSSID);
-  
-  // Get Password (can be empty for open networks)
-  Serial.print("Enter WiFi Password (press Enter if open network): ");
-  wifiPassword = readSerialLine(SERIAL_TIMEOUT_MS);
-  
-  if (wifiPassword.length() == 0) {
-    Serial.println("[OPEN NETWORK]");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.println("  Password: [NONE - Open Network]");
-  } else {
-    Serial.println("********");
-    Serial.println();
-    Serial.println("Credentials received:");
-    Serial.print("  SSID: ");
-    Serial.println(wifiSSID);
-    Serial.print("  Password: ");
-    for (int i = 0; i < wifiPassword.length(); i++) {
-      Serial.print("*");
-    }
-    Serial.println();
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    if (event.source == TRANSPORT_WEBSOCKET && event.client == i) continue;
+    if (webSocket.clientIsConnected(i)) webSocket.sendTXT(i, json.c_str(), json.length());
   }
-  
-  return true;
-}
-
-/**
- * @brief Control LED state
- */
-void setLED(bool state) {
-  ledState = state;
-  digitalWrite(LED_PIN, state ? HIGH : LOW);
 }
 
 /**
  * @brief Build JSON status message
+ * @param request Command answered, so the sender can tell its reply from a broadcast
  */
-String buildStatusJson() {
-  String json = "{";
-  json += "\"type\":\"status\"";
-  json += ",\"device\":\"ESP32\"";
-  json += ",\"ip\":\"" + WiFi.localIP().toString() + "\"";
-  json += ",\"ssid\":\"" + WiFi.SSID() + "\"";
-  json += ",\"rssi\":" + String(WiFi.RSSI());
-  json += ",\"led\":" + String(ledState ? "true" : "false");
-  json += ",\"uptime\":" + String(millis() / 1000);
-  json += ",\"heap\":" + String(ESP.getFreeHeap());
-  json += ",\"timestamp\":" + String(millis());
-  json += "}";
-  return json;
+void buildStatusJson(JsonWriter& json, const char* request = nullptr) {
+  json.beginObject()
+      .field("type", "status");
+  if (request != nullptr) json.field("request", request);
+  json.field("device", "ESP32")
+      .field("ip", identity.ip())
+      .field("ssid", identity.ssid())
+      .field("rssi", WiFi.RSSI())
+      .field("led", bus.led())
+      .field("uptime", millis() / 1000)
+      .field("heap", ESP.getFreeHeap());
+  WiFiReconnect::writeStatusJson(json);
+  WiFiPowerSave::writeStatusJson(json);
+  json.field("timestamp", millis())
+      .endObject();
 }
 
 /**
  * @brief Build JSON response message
  */
-String buildResponseJson(bool success, const char* message) {
-  String json = "{";
-  json += "\"type\":\"response\"";
-  json += ",\"success\":";
-  json += success ? "true" : "false";
-  json += ",\"message\":\"";
-  json += message;
-  json += "\"";
-  json += ",\"led\":";
-  json += ledState ? "true" : "false";
-  json += ",\"timestamp\":" + String(millis());
-  json += "}";
-  return json;
+void buildResponseJson(JsonWriter& json, bool success, const char* message) {
+  json.beginObject()
+      .field("type", "response")
+      .field("success", success)
+      .field("message", message)
+      .field("led", bus.led())
+      .field("timestamp", millis())
+      .endObject();
 }
 
 /**
  * @brief Handle incoming WebSocket messages
  */
-void handleWebSocketMessage(uint8_t clientNum, String payload) {
-  Serial.print("Message from client ");
-  Serial.print(clientNum);
-  Serial.print(": ");
-  Serial.println(payload);
+void handleWebSocketMessage(uint8_t clientNum, const char* payload, size_t length) {
+  LOG_DEBUG("Message from client %u: %.*s", clientNum, (int)length, payload);
   
-  payload.toLowerCase();
+  Command command;
+  parseJsonCommand(payload, length, TRANSPORT_WEBSOCKET, command);
+  command.client = clientNum;
   
-  // Parse JSON command
-  if (payload.indexOf("\"command\":\"led_on\"") >= 0) {
-    setLED(true);
-    String response = buildResponseJson(true, "LED ON");
-    webSocket.sendTXT(clientNum, response);
-    Serial.println("LED turned ON");
-    
-  } else if (payload.indexOf("\"command\":\"led_off\"") >= 0) {
-    setLED(false);
-    String response = buildResponseJson(true, "LED OFF");
-    webSocket.sendTXT(clientNum, response);
-    Serial.println("LED turned OFF");
-    
-  } else if (payload.indexOf("\"command\":\"toggle\"") >= 0) {
-    setLED(!ledState);
-    String response = buildResponseJson(true, ledState ? "LED ON" : "LED OFF");
-    webSocket.sendTXT(clientNum, response);
-    Serial.println("LED toggled");
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  switch (command.type) {
+    case CMD_LED_SET:
+    case CMD_LED_TOGGLE:
+      bus.dispatch(command);
+      buildResponseJson(json, true, bus.led() ? "LED ON" : "LED OFF");
+      LOG_INFO("LED turned %s", bus.led() ? "ON" : "OFF");
+      break;
     
-  } else if (payload.indexOf("\"command\":\"status\"") >= 0) {
-    String status = buildStatusJson();
-    webSocket.sendTXT(clientNum, status);
-    Serial.println("Status sent");
+    case CMD_STATUS:
+      buildStatusJson(json, "status");
+      LOG_DEBUG("Status sent");
+      break;
     
-  } else {
-    String response = buildResponseJson(false, "Unknown command");
-    webSocket.sendTXT(clientNum, response);
-    Serial.println("Unknown command received");
+    default:
+      buildResponseJson(json, false, "Unknown command");
+      LOG_WARN("Unknown command received");
+      break;
   }
+  webSocket.sendTXT(clientNum, json.c_str(), json.length());
+}
+
+/**
+ * @brief Close the boot timeline when the first client has its status, and log it
+ */
+void logBootDone() {
+  if (!boot.ready("first_client", micros())) return;
+  StaticResponseBuffer<192> line;
+  boot.report(line);
+  LOG_INFO("%s", line.c_str());
 }
 
 /**
  * @brief WebSocket event handler
  */
 void webSocketEvent(uint8_t clientNum, WStype_t type, uint8_t* payload, size_t length) {
+  LoopIdle::markBusy();  // The library may hold more frames; don't idle yet
+  
   switch(type) {
     case WStype_DISCONNECTED:
-      Serial.print("Client ");
-      Serial.print(clientNum);
-      Serial.println(" disconnected");
+      LOG_INFO("Client %u disconnected", clientNum);
       break;
       
     case WStype_CONNECTED: {
       IPAddress ip = webSocket.remoteIP(clientNum);
-      Serial.print("Client ");
-      Serial.print(clientNum);
-      Serial.print(" connected from ");
-      Serial.println(ip);
+      LOG_INFO("Client %u connected from %u.%u.%u.%u", clientNum, ip[0], ip[1], ip[2], ip[3]);
       
       // Send initial status
-      String status = buildStatusJson();
-      webSocket.sendTXT(clientNum, status);
+      RequestArena::Scope scope(requestArena);
+      JsonWriter json(requestArena);
+      buildStatusJson(json);
+      webSocket.sendTXT(clientNum, json.c_str(), json.length());
+      logBootDone();
       break;
     }
     
     case WStype_TEXT:
-      handleWebSocketMessage(clientNum, String((char*)payload));
+      framesReceived++;
+      handleWebSocketMessage(clientNum, (const char*)payload, length);
       break;
       
     case WStype_ERROR:
-      Serial.print("WebSocket error on client ");
-      Serial.println(clientNum);
+      LOG_WARN("WebSocket error on client %u", clientNum);
       break;
       
     default:
@@ -214,72 +200,86 @@ void webSocketEvent(uint8_t clientNum, WStype_t type, uint8_t* payload, size_t l
 }
 
 /**
- * @brief Broadcast status to all connected clients
+ * @brief Broadcast status to all connected clients (scheduled task)
  */
-void broadcastStatus() {
-  uint32_t now = millis();
-  if (now - lastStatusBroadcast < STATUS_BROADCAST_INTERVAL_MS) return;
-  
-  lastStatusBroadcast = now;
-  String status = buildStatusJson();
-  webSocket.broadcastTXT(status);
-  Serial.println("Status broadcast to all clients");
+void broadcastStatus(void*) {
+  RequestArena::Scope scope(requestArena);
+  JsonWriter json(requestArena);
+  buildStatusJson(json);
+  webSocket.broadcastTXT(json.c_str(), json.length());
+  LOG_DEBUG("Status broadcast to all clients");
 }
 
 /**
- * @brief Connect to WiFi with timeout
+ * @brief Start connecting to WiFi; finishWiFi() waits for the result
+ *
+ * After the first connect the channel and BSSID are cached, so a reboot
+ * skips the scan (FastWiFi.h)
  */
-bool connectWiFi() {
-  Serial.print("Connecting to WiFi: ");
-  Serial.println(wifiSSID);
-  
-  WiFi.mode(WIFI_STA);
-  
-  if (wifiPassword.length() > 0) {
-    Serial.println("(Secured network)");
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-  } else {
-    Serial.println("(Open network)");
-    WiFi.begin(wifiSSID.c_str());
+void startWiFi() {
+  LOG_INFO("Connecting to WiFi: %s (%s network)", wifiCache.ssid(),
+           wifiCache.password()[0] != '\0' ? "Secured" : "Open");
+  wifiPhase = boot.begin("wifi", micros());
+  wifiConnector.start(wifiCache, WIFI_TIMEOUT_MS, REUSE_DHCP_LEASE);
+}
+
+/**
+ * @brief Wait for the connection startWiFi() began, with timeout
+ */
+bool finishWiFi() {
+  FastWiFi::Result result;
+  while ((result = wifiConnector.update()) == FastWiFi::PENDING) {
+    delay(FastWiFi::POLL_MS);
   }
-  
-  uint32_t start = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - start > WIFI_TIMEOUT_MS) {
-      Serial.println(" FAILED");
-      Serial.println("Connection timeout - check credentials");
-      return false;
-    }
-    delay(500);
-    Serial.print(".");
+  boot.end(wifiPhase, micros());
+  boot.setNote(FastWiFi::describe(result, wifiCache, REUSE_DHCP_LEASE));
+  if (result == FastWiFi::FAILED) {
+    LOG_ERROR("WiFi connection timeout - check credentials");
+    return false;
   }
   
-  Serial.println(" CONNECTED");
-  Serial.print("IP Address: ");
-  Serial.println(WiFi.localIP());
-  Serial.print("Signal: ");
-  Serial.print(WiFi.RSSI());
-  Serial.println(" dBm");
+  IPAddress ip = WiFi.localIP();
+  LOG_INFO("WiFi connected (%s) | IP Address: %u.%u.%u.%u | Signal: %d dBm",
+           result == FastWiFi::CACHED_AP ? "cached AP" : "full scan",
+           ip[0], ip[1], ip[2], ip[3], (int)WiFi.RSSI());
+  if (!FastWiFi::remember(wifiCache, REUSE_DHCP_LEASE)) {
+    LOG_WARN("Could not save WiFi settings - next boot will ask again");
+  }
   return true;
 }
 
 /**
- * @brief Monitor WiFi connection
+ * @brief Act on WiFi events; WiFiReconnect.h retries with backoff
+ *
+ * Clients whose connection survived the outage missed the broadcasts made
+ * during it, so they get the current state at once.
  */
 void checkWiFi() {
-  uint32_t now = millis();
-  if (now - lastWifiCheck < WIFI_CHECK_INTERVAL_MS) return;
-  
-  lastWifiCheck = now;
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi lost - reconnecting");
-    WiFi.reconnect();
+  switch (WiFiReconnect::poll(millis())) {
+    case WiFiReconnect::LOST:
+      LOG_WARN("WiFi lost - reconnecting");
+      break;
+    case WiFiReconnect::CONNECTED:
+      LOG_INFO("WiFi back after %lu ms", (unsigned long)WiFiReconnect::policy().lastRecoveryMs());
+      broadcastStatus(nullptr);
+      break;
+    default:
+      break;
   }
 }
 
 void setup() {
   Serial.begin(115200);
-  delay(1000);
+  Log::begin(Serial);
+  
+  // With saved credentials WiFi associates while the rest of setup() runs,
+  // and there is no prompt to wait for a serial monitor
+  bool saved = FastWiFi::load(wifiCache);
+  if (saved) {
+    startWiFi();
+  } else {
+    delay(1000);
+  }
   
   // Clear serial buffer
   while (Serial.available()) {
@@ -288,55 +288,69 @@ void setup() {
   
   // Initialize hardware
   pinMode(LED_PIN, OUTPUT);
-  setLED(false);
+  bus.setOutput(writeLed);
+  bus.subscribe(onLedChangedWebSocket);
+  bus.applyOutput();  // LED off
   
-  Serial.println("\n\n=== ESP32 WebSocket Server ===");
-  Serial.println("Firmware Version: 1.0");
-  Serial.println();
+  LOG_INFO("=== ESP32 WebSocket Server ===");
+  LOG_INFO("Firmware Version: 1.0");
   
-  // Get WiFi credentials (retry until valid input)
-  while (!getWiFiCredentials()) {
-    delay(2000);  // Wait 2 seconds before prompting again
+  // Configure the server; it listens once WiFi has an address
+  webSocket.onEvent(webSocketEvent);
+  scheduler.every(STATUS_BROADCAST_INTERVAL_MS, broadcastStatus, nullptr, millis());
+  LOG_INFO("=== Available Commands ===");
+  LOG_INFO("{\"command\":\"led_on\"}    - Turn LED on");
+  LOG_INFO("{\"command\":\"led_off\"}   - Turn LED off");
+  LOG_INFO("{\"command\":\"toggle\"}    - Toggle LED");
+  LOG_INFO("{\"command\":\"status\"}    - Get status");
+  boot.mark("init", micros());  // Includes the banner: Serial output blocks at 115200 baud
+  
+  // Serial, BLE or the setup AP, whichever delivers first, unless saved
+  if (!wifiCache.hasCredentials()) {
+    ProvisioningPortal::run(wifiCache);
+    boot.mark("credentials", micros());
+    startWiFi();
   }
   
-  // Connect to WiFi
-  Serial.println("\n=== Connecting to WiFi ===");
-  if (!connectWiFi()) {
-    Serial.println("\nERROR: WiFi connection failed");
-    Serial.println("Please reset and check:");
-    Serial.println("  1. SSID is correct");
-    Serial.println("  2. Password is correct (if secured)");
-    Serial.println("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
-    Serial.println("  4. Router is powered on");
-    while(1) {
-      delay(1000);
+  while (!finishWiFi()) {
+    if (!saved) {
+      // Just entered, so never saved: drop them and ask again
+      LOG_ERROR("WiFi connection failed. Enter the credentials again, and check:");
+      LOG_ERROR("  1. SSID is correct");
+      LOG_ERROR("  2. Password is correct (if secured)");
+      LOG_ERROR("  3. WiFi is 2.4GHz (ESP32 doesn't support 5GHz)");
+      LOG_ERROR("  4. Router is powered on");
+      wifiCache.clear();
+      ProvisioningPortal::run(wifiCache);
+      startWiFi();
+      continue;
     }
+    // The saved network may just be down: new credentials, or retry on timeout
+    LOG_WARN("Saved WiFi network not reachable - enter new credentials or wait to retry");
+    if (ProvisioningPortal::run(wifiCache, PROVISION_TIMEOUT_MS)) saved = false;
+    startWiFi();
   }
+  boot.mark("wifi_wait", micros());  // Setup time spent waiting for the address
+  WiFiReconnect::begin(wifiCache.ssid(), wifiCache.password());  // Drops from here on
+  WiFiPowerSave::begin(POWER_SAVE_IDLE_MS, POWER_SAVE_DEEP_IDLE_MS);
+  
+  WiFiIdentity::begin(identity);
   
   // Start WebSocket server
-  Serial.println("\n=== Starting WebSocket Server ===");
   webSocket.begin();
-  webSocket.onEvent(webSocketEvent);
-  Serial.println("WebSocket server started successfully!");
-  Serial.println();
-  Serial.println("=== Available Commands ===");
-  Serial.println("{\"command\":\"led_on\"}    - Turn LED on");
-  Serial.println("{\"command\":\"led_off\"}   - Turn LED off");
-  Serial.println("{\"command\":\"toggle\"}    - Toggle LED");
-  Serial.println("{\"command\":\"status\"}    - Get status");
-  Serial.println();
-  Serial.println("=== Connection Info ===");
-  Serial.print("ws://");
-  Serial.print(WiFi.localIP());
-  Serial.print(":");
-  Serial.println(WEBSOCKET_PORT);
-  Serial.println("========================");
-  Serial.println("\nReady! Waiting for connections...\n");
+  boot.mark("listen", micros());
+  LOG_INFO("WebSocket server started: ws://%s:%u", identity.ip(), WEBSOCKET_PORT);
+  LOG_INFO("Ready! Waiting for connections...");
 }
 
 void loop() {
-  webSocket.loop();
   checkWiFi();
-  broadcastStatus();  // Auto-broadcast status every 5 seconds
-  delay(1);
+  WiFiIdentity::refresh();  // Re-format MAC/IP/SSID only after a WiFi event
+  WiFiPowerSave::update(millis(), framesReceived, webSocket.connectedClients());
+  webSocket.loop();
+  scheduler.run(millis());  // broadcastStatus (every 5 seconds)
+  
+  // Sleep until the next task is due or a frame arrives (no fixed delay;
+  // reconnect attempts wait at most LoopIdle::MAX_WAIT_MS extra)
+  LoopIdle::wait(scheduler.msUntilNext(millis()), framesReceived);
 }